@@ -206,6 +206,10 @@ if [ -z $module ] || [ "$module" = 'auth_client' -o "$module" = 'authclient' ];
     cd $base_path/src/auth/client/tools
     replace_makefile
     make $param1 $param2
+
+    cd $base_path/src/auth/client/tests
+    replace_makefile
+    make $param1 $param2
   fi
 fi
 
@@ -214,6 +218,10 @@ if [ -z $module ] || [ "$module" = 'vote_server' -o "$module" = 'voteserver' ];
     cd $base_path/src/vote/server
     replace_makefile
     make $param1 $param2
+
+    cd $base_path/src/vote/tests
+    replace_makefile
+    make $param1 $param2
   fi
 fi
 
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <sys/file.h>
+#include "fastcommon/shared_func.h"
+#include "fastcommon/logger.h"
+#include "sf/sf_global.h"
+#include "sf/sf_func.h"
+#include "fcfs_api_util.h"
+#include "append_lease.h"
+
+#define APPEND_LEASE_RELEASE_BATCH_SIZE  64
+
+AppendLeaseContext g_append_lease_ctx;
+
+#define FCFS_API_CTX  g_append_lease_ctx.fcfs_api_ctx
+
+static int append_lease_alloc_init(FCFSAPIAppendLease *lease,
+        struct fast_mblock_man *allocator)
+{
+    return init_pthread_lock(&lease->lock);
+}
+
+#define APPEND_LEASE_GET_BUCKET(inode) (g_append_lease_ctx.htable.buckets + \
+        (inode) % FCFS_API_APPEND_LEASE_HTABLE_CAPACITY)
+
+FCFSAPIAppendLease *append_lease_get(FCFSAPIFileInfo *fi)
+{
+    FCFSAPIAppendLease **bucket;
+    FCFSAPIAppendLease *lease;
+
+    if (fi->append_lease != NULL) {
+        return fi->append_lease;
+    }
+
+    bucket = APPEND_LEASE_GET_BUCKET(fi->dentry.inode);
+    PTHREAD_MUTEX_LOCK(&g_append_lease_ctx.htable.lock);
+    lease = *bucket;
+    while (lease != NULL && lease->inode != fi->dentry.inode) {
+        lease = lease->next;
+    }
+
+    if (lease != NULL) {
+        lease->reffer_count++;
+    } else if ((lease=(FCFSAPIAppendLease *)fast_mblock_alloc_object(
+                    &g_append_lease_ctx.allocator)) != NULL)
+    {
+        lease->held = false;
+        lease->reffer_count = 1;
+        lease->inode = fi->dentry.inode;
+        lease->retry_after = 0;
+        FC_INIT_LIST_HEAD(&lease->dlink);
+        lease->next = *bucket;
+        *bucket = lease;
+    }
+    PTHREAD_MUTEX_UNLOCK(&g_append_lease_ctx.htable.lock);
+
+    fi->append_lease = lease;
+    return lease;
+}
+
+/* return true when no fd refers to the lease */
+static bool append_lease_unref(FCFSAPIAppendLease *lease)
+{
+    FCFSAPIAppendLease **bucket;
+    FCFSAPIAppendLease *previous;
+    bool removed;
+
+    PTHREAD_MUTEX_LOCK(&g_append_lease_ctx.htable.lock);
+    if ((removed=(--lease->reffer_count == 0))) {
+        bucket = APPEND_LEASE_GET_BUCKET(lease->inode);
+        if (*bucket == lease) {
+            *bucket = lease->next;
+        } else {
+            previous = *bucket;
+            while (previous->next != lease) {
+                previous = previous->next;
+            }
+            previous->next = lease->next;
+        }
+    }
+    PTHREAD_MUTEX_UNLOCK(&g_append_lease_ctx.htable.lock);
+
+    return removed;
+}
+
+int append_lease_acquire(FCFSAPIAppendLease *lease)
+{
+    FCFSAPIContext *ctx;
+    int64_t current_time_ms;
+    int64_t space_end;
+    int result;
+
+    ctx = FCFS_API_CTX;
+    current_time_ms = get_current_time_ms();
+    if (current_time_ms < lease->retry_after) {
+        return EWOULDBLOCK;
+    }
+
+    if ((result=fcfs_api_dentry_sys_lock_ex(ctx, &lease->session,
+                    lease->inode, LOCK_NB,
+                    &lease->old_size, &space_end)) != 0)
+    {
+        if (result == EWOULDBLOCK || result == EAGAIN) {
+            /* contended by other clients, fallback to lock per write */
+            lease->retry_after = current_time_ms +
+                ctx->append_lease.lease_ms;
+            result = EWOULDBLOCK;
+        }
+        if (lease->session.mconn != NULL) {
+            fdir_client_close_session(&lease->session,
+                    result != EWOULDBLOCK);
+        }
+        return result;
+    }
+
+    lease->held = true;
+    lease->end = lease->old_size;
+    lease->limit = lease->old_size + ctx->append_lease.max_bytes;
+    lease->inc_alloc = 0;
+    lease->expires = current_time_ms + ctx->append_lease.lease_ms;
+
+    /* the expires of the held list are in ascending order */
+    PTHREAD_MUTEX_LOCK(&g_append_lease_ctx.held.lock);
+    fc_list_add_tail(&lease->dlink, &g_append_lease_ctx.held.head);
+    PTHREAD_MUTEX_UNLOCK(&g_append_lease_ctx.held.lock);
+    return 0;
+}
+
+static int do_release(FCFSAPIAppendLease *lease)
+{
+    FDIRSetDEntrySizeInfo dsize;
+    string_t *ns;
+
+    if (lease->end > lease->old_size) {
+        ns = &FCFS_API_CTX->ns; //set ns for update file_size, space_end etc.
+    } else {
+        ns = NULL;  //do NOT update
+    }
+
+    dsize.inode = lease->inode;
+    dsize.file_size = lease->end;
+    dsize.inc_alloc = lease->inc_alloc;
+    dsize.force = false;
+    dsize.flags = FDIR_DENTRY_FIELD_MODIFIED_FLAG_FILE_SIZE |
+        FDIR_DENTRY_FIELD_MODIFIED_FLAG_SPACE_END;
+    lease->held = false;
+    return fcfs_api_dentry_sys_unlock(&lease->session,
+            ns, lease->old_size, &dsize);
+}
+
+int append_lease_release_ex(FCFSAPIAppendLease *lease)
+{
+    if (!lease->held) {
+        return 0;
+    }
+
+    PTHREAD_MUTEX_LOCK(&g_append_lease_ctx.held.lock);
+    fc_list_del_init(&lease->dlink);
+    PTHREAD_MUTEX_UNLOCK(&g_append_lease_ctx.held.lock);
+    return do_release(lease);
+}
+
+int append_lease_release(FCFSAPIAppendLease *lease)
+{
+    int result;
+
+    PTHREAD_MUTEX_LOCK(&lease->lock);
+    result = append_lease_release_ex(lease);
+    PTHREAD_MUTEX_UNLOCK(&lease->lock);
+    return result;
+}
+
+void append_lease_free(FCFSAPIFileInfo *fi)
+{
+    if (fi->append_lease == NULL) {
+        return;
+    }
+
+    /* report the file size on close for the other processes */
+    append_lease_release(fi->append_lease);
+    if (append_lease_unref(fi->append_lease)) {
+        fast_mblock_free_object(&g_append_lease_ctx.allocator,
+                fi->append_lease);
+    }
+    fi->append_lease = NULL;
+}
+
+static int release_expired(const int64_t deadline_ms)
+{
+    FCFSAPIAppendLease *leases[APPEND_LEASE_RELEASE_BATCH_SIZE];
+    FCFSAPIAppendLease *lease;
+    FCFSAPIAppendLease *tmp;
+    int count;
+    int total;
+    int i;
+
+    total = 0;
+    do {
+        count = 0;
+        PTHREAD_MUTEX_LOCK(&g_append_lease_ctx.held.lock);
+        fc_list_for_each_entry_safe(lease, tmp, &g_append_lease_ctx.
+                held.head, dlink)
+        {
+            if (lease->expires > deadline_ms) {
+                break;
+            }
+
+            /* skip the lease in use, the writer will renew it */
+            if (pthread_mutex_trylock(&lease->lock) != 0) {
+                continue;
+            }
+
+            fc_list_del_init(&lease->dlink);
+            leases[count++] = lease;
+            if (count == APPEND_LEASE_RELEASE_BATCH_SIZE) {
+                break;
+            }
+        }
+        PTHREAD_MUTEX_UNLOCK(&g_append_lease_ctx.held.lock);
+
+        for (i=0; i<count; i++) {
+            do_release(leases[i]);
+            PTHREAD_MUTEX_UNLOCK(&leases[i]->lock);
+        }
+        total += count;
+    } while (count == APPEND_LEASE_RELEASE_BATCH_SIZE);
+
+    return total;
+}
+
+static void *append_lease_thread_func(void *arg)
+{
+    int interval_ms;
+
+#ifdef OS_LINUX
+    prctl(PR_SET_NAME, "append-lease");
+#endif
+
+    interval_ms = FCFS_API_CTX->append_lease.lease_ms / 2;
+    if (interval_ms <= 0) {
+        interval_ms = 1;
+    }
+    while (SF_G_CONTINUE_FLAG) {
+        fc_timedwait_ms(&g_append_lease_ctx.lcp.lock,
+                &g_append_lease_ctx.lcp.cond, interval_ms);
+        release_expired(get_current_time_ms());
+    }
+
+    return NULL;
+}
+
+int append_lease_init(FCFSAPIContext *fcfs_api_ctx)
+{
+    int result;
+
+    g_append_lease_ctx.fcfs_api_ctx = fcfs_api_ctx;
+    if ((result=fast_mblock_init_ex1(&g_append_lease_ctx.allocator,
+                    "append_lease", sizeof(FCFSAPIAppendLease), 256, 0,
+                    (fast_mblock_object_init_func)append_lease_alloc_init,
+                    &g_append_lease_ctx.allocator, true)) != 0)
+    {
+        return result;
+    }
+
+    if ((result=init_pthread_lock(&g_append_lease_ctx.htable.lock)) != 0) {
+        return result;
+    }
+
+    if ((result=init_pthread_lock(&g_append_lease_ctx.held.lock)) != 0) {
+        return result;
+    }
+    FC_INIT_LIST_HEAD(&g_append_lease_ctx.held.head);
+
+    return init_pthread_lock_cond_pair(&g_append_lease_ctx.lcp);
+}
+
+/* the leases of the parent process are abandoned, the child MUST NOT
+ * report the file size or unlock by the sessions of the parent
+ */
+void append_lease_fork_child()
+{
+    init_pthread_lock(&g_append_lease_ctx.htable.lock);
+    memset(g_append_lease_ctx.htable.buckets, 0,
+            sizeof(g_append_lease_ctx.htable.buckets));
+    init_pthread_lock(&g_append_lease_ctx.held.lock);
+    FC_INIT_LIST_HEAD(&g_append_lease_ctx.held.head);
+}
+
+int append_lease_start()
+{
+    pthread_t tid;
+
+    return fc_create_thread(&tid, append_lease_thread_func,
+            NULL, SF_G_THREAD_STACK_SIZE);
+}
+
+void append_lease_terminate()
+{
+    int count;
+
+    if (!g_append_lease_ctx.fcfs_api_ctx->append_lease.enabled) {
+        return;
+    }
+
+    count = release_expired(INT64_MAX);
+    logInfo("file: "__FILE__", line: %d, "
+            "append_lease_terminate, release count: %d",
+            __LINE__, count);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FCFS_API_APPEND_LEASE_H
+#define _FCFS_API_APPEND_LEASE_H
+
+#include "fastcommon/fc_list.h"
+#include "fastcommon/pthread_func.h"
+#include "fcfs_api_types.h"
+
+#define FCFS_API_APPEND_LEASE_HTABLE_CAPACITY  1361
+
+/* the exclusive append lease based on the sys lock of FastDIR,
+ * the lease holder appends to the file tail locally and reports
+ * the final file size when the lease released or renewed,
+ * the lease is shared by the fds of the same inode in this process
+ */
+typedef struct fcfs_api_append_lease {
+    pthread_mutex_t lock;
+    bool held;
+    int reffer_count;     //the fds refer to it, protected by the htable lock
+    FDIRClientSession session;
+    uint64_t inode;
+    int64_t old_size;     //file size when the lease acquired
+    int64_t end;          //current file tail
+    int64_t limit;        //the end of the reserved tail range
+    int64_t inc_alloc;
+    int64_t expires;      //in milliseconds
+    int64_t retry_after;  //in milliseconds, for contended inode
+    struct fc_list_head dlink;  //for held lease list
+    struct fcfs_api_append_lease *next;  //for htable chain
+} FCFSAPIAppendLease;
+
+typedef struct {
+    FCFSAPIContext *fcfs_api_ctx;
+    struct fast_mblock_man allocator; //element: FCFSAPIAppendLease
+    struct {
+        pthread_mutex_t lock;
+        FCFSAPIAppendLease *buckets[FCFS_API_APPEND_LEASE_HTABLE_CAPACITY];
+    } htable;  //key: inode
+    struct {
+        pthread_mutex_t lock;
+        struct fc_list_head head;  //element: FCFSAPIAppendLease
+    } held;
+    pthread_lock_cond_pair_t lcp;  //for timed wait
+} AppendLeaseContext;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    extern AppendLeaseContext g_append_lease_ctx;
+
+    int append_lease_init(FCFSAPIContext *fcfs_api_ctx);
+
+    int append_lease_start();
+
+    void append_lease_terminate();
+
+    /* drop the leases inherited from the parent process */
+    void append_lease_fork_child();
+
+    /* get the lease of the inode and refer it by the fd */
+    FCFSAPIAppendLease *append_lease_get(FCFSAPIFileInfo *fi);
+
+    /* non-blocking acquire, the caller MUST hold the lease lock
+     * return EWOULDBLOCK when the inode is contended by others
+     */
+    int append_lease_acquire(FCFSAPIAppendLease *lease);
+
+    /* report the file size and unlock, the caller MUST hold the lease lock */
+    int append_lease_release_ex(FCFSAPIAppendLease *lease);
+
+    int append_lease_release(FCFSAPIAppendLease *lease);
+
+    /* release the lease and unrefer it by the fd */
+    void append_lease_free(FCFSAPIFileInfo *fi);
+
+    static inline int fcfs_api_release_append_lease(FCFSAPIFileInfo *fi)
+    {
+        if (fi->append_lease == NULL) {
+            return 0;
+        }
+        return append_lease_release(fi->append_lease);
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -308,6 +308,27 @@ void async_reporter_terminate()
             __LINE__, count);
 }
 
+void async_reporter_quiesce(const int timeout_ms)
+{
+    int64_t deadline_ms;
+    int waiting_count;
+
+    deadline_ms = get_current_time_ms() + timeout_ms;
+    while ((waiting_count=FC_ATOMIC_GET(g_async_reporter_ctx.
+                    waiting_count)) > 0)
+    {
+        if (get_current_time_ms() >= deadline_ms) {
+            logDebug("file: "__FILE__", line: %d, "
+                    "wait the async reporter timeout, "
+                    "waiting count: %d", __LINE__, waiting_count);
+            break;
+        }
+
+        async_reporter_notify();
+        fc_sleep_ms(1);
+    }
+}
+
 static inline void check_and_set_stage()
 {
     int old_stage;
@@ -50,6 +50,9 @@ extern "C" {
 
     void async_reporter_terminate();
 
+    /* wait until the queued events are reported or timeout */
+    void async_reporter_quiesce(const int timeout_ms);
+
     static inline int async_reporter_push(const FDIRSetDEntrySizeInfo *dsize)
     {
         int result;
@@ -31,7 +31,10 @@
 #include "fastcommon/logger.h"
 #include "sf/idempotency/client/client_channel.h"
 #include "sf/idempotency/client/receipt_handler.h"
+#include "fastcfs/auth/simple_connection_manager.h"
 #include "async_reporter.h"
+#include "lazytime.h"
+#include "append_lease.h"
 #include "fcfs_api.h"
 
 #define FCFS_API_MIN_SHARED_ALLOCATOR_COUNT           1
@@ -46,6 +49,19 @@
 #define FCFS_API_MAX_HASHTABLE_TOTAL_CAPACITY      100000000
 #define FCFS_API_DEFAULT_HASHTABLE_TOTAL_CAPACITY    1403641
 
+#define FCFS_API_MIN_LAZYTIME_MAX_DIRTY_INODES          1024
+#define FCFS_API_MAX_LAZYTIME_MAX_DIRTY_INODES      10000000
+#define FCFS_API_DEFAULT_LAZYTIME_MAX_DIRTY_INODES     65536
+
+#define FCFS_API_DEFAULT_APPEND_LEASE_MS               100
+#define FCFS_API_DEFAULT_APPEND_LEASE_MAX_BYTES  (4 * 1024 * 1024)
+
+#define FCFS_API_DEFAULT_TINY_FILE_MAX_SIZE   (64 * 1024)
+
+/* the max time to wait the pending size reports before fork,
+ * the reports not done in time are kept by the parent */
+#define FCFS_API_FORK_QUIESCE_TIMEOUT_MS  20
+
 #define FCFS_API_INI_IDEMPOTENCY_SECTION_NAME      "idempotency"
 #define FCFS_API_IDEMPOTENCY_DEFAULT_WORK_THREADS  1
 
@@ -58,6 +74,68 @@ FCFSAPIContext g_fcfs_api_ctx;
 static int fcfs_api_load_owner_config(IniFullContext *ini_ctx,
         FCFSAPIContext *ctx);
 
+static int fcfs_api_load_append_lease_config(IniFullContext *ini_ctx,
+        const char *fdir_section_name, FCFSAPIContext *ctx)
+{
+    char *max_bytes;
+    int result;
+
+    ctx->append_lease.enabled = ctx->use_sys_lock_for_append &&
+        iniGetBoolValue(fdir_section_name, "append_lease_enabled",
+                ini_ctx->context, false);
+    ctx->append_lease.lease_ms = iniGetIntValue(fdir_section_name,
+            "append_lease_time_ms", ini_ctx->context,
+            FCFS_API_DEFAULT_APPEND_LEASE_MS);
+    if (ctx->append_lease.lease_ms <= 0) {
+        ctx->append_lease.lease_ms = FCFS_API_DEFAULT_APPEND_LEASE_MS;
+    }
+
+    max_bytes = iniGetStrValue(fdir_section_name,
+            "append_lease_max_bytes", ini_ctx->context);
+    if (max_bytes == NULL || *max_bytes == '\0') {
+        ctx->append_lease.max_bytes = FCFS_API_DEFAULT_APPEND_LEASE_MAX_BYTES;
+    } else if ((result=parse_bytes(max_bytes, 1, &ctx->
+                    append_lease.max_bytes)) != 0)
+    {
+        logError("file: "__FILE__", line: %d, "
+                "config file: %s, section: %s, invalid "
+                "append_lease_max_bytes: %s", __LINE__, ini_ctx->
+                filename, fdir_section_name, max_bytes);
+        return result;
+    }
+
+    return 0;
+}
+
+static int fcfs_api_load_tiny_file_config(IniFullContext *ini_ctx,
+        const char *fdir_section_name, FCFSAPIContext *ctx)
+{
+    char *max_size;
+    int result;
+
+    ctx->tiny_file.attr_timeout_ms = iniGetIntValue(fdir_section_name,
+            "tiny_file_attr_timeout_ms", ini_ctx->context, 0);
+    if (ctx->tiny_file.attr_timeout_ms < 0) {
+        ctx->tiny_file.attr_timeout_ms = 0;
+    }
+
+    max_size = iniGetStrValue(fdir_section_name,
+            "tiny_file_max_size", ini_ctx->context);
+    if (max_size == NULL || *max_size == '\0') {
+        ctx->tiny_file.max_size = FCFS_API_DEFAULT_TINY_FILE_MAX_SIZE;
+    } else if ((result=parse_bytes(max_size, 1, &ctx->
+                    tiny_file.max_size)) != 0)
+    {
+        logError("file: "__FILE__", line: %d, "
+                "config file: %s, section: %s, invalid "
+                "tiny_file_max_size: %s", __LINE__, ini_ctx->
+                filename, fdir_section_name, max_size);
+        return result;
+    }
+
+    return 0;
+}
+
 static int opendir_session_alloc_init(void *element, void *args)
 {
     int result;
@@ -119,6 +197,16 @@ static int fcfs_api_common_init(FCFSAPIContext *ctx, FDIRClientContext *fdir,
     ctx->persist_additional_gids = persist_additional_gids;
     ctx->use_sys_lock_for_append = iniGetBoolValue(fdir_section_name,
             "use_sys_lock_for_append", ini_ctx->context, false);
+    if ((result=fcfs_api_load_append_lease_config(ini_ctx,
+                    fdir_section_name, ctx)) != 0)
+    {
+        return result;
+    }
+    if ((result=fcfs_api_load_tiny_file_config(ini_ctx,
+                    fdir_section_name, ctx)) != 0)
+    {
+        return result;
+    }
     ctx->async_report.enabled = iniGetBoolValue(fdir_section_name,
             "async_report_enabled", ini_ctx->context, true);
     ctx->async_report.interval_ms = iniGetIntValue(fdir_section_name,
@@ -143,6 +231,25 @@ static int fcfs_api_common_init(FCFSAPIContext *ctx, FDIRClientContext *fdir,
             FCFS_API_MIN_HASHTABLE_TOTAL_CAPACITY,
             FCFS_API_MAX_HASHTABLE_TOTAL_CAPACITY);
 
+    ctx->lazytime.enabled = iniGetBoolValue(fdir_section_name,
+            "lazytime_enabled", ini_ctx->context, false);
+    ctx->lazytime.flush_interval = iniGetIntValue(fdir_section_name,
+            "lazytime_flush_interval", ini_ctx->context, 60);
+    if (ctx->lazytime.flush_interval <= 0) {
+        ctx->lazytime.flush_interval = 1;
+    }
+    ctx->lazytime.max_dirty_inodes = iniGetIntCorrectValue(
+            ini_ctx, "lazytime_max_dirty_inodes",
+            FCFS_API_DEFAULT_LAZYTIME_MAX_DIRTY_INODES,
+            FCFS_API_MIN_LAZYTIME_MAX_DIRTY_INODES,
+            FCFS_API_MAX_LAZYTIME_MAX_DIRTY_INODES);
+
+    if (ctx->secondary) {
+        ctx->append_lease.enabled = false;
+        ctx->async_report.enabled = false;
+        ctx->lazytime.enabled = false;
+    }
+
     if (ctx->async_report.enabled) {
         if ((result=fcfs_api_allocator_init(ctx)) != 0) {
             return result;
@@ -158,6 +265,18 @@ static int fcfs_api_common_init(FCFSAPIContext *ctx, FDIRClientContext *fdir,
         }
     }
 
+    if (ctx->lazytime.enabled) {
+        if ((result=lazytime_init(ctx)) != 0) {
+            return result;
+        }
+    }
+
+    if (ctx->append_lease.enabled) {
+        if ((result=append_lease_init(ctx)) != 0) {
+            return result;
+        }
+    }
+
     ini_ctx->section_name = fs_section_name;
     if ((result=fs_api_init_ex(fsapi, ini_ctx,
                     fcfs_api_file_write_done_callback,
@@ -380,6 +499,13 @@ int fcfs_api_start_ex(FCFSAPIContext *ctx)
         FCAddressPtrArray *address_array;
         FCServerInfo *first_server;
 
+        if (ctx->secondary) {  //the receipt handler is process wide
+            logError("file: "__FILE__", line: %d, "
+                    "namespace: %s, the idempotency is not supported "
+                    "by the secondary context", __LINE__, ctx->ns.str);
+            return EOPNOTSUPP;
+        }
+
         address_array = NULL;
         if (ctx->contexts.fdir->idempotency_enabled) {
             server_group = fc_server_get_group_by_index(
@@ -421,7 +547,19 @@ int fcfs_api_start_ex(FCFSAPIContext *ctx)
     }
 
     if (ctx->async_report.enabled) {
-        return async_reporter_init(ctx);
+        if ((result=async_reporter_init(ctx)) != 0) {
+            return result;
+        }
+    }
+
+    if (ctx->append_lease.enabled) {
+        if ((result=append_lease_start()) != 0) {
+            return result;
+        }
+    }
+
+    if (ctx->lazytime.enabled) {
+        return lazytime_start();
     } else {
         return 0;
     }
@@ -430,19 +568,125 @@ int fcfs_api_start_ex(FCFSAPIContext *ctx)
 void fcfs_api_terminate_ex(FCFSAPIContext *ctx)
 {
     fs_api_terminate_ex(ctx->contexts.fsapi);
+    if (ctx->append_lease.enabled) {
+        append_lease_terminate();
+    }
+    if (ctx->lazytime.enabled) {
+        lazytime_terminate();
+    }
     if (ctx->async_report.enabled) {
         async_reporter_terminate();
     }
 }
 
+/* the auth client context is shared by FastDIR and FastStore */
+static inline FCFSAuthClientContext *get_auth_client_ctx(FCFSAPIContext *ctx)
+{
+    if (ctx->contexts.fdir != NULL && ctx->contexts.fdir->auth.enabled) {
+        return ctx->contexts.fdir->auth.ctx;
+    } else if (ctx->contexts.fsapi != NULL && ctx->contexts.fsapi->fs !=
+            NULL && ctx->contexts.fsapi->fs->auth.enabled)
+    {
+        return ctx->contexts.fsapi->fs->auth.ctx;
+    } else {
+        return NULL;
+    }
+}
+
+void fcfs_api_fork_prepare_ex(FCFSAPIContext *ctx)
+{
+    FCFSAuthClientContext *auth_ctx;
+
+    if (ctx->async_report.enabled && FC_ATOMIC_GET(
+                g_async_reporter_ctx.waiting_count) > 0)
+    {
+        async_reporter_quiesce(FCFS_API_FORK_QUIESCE_TIMEOUT_MS);
+    }
+
+    if (ctx->contexts.fdir != NULL) {
+        PTHREAD_MUTEX_LOCK(&ctx->contexts.fdir->cm.cpool.lock);
+    }
+    if (ctx->contexts.fsapi != NULL && ctx->contexts.fsapi->fs != NULL) {
+        PTHREAD_MUTEX_LOCK(&ctx->contexts.fsapi->fs->cm.cpool.lock);
+    }
+    if ((auth_ctx=get_auth_client_ctx(ctx)) != NULL) {
+        fcfs_auth_simple_connection_manager_fork_prepare(&auth_ctx->cm);
+    }
+}
+
+void fcfs_api_fork_parent_ex(FCFSAPIContext *ctx)
+{
+    FCFSAuthClientContext *auth_ctx;
+
+    if ((auth_ctx=get_auth_client_ctx(ctx)) != NULL) {
+        fcfs_auth_simple_connection_manager_fork_parent(&auth_ctx->cm);
+    }
+    if (ctx->contexts.fsapi != NULL && ctx->contexts.fsapi->fs != NULL) {
+        PTHREAD_MUTEX_UNLOCK(&ctx->contexts.fsapi->fs->cm.cpool.lock);
+    }
+    if (ctx->contexts.fdir != NULL) {
+        PTHREAD_MUTEX_UNLOCK(&ctx->contexts.fdir->cm.cpool.lock);
+    }
+}
+
+void fcfs_api_fork_child_ex(FCFSAPIContext *ctx)
+{
+    FCFSAuthClientContext *auth_ctx;
+
+    if ((auth_ctx=get_auth_client_ctx(ctx)) != NULL) {
+        fcfs_auth_simple_connection_manager_fork_child(&auth_ctx->cm);
+    }
+    if (ctx->contexts.fsapi != NULL && ctx->contexts.fsapi->fs != NULL) {
+        PTHREAD_MUTEX_UNLOCK(&ctx->contexts.fsapi->fs->cm.cpool.lock);
+        conn_pool_destroy(&ctx->contexts.fsapi->fs->cm.cpool);
+    }
+    if (ctx->contexts.fdir != NULL) {
+        PTHREAD_MUTEX_UNLOCK(&ctx->contexts.fdir->cm.cpool.lock);
+        conn_pool_destroy(&ctx->contexts.fdir->cm.cpool);
+    }
+
+    /* the leases and the dirty mtimes belong to the parent process */
+    if (ctx->append_lease.enabled) {
+        append_lease_fork_child();
+    }
+    if (ctx->lazytime.enabled) {
+        lazytime_fork_child();
+    }
+}
+
 void fcfs_api_async_report_config_to_string_ex(FCFSAPIContext *ctx,
         char *output, const int size)
 {
     int len;
 
-    len = snprintf(output, size, "use_sys_lock_for_append: %d, "
-            "async_report { enabled: %d", ctx->use_sys_lock_for_append,
-            ctx->async_report.enabled);
+    len = snprintf(output, size, "use_sys_lock_for_append: %d",
+            ctx->use_sys_lock_for_append);
+    if (ctx->use_sys_lock_for_append) {
+        len += snprintf(output + len, size - len, ", append_lease "
+                "{ enabled: %d", ctx->append_lease.enabled);
+        if (ctx->append_lease.enabled) {
+            len += snprintf(output + len, size - len, ", lease_time: %d ms, "
+                    "max_bytes: %"PRId64" KB", ctx->append_lease.lease_ms,
+                    ctx->append_lease.max_bytes / 1024);
+        }
+        len += snprintf(output + len, size - len, " }");
+    }
+    len += snprintf(output + len, size - len, ", lazytime { enabled: %d",
+            ctx->lazytime.enabled);
+    if (ctx->lazytime.enabled) {
+        len += snprintf(output + len, size - len, ", "
+                "flush_interval: %ds, max_dirty_inodes: %d",
+                ctx->lazytime.flush_interval,
+                ctx->lazytime.max_dirty_inodes);
+    }
+    len += snprintf(output + len, size - len, " }, tiny_file "
+            "{ attr_timeout_ms: %d", ctx->tiny_file.attr_timeout_ms);
+    if (ctx->tiny_file.attr_timeout_ms > 0) {
+        len += snprintf(output + len, size - len, ", max_size: %"PRId64
+                " KB", ctx->tiny_file.max_size / 1024);
+    }
+    len += snprintf(output + len, size - len, " }, "
+            "async_report { enabled: %d", ctx->async_report.enabled);
     if (ctx->async_report.enabled) {
         len += snprintf(output + len, size - len, ", "
                 "async_report_interval_ms: %d, "
@@ -886,7 +1130,7 @@ void fcfs_api_log_client_common_configs(FCFSAPIContext *ctx,
 {
     char auth_config[512];
     char fsapi_config[1024];
-    char async_report_config[512];
+    char async_report_config[640];
     int len;
 
     if (ctx->contexts.fdir->idempotency_enabled ||
@@ -21,6 +21,7 @@
 #include "fcfs_api_types.h"
 #include "fcfs_api_file.h"
 #include "fcfs_api_util.h"
+#include "fcfs_api_walk.h"
 
 #define FCFS_API_DEFAULT_FASTDIR_SECTION_NAME    "FastDIR"
 #define FCFS_API_DEFAULT_FASTSTORE_SECTION_NAME  "FastStore"
@@ -118,6 +119,21 @@ extern "C" {
 
     void fcfs_api_terminate_ex(FCFSAPIContext *ctx);
 
+    /* call before fork, wait for the async reporter to drain the
+     * pending dentry size reports and hold the connection pool locks
+     */
+    void fcfs_api_fork_prepare_ex(FCFSAPIContext *ctx);
+
+    /* call in the parent process after fork, release the locks */
+    void fcfs_api_fork_parent_ex(FCFSAPIContext *ctx);
+
+    /* call in the child process after fork, the connections inherited
+     * from the parent process are owned by the parent, close the copies
+     * of their sockets without shutdown. the append leases and the
+     * lazytime dirty entries of the parent are dropped
+     */
+    void fcfs_api_fork_child_ex(FCFSAPIContext *ctx);
+
     int fcfs_api_client_session_create(FCFSAPIContext *ctx, const bool publish);
 
     static inline int fcfs_api_init_with_auth(const char *ns,
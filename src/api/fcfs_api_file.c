@@ -24,6 +24,13 @@
 
 #define FCFS_API_MAGIC_NUMBER    1588076578
 
+#define FCFS_API_TINY_FILE_ATTR_VALID(fi) ((fi)->attr_expires_ms > 0 && \
+        get_current_time_ms() < (fi)->attr_expires_ms)
+
+#ifndef FALLOC_FL_ZERO_RANGE
+#define FALLOC_FL_ZERO_RANGE  0x10
+#endif
+
 static int file_truncate(FCFSAPIContext *ctx, const int64_t oid,
         const int64_t new_size, const FDIRDentryOperator *oper,
         const int64_t tid);
@@ -57,7 +64,21 @@ static int deal_open_flags(FCFSAPIFileInfo *fi, FDIRClientOperFnamePair *path,
 
     if (!((fi->flags & O_WRONLY) || (fi->flags & O_RDWR))) {
         fi->offset = 0;
-        return (fi->flags & O_TRUNC) ? EACCES : result;
+        if ((fi->flags & O_TRUNC)) {
+            return EACCES;
+        }
+
+        /* the open of the tiny files such as the python modules is
+         * followed by fstat and read to EOF
+         */
+        if (result == 0 && fi->ctx->tiny_file.attr_timeout_ms > 0 &&
+                S_ISREG(fi->dentry.stat.mode) && fi->dentry.stat.size <=
+                fi->ctx->tiny_file.max_size)
+        {
+            fi->attr_expires_ms = get_current_time_ms() +
+                fi->ctx->tiny_file.attr_timeout_ms;
+        }
+        return result;
     }
 
     if ((fi->flags & O_CREAT)) {
@@ -127,6 +148,8 @@ static int deal_open_flags(FCFSAPIFileInfo *fi, FDIRClientOperFnamePair *path,
 #define SET_FILE_COMMON_FIELDS(fi, _ctx, _flags) \
     fi->ctx = _ctx;     \
     fi->flags = _flags; \
+    fi->attr_expires_ms = 0;  \
+    fi->append_lease = NULL; \
     fi->sessions.flock.mconn = NULL
 
 int fcfs_api_open_ex(FCFSAPIContext *ctx, FCFSAPIFileInfo *fi,
@@ -214,6 +237,11 @@ int fcfs_api_close(FCFSAPIFileInfo *fi)
         fdir_client_close_session(&fi->sessions.flock, true);
     }
 
+    append_lease_free(fi);
+    if ((fi->flags & O_WRONLY) || (fi->flags & O_RDWR)) {
+        lazytime_flush(fi->ctx, fi->dentry.inode);
+    }
+
     if (fi->ctx->persist_additional_gids) {
         if (fi->oper.additional_gids.list != fi->fixed_groups_buff) {
             free((void *)fi->oper.additional_gids.list);
@@ -226,6 +254,20 @@ int fcfs_api_close(FCFSAPIFileInfo *fi)
     return 0;
 }
 
+void fcfs_api_fork_child_file(FCFSAPIFileInfo *fi)
+{
+    if (fi->magic != FCFS_API_MAGIC_NUMBER) {
+        return;
+    }
+
+    if (fi->sessions.flock.mconn != NULL) {
+        /* close the copy of the socket without shutdown */
+        conn_pool_disconnect_server(fi->sessions.flock.mconn);
+        fi->sessions.flock.mconn = NULL;
+    }
+    fi->append_lease = NULL;
+}
+
 static int report_size_and_time(FCFSAPIContext *ctx,
         const FDIRSetDEntrySizeInfo *dsize, FDIRDEntryInfo *dentry)
 {
@@ -292,8 +334,22 @@ static int fcfs_api_file_report_size_and_time(
 
     if (*flags == 0) {
         return 0;
+    } else if (*flags == FDIR_DENTRY_FIELD_MODIFIED_FLAG_MTIME &&
+            callback_arg->extra.ctx->lazytime.enabled)
+    {
+        /* overwrite inside the file, keep the mtime change in memory */
+        if (dentry != NULL) {
+            dentry->stat.mtime = get_current_time();
+        }
+        return lazytime_mark_dirty(callback_arg->arg.bs_key->block.oid);
     } else {
         dsize.inode = callback_arg->arg.bs_key->block.oid;
+        if ((*flags & (FDIR_DENTRY_FIELD_MODIFIED_FLAG_FILE_SIZE |
+                        FDIR_DENTRY_FIELD_MODIFIED_FLAG_MTIME)) != 0)
+        {
+            /* the reported mtime is newer than the kept one */
+            lazytime_discard(callback_arg->extra.ctx, dsize.inode);
+        }
         dsize.inc_alloc = callback_arg->arg.inc_alloc;
         dsize.force = false;
         dsize.flags = *flags;
@@ -462,6 +518,48 @@ int fcfs_api_pwrite_ex(FCFSAPIFileInfo *fi, const char *buff,
     return pwrite_wrapper(fi, &wbuffer, size, offset, written_bytes, tid);
 }
 
+static int lease_append(FCFSAPIFileInfo *fi, FSAPIWriteBuffer *wbuffer,
+        const int size, int *written_bytes, const int64_t tid)
+{
+    FCFSAPIAppendLease *lease;
+    int total_inc_alloc;
+    int result;
+
+    if ((lease=append_lease_get(fi)) == NULL) {
+        return ENOMEM;
+    }
+
+    PTHREAD_MUTEX_LOCK(&lease->lock);
+    if (lease->held && (lease->end + size > lease->limit ||
+                get_current_time_ms() >= lease->expires))
+    {
+        append_lease_release_ex(lease);  //renew the lease
+    }
+
+    if (!lease->held) {
+        if ((result=append_lease_acquire(lease)) != 0) {
+            PTHREAD_MUTEX_UNLOCK(&lease->lock);
+            return result;
+        }
+    }
+
+    if ((result=do_pwrite(fi, wbuffer, size, lease->end, written_bytes,
+                    &total_inc_alloc, false, tid)) == 0)
+    {
+        lease->end += *written_bytes;
+        lease->inc_alloc += total_inc_alloc;
+        fi->offset = lease->end;
+        if (lease->end > fi->dentry.stat.size) {
+            fi->dentry.stat.size = lease->end;
+        }
+        if (lease->end > fi->dentry.stat.space_end) {
+            fi->dentry.stat.space_end = lease->end;
+        }
+    }
+    PTHREAD_MUTEX_UNLOCK(&lease->lock);
+    return result;
+}
+
 static int do_write(FCFSAPIFileInfo *fi, FSAPIWriteBuffer *wbuffer,
         const int size, int *written_bytes, const int64_t tid)
 {
@@ -485,6 +583,15 @@ static int do_write(FCFSAPIFileInfo *fi, FSAPIWriteBuffer *wbuffer,
 
     use_sys_lock = fi->ctx->use_sys_lock_for_append &&
         !fi->ctx->async_report.enabled && (fi->flags & O_APPEND);
+    if (use_sys_lock && fi->ctx->append_lease.enabled) {
+        /* fallback to lock per write when the inode is contended */
+        if ((result=lease_append(fi, wbuffer, size, written_bytes,
+                        tid)) != EWOULDBLOCK)
+        {
+            return result;
+        }
+    }
+
     if (use_sys_lock) {
         if ((result=fcfs_api_dentry_sys_lock(&session, fi->dentry.inode,
                         0, &old_size, &space_end)) != 0)
@@ -567,6 +674,7 @@ static int do_pread(FCFSAPIFileInfo *fi, const bool is_readv,
     int64_t current_offset;
     int64_t hole_bytes;
     int fill_bytes;
+    bool size_refreshed;
 
     *read_bytes = 0;
     if (size == 0) {
@@ -579,6 +687,12 @@ static int do_pread(FCFSAPIFileInfo *fi, const bool is_readv,
         return result;
     }
 
+    if (offset >= fi->dentry.stat.size && FCFS_API_TINY_FILE_ATTR_VALID(fi)) {
+        return 0;
+    }
+
+    /* refresh the file size at most once per read */
+    size_refreshed = FCFS_API_TINY_FILE_ATTR_VALID(fi);
     FS_API_SET_CTX_AND_TID_EX(op_ctx, fi->ctx->contexts.fsapi, tid);
     fs_set_block_slice(&op_ctx.bs_key, fi->dentry.inode, offset, size);
     if (is_readv) {
@@ -609,13 +723,14 @@ static int do_pread(FCFSAPIFileInfo *fi, const bool is_readv,
                 break;
             }
 
-            if (current_offset > fi->dentry.stat.size) {
+            if (current_offset > fi->dentry.stat.size && !size_refreshed) {
                 FCFSAPI_SET_OPER_INODE_PAIR(oino, fi->oper, fi->dentry.inode);
                 if ((result=fcfs_api_stat_dentry_by_inode_ex(fi->ctx,
                                 &oino, flags, &fi->dentry)) != 0)
                 {
                     break;
                 }
+                size_refreshed = true;
             }
 
             hole_bytes = fi->dentry.stat.size - current_offset;
@@ -922,6 +1037,7 @@ int fcfs_api_ftruncate_ex(FCFSAPIFileInfo *fi, const int64_t new_size,
         return result;
     }
 
+    fcfs_api_release_append_lease(fi);
     return file_truncate(fi->ctx, fi->dentry.inode, new_size,
             &fi->oper, tid);
 }
@@ -981,16 +1097,79 @@ int fcfs_api_file_truncate_ex(FCFSAPIContext *ctx,
     return file_truncate(ctx, oino->inode, new_size, &oino->oper, tid);
 }
 
+/* for the l_whence of the fcntl locks, SEEK_DATA and SEEK_HOLE
+ * are valid for lseek only
+ */
 #define calc_file_offset(fi, offset, whence, new_offset)  \
-    calc_file_offset_ex(fi, offset, whence, false, new_offset)
+    (((whence) == SEEK_SET || (whence) == SEEK_CUR ||      \
+      (whence) == SEEK_END) ? calc_file_offset_ex(fi,      \
+          offset, whence, false, new_offset) : EINVAL)
+
+static inline int refresh_file_size(FCFSAPIFileInfo *fi)
+{
+    const int flags = FDIR_FLAGS_FOLLOW_SYMLINK;
+    FDIRClientOperInodePair oino;
+
+    fcfs_api_release_append_lease(fi);
+    FCFSAPI_SET_OPER_INODE_PAIR(oino, fi->oper, fi->dentry.inode);
+    return fcfs_api_stat_dentry_by_inode_ex(fi->ctx,
+            &oino, flags, &fi->dentry);
+}
+
+#ifdef SEEK_DATA
+/* the data region of the file by the space attributes of FastDIR,
+ * the space after the last written byte such as extended by ftruncate
+ * is a hole, and the holes inside are regarded as data
+ */
+static inline int64_t get_file_data_end(FCFSAPIFileInfo *fi)
+{
+    if (fi->dentry.stat.alloc <= 0) {
+        return 0;
+    }
+
+    if (fi->dentry.stat.space_end > 0 && fi->dentry.stat.
+            space_end < fi->dentry.stat.size)
+    {
+        return fi->dentry.stat.space_end;
+    }
+    return fi->dentry.stat.size;
+}
+
+static int seek_data_or_hole(FCFSAPIFileInfo *fi, const int64_t offset,
+        const int whence, const bool refresh_fsize, int64_t *new_offset)
+{
+    int64_t data_end;
+    int result;
+
+    if (refresh_fsize) {
+        if ((result=refresh_file_size(fi)) != 0) {
+            return result;
+        }
+    }
+
+    if (offset < 0 || offset >= fi->dentry.stat.size) {
+        return ENXIO;
+    }
+
+    data_end = get_file_data_end(fi);
+    if (whence == SEEK_DATA) {
+        if (offset >= data_end) {
+            return ENXIO;
+        }
+        *new_offset = offset;
+    } else {
+        *new_offset = (offset < data_end ? data_end : offset);
+    }
+
+    return 0;
+}
+#endif
 
 static inline int calc_file_offset_ex(FCFSAPIFileInfo *fi,
         const int64_t offset, const int whence,
         const bool refresh_fsize, int64_t *new_offset)
 {
-    const int flags = FDIR_FLAGS_FOLLOW_SYMLINK;
     int result;
-    FDIRClientOperInodePair oino;
 
     switch (whence) {
         case SEEK_SET:
@@ -1007,10 +1186,7 @@ static inline int calc_file_offset_ex(FCFSAPIFileInfo *fi,
             break;
         case SEEK_END:
             if (refresh_fsize) {
-                FCFSAPI_SET_OPER_INODE_PAIR(oino, fi->oper, fi->dentry.inode);
-                if ((result=fcfs_api_stat_dentry_by_inode_ex(fi->ctx,
-                                &oino, flags, &fi->dentry)) != 0)
-                {
+                if ((result=refresh_file_size(fi)) != 0) {
                     return result;
                 }
             }
@@ -1020,6 +1196,12 @@ static inline int calc_file_offset_ex(FCFSAPIFileInfo *fi,
                 return EINVAL;
             }
             break;
+#ifdef SEEK_DATA
+        case SEEK_DATA:
+        case SEEK_HOLE:
+            return seek_data_or_hole(fi, offset, whence,
+                    refresh_fsize, new_offset);
+#endif
         default:
             logError("file: "__FILE__", line: %d, "
                     "invalid whence: %d", __LINE__, whence);
@@ -1078,11 +1260,14 @@ int fcfs_api_fstat(FCFSAPIFileInfo *fi, struct stat *buf)
         return EBADF;
     }
 
-    FCFSAPI_SET_OPER_INODE_PAIR(oino, fi->oper, fi->dentry.inode);
-    if ((result=fcfs_api_stat_dentry_by_inode_ex(fi->ctx,
-                    &oino, flags, &fi->dentry)) != 0)
-    {
-        return result;
+    if (!FCFS_API_TINY_FILE_ATTR_VALID(fi)) {
+        fcfs_api_release_append_lease(fi);
+        FCFSAPI_SET_OPER_INODE_PAIR(oino, fi->oper, fi->dentry.inode);
+        if ((result=fcfs_api_stat_dentry_by_inode_ex(fi->ctx,
+                        &oino, flags, &fi->dentry)) != 0)
+        {
+            return result;
+        }
     }
 
     memset(buf, 0, sizeof(struct stat));
@@ -1128,6 +1313,27 @@ int fcfs_api_stat_ex(FCFSAPIContext *ctx, const char *path,
     return fapi_stat(ctx, &fname, buf, flags);
 }
 
+int fcfs_api_stat_by_pname_ex(FCFSAPIContext *ctx,
+        const int64_t parent_inode, const string_t *name,
+        const FDIRDentryOperator *oper, struct stat *buf,
+        const int flags)
+{
+    int result;
+    FDIRClientOperPnamePair opname;
+    FDIRDEntryInfo dentry;
+
+    FCFSAPI_SET_PATH_OPER_PNAME(opname, *oper, parent_inode, name);
+    if ((result=fcfs_api_stat_dentry_by_pname_ex(ctx, &opname,
+                    flags, LOG_DEBUG, &dentry)) != 0)
+    {
+        return result;
+    }
+
+    memset(buf, 0, sizeof(struct stat));
+    fcfs_api_fill_stat(&dentry, buf);
+    return 0;
+}
+
 static inline int fcntl_lock(FCFSAPIFileInfo *fi, const int operation,
         const int64_t offset, const int64_t length,
         const int64_t owner_id, const pid_t pid)
@@ -1316,6 +1522,29 @@ int fcfs_api_getlk_ex(FCFSAPIFileInfo *fi,
     return result;
 }
 
+/* the slices are removed then allocated again, both are the metadata
+ * operations of FastStore, and the allocated space is read as zeros
+ */
+static int do_zero_range(FCFSAPIContext *ctx, const int64_t oid,
+        const int64_t old_space_end, const int64_t offset,
+        const int64_t length, int64_t *total_inc_alloc, const int64_t tid)
+{
+    int64_t dec_alloc;
+    int64_t inc_alloc;
+    int result;
+
+    if ((result=do_truncate(ctx, oid, old_space_end, offset,
+                    length, &dec_alloc, tid)) != 0)
+    {
+        *total_inc_alloc = dec_alloc;
+        return result;
+    }
+
+    result = do_allocate(ctx, oid, offset, length, &inc_alloc, tid);
+    *total_inc_alloc = dec_alloc + inc_alloc;
+    return result;
+}
+
 int fcfs_api_fallocate_ex(FCFSAPIFileInfo *fi, const int mode,
         const int64_t offset, const int64_t length, const int64_t tid)
 {
@@ -1335,7 +1564,9 @@ int fcfs_api_fallocate_ex(FCFSAPIFileInfo *fi, const int mode,
     }
 
     op = mode & (~FALLOC_FL_KEEP_SIZE);
-    if (!(op == 0 || op == FALLOC_FL_PUNCH_HOLE)) {
+    if (!(op == 0 || op == FALLOC_FL_PUNCH_HOLE ||
+                op == FALLOC_FL_ZERO_RANGE))
+    {
         return EOPNOTSUPP;
     }
 
@@ -1343,23 +1574,27 @@ int fcfs_api_fallocate_ex(FCFSAPIFileInfo *fi, const int mode,
         return 0;
     }
 
-    if (fi->ctx->use_sys_lock_for_append && !fi->ctx->async_report.enabled) {
-        if ((result=fcfs_api_dentry_sys_lock(&session, fi->dentry.
-                        inode, 0, &old_size, &space_end)) != 0)
-        {
-            return result;
-        }
-    } else {
-        old_size = fi->dentry.stat.size;
-        space_end = fi->dentry.stat.space_end;
+    /* the space end cached by the fd may be stale, which causes
+     * the slices after it are NOT deleted
+     */
+    fcfs_api_release_append_lease(fi);
+    if ((result=check_and_sys_lock(fi->ctx, &session, fi->dentry.inode,
+                    &fi->oper, &old_size, &space_end)) != 0)
+    {
+        return result;
     }
 
     dsize.inode = fi->dentry.inode;
     dsize.force = true;
     dsize.flags = 0;
-    if (op == 0) {   //allocate space
-        result = do_allocate(fi->ctx, fi->dentry.inode,
-                offset, length, &dsize.inc_alloc, tid);
+    if (op == 0 || op == FALLOC_FL_ZERO_RANGE) {
+        if (op == 0) {   //allocate space
+            result = do_allocate(fi->ctx, fi->dentry.inode,
+                    offset, length, &dsize.inc_alloc, tid);
+        } else {         //zero range
+            result = do_zero_range(fi->ctx, fi->dentry.inode, space_end,
+                    offset, length, &dsize.inc_alloc, tid);
+        }
         dsize.file_size = offset + length;
         if (dsize.file_size > space_end) {
             dsize.flags |= FDIR_DENTRY_FIELD_MODIFIED_FLAG_SPACE_END;
@@ -1393,6 +1628,211 @@ int fcfs_api_fallocate_ex(FCFSAPIFileInfo *fi, const int mode,
     return check_and_sys_unlock(fi->ctx, &session, old_size, &dsize, result);
 }
 
+typedef struct {
+    FCFSAPIPutFileEntry *entries[FDIR_BATCH_SET_MAX_DENTRY_COUNT];
+    FDIRSetDEntrySizeInfo dsizes[FDIR_BATCH_SET_MAX_DENTRY_COUNT];
+    int count;
+} PutFilesReportBatch;
+
+static int put_files_report(FCFSAPIContext *ctx, PutFilesReportBatch *batch)
+{
+    int result;
+    int i;
+
+    if (batch->count == 0) {
+        return 0;
+    }
+
+    if ((result=fdir_client_batch_set_dentry_size(ctx->contexts.fdir,
+                    &ctx->ns, batch->dsizes, batch->count)) != 0)
+    {
+        for (i=0; i<batch->count; i++) {
+            batch->entries[i]->result = result;
+        }
+    }
+
+    batch->count = 0;
+    return result;
+}
+
+/* write the content of the new file, without the size report */
+static int put_new_file(FCFSAPIContext *ctx, FCFSAPIPutFileEntry *entry,
+        const FDIRDEntryInfo *dentry, const FCFSAPIFileContext *fctx,
+        FDIRSetDEntrySizeInfo *dsize)
+{
+    FCFSAPIFileInfo fi;
+    FSAPIWriteBuffer wbuffer;
+    int written_bytes;
+    int inc_alloc;
+    int result;
+
+    dsize->file_size = 0;
+    if ((result=fcfs_api_open_by_dentry_ex(ctx, &fi, dentry,
+                    O_WRONLY, fctx)) != 0)
+    {
+        return result;
+    }
+
+    FS_API_SET_WBUFFER_BUFF(wbuffer, entry->data.str);
+    result = do_pwrite(&fi, &wbuffer, entry->data.len, 0,
+            &written_bytes, &inc_alloc, false, fctx->tid);
+    if (result == 0 && written_bytes != entry->data.len) {
+        result = EIO;
+    }
+    fcfs_api_close(&fi);
+
+    dsize->inode = dentry->inode;
+    dsize->file_size = written_bytes;
+    dsize->inc_alloc = inc_alloc;
+    dsize->force = false;
+    dsize->flags = FDIR_DENTRY_FIELD_MODIFIED_FLAG_FILE_SIZE |
+        FDIR_DENTRY_FIELD_MODIFIED_FLAG_SPACE_END;
+    if (inc_alloc != 0) {
+        dsize->flags |= FDIR_DENTRY_FIELD_MODIFIED_FLAG_INC_ALLOC;
+    }
+    if (get_current_time() > dentry->stat.mtime) {
+        dsize->flags |= FDIR_DENTRY_FIELD_MODIFIED_FLAG_MTIME;
+    }
+    return result;
+}
+
+static int put_existing_file(FCFSAPIContext *ctx,
+        FCFSAPIPutFileEntry *entry, const FCFSAPIFileContext *fctx)
+{
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    FCFSAPIFileContext new_fctx;
+    FCFSAPIFileInfo fi;
+    int written_bytes;
+    int result;
+
+    new_fctx = *fctx;
+    new_fctx.mode = entry->mode;
+    if ((result=fcfs_api_open_ex(ctx, &fi, entry->path,
+                    flags, &new_fctx)) != 0)
+    {
+        return result;
+    }
+
+    if (entry->data.len > 0) {
+        if ((result=fcfs_api_pwrite_ex(&fi, entry->data.str,
+                        entry->data.len, 0, &written_bytes,
+                        fctx->tid)) == 0)
+        {
+            if (written_bytes != entry->data.len) {
+                result = EIO;
+            }
+        }
+    }
+
+    fcfs_api_close(&fi);
+    return result;
+}
+
+int fcfs_api_put_files_ex(FCFSAPIContext *ctx,
+        FCFSAPIPutFileEntry *entries, const int count,
+        const FCFSAPIFileContext *fctx)
+{
+    PutFilesReportBatch *batch;
+    FCFSAPIPutFileEntry *entry;
+    FCFSAPIPutFileEntry *end;
+    FDIRDEntryInfo dentry;
+    FDIRSetDEntrySizeInfo dsize;
+    char parent_path[PATH_MAX];
+    const char *last;
+    string_t name;
+    int64_t parent_inode;
+    int parent_len;
+    int first_error;
+    int result;
+
+    if (count <= 0) {
+        return 0;
+    }
+
+    batch = (PutFilesReportBatch *)fc_malloc(sizeof(PutFilesReportBatch));
+    if (batch == NULL) {
+        return ENOMEM;
+    }
+    batch->count = 0;
+
+    *parent_path = '\0';
+    parent_len = 0;
+    parent_inode = 0;
+    end = entries + count;
+    for (entry=entries; entry<end; entry++) {
+        if ((last=strrchr(entry->path, '/')) == NULL ||
+                *(last + 1) == '\0' || entry->data.len < 0)
+        {
+            entry->result = EINVAL;
+            continue;
+        }
+
+        /* the files of the batch are usually in the same directory */
+        if (parent_len == 0 || (last - entry->path) + 1 != parent_len ||
+                memcmp(entry->path, parent_path, parent_len) != 0)
+        {
+            /* the new files of the last directory stay at size 0
+             * until reported, so do not hold them across directories */
+            put_files_report(ctx, batch);
+
+            parent_len = (last - entry->path) + 1;
+            if (parent_len >= sizeof(parent_path)) {
+                parent_len = 0;
+                entry->result = ENAMETOOLONG;
+                continue;
+            }
+            memcpy(parent_path, entry->path, parent_len);
+            *(parent_path + parent_len) = '\0';
+            if ((entry->result=fcfs_api_lookup_inode_by_path_ex(ctx,
+                            parent_path, &fctx->oper, LOG_DEBUG,
+                            &parent_inode)) != 0)
+            {
+                parent_len = 0;
+                continue;
+            }
+        }
+
+        FC_SET_STRING(name, (char *)(last + 1));
+        entry->result = fcfs_api_create_dentry_by_pname_ex(ctx,
+                parent_inode, &name, &fctx->oper, (entry->mode &
+                    (~S_IFMT)) | S_IFREG, 0, &dentry);
+        if (entry->result == EEXIST) {
+            entry->result = put_existing_file(ctx, entry, fctx);
+            continue;
+        } else if (entry->result != 0 || entry->data.len == 0) {
+            continue;
+        }
+
+        entry->result = put_new_file(ctx, entry, &dentry, fctx, &dsize);
+        if (dsize.file_size == 0) {
+            continue;
+        }
+
+        if (ctx->async_report.enabled) {
+            if ((result=async_reporter_push(&dsize)) != 0) {
+                entry->result = result;
+            }
+        } else {
+            batch->entries[batch->count] = entry;
+            batch->dsizes[batch->count++] = dsize;
+            if (batch->count == FDIR_BATCH_SET_MAX_DENTRY_COUNT) {
+                put_files_report(ctx, batch);
+            }
+        }
+    }
+    put_files_report(ctx, batch);
+    free(batch);
+
+    first_error = 0;
+    for (entry=entries; entry<end; entry++) {
+        if (entry->result != 0) {
+            first_error = entry->result;
+            break;
+        }
+    }
+    return first_error;
+}
+
 int fcfs_api_rename_ex(FCFSAPIContext *ctx, const char *old_path,
         const char *new_path, const int flags,
         const FCFSAPIFileContext *fctx)
@@ -1586,6 +2026,19 @@ int fcfs_api_access_ex(FCFSAPIContext *ctx, const char *path,
             &fname, mask, flags, &dentry);
 }
 
+int fcfs_api_access_by_pname_ex(FCFSAPIContext *ctx,
+        const int64_t parent_inode, const string_t *name,
+        const int mask, const FDIRDentryOperator *oper,
+        const int flags)
+{
+    FDIRClientOperPnamePair opname;
+    FDIRDEntryInfo dentry;
+
+    FCFSAPI_SET_PATH_OPER_PNAME(opname, *oper, parent_inode, name);
+    return fcfs_api_access_dentry_by_pname_ex(ctx,
+            &opname, mask, flags, &dentry);
+}
+
 int fcfs_api_euidaccess_ex(FCFSAPIContext *ctx, const char *path,
         const int mask, const FDIRDentryOperator *oper,
         const int flags)
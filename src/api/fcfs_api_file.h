@@ -25,6 +25,7 @@
 #include <utime.h>
 #include "fcfs_api_types.h"
 #include "fcfs_api_util.h"
+#include "append_lease.h"
 
 #ifndef FALLOC_FL_KEEP_SIZE
 #define FALLOC_FL_KEEP_SIZE  0x01
@@ -98,6 +99,9 @@ extern "C" {
 #define fcfs_api_file_truncate(oino, new_size, tid, dentry) \
     fcfs_api_file_truncate_ex(&g_fcfs_api_ctx, oino, new_size, tid, dentry)
 
+#define fcfs_api_put_files(entries, count, fctx)  \
+    fcfs_api_put_files_ex(&g_fcfs_api_ctx, entries, count, fctx)
+
 #define fcfs_api_unlink(path, tid)  \
     fcfs_api_unlink_ex(&g_fcfs_api_ctx, path, tid)
 
@@ -135,6 +139,12 @@ extern "C" {
 
     int fcfs_api_close(FCFSAPIFileInfo *fi);
 
+    /* call in the child process after fork for the file inherited from
+     * the parent process, the flock session and the append lease belong
+     * to the parent, drop them without any RPC
+     */
+    void fcfs_api_fork_child_file(FCFSAPIFileInfo *fi);
+
     void fcfs_api_file_write_done_callback(
             FSAPIWriteDoneCallbackArg *callback_arg);
 
@@ -179,6 +189,26 @@ extern "C" {
     int fcfs_api_fallocate_ex(FCFSAPIFileInfo *fi, const int mode,
             const int64_t offset, const int64_t len, const int64_t tid);
 
+    /* create the small files and write their whole content, the new files
+     * are created by the parent inode, and their sizes are reported in
+     * batch, the existing files are truncated and written one by one
+     *
+     * NOTE: a new file is visible at size 0 between its creation and
+     *   the size report. without async report, the sizes are reported
+     *   when the batch is full or the parent directory changes, so
+     *   sort the entries by directory to keep this window short. with
+     *   async report, the window lasts until the reporter flushes
+     * parameters:
+     *   ctx: the api context
+     *   entries: the files to put, the result of each file is set
+     *   count: the count of the entries
+     *   fctx: the file context, the mode is ignored
+     * return: 0 for all success, or the error no of the first failed file
+     */
+    int fcfs_api_put_files_ex(FCFSAPIContext *ctx,
+            FCFSAPIPutFileEntry *entries, const int count,
+            const FCFSAPIFileContext *fctx);
+
     static inline int fcfs_api_unlink_ex(FCFSAPIContext *ctx,
             const FDIRClientOperFnamePair *path, const int64_t tid)
     {
@@ -200,6 +230,12 @@ extern "C" {
             const FDIRDentryOperator *oper, struct stat *buf,
             const int flags);
 
+    /* stat the entry by the parent inode and name without path walk */
+    int fcfs_api_stat_by_pname_ex(FCFSAPIContext *ctx,
+            const int64_t parent_inode, const string_t *name,
+            const FDIRDentryOperator *oper, struct stat *buf,
+            const int flags);
+
     int fcfs_api_flock_ex2(FCFSAPIFileInfo *fi, const int operation,
             const int64_t owner_id, const pid_t pid);
 
@@ -276,6 +312,11 @@ extern "C" {
             const int mask, const FDIRDentryOperator *oper,
             const int flags);
 
+    int fcfs_api_access_by_pname_ex(FCFSAPIContext *ctx,
+            const int64_t parent_inode, const string_t *name,
+            const int mask, const FDIRDentryOperator *oper,
+            const int flags);
+
     int fcfs_api_euidaccess_ex(FCFSAPIContext *ctx, const char *path,
             const int mask, const FDIRDentryOperator *oper,
             const int flags);
@@ -297,16 +338,20 @@ extern "C" {
             const int64_t tid)
     {
         fs_api_datasync(fi->ctx->contexts.fsapi, fi->dentry.inode, tid);
-        return 0;
+        return fcfs_api_release_append_lease(fi);
     }
 
     static inline int fcfs_api_fsync(FCFSAPIFileInfo *fi, const int64_t tid)
     {
+        int result;
+
         fs_api_datasync(fi->ctx->contexts.fsapi, fi->dentry.inode, tid);
+        result = fcfs_api_release_append_lease(fi);
+        lazytime_flush(fi->ctx, fi->dentry.inode);
         if (fi->ctx->async_report.enabled) {
             inode_htable_check_conflict_and_wait(fi->dentry.inode);
         }
-        return 0;
+        return result;
     }
 
 #ifdef __cplusplus
@@ -51,6 +51,18 @@ typedef struct fcfs_api_context {
     /* whether FCFSAPIFileInfo object persist additional gids */
     bool persist_additional_gids;
     bool use_sys_lock_for_append;
+
+    /* has its own client contexts, the process wide services such as
+     * the async reporter, lazytime and append lease are left to
+     * the primary context
+     */
+    bool secondary;
+    struct {
+        bool enabled;
+        int lease_ms;
+        int64_t max_bytes;
+    } append_lease;  //valid when use_sys_lock_for_append is true
+
     struct {
         bool enabled;
         bool busy_polling;  //for RDMA
@@ -64,6 +76,20 @@ typedef struct fcfs_api_context {
         int64_t hashtable_total_capacity;
     } async_report;
 
+    struct {
+        bool enabled;
+        int flush_interval;   //in seconds
+        int max_dirty_inodes;
+    } lazytime;
+
+    /* the attributes of the tiny file got by the open of read only
+     * serve the fstat and the read at EOF in a short time
+     */
+    struct {
+        int attr_timeout_ms;  //0 for disable
+        int64_t max_size;
+    } tiny_file;
+
     string_t ns;  //namespace
     char ns_holder[NAME_MAX];
     FCFSAPIOwnerInfo owner;
@@ -76,6 +102,8 @@ typedef struct fcfs_api_context {
     struct fast_mblock_man opendir_session_pool;
 } FCFSAPIContext;
 
+struct fcfs_api_append_lease;
+
 typedef struct fcfs_api_file_info {
     FCFSAPIContext *ctx;
     FDIRDentryOperator oper;
@@ -91,6 +119,8 @@ typedef struct fcfs_api_file_info {
         int last_modified_time;
     } write_notify;
     int64_t offset;  //current offset
+    int64_t attr_expires_ms;  //for the tiny file, 0 for never trusted
+    struct fcfs_api_append_lease *append_lease;  //for O_APPEND
     char fixed_groups_buff[256];  //for additional gids
 } FCFSAPIFileInfo;
 
@@ -100,6 +130,13 @@ typedef struct fcfs_api_file_context {
     int64_t tid;
 } FCFSAPIFileContext;
 
+typedef struct fcfs_api_put_file_entry {
+    const char *path;  //the full path of the file
+    mode_t mode;
+    string_t data;     //the whole content of the file
+    int result;        //output: the error no of this file, 0 for success
+} FCFSAPIPutFileEntry;
+
 typedef struct fcfs_api_write_done_callback_extra_data {
     FCFSAPIContext *ctx;
     int64_t file_size;
@@ -23,6 +23,7 @@
 #include "fcfs_api_types.h"
 #include "inode_htable.h"
 #include "async_reporter.h"
+#include "lazytime.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -202,6 +203,7 @@ static inline int fcfs_api_stat_dentry_by_inode_ex(FCFSAPIContext *ctx,
         const FDIRClientOperInodePair *oino, const int flags,
         FDIRDEntryInfo *dentry)
 {
+    lazytime_flush(ctx, oino->inode);
     if (ctx->async_report.enabled) {
         inode_htable_check_conflict_and_wait(oino->inode);
     }
@@ -265,8 +267,11 @@ static inline int fcfs_api_access_dentry_by_inode_ex(FCFSAPIContext *ctx,
         const FDIRClientOperInodePair *oino, const char mask,
         const int flags, FDIRDEntryInfo *dentry)
 {
-    if (ctx->async_report.enabled && (flags & FDIR_FLAGS_OUTPUT_DENTRY)) {
-        inode_htable_check_conflict_and_wait(oino->inode);
+    if ((flags & FDIR_FLAGS_OUTPUT_DENTRY)) {
+        lazytime_flush(ctx, oino->inode);
+        if (ctx->async_report.enabled) {
+            inode_htable_check_conflict_and_wait(oino->inode);
+        }
     }
 
     return fdir_client_access_dentry_by_inode(ctx->contexts.fdir,
@@ -0,0 +1,615 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <limits.h>
+#include "fastcommon/shared_func.h"
+#include "fastcommon/logger.h"
+#include "fastcommon/fc_atomic.h"
+#include "sf/sf_global.h"
+#include "fcfs_api_util.h"
+#include "fcfs_api_walk.h"
+
+typedef struct {
+    FCFSAPIContext *ctx;
+    const FDIRDentryOperator *oper;
+    FCFSAPIRemoveTreeStat *stat;
+    int64_t tid;
+    volatile int not_empty_count;
+    volatile int result;  //the first error
+} FCFSAPIRemoveTreeArgs;
+
+static FCFSAPIWalkNode *alloc_node(const string_t *path,
+        const string_t *name, const FDIRDEntryInfo *dentry,
+        const int depth, FCFSAPIWalkNode *parent)
+{
+    FCFSAPIWalkNode *node;
+
+    node = (FCFSAPIWalkNode *)fc_malloc(sizeof(FCFSAPIWalkNode) +
+            path->len + 1);
+    if (node == NULL) {
+        return NULL;
+    }
+
+    node->dentry = *dentry;
+    node->path.str = (char *)(node + 1);
+    memcpy(node->path.str, path->str, path->len);
+    node->path.len = path->len;
+    *(node->path.str + node->path.len) = '\0';
+    node->name.len = name->len;
+    node->name.str = node->path.str + (path->len - name->len);
+    node->depth = depth;
+    node->pending = 1;
+    node->parent = parent;
+    return node;
+}
+
+static inline void set_first_error(FCFSAPIWalkContext *wctx,
+        const int result)
+{
+    __sync_bool_compare_and_swap(&wctx->result, 0, result);
+}
+
+static void push_node(FCFSAPIWalkWorker *worker, FCFSAPIWalkNode *node)
+{
+    FCFSAPIWalkContext *wctx;
+
+    wctx = worker->wctx;
+    PTHREAD_MUTEX_LOCK(&worker->lock);
+    fc_list_add_tail(&node->dlink, &worker->head);
+    PTHREAD_MUTEX_UNLOCK(&worker->lock);
+
+    __sync_add_and_fetch(&wctx->queue_size, 1);
+    if (FC_ATOMIC_GET(wctx->idle_count) > 0) {
+        PTHREAD_MUTEX_LOCK(&wctx->lcp.lock);
+        pthread_cond_signal(&wctx->lcp.cond);
+        PTHREAD_MUTEX_UNLOCK(&wctx->lcp.lock);
+    }
+}
+
+/* pop the newest node from the own queue for depth first */
+static FCFSAPIWalkNode *pop_node(FCFSAPIWalkWorker *worker)
+{
+    FCFSAPIWalkNode *node;
+
+    PTHREAD_MUTEX_LOCK(&worker->lock);
+    if (fc_list_empty(&worker->head)) {
+        node = NULL;
+    } else {
+        node = fc_list_entry(worker->head.prev, FCFSAPIWalkNode, dlink);
+        fc_list_del_init(&node->dlink);
+    }
+    PTHREAD_MUTEX_UNLOCK(&worker->lock);
+
+    if (node != NULL) {
+        __sync_sub_and_fetch(&worker->wctx->queue_size, 1);
+    }
+    return node;
+}
+
+/* steal the oldest node which has the largest subtree probably */
+static FCFSAPIWalkNode *steal_node(FCFSAPIWalkWorker *worker)
+{
+    FCFSAPIWalkContext *wctx;
+    FCFSAPIWalkWorker *victim;
+    FCFSAPIWalkNode *node;
+    int index;
+    int i;
+
+    wctx = worker->wctx;
+    index = worker - wctx->workers;
+    for (i=1; i<wctx->worker_count; i++) {
+        victim = wctx->workers + (index + i) % wctx->worker_count;
+        PTHREAD_MUTEX_LOCK(&victim->lock);
+        node = fc_list_first_entry(&victim->head, FCFSAPIWalkNode, dlink);
+        if (node != NULL) {
+            fc_list_del_init(&node->dlink);
+        }
+        PTHREAD_MUTEX_UNLOCK(&victim->lock);
+
+        if (node != NULL) {
+            __sync_sub_and_fetch(&wctx->queue_size, 1);
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+static void complete_node(FCFSAPIWalkContext *wctx, FCFSAPIWalkNode *node)
+{
+    FCFSAPIWalkNode *parent;
+    FCFSAPIWalkEntry entry;
+
+    while (node != NULL) {
+        if (__sync_sub_and_fetch(&node->pending, 1) > 0) {
+            return;
+        }
+
+        if (!FC_ATOMIC_GET(wctx->stop)) {
+            entry.path = &node->path;
+            entry.name = &node->name;
+            entry.parent_inode = (node->parent != NULL ?
+                    node->parent->dentry.inode : 0);
+            entry.dentry = &node->dentry;
+            entry.depth = node->depth;
+            wctx->callback(wctx->args, fcfs_api_walk_visit_post, &entry);
+        }
+
+        parent = node->parent;
+        free(node);
+        node = parent;
+    }
+
+    /* the start directory completed */
+    PTHREAD_MUTEX_LOCK(&wctx->lcp.lock);
+    wctx->done = true;
+    pthread_cond_broadcast(&wctx->lcp.cond);
+    PTHREAD_MUTEX_UNLOCK(&wctx->lcp.lock);
+}
+
+static FCFSAPIWalkLevel *get_level(FCFSAPIWalkWorker *worker,
+        const int level)
+{
+    FCFSAPIWalkLevel *wl;
+
+    if ((wl=worker->levels[level]) != NULL) {
+        return wl;
+    }
+
+    wl = (FCFSAPIWalkLevel *)fc_malloc(sizeof(FCFSAPIWalkLevel));
+    if (wl == NULL) {
+        return NULL;
+    }
+    if (fdir_client_dentry_array_init(&wl->array) != 0) {
+        free(wl);
+        return NULL;
+    }
+    worker->levels[level] = wl;
+    return wl;
+}
+
+static void walk_dir(FCFSAPIWalkWorker *worker,
+        FCFSAPIWalkNode *node, const int level);
+
+static void list_children(FCFSAPIWalkWorker *worker,
+        FCFSAPIWalkNode *node, const int level)
+{
+    FCFSAPIWalkContext *wctx;
+    FCFSAPIWalkLevel *wl;
+    FDIRClientOperInodePair oino;
+    FDIRClientDentryArray *array;
+    FDIRClientDentry *cd;
+    FDIRClientDentry *end;
+    FCFSAPIWalkNode *sub;
+    FCFSAPIWalkEntry entry;
+    string_t path;
+    char *full_path;
+    int prefix_len;
+    int result;
+
+    wctx = worker->wctx;
+    if ((wl=get_level(worker, level)) == NULL) {
+        set_first_error(wctx, ENOMEM);
+        return;
+    }
+    array = &wl->array;
+    full_path = wl->full_path;
+
+    FCFSAPI_SET_OPER_INODE_PAIR(oino, *wctx->oper, node->dentry.inode);
+    if ((result=fcfs_api_list_dentry_by_inode_ex(wctx->ctx,
+                    &oino, array)) != 0)
+    {
+        if (result == ENOENT) {  //removed by others, skip it
+            return;
+        }
+        logWarning("file: "__FILE__", line: %d, "
+                "list directory %s fail, errno: %d, error info: %s",
+                __LINE__, node->path.str, result, STRERROR(result));
+        set_first_error(wctx, result);
+        return;
+    }
+
+    prefix_len = node->path.len;
+    memcpy(full_path, node->path.str, prefix_len);
+    if (prefix_len == 0 || full_path[prefix_len - 1] != '/') {
+        full_path[prefix_len++] = '/';
+    }
+
+    path.str = full_path;
+    entry.path = &path;
+    entry.parent_inode = node->dentry.inode;
+    entry.depth = node->depth + 1;
+    end = array->entries + array->count;
+    for (cd=array->entries; cd<end; cd++) {
+        if (FC_ATOMIC_GET(wctx->stop)) {
+            break;
+        }
+
+        /* the listing outputs the special entries . and .. */
+        if (*cd->name.str == '.' && (cd->name.len == 1 ||
+                    (cd->name.len == 2 && *(cd->name.str + 1) == '.')))
+        {
+            continue;
+        }
+
+        if (prefix_len + cd->name.len >= PATH_MAX) {
+            logWarning("file: "__FILE__", line: %d, "
+                    "path %s/%.*s is too long", __LINE__, node->path.str,
+                    cd->name.len, cd->name.str);
+            set_first_error(wctx, ENAMETOOLONG);
+            continue;
+        }
+        memcpy(full_path + prefix_len, cd->name.str, cd->name.len);
+        path.len = prefix_len + cd->name.len;
+        *(full_path + path.len) = '\0';
+        entry.name = &cd->name;
+        entry.dentry = &cd->dentry;
+
+        if (!S_ISDIR(cd->dentry.stat.mode)) {
+            if (wctx->callback(wctx->args, fcfs_api_walk_visit_file,
+                        &entry) == FCFS_API_WALK_STOP)
+            {
+                __sync_bool_compare_and_swap(&wctx->stop, 0, 1);
+                break;
+            }
+            continue;
+        }
+
+        result = wctx->callback(wctx->args, fcfs_api_walk_visit_pre, &entry);
+        if (result == FCFS_API_WALK_PRUNE) {
+            continue;
+        } else if (result == FCFS_API_WALK_STOP) {
+            __sync_bool_compare_and_swap(&wctx->stop, 0, 1);
+            break;
+        }
+
+        if ((sub=alloc_node(&path, &cd->name, &cd->dentry,
+                        entry.depth, node)) == NULL)
+        {
+            set_first_error(wctx, ENOMEM);
+            continue;
+        }
+
+        __sync_add_and_fetch(&node->pending, 1);
+        if (FC_ATOMIC_GET(wctx->queue_size) >= wctx->max_queue_size &&
+                level + 1 < FCFS_API_WALK_MAX_INLINE_LEVELS)
+        {
+            /* the queue is full, walk the sub directory inline
+             * so the pending nodes do not pile up in memory */
+            walk_dir(worker, sub, level + 1);
+        } else {
+            push_node(worker, sub);
+        }
+    }
+}
+
+static void walk_dir(FCFSAPIWalkWorker *worker,
+        FCFSAPIWalkNode *node, const int level)
+{
+    if (!FC_ATOMIC_GET(worker->wctx->stop)) {
+        list_children(worker, node, level);
+    }
+    complete_node(worker->wctx, node);
+}
+
+static void walk_worker_run(FCFSAPIWalkWorker *worker)
+{
+    FCFSAPIWalkContext *wctx;
+    FCFSAPIWalkNode *node;
+    bool done;
+
+    wctx = worker->wctx;
+    while (1) {
+        if ((node=pop_node(worker)) != NULL ||
+                (node=steal_node(worker)) != NULL)
+        {
+            walk_dir(worker, node, 0);
+            continue;
+        }
+
+        PTHREAD_MUTEX_LOCK(&wctx->lcp.lock);
+        __sync_add_and_fetch(&wctx->idle_count, 1);
+        while (!wctx->done && FC_ATOMIC_GET(wctx->queue_size) == 0) {
+            pthread_cond_wait(&wctx->lcp.cond, &wctx->lcp.lock);
+        }
+        __sync_sub_and_fetch(&wctx->idle_count, 1);
+        done = wctx->done;
+        PTHREAD_MUTEX_UNLOCK(&wctx->lcp.lock);
+
+        if (done) {
+            break;
+        }
+    }
+}
+
+static void *walk_thread_func(void *arg)
+{
+    FCFSAPIWalkWorker *worker;
+    FCFSAPIWalkContext *wctx;
+
+#ifdef OS_LINUX
+    prctl(PR_SET_NAME, "fcfs-walk");
+#endif
+
+    worker = (FCFSAPIWalkWorker *)arg;
+    wctx = worker->wctx;
+    walk_worker_run(worker);
+
+    PTHREAD_MUTEX_LOCK(&wctx->lcp.lock);
+    wctx->running_count--;
+    pthread_cond_broadcast(&wctx->lcp.cond);
+    PTHREAD_MUTEX_UNLOCK(&wctx->lcp.lock);
+    return NULL;
+}
+
+static int init_walk_context(FCFSAPIWalkContext *wctx,
+        FCFSAPIContext *ctx, const FDIRDentryOperator *oper,
+        const FCFSAPIWalkOptions *options,
+        fcfs_api_walk_callback callback, void *args)
+{
+    FCFSAPIWalkWorker *worker;
+    FCFSAPIWalkWorker *end;
+    int result;
+
+    memset(wctx, 0, sizeof(*wctx));
+    wctx->ctx = ctx;
+    wctx->oper = oper;
+    wctx->callback = callback;
+    wctx->args = args;
+    if (options != NULL && options->thread_count > 0) {
+        wctx->worker_count = options->thread_count;
+    } else {
+        wctx->worker_count = FCFS_API_WALK_DEFAULT_THREAD_COUNT;
+    }
+    if (options != NULL && options->max_queue_size > 0) {
+        wctx->max_queue_size = options->max_queue_size;
+    } else {
+        wctx->max_queue_size = FCFS_API_WALK_DEFAULT_MAX_QUEUE_SIZE;
+    }
+
+    wctx->workers = (FCFSAPIWalkWorker *)fc_malloc(
+            sizeof(FCFSAPIWalkWorker) * wctx->worker_count);
+    if (wctx->workers == NULL) {
+        return ENOMEM;
+    }
+
+    end = wctx->workers + wctx->worker_count;
+    for (worker=wctx->workers; worker<end; worker++) {
+        if ((result=init_pthread_lock(&worker->lock)) != 0) {
+            return result;
+        }
+        FC_INIT_LIST_HEAD(&worker->head);
+        memset(worker->levels, 0, sizeof(worker->levels));
+        worker->wctx = wctx;
+    }
+
+    return init_pthread_lock_cond_pair(&wctx->lcp);
+}
+
+static void destroy_walk_context(FCFSAPIWalkContext *wctx)
+{
+    FCFSAPIWalkWorker *worker;
+    FCFSAPIWalkWorker *end;
+    int i;
+
+    end = wctx->workers + wctx->worker_count;
+    for (worker=wctx->workers; worker<end; worker++) {
+        for (i=0; i<FCFS_API_WALK_MAX_INLINE_LEVELS; i++) {
+            if (worker->levels[i] != NULL) {
+                fdir_client_dentry_array_free(&worker->levels[i]->array);
+                free(worker->levels[i]);
+            }
+        }
+        pthread_mutex_destroy(&worker->lock);
+    }
+    free(wctx->workers);
+    destroy_pthread_lock_cond_pair(&wctx->lcp);
+}
+
+int fcfs_api_walk_ex(FCFSAPIContext *ctx, const char *path,
+        const FDIRDentryOperator *oper,
+        const FCFSAPIWalkOptions *options,
+        fcfs_api_walk_callback callback, void *args)
+{
+    const int flags = 0;
+    FCFSAPIWalkContext wctx;
+    FCFSAPIWalkNode *root;
+    FCFSAPIWalkEntry entry;
+    FDIRDEntryInfo dentry;
+    string_t spath;
+    pthread_t tid;
+    int result;
+    int i;
+
+    if ((result=fcfs_api_stat_dentry_by_path_ex(ctx, path, oper,
+                    flags, LOG_DEBUG, &dentry)) != 0)
+    {
+        return result;
+    }
+
+    FC_SET_STRING(spath, (char *)path);
+    if (spath.len >= PATH_MAX) {
+        return ENAMETOOLONG;
+    }
+    entry.path = &spath;
+    entry.name = &spath;
+    entry.parent_inode = 0;
+    entry.dentry = &dentry;
+    entry.depth = 0;
+    if (!S_ISDIR(dentry.stat.mode)) {
+        result = callback(args, fcfs_api_walk_visit_file, &entry);
+        return (result == FCFS_API_WALK_STOP ? ECANCELED : 0);
+    }
+
+    result = callback(args, fcfs_api_walk_visit_pre, &entry);
+    if (result == FCFS_API_WALK_PRUNE) {
+        return 0;
+    } else if (result == FCFS_API_WALK_STOP) {
+        return ECANCELED;
+    }
+
+    if ((result=init_walk_context(&wctx, ctx, oper,
+                    options, callback, args)) != 0)
+    {
+        return result;
+    }
+    if ((root=alloc_node(&spath, &spath, &dentry, 0, NULL)) == NULL) {
+        destroy_walk_context(&wctx);
+        return ENOMEM;
+    }
+    push_node(wctx.workers, root);
+
+    /* the caller thread acts as the first worker */
+    for (i=1; i<wctx.worker_count; i++) {
+        PTHREAD_MUTEX_LOCK(&wctx.lcp.lock);
+        wctx.running_count++;
+        PTHREAD_MUTEX_UNLOCK(&wctx.lcp.lock);
+        if ((result=fc_create_thread(&tid, walk_thread_func,
+                        wctx.workers + i, SF_G_THREAD_STACK_SIZE)) != 0)
+        {
+            PTHREAD_MUTEX_LOCK(&wctx.lcp.lock);
+            wctx.running_count--;
+            PTHREAD_MUTEX_UNLOCK(&wctx.lcp.lock);
+            break;
+        }
+    }
+    walk_worker_run(wctx.workers);
+
+    PTHREAD_MUTEX_LOCK(&wctx.lcp.lock);
+    while (wctx.running_count > 0) {
+        pthread_cond_wait(&wctx.lcp.cond, &wctx.lcp.lock);
+    }
+    PTHREAD_MUTEX_UNLOCK(&wctx.lcp.lock);
+
+    destroy_walk_context(&wctx);
+    if (wctx.stop) {
+        return ECANCELED;
+    }
+    return wctx.result;
+}
+
+static int remove_entry(FCFSAPIRemoveTreeArgs *rargs,
+        const FCFSAPIWalkEntry *entry, const int flags)
+{
+    FDIRClientOperFnamePair fname;
+    FDIRClientOperPnamePair opname;
+
+    if (entry->parent_inode == 0) {  //the start path
+        if (strcmp(entry->path->str, "/") == 0) {
+            return 0;  //keep the root directory
+        }
+
+        FCFSAPI_SET_PATH_OPER_FNAME(fname, rargs->ctx,
+                *rargs->oper, entry->path->str);
+        return fcfs_api_remove_dentry_ex(rargs->ctx,
+                &fname, flags, rargs->tid);
+    } else {
+        FCFSAPI_SET_PATH_OPER_PNAME(opname, *rargs->oper,
+                entry->parent_inode, entry->name);
+        return fcfs_api_remove_dentry_by_pname_ex(rargs->ctx,
+                &opname, flags, rargs->tid);
+    }
+}
+
+static int remove_tree_callback(void *args, const FCFSAPIWalkVisitType type,
+        const FCFSAPIWalkEntry *entry)
+{
+    FCFSAPIRemoveTreeArgs *rargs;
+    int result;
+
+    rargs = (FCFSAPIRemoveTreeArgs *)args;
+    if (type == fcfs_api_walk_visit_pre) {
+        return FCFS_API_WALK_CONTINUE;
+    }
+
+    if (type == fcfs_api_walk_visit_file) {
+        if ((result=remove_entry(rargs, entry,
+                        FDIR_UNLINK_FLAGS_MATCH_FILE)) == 0)
+        {
+            __sync_add_and_fetch(&rargs->stat->file_count, 1);
+            __sync_add_and_fetch(&rargs->stat->bytes,
+                    entry->dentry->stat.size);
+        }
+    } else {
+        if ((result=remove_entry(rargs, entry,
+                        FDIR_UNLINK_FLAGS_MATCH_DIR)) == 0)
+        {
+            __sync_add_and_fetch(&rargs->stat->dir_count, 1);
+        }
+    }
+
+    if (result == 0 || result == ENOENT) {
+        return FCFS_API_WALK_CONTINUE;
+    }
+
+    if (result == ENOTEMPTY) {  //new entries created concurrently
+        __sync_add_and_fetch(&rargs->not_empty_count, 1);
+    } else {
+        logWarning("file: "__FILE__", line: %d, "
+                "remove %s fail, errno: %d, error info: %s",
+                __LINE__, entry->path->str, result, STRERROR(result));
+        __sync_add_and_fetch(&rargs->stat->fail_count, 1);
+        __sync_bool_compare_and_swap(&rargs->result, 0, result);
+    }
+    return FCFS_API_WALK_CONTINUE;
+}
+
+int fcfs_api_remove_tree_ex(FCFSAPIContext *ctx, const char *path,
+        const FDIRDentryOperator *oper,
+        const FCFSAPIWalkOptions *options,
+        FCFSAPIRemoveTreeStat *stat, const int64_t tid)
+{
+    FCFSAPIRemoveTreeArgs rargs;
+    FCFSAPIRemoveTreeStat holder;
+    int round;
+    int result;
+
+    if (stat == NULL) {
+        stat = &holder;
+    }
+    memset(stat, 0, sizeof(*stat));
+    rargs.ctx = ctx;
+    rargs.oper = oper;
+    rargs.stat = stat;
+    rargs.tid = tid;
+    rargs.result = 0;
+    for (round=1; ; round++) {
+        rargs.not_empty_count = 0;
+        result = fcfs_api_walk_ex(ctx, path, oper, options,
+                remove_tree_callback, &rargs);
+        if (result == ENOENT && round > 1) {
+            result = 0;  //the start path has been removed
+            break;
+        }
+
+        if (result != 0) {
+            break;
+        }
+        if (rargs.result != 0) {
+            result = rargs.result;
+            break;
+        }
+        if (rargs.not_empty_count == 0) {
+            break;
+        }
+        if (round == FCFS_API_REMOVE_TREE_MAX_ROUNDS) {
+            result = ENOTEMPTY;
+            break;
+        }
+    }
+
+    return result;
+}
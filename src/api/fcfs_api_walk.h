@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FCFS_API_WALK_H
+#define _FCFS_API_WALK_H
+
+#include "fastcommon/fc_list.h"
+#include "fastcommon/pthread_func.h"
+#include "fcfs_api_types.h"
+
+#define FCFS_API_WALK_DEFAULT_THREAD_COUNT     8
+#define FCFS_API_WALK_DEFAULT_MAX_QUEUE_SIZE   (64 * 1024)
+
+/* the return values of the walk callback */
+#define FCFS_API_WALK_CONTINUE  0
+#define FCFS_API_WALK_PRUNE     1  //skip the children of the directory
+#define FCFS_API_WALK_STOP      2  //stop the whole walk
+
+#define FCFS_API_REMOVE_TREE_MAX_ROUNDS  3
+
+/* the max levels of the sub directories walked inline when the queue
+ * is full, the deeper ones are queued even if the queue is full
+ */
+#define FCFS_API_WALK_MAX_INLINE_LEVELS  32
+
+#define fcfs_api_walk(path, options, callback, args) \
+    fcfs_api_walk_ex(&g_fcfs_api_ctx, path, &g_fcfs_api_ctx. \
+            owner.oper, options, callback, args)
+
+#define fcfs_api_remove_tree(path, options, stat) \
+    fcfs_api_remove_tree_ex(&g_fcfs_api_ctx, path, &g_fcfs_api_ctx. \
+            owner.oper, options, stat, getpid())
+
+typedef enum {
+    fcfs_api_walk_visit_file,  //non-directory entry
+    fcfs_api_walk_visit_pre,   //directory before its children
+    fcfs_api_walk_visit_post   //directory after all of its children
+} FCFSAPIWalkVisitType;
+
+typedef struct fcfs_api_walk_entry {
+    const string_t *path;  //the full path in the namespace
+    const string_t *name;  //the last component of the path
+    int64_t parent_inode;  //0 for the start path
+    const FDIRDEntryInfo *dentry;  //the attributes from the dentry listing
+    int depth;             //0 for the start path
+} FCFSAPIWalkEntry;
+
+/* the callback is called by the walk threads concurrently,
+ * the return value is only checked for the file and pre visit
+ */
+typedef int (*fcfs_api_walk_callback)(void *args,
+        const FCFSAPIWalkVisitType type,
+        const FCFSAPIWalkEntry *entry);
+
+typedef struct fcfs_api_walk_options {
+    int thread_count;    //the walk threads including the caller
+    int max_queue_size;  //the max pending directories in memory
+} FCFSAPIWalkOptions;
+
+typedef struct fcfs_api_remove_tree_stat {
+    volatile int64_t file_count;  //the removed non-directory entries
+    volatile int64_t dir_count;   //the removed directories
+    volatile int64_t bytes;       //the file size of the removed files
+    volatile int64_t fail_count;
+} FCFSAPIRemoveTreeStat;
+
+typedef struct fcfs_api_walk_node {
+    FDIRDEntryInfo dentry;
+    string_t path;
+    string_t name;
+    int depth;
+    volatile int pending;  //self listing + uncompleted sub directories
+    struct fcfs_api_walk_node *parent;
+    struct fc_list_head dlink;
+} FCFSAPIWalkNode;
+
+/* the listing buffer of one inline level */
+typedef struct fcfs_api_walk_level {
+    FDIRClientDentryArray array;
+    char full_path[PATH_MAX];
+} FCFSAPIWalkLevel;
+
+struct fcfs_api_walk_context;
+typedef struct fcfs_api_walk_worker {
+    pthread_mutex_t lock;
+    struct fc_list_head head;  //element: FCFSAPIWalkNode
+    FCFSAPIWalkLevel *levels[FCFS_API_WALK_MAX_INLINE_LEVELS]; //alloc on demand
+    struct fcfs_api_walk_context *wctx;
+} FCFSAPIWalkWorker;
+
+typedef struct fcfs_api_walk_context {
+    FCFSAPIContext *ctx;
+    const FDIRDentryOperator *oper;
+    fcfs_api_walk_callback callback;
+    void *args;
+    int max_queue_size;
+    volatile int queue_size;
+    volatile int idle_count;
+    volatile int running_count;
+    volatile int stop;
+    volatile int result;   //the first error
+    bool done;
+    int worker_count;
+    FCFSAPIWalkWorker *workers;
+    pthread_lock_cond_pair_t lcp;
+} FCFSAPIWalkContext;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /* walk the directory tree concurrently like nftw, the sub directories
+     * are listed by a work-stealing pool of threads.
+     *
+     * return 0 for success, ECANCELED when the callback returns
+     * FCFS_API_WALK_STOP, otherwise the first error of the listing
+     * (the walk continues when a directory fails to list)
+     */
+    int fcfs_api_walk_ex(FCFSAPIContext *ctx, const char *path,
+            const FDIRDentryOperator *oper,
+            const FCFSAPIWalkOptions *options,
+            fcfs_api_walk_callback callback, void *args);
+
+    /* remove the directory tree like rm -rf, the entries are removed by
+     * the parent inode and name in post order with the walk threads.
+     *
+     * the entries created inside the tree during the removal are removed
+     * when the listing sees them. the directories which fail with
+     * ENOTEMPTY are retried by walking the tree again, up to
+     * FCFS_API_REMOVE_TREE_MAX_ROUNDS rounds, then ENOTEMPTY returned.
+     * the entries removed by others concurrently are skipped.
+     *
+     * stat: the progress which can be read by other threads, can be NULL
+     */
+    int fcfs_api_remove_tree_ex(FCFSAPIContext *ctx, const char *path,
+            const FDIRDentryOperator *oper,
+            const FCFSAPIWalkOptions *options,
+            FCFSAPIRemoveTreeStat *stat, const int64_t tid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include "fastcommon/shared_func.h"
+#include "fastcommon/logger.h"
+#include "fastcommon/sched_thread.h"
+#include "sf/sf_global.h"
+#include "sf/sf_func.h"
+#include "async_reporter.h"
+#include "lazytime.h"
+
+#define LAZYTIME_FLUSH_BATCH_SIZE  256
+
+LazytimeContext g_lazytime_ctx;
+
+#define FCFS_API_CTX  g_lazytime_ctx.fcfs_api_ctx
+
+#define LAZYTIME_GET_SHARDING(inode) \
+    (g_lazytime_ctx.shardings + (inode) % FCFS_API_LAZYTIME_SHARDING_COUNT)
+
+#define LAZYTIME_GET_BUCKET(sharding, inode) \
+    ((sharding)->buckets + ((inode) / FCFS_API_LAZYTIME_SHARDING_COUNT) % \
+     g_lazytime_ctx.capacity)
+
+typedef struct {
+    uint64_t inode;
+    int mtime;
+} LazytimeDirtyMtime;
+
+/* set the mtime to the write time instead of the report time
+ * of the server, by the root operator as the size report
+ */
+static int report_mtime(const LazytimeDirtyMtime *dirty)
+{
+    FDIRClientOperInodePair oino;
+    FDIRStatModifyFlags options;
+    FDIRDEntryStat stat;
+    FDIRDEntryInfo dentry;
+    int result;
+
+    if (FCFS_API_CTX->async_report.enabled) {
+        inode_htable_check_conflict_and_wait(dirty->inode);
+    }
+
+    FDIR_SET_OPERATOR(oino.oper, 0, 0, 0, NULL);
+    oino.inode = dirty->inode;
+    options.flags = 0;
+    options.mtime = 1;
+    memset(&stat, 0, sizeof(stat));
+    stat.mtime = dirty->mtime;
+    if ((result=fdir_client_modify_stat_by_inode(FCFS_API_CTX->
+                    contexts.fdir, &FCFS_API_CTX->ns, &oino,
+                    options.flags, &stat, 0, &dentry)) != 0)
+    {
+        logError("file: "__FILE__", line: %d, "
+                "report mtime of inode: %"PRId64" fail, "
+                "errno: %d, error info: %s", __LINE__,
+                dirty->inode, result, STRERROR(result));
+    }
+    return result;
+}
+
+static inline int report_mtimes(const LazytimeDirtyMtime *dirties,
+        const int count)
+{
+    const LazytimeDirtyMtime *dirty;
+    const LazytimeDirtyMtime *end;
+    int result;
+    int r;
+
+    result = 0;
+    end = dirties + count;
+    for (dirty=dirties; dirty<end; dirty++) {
+        if ((r=report_mtime(dirty)) != 0) {
+            result = r;
+        }
+    }
+
+    return result;
+}
+
+static FCFSAPILazytimeEntry *remove_entry(FCFSAPILazytimeSharding
+        *sharding, const uint64_t inode)
+{
+    FCFSAPILazytimeEntry **bucket;
+    FCFSAPILazytimeEntry *previous;
+    FCFSAPILazytimeEntry *entry;
+
+    bucket = LAZYTIME_GET_BUCKET(sharding, inode);
+    previous = NULL;
+    entry = *bucket;
+    while (entry != NULL) {
+        if (entry->inode == inode) {
+            if (previous == NULL) {
+                *bucket = entry->next;
+            } else {
+                previous->next = entry->next;
+            }
+
+            fc_list_del_init(&entry->dlink);
+            sharding->count--;
+            __sync_sub_and_fetch(&g_lazytime_ctx.dirty_count, 1);
+            return entry;
+        }
+
+        previous = entry;
+        entry = entry->next;
+    }
+
+    return NULL;
+}
+
+/* pop the oldest entry, the caller should hold the sharding lock */
+static inline bool pop_oldest_entry(FCFSAPILazytimeSharding *sharding,
+        const int deadline, LazytimeDirtyMtime *dirty)
+{
+    FCFSAPILazytimeEntry *entry;
+
+    entry = fc_list_first_entry(&sharding->fifo,
+            FCFSAPILazytimeEntry, dlink);
+    if (entry == NULL || entry->dirty_time > deadline) {
+        return false;
+    }
+
+    dirty->inode = entry->inode;
+    dirty->mtime = entry->mtime;
+    remove_entry(sharding, entry->inode);
+    fast_mblock_free_object(&sharding->allocator, entry);
+    return true;
+}
+
+int lazytime_mark_dirty(const uint64_t inode)
+{
+    FCFSAPILazytimeSharding *sharding;
+    FCFSAPILazytimeEntry **bucket;
+    FCFSAPILazytimeEntry *entry;
+    LazytimeDirtyMtime oldest;
+    LazytimeDirtyMtime current;
+    bool evicted;
+
+    sharding = LAZYTIME_GET_SHARDING(inode);
+    bucket = LAZYTIME_GET_BUCKET(sharding, inode);
+    current.inode = inode;
+    current.mtime = get_current_time();
+    evicted = false;
+    PTHREAD_MUTEX_LOCK(&sharding->lock);
+    entry = *bucket;
+    while (entry != NULL) {
+        if (entry->inode == inode) {
+            break;
+        }
+        entry = entry->next;
+    }
+
+    if (entry == NULL) {
+        if (sharding->count >= g_lazytime_ctx.max_count) {
+            /* memory pressure, flush the oldest one */
+            evicted = pop_oldest_entry(sharding, INT32_MAX, &oldest);
+        }
+
+        entry = (FCFSAPILazytimeEntry *)fast_mblock_alloc_object(
+                &sharding->allocator);
+        if (entry != NULL) {
+            entry->inode = inode;
+            entry->dirty_time = current.mtime;
+            entry->next = *bucket;
+            *bucket = entry;
+            fc_list_add_tail(&entry->dlink, &sharding->fifo);
+            sharding->count++;
+            __sync_add_and_fetch(&g_lazytime_ctx.dirty_count, 1);
+        }
+    }
+    if (entry != NULL) {
+        entry->mtime = current.mtime;
+    }
+    PTHREAD_MUTEX_UNLOCK(&sharding->lock);
+
+    if (evicted) {
+        report_mtime(&oldest);
+    }
+
+    if (entry == NULL) {  //fallback to report directly
+        return report_mtime(&current);
+    }
+    return 0;
+}
+
+int lazytime_do_flush(const uint64_t inode)
+{
+    FCFSAPILazytimeSharding *sharding;
+    FCFSAPILazytimeEntry *entry;
+    LazytimeDirtyMtime dirty;
+
+    sharding = LAZYTIME_GET_SHARDING(inode);
+    PTHREAD_MUTEX_LOCK(&sharding->lock);
+    if ((entry=remove_entry(sharding, inode)) != NULL) {
+        dirty.inode = inode;
+        dirty.mtime = entry->mtime;
+        fast_mblock_free_object(&sharding->allocator, entry);
+    }
+    PTHREAD_MUTEX_UNLOCK(&sharding->lock);
+
+    if (entry == NULL) {
+        return 0;
+    }
+
+    return report_mtime(&dirty);
+}
+
+void lazytime_do_discard(const uint64_t inode)
+{
+    FCFSAPILazytimeSharding *sharding;
+    FCFSAPILazytimeEntry *entry;
+
+    sharding = LAZYTIME_GET_SHARDING(inode);
+    PTHREAD_MUTEX_LOCK(&sharding->lock);
+    if ((entry=remove_entry(sharding, inode)) != NULL) {
+        fast_mblock_free_object(&sharding->allocator, entry);
+    }
+    PTHREAD_MUTEX_UNLOCK(&sharding->lock);
+}
+
+static int flush_expired(const int deadline)
+{
+    FCFSAPILazytimeSharding *sharding;
+    FCFSAPILazytimeSharding *end;
+    LazytimeDirtyMtime dirties[LAZYTIME_FLUSH_BATCH_SIZE];
+    int count;
+    int total;
+
+    total = 0;
+    end = g_lazytime_ctx.shardings + FCFS_API_LAZYTIME_SHARDING_COUNT;
+    for (sharding=g_lazytime_ctx.shardings; sharding<end; sharding++) {
+        do {
+            count = 0;
+            PTHREAD_MUTEX_LOCK(&sharding->lock);
+            while (count < LAZYTIME_FLUSH_BATCH_SIZE && pop_oldest_entry(
+                        sharding, deadline, dirties + count))
+            {
+                count++;
+            }
+            PTHREAD_MUTEX_UNLOCK(&sharding->lock);
+
+            if (count > 0) {
+                report_mtimes(dirties, count);
+                total += count;
+            }
+        } while (count == LAZYTIME_FLUSH_BATCH_SIZE);
+    }
+
+    return total;
+}
+
+static void *lazytime_thread_func(void *arg)
+{
+#ifdef OS_LINUX
+    prctl(PR_SET_NAME, "dir-lazytime");
+#endif
+
+    while (SF_G_CONTINUE_FLAG) {
+        fc_timedwait_ms(&g_lazytime_ctx.lcp.lock,
+                &g_lazytime_ctx.lcp.cond, 1000);
+        if (FC_ATOMIC_GET(g_lazytime_ctx.dirty_count) > 0) {
+            flush_expired(get_current_time() - FCFS_API_CTX->
+                    lazytime.flush_interval);
+        }
+    }
+
+    return NULL;
+}
+
+int lazytime_init(FCFSAPIContext *fcfs_api_ctx)
+{
+    FCFSAPILazytimeSharding *sharding;
+    FCFSAPILazytimeSharding *end;
+    int64_t bytes;
+    int result;
+
+    g_lazytime_ctx.fcfs_api_ctx = fcfs_api_ctx;
+    g_lazytime_ctx.max_count = fcfs_api_ctx->lazytime.max_dirty_inodes /
+        FCFS_API_LAZYTIME_SHARDING_COUNT;
+    if (g_lazytime_ctx.max_count <= 0) {
+        g_lazytime_ctx.max_count = 1;
+    }
+    g_lazytime_ctx.capacity = g_lazytime_ctx.max_count;
+    bytes = sizeof(FCFSAPILazytimeEntry *) * g_lazytime_ctx.capacity;
+
+    end = g_lazytime_ctx.shardings + FCFS_API_LAZYTIME_SHARDING_COUNT;
+    for (sharding=g_lazytime_ctx.shardings; sharding<end; sharding++) {
+        if ((result=init_pthread_lock(&sharding->lock)) != 0) {
+            return result;
+        }
+
+        sharding->buckets = (FCFSAPILazytimeEntry **)fc_malloc(bytes);
+        if (sharding->buckets == NULL) {
+            return ENOMEM;
+        }
+        memset(sharding->buckets, 0, bytes);
+        FC_INIT_LIST_HEAD(&sharding->fifo);
+
+        if ((result=fast_mblock_init_ex1(&sharding->allocator,
+                        "lazytime_entry", sizeof(FCFSAPILazytimeEntry),
+                        1024, 0, NULL, NULL, false)) != 0)
+        {
+            return result;
+        }
+    }
+
+    return init_pthread_lock_cond_pair(&g_lazytime_ctx.lcp);
+}
+
+/* the dirty mtimes are reported by the parent process, drop them
+ * and free the memory because lazytime_init is called again by the
+ * rebuild of the child
+ */
+void lazytime_fork_child()
+{
+    FCFSAPILazytimeSharding *sharding;
+    FCFSAPILazytimeSharding *end;
+
+    end = g_lazytime_ctx.shardings + FCFS_API_LAZYTIME_SHARDING_COUNT;
+    for (sharding=g_lazytime_ctx.shardings; sharding<end; sharding++) {
+        init_pthread_lock(&sharding->lock);
+        free(sharding->buckets);
+        sharding->buckets = NULL;
+        sharding->count = 0;
+        FC_INIT_LIST_HEAD(&sharding->fifo);
+        fast_mblock_destroy(&sharding->allocator);
+    }
+    FC_ATOMIC_SET(g_lazytime_ctx.dirty_count, 0);
+}
+
+int lazytime_start()
+{
+    pthread_t tid;
+
+    return fc_create_thread(&tid, lazytime_thread_func,
+            NULL, SF_G_THREAD_STACK_SIZE);
+}
+
+void lazytime_terminate()
+{
+    int count;
+
+    if (!g_lazytime_ctx.fcfs_api_ctx->lazytime.enabled) {
+        return;
+    }
+
+    count = flush_expired(INT32_MAX);
+    logInfo("file: "__FILE__", line: %d, "
+            "lazytime_terminate, flush count: %d",
+            __LINE__, count);
+}
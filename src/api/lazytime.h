@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FCFS_API_LAZYTIME_H
+#define _FCFS_API_LAZYTIME_H
+
+#include "fastcommon/fc_list.h"
+#include "fastcommon/fc_atomic.h"
+#include "fastcommon/pthread_func.h"
+#include "fcfs_api_types.h"
+
+#define FCFS_API_LAZYTIME_SHARDING_COUNT  17
+
+typedef struct fcfs_api_lazytime_entry {
+    uint64_t inode;
+    int dirty_time;   //the first dirty time for flush interval
+    int mtime;        //the last write time to report
+    struct fcfs_api_lazytime_entry *next;  //for hashtable chain
+    struct fc_list_head dlink;  //for flush order
+} FCFSAPILazytimeEntry;
+
+typedef struct fcfs_api_lazytime_sharding {
+    pthread_mutex_t lock;
+    int count;
+    FCFSAPILazytimeEntry **buckets;
+    struct fc_list_head fifo;  //element: FCFSAPILazytimeEntry
+    struct fast_mblock_man allocator; //element: FCFSAPILazytimeEntry
+} FCFSAPILazytimeSharding;
+
+typedef struct {
+    FCFSAPIContext *fcfs_api_ctx;
+    int capacity;   //bucket count per sharding
+    int max_count;  //max dirty inodes per sharding
+    volatile int dirty_count;
+    FCFSAPILazytimeSharding shardings[FCFS_API_LAZYTIME_SHARDING_COUNT];
+    pthread_lock_cond_pair_t lcp;  //for timed wait
+} LazytimeContext;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    extern LazytimeContext g_lazytime_ctx;
+
+    int lazytime_init(FCFSAPIContext *fcfs_api_ctx);
+
+    int lazytime_start();
+
+    void lazytime_terminate();
+
+    /* drop the dirty entries inherited from the parent process */
+    void lazytime_fork_child();
+
+    /* keep the mtime change of the inode in memory */
+    int lazytime_mark_dirty(const uint64_t inode);
+
+    /* report the mtime change of the inode if dirty */
+    int lazytime_do_flush(const uint64_t inode);
+
+    /* the mtime is reported by the size report with a newer time */
+    void lazytime_do_discard(const uint64_t inode);
+
+    static inline int lazytime_flush(FCFSAPIContext *ctx,
+            const uint64_t inode)
+    {
+        if (!ctx->lazytime.enabled || FC_ATOMIC_GET(
+                    g_lazytime_ctx.dirty_count) == 0)
+        {
+            return 0;
+        }
+
+        return lazytime_do_flush(inode);
+    }
+
+    static inline void lazytime_discard(FCFSAPIContext *ctx,
+            const uint64_t inode)
+    {
+        if (ctx->lazytime.enabled && FC_ATOMIC_GET(
+                    g_lazytime_ctx.dirty_count) > 0)
+        {
+            lazytime_do_discard(inode);
+        }
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
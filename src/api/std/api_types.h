@@ -17,6 +17,7 @@
 #ifndef _FCFS_POSIX_API_TYPES_H
 #define _FCFS_POSIX_API_TYPES_H
 
+#include <dirent.h>
 #include "fastcommon/fc_list.h"
 #include "fastcommon/pthread_func.h"
 #include "../fcfs_api.h"
@@ -27,14 +28,61 @@ typedef off_t off64_t;
 
 #define FCFS_POSIX_API_FD_BASE  (2 << 28)
 
-struct dirent;
+/* the fd encodes the index of its owning context in the high bits:
+ * FCFS_POSIX_API_FD_BASE + (context index << 24) + sequence
+ */
+#define FCFS_POSIX_API_FD_CTX_SHIFT    24
+#define FCFS_POSIX_API_FD_SEQ_MASK     ((1 << FCFS_POSIX_API_FD_CTX_SHIFT) - 1)
+#define FCFS_POSIX_API_MAX_CONTEXTS    16
+
+#define FCFS_POSIX_DIR_CACHE_SLOTS     8
+
 typedef int (*fcfs_dir_filter_func)(const struct dirent *ent);
 typedef int (*fcfs_dir_compare_func)(const struct dirent **ent1,
         const struct dirent **ent2);
 
+typedef struct fcfs_posix_api_clients {
+    FDIRClientContext fdir;
+    FSClientContext fs;
+    FSAPIContext fsapi;
+} FCFSPosixAPIClients;
+
+/* the entries of a directory with their attributes from one listing,
+ * shared by the readers of the directory and the attribute cache
+ */
+typedef struct fcfs_posix_dir_listing {
+    FDIRClientDentryArray array;
+    int64_t inode;       //the inode of the directory
+    string_t path;       //the directory path ends with '/'
+    int64_t expires;     //in milliseconds, for the attribute cache
+    struct {
+        int count;
+        int *buckets;    //the entry index, -1 for empty
+        int *nexts;
+    } htable;            //the names of the entries
+    volatile int reffer_count;
+} FCFSPosixDirListing;
+
+/* the stat of the entries are served from the recent listings for the
+ * ls -l alike applications, the attributes may be stale in timeout
+ */
+typedef struct fcfs_posix_dir_cache {
+    int timeout_ms;      //0 for disabled
+    volatile int count;
+    pthread_mutex_t lock;
+    FCFSPosixDirListing *slots[FCFS_POSIX_DIR_CACHE_SLOTS];
+} FCFSPosixDirCache;
+
 typedef struct fcfs_posix_api_context {
     FCFSAPINSMountpointHolder nsmp;
     string_t mountpoint;
+    int index;  //the context index encoded in the fds
+    FCFSPosixAPIClients *clients;  //NULL for the global client contexts
+    FCFSPosixDirCache dir_cache;
+    struct {
+        int size;   //0 for disabled
+        int flush_interval_ms;
+    } append_buffer;  //the write buffer of the O_APPEND files
     FCFSAPIContext api_ctx;
 } FCFSPosixAPIContext;
 
@@ -43,13 +91,33 @@ typedef enum {
     fcfs_papi_tpid_type_pid
 } FCFSPosixAPITPIDType;
 
+struct fcfs_posix_write_buffer;
+
 typedef struct fcfs_posix_api_file_info {
     string_t filename;
     int fd;
     FCFSPosixAPITPIDType tpid_type;  //use pid or tid
+    FCFSPosixDirListing *listing;    //for getdents64
+    struct fcfs_posix_write_buffer *wbuffer;  //NULL for write through
     FCFSAPIFileInfo fi;
 } FCFSPosixAPIFileInfo;
 
+/* the small writes of the fd are gathered and written by one RPC when
+ * the buffer is full, the data is too old, or before the other file
+ * operations of the fd
+ */
+typedef struct fcfs_posix_write_buffer {
+    pthread_mutex_t lock;
+    char *buff;
+    int size;
+    int length;            //the buffered bytes
+    int error_no;          //of the background flush, reported later
+    int flush_interval_ms;
+    int64_t first_time_ms; //when the first byte buffered
+    FCFSPosixAPIFileInfo *file;
+    struct fc_list_head dlink;  //for the buffered files chain
+} FCFSPosixWriteBuffer;
+
 typedef struct fcfs_posix_file_ptr_array {
     volatile FCFSPosixAPIFileInfo **files;
     volatile int count;
@@ -57,7 +125,8 @@ typedef struct fcfs_posix_file_ptr_array {
 
 typedef struct fcfs_posix_api_dir {
     FCFSPosixAPIFileInfo *file;
-    FDIRClientCompactDentryArray darray;
+    FCFSPosixDirListing *listing;
+    struct dirent dirent;  //the entry returned by readdir
     int magic;
     int offset;
 } FCFSPosixAPIDIR;
@@ -74,9 +143,16 @@ typedef struct fcfs_posix_capi_file {
 typedef struct fcfs_posix_api_global_vars {
     FCFSPosixAPIContext ctx;
     string_t *cwd;
+    struct {
+        FCFSPosixAPIContext *entries[FCFS_POSIX_API_MAX_CONTEXTS];
+        volatile int count;
+    } contexts;  //the first is the global context
 } FCFSPosixAPIGlobalVars;
 
 #define FCFS_PAPI_IS_MY_FD(fd) \
     (fd > FCFS_POSIX_API_FD_BASE)
 
+#define FCFS_PAPI_FD_CTX_INDEX(fd) \
+    (((fd) - FCFS_POSIX_API_FD_BASE) >> FCFS_POSIX_API_FD_CTX_SHIFT)
+
 #endif
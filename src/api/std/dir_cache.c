@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <sys/stat.h>
+#include "fastcommon/shared_func.h"
+#include "fastcommon/hash.h"
+#include "fastcommon/logger.h"
+#include "dir_cache.h"
+
+#define DIR_NAME_HASH_CODE(name) \
+    ((unsigned int)simple_hash((name)->str, (name)->len))
+
+int fcfs_dir_cache_init(FCFSPosixDirCache *cache)
+{
+    return init_pthread_lock(&cache->lock);
+}
+
+void fcfs_dir_cache_destroy(FCFSPosixDirCache *cache)
+{
+    fcfs_dir_cache_clear(cache);
+    pthread_mutex_destroy(&cache->lock);
+}
+
+static int build_htable(FCFSPosixDirListing *listing)
+{
+    FDIRClientDentry *cd;
+    int *bucket;
+    int bytes;
+    int index;
+
+    listing->htable.count = (listing->array.count > 0 ?
+            listing->array.count : 1);
+    bytes = sizeof(int) * (listing->htable.count + listing->array.count);
+    if ((listing->htable.buckets=fc_malloc(bytes)) == NULL) {
+        return ENOMEM;
+    }
+    listing->htable.nexts = listing->htable.buckets + listing->htable.count;
+    memset(listing->htable.buckets, -1, sizeof(int) *
+            listing->htable.count);
+
+    for (index=0; index<listing->array.count; index++) {
+        cd = listing->array.entries + index;
+        bucket = listing->htable.buckets + DIR_NAME_HASH_CODE(
+                &cd->name) % listing->htable.count;
+        listing->htable.nexts[index] = *bucket;
+        *bucket = index;
+    }
+
+    return 0;
+}
+
+static FDIRClientDentry *listing_find(FCFSPosixDirListing *listing,
+        const string_t *name)
+{
+    FDIRClientDentry *cd;
+    int index;
+
+    index = listing->htable.buckets[DIR_NAME_HASH_CODE(name) %
+        listing->htable.count];
+    while (index >= 0) {
+        cd = listing->array.entries + index;
+        if (fc_string_equal(&cd->name, name)) {
+            return cd;
+        }
+        index = listing->htable.nexts[index];
+    }
+
+    return NULL;
+}
+
+static void cache_add(FCFSPosixDirCache *cache,
+        FCFSPosixDirListing *listing)
+{
+    FCFSPosixDirListing **slot;
+    FCFSPosixDirListing **end;
+    FCFSPosixDirListing **target;
+    FCFSPosixDirListing *old;
+
+    __sync_add_and_fetch(&listing->reffer_count, 1);
+    target = NULL;
+    PTHREAD_MUTEX_LOCK(&cache->lock);
+    end = cache->slots + FCFS_POSIX_DIR_CACHE_SLOTS;
+    for (slot=cache->slots; slot<end; slot++) {
+        if (*slot == NULL || (*slot)->inode == listing->inode) {
+            target = slot;
+            break;
+        }
+
+        /* replace the oldest one */
+        if (target == NULL || (*slot)->expires < (*target)->expires) {
+            target = slot;
+        }
+    }
+
+    old = *target;
+    *target = listing;
+    if (old == NULL) {
+        cache->count++;
+    }
+    PTHREAD_MUTEX_UNLOCK(&cache->lock);
+
+    if (old != NULL) {
+        fcfs_dir_listing_release(old);
+    }
+}
+
+FCFSPosixDirListing *fcfs_dir_listing_create(FCFSPosixAPIContext *ctx,
+        FCFSPosixAPIFileInfo *file, int *err_no)
+{
+    FDIRClientOperInodePair oino;
+    FCFSPosixDirListing *listing;
+
+    listing = (FCFSPosixDirListing *)fc_malloc(sizeof(
+                FCFSPosixDirListing) + file->filename.len + 2);
+    if (listing == NULL) {
+        *err_no = ENOMEM;
+        return NULL;
+    }
+    memset(listing, 0, sizeof(FCFSPosixDirListing));
+    if ((*err_no=fdir_client_dentry_array_init(&listing->array)) != 0) {
+        free(listing);
+        return NULL;
+    }
+
+    FCFSAPI_SET_OPER_INODE_PAIR(oino, file->fi.ctx->
+            owner.oper, file->fi.dentry.inode);
+    if ((*err_no=fcfs_api_list_dentry_by_inode_ex(&ctx->api_ctx,
+                    &oino, &listing->array)) != 0)
+    {
+        fdir_client_dentry_array_free(&listing->array);
+        free(listing);
+        return NULL;
+    }
+
+    listing->inode = file->fi.dentry.inode;
+    /* end with the slash as the dir part of the paths to stat */
+    listing->path.str = (char *)(listing + 1);
+    listing->path.len = file->filename.len;
+    memcpy(listing->path.str, file->filename.str, file->filename.len);
+    if (listing->path.len == 0 || listing->path.str[
+            listing->path.len - 1] != '/')
+    {
+        listing->path.str[listing->path.len++] = '/';
+    }
+    listing->path.str[listing->path.len] = '\0';
+    listing->reffer_count = 1;
+
+    /* the index is built before shared, the cache is best effort */
+    if (ctx->dir_cache.timeout_ms > 0 && build_htable(listing) == 0) {
+        listing->expires = get_current_time_ms() +
+            ctx->dir_cache.timeout_ms;
+        cache_add(&ctx->dir_cache, listing);
+    }
+
+    return listing;
+}
+
+static inline bool fill_stat(FCFSPosixDirListing *listing,
+        const string_t *name, const bool follow, struct stat *buf)
+{
+    FDIRClientDentry *cd;
+
+    if (listing->expires < get_current_time_ms()) {
+        return false;
+    }
+
+    if ((cd=listing_find(listing, name)) == NULL) {
+        return false;
+    }
+
+    if (follow && S_ISLNK(cd->dentry.stat.mode)) {
+        return false;
+    }
+
+    memset(buf, 0, sizeof(struct stat));
+    fcfs_api_fill_stat(&cd->dentry, buf);
+    return true;
+}
+
+bool fcfs_dir_cache_stat_by_pname(FCFSPosixDirCache *cache,
+        const int64_t parent_inode, const string_t *name,
+        const bool follow, struct stat *buf)
+{
+    FCFSPosixDirListing **slot;
+    FCFSPosixDirListing **end;
+    bool found;
+
+    if (FC_ATOMIC_GET(cache->count) == 0) {
+        return false;
+    }
+
+    found = false;
+    PTHREAD_MUTEX_LOCK(&cache->lock);
+    end = cache->slots + FCFS_POSIX_DIR_CACHE_SLOTS;
+    for (slot=cache->slots; slot<end; slot++) {
+        if (*slot != NULL && (*slot)->inode == parent_inode) {
+            found = fill_stat(*slot, name, follow, buf);
+            break;
+        }
+    }
+    PTHREAD_MUTEX_UNLOCK(&cache->lock);
+
+    return found;
+}
+
+bool fcfs_dir_cache_stat_by_path(FCFSPosixDirCache *cache,
+        const char *path, const bool follow, struct stat *buf)
+{
+    FCFSPosixDirListing **slot;
+    FCFSPosixDirListing **end;
+    const char *last;
+    string_t name;
+    int dir_len;
+    bool found;
+
+    if (FC_ATOMIC_GET(cache->count) == 0) {
+        return false;
+    }
+
+    if ((last=strrchr(path, '/')) == NULL) {
+        return false;
+    }
+
+    /* the path is not normalized, the dot names are missed */
+    dir_len = (last - path) + 1;
+    FC_SET_STRING(name, (char *)(last + 1));
+    if (name.len == 0 || (*name.str == '.' && (name.len == 1 ||
+                    (name.len == 2 && *(name.str + 1) == '.'))))
+    {
+        return false;
+    }
+
+    found = false;
+    PTHREAD_MUTEX_LOCK(&cache->lock);
+    end = cache->slots + FCFS_POSIX_DIR_CACHE_SLOTS;
+    for (slot=cache->slots; slot<end; slot++) {
+        if (*slot != NULL && (*slot)->path.len == dir_len &&
+                memcmp((*slot)->path.str, path, dir_len) == 0)
+        {
+            found = fill_stat(*slot, &name, follow, buf);
+            break;
+        }
+    }
+    PTHREAD_MUTEX_UNLOCK(&cache->lock);
+
+    return found;
+}
+
+void fcfs_dir_cache_clear(FCFSPosixDirCache *cache)
+{
+    FCFSPosixDirListing *listings[FCFS_POSIX_DIR_CACHE_SLOTS];
+    FCFSPosixDirListing **slot;
+    FCFSPosixDirListing **end;
+    int count;
+    int i;
+
+    count = 0;
+    PTHREAD_MUTEX_LOCK(&cache->lock);
+    end = cache->slots + FCFS_POSIX_DIR_CACHE_SLOTS;
+    for (slot=cache->slots; slot<end; slot++) {
+        if (*slot != NULL) {
+            listings[count++] = *slot;
+            *slot = NULL;
+        }
+    }
+    cache->count = 0;
+    PTHREAD_MUTEX_UNLOCK(&cache->lock);
+
+    for (i=0; i<count; i++) {
+        fcfs_dir_listing_release(listings[i]);
+    }
+}
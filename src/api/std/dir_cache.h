@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _FCFS_DIR_CACHE_H
+#define _FCFS_DIR_CACHE_H
+
+#include "fastcommon/fc_atomic.h"
+#include "api_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    int fcfs_dir_cache_init(FCFSPosixDirCache *cache);
+
+    void fcfs_dir_cache_destroy(FCFSPosixDirCache *cache);
+
+    /* list the directory with the attributes of its entries by one RPC
+     * and put the listing into the attribute cache when enabled,
+     * the listing is referred once for the caller
+     */
+    FCFSPosixDirListing *fcfs_dir_listing_create(FCFSPosixAPIContext *ctx,
+            FCFSPosixAPIFileInfo *file, int *err_no);
+
+    static inline void fcfs_dir_listing_release(FCFSPosixDirListing *listing)
+    {
+        if (__sync_sub_and_fetch(&listing->reffer_count, 1) == 0) {
+            fdir_client_dentry_array_free(&listing->array);
+            if (listing->htable.buckets != NULL) {
+                free(listing->htable.buckets);
+            }
+            free(listing);
+        }
+    }
+
+    /* get the attributes of the entry from the cache
+     * parameters:
+     *   cache: the attribute cache
+     *   parent_inode: the inode of the parent directory
+     *   name: the name of the entry
+     *   follow: if follow the symlink, the symlinks are not served
+     *   buf: store the attributes
+     * return true for cache hit
+     */
+    bool fcfs_dir_cache_stat_by_pname(FCFSPosixDirCache *cache,
+            const int64_t parent_inode, const string_t *name,
+            const bool follow, struct stat *buf);
+
+    /* the path is relative to the mountpoint */
+    bool fcfs_dir_cache_stat_by_path(FCFSPosixDirCache *cache,
+            const char *path, const bool follow, struct stat *buf);
+
+    void fcfs_dir_cache_clear(FCFSPosixDirCache *cache);
+
+    /* called by the local modifications which make the cached
+     * attributes stale
+     */
+    static inline void fcfs_dir_cache_expire(FCFSPosixDirCache *cache)
+    {
+        if (FC_ATOMIC_GET(cache->count) > 0) {
+            fcfs_dir_cache_clear(cache);
+        }
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -16,6 +16,7 @@
 #include "fastcommon/fast_mblock.h"
 #include "fastcommon/shared_func.h"
 #include "fastcommon/logger.h"
+#include "dir_cache.h"
 #include "fd_manager.h"
 
 #define FILE_INFO_ALLOC_ONCE  1024
@@ -85,6 +86,13 @@ static int finfo_init_func(FCFSPosixAPIFileInfo *finfo, void *args)
 
     finfo->fd = __sync_add_and_fetch(&PAPI_NEXT_FD, 1);
     elt_count = finfo->fd - FCFS_POSIX_API_FD_BASE;
+    if (elt_count > FCFS_POSIX_API_FD_SEQ_MASK) {
+        logError("file: "__FILE__", line: %d, "
+                "too many files, exceeds %d", __LINE__,
+                FCFS_POSIX_API_FD_SEQ_MASK);
+        return EMFILE;
+    }
+
     if (elt_count <= FILE_PARRAY.count) {
         return 0;
     } else {
@@ -116,7 +124,36 @@ void fcfs_fd_manager_destroy()
     FILE_PARRAY.count = 0;
 }
 
-#define FCFS_FD_TO_INDEX(fd) ((fd - FCFS_POSIX_API_FD_BASE) - 1)
+void fcfs_fd_manager_fork_prepare()
+{
+    PTHREAD_MUTEX_LOCK(&FINFO_ALLOCATOR.lcp.lock);
+}
+
+void fcfs_fd_manager_fork_parent()
+{
+    PTHREAD_MUTEX_UNLOCK(&FINFO_ALLOCATOR.lcp.lock);
+}
+
+void fcfs_fd_manager_fork_child()
+{
+    FCFSPosixAPIFileInfo *finfo;
+    int i;
+
+    PTHREAD_MUTEX_UNLOCK(&FINFO_ALLOCATOR.lcp.lock);
+    PARRAY_IN_REALLOC = 0;
+    for (i=0; i<FILE_PARRAY.count; i++) {
+        if ((finfo=(FCFSPosixAPIFileInfo *)FILE_PARRAY.files[i]) != NULL) {
+            fcfs_api_fork_child_file(&finfo->fi);
+        }
+    }
+}
+
+#define FCFS_FD_TO_INDEX(fd) \
+    (((fd - FCFS_POSIX_API_FD_BASE) & FCFS_POSIX_API_FD_SEQ_MASK) - 1)
+
+#define FCFS_FD_SET_CTX_INDEX(fd, ctx_index) \
+    (FCFS_POSIX_API_FD_BASE + ((ctx_index) << FCFS_POSIX_API_FD_CTX_SHIFT) \
+     + ((fd - FCFS_POSIX_API_FD_BASE) & FCFS_POSIX_API_FD_SEQ_MASK))
 
 static inline int set_file_info(const int index,
         FCFSPosixAPIFileInfo *old_finfo,
@@ -136,7 +173,8 @@ static inline int set_file_info(const int index,
     return 0;
 }
 
-FCFSPosixAPIFileInfo *fcfs_fd_manager_alloc(const char *filename)
+FCFSPosixAPIFileInfo *fcfs_fd_manager_alloc(const int ctx_index,
+        const char *filename)
 {
     FCFSPosixAPIFileInfo *finfo;
 
@@ -144,6 +182,10 @@ FCFSPosixAPIFileInfo *fcfs_fd_manager_alloc(const char *filename)
         return finfo;
     }
 
+    /* the slot of the fd table is kept, the owning context changes */
+    finfo->fd = FCFS_FD_SET_CTX_INDEX(finfo->fd, ctx_index);
+    finfo->listing = NULL;
+    finfo->wbuffer = NULL;
     finfo->filename.len = strlen(filename);
     finfo->filename.str = (char *)fc_malloc(finfo->filename.len + 2);
     if (finfo->filename.str == NULL) {
@@ -174,7 +216,14 @@ FCFSPosixAPIFileInfo *fcfs_fd_manager_get(const int fd)
     if (index >= 0 && index < FC_ATOMIC_GET(FILE_PARRAY.count)) {
         finfo = (FCFSPosixAPIFileInfo *)FC_ATOMIC_GET(
                 FILE_PARRAY.files[index]);
-        result = finfo != NULL ? 0 : ENOENT;
+        if (finfo == NULL) {
+            result = ENOENT;
+        } else if (finfo->fd != fd) {  //the slot reused by another context
+            finfo = NULL;
+            result = EBADF;
+        } else {
+            result = 0;
+        }
     } else {
         finfo = NULL;
         result = EOVERFLOW;
@@ -205,6 +254,11 @@ int fcfs_fd_manager_free(FCFSPosixAPIFileInfo *finfo)
     }
 
     if (result == 0) {
+        if (finfo->listing != NULL) {
+            fcfs_dir_listing_release(finfo->listing);
+            finfo->listing = NULL;
+        }
+        finfo->wbuffer = NULL;
         free(finfo->filename.str);
         FC_SET_STRING_NULL(finfo->filename);
         fast_mblock_free_object(&FINFO_ALLOCATOR, finfo);
@@ -27,7 +27,20 @@ extern "C" {
 
     void fcfs_fd_manager_destroy();
 
-    FCFSPosixAPIFileInfo *fcfs_fd_manager_alloc(const char *filename);
+    /* the allocator lock is held across fork */
+    void fcfs_fd_manager_fork_prepare();
+
+    void fcfs_fd_manager_fork_parent();
+
+    /* the fds survive across fork, reset the state of a realloc
+     * which in progress by another thread of the parent process,
+     * and drop the flock sessions and the append leases of the files
+     */
+    void fcfs_fd_manager_fork_child();
+
+    /* the fd of the returned object encodes the context index */
+    FCFSPosixAPIFileInfo *fcfs_fd_manager_alloc(const int ctx_index,
+            const char *filename);
 
     FCFSPosixAPIFileInfo *fcfs_fd_manager_get(const int fd);
 
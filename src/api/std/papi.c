@@ -14,15 +14,38 @@
  */
 
 #include <stdarg.h>
+#include <stddef.h>
 #include <sys/uio.h>
 #include <sys/stat.h>
 #include "fastcommon/shared_func.h"
 #include "fastcommon/logger.h"
 #include "posix_api.h"
+#include "dir_cache.h"
+#include "write_buffer.h"
 #include "papi.h"
 
 #define FCFS_PAPI_MAGIC_NUMBER    1644551636
 
+#ifndef IFTODT
+#define IFTODT(mode)  (((mode) & 0170000) >> 12)
+#endif
+
+/* the local modifications expire the attribute cache of the context */
+#define PAPI_DIR_CACHE_EXPIRE(ctx) \
+    fcfs_dir_cache_expire(&(ctx)->dir_cache)
+
+#define PAPI_FD_DIR_CACHE_EXPIRE(fd) \
+    fcfs_dir_cache_expire(&fcfs_posix_api_get_fd_context(fd)->dir_cache)
+
+/* the record of getdents64 as struct linux_dirent64 */
+typedef struct fcfs_papi_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[0];
+} FCFSPAPIDirent64;
+
 static FCFSPosixAPIFileInfo *do_open_ex(FCFSPosixAPIContext *ctx,
         const char *path, const int flags, const int mode,
         const FCFSPosixAPITPIDType tpid_type)
@@ -31,7 +54,7 @@ static FCFSPosixAPIFileInfo *do_open_ex(FCFSPosixAPIContext *ctx,
     FCFSAPIFileContext fctx;
     int result;
 
-    if ((file=fcfs_fd_manager_alloc(path)) == NULL) {
+    if ((file=fcfs_fd_manager_alloc(ctx->index, path)) == NULL) {
         errno = ENOMEM;
         return NULL;
     }
@@ -45,8 +68,17 @@ static FCFSPosixAPIFileInfo *do_open_ex(FCFSPosixAPIContext *ctx,
         return NULL;
     }
 
+    if ((flags & (O_CREAT | O_TRUNC)) != 0) {
+        PAPI_DIR_CACHE_EXPIRE(ctx);
+    }
+
     if (S_ISDIR(file->fi.dentry.stat.mode)) {
         fcfs_fd_manager_normalize_path(file);
+    } else if ((flags & O_APPEND) != 0 && (flags & O_ACCMODE) !=
+            O_RDONLY && ctx->append_buffer.size > 0)
+    {
+        /* write through when fail */
+        fcfs_write_buffer_create(ctx, file);
     }
 
     return file;
@@ -168,6 +200,38 @@ static int papi_resolve_pathat(FCFSPosixAPIContext *ctx, const char *func,
     return 0;
 }
 
+/* resolve the single component name relative to the directory fd
+ * for the pname based operations which skip the path walk from the
+ * namespace root, return false for the full path resolution
+ */
+static bool papi_resolve_pnameat(int fd, const char *path,
+        int64_t *parent_inode, string_t *name)
+{
+    FCFSPosixAPIFileInfo *file;
+
+    if (fd == AT_FDCWD || *path == '\0' || *path == '/' ||
+            strchr(path, '/') != NULL)
+    {
+        return false;
+    }
+
+    if (*path == '.' && (*(path + 1) == '\0' ||
+                (*(path + 1) == '.' && *(path + 2) == '\0')))
+    {
+        return false;
+    }
+
+    if ((file=fcfs_fd_manager_get(fd)) == NULL ||
+            !S_ISDIR(file->fi.dentry.stat.mode))
+    {
+        return false;
+    }
+
+    *parent_inode = file->fi.dentry.inode;
+    FC_SET_STRING(*name, (char *)path);
+    return true;
+}
+
 int fcfs_open_ex(FCFSPosixAPIContext *ctx, const char *path, int flags, ...)
 {
     char full_fname[PATH_MAX];
@@ -235,26 +299,44 @@ int fcfs_creat_ex(FCFSPosixAPIContext *ctx, const char *path, mode_t mode)
 int fcfs_close(int fd)
 {
     FCFSPosixAPIFileInfo *file;
+    int result;
 
     if ((file=fcfs_fd_manager_get(fd)) == NULL) {
         errno = EBADF;
         return -1;
     }
 
+    /* the fd is closed even if the flush fails */
+    result = (file->wbuffer != NULL ? fcfs_write_buffer_destroy(file) : 0);
+    if ((file->fi.flags & O_ACCMODE) != O_RDONLY) {
+        PAPI_FD_DIR_CACHE_EXPIRE(fd);
+    }
     fcfs_api_close(&file->fi);
     fcfs_fd_manager_free(file);
+    if (result != 0) {
+        errno = result;
+        return -1;
+    }
     return 0;
 }
 
 int fcfs_fsync(int fd)
 {
     FCFSPosixAPIFileInfo *file;
+    int result;
 
     if ((file=fcfs_fd_manager_get(fd)) == NULL) {
         errno = EBADF;
         return -1;
     }
 
+    if (file->wbuffer != NULL && (result=
+                fcfs_write_buffer_flush(file)) != 0)
+    {
+        errno = result;
+        return -1;
+    }
+
     return fcfs_api_fsync(&file->fi,
             fcfs_posix_api_gettid(
                 file->tpid_type));
@@ -263,12 +345,20 @@ int fcfs_fsync(int fd)
 int fcfs_fdatasync(int fd)
 {
     FCFSPosixAPIFileInfo *file;
+    int result;
 
     if ((file=fcfs_fd_manager_get(fd)) == NULL) {
         errno = EBADF;
         return -1;
     }
 
+    if (file->wbuffer != NULL && (result=
+                fcfs_write_buffer_flush(file)) != 0)
+    {
+        errno = result;
+        return -1;
+    }
+
     return fcfs_api_fdatasync(&file->fi,
             fcfs_posix_api_gettid(
                 file->tpid_type));
@@ -280,6 +370,11 @@ static inline ssize_t do_write(FCFSPosixAPIFileInfo *file,
     int result;
     int write_bytes;
 
+    PAPI_FD_DIR_CACHE_EXPIRE(file->fd);
+    if (file->wbuffer != NULL) {
+        return fcfs_write_buffer_write(file, buff, count);
+    }
+
     if ((result=fcfs_api_write_ex(&file->fi, buff, count, &write_bytes,
                     fcfs_posix_api_gettid(file->tpid_type))) != 0)
     {
@@ -341,6 +436,8 @@ ssize_t fcfs_pwrite(int fd, const void *buff, size_t count, off_t offset)
         return -1;
     }
 
+    PAPI_FD_DIR_CACHE_EXPIRE(fd);
+    fcfs_write_buffer_sync(file);
     if ((result=fcfs_api_pwrite_ex(&file->fi, buff, count, offset,
                     &write_bytes, fcfs_posix_api_gettid(
                         file->tpid_type))) != 0)
@@ -363,6 +460,8 @@ ssize_t fcfs_writev(int fd, const struct iovec *iov, int iovcnt)
         return -1;
     }
 
+    PAPI_FD_DIR_CACHE_EXPIRE(fd);
+    fcfs_write_buffer_sync(file);
     if ((result=fcfs_api_writev_ex(&file->fi, iov, iovcnt, &write_bytes,
                     fcfs_posix_api_gettid(file->tpid_type))) != 0)
     {
@@ -385,6 +484,8 @@ ssize_t fcfs_pwritev(int fd, const struct iovec *iov,
         return -1;
     }
 
+    PAPI_FD_DIR_CACHE_EXPIRE(fd);
+    fcfs_write_buffer_sync(file);
     if ((result=fcfs_api_pwritev_ex(&file->fi, iov, iovcnt, offset,
                     &write_bytes, fcfs_posix_api_gettid(
                         file->tpid_type))) != 0)
@@ -402,6 +503,7 @@ static inline ssize_t do_read(FCFSPosixAPIFileInfo *file,
     int result;
     int read_bytes;
 
+    fcfs_write_buffer_sync(file);
     if ((result=fcfs_api_read_ex(&file->fi, buff, count, &read_bytes,
                     fcfs_posix_api_gettid(file->tpid_type))) != 0)
     {
@@ -636,6 +738,7 @@ ssize_t fcfs_pread(int fd, void *buff, size_t count, off_t offset)
         return -1;
     }
 
+    fcfs_write_buffer_sync(file);
     if ((result=fcfs_api_pread_ex(&file->fi, buff, count, offset,
                     &read_bytes, fcfs_posix_api_gettid(
                         file->tpid_type))) != 0)
@@ -658,6 +761,7 @@ ssize_t fcfs_readv(int fd, const struct iovec *iov, int iovcnt)
         return -1;
     }
 
+    fcfs_write_buffer_sync(file);
     if ((result=fcfs_api_readv_ex(&file->fi, iov, iovcnt, &read_bytes,
                     fcfs_posix_api_gettid(file->tpid_type))) != 0)
     {
@@ -680,6 +784,7 @@ ssize_t fcfs_preadv(int fd, const struct iovec *iov,
         return -1;
     }
 
+    fcfs_write_buffer_sync(file);
     if ((result=fcfs_api_preadv_ex(&file->fi, iov, iovcnt, offset,
                     &read_bytes, fcfs_posix_api_gettid(
                         file->tpid_type))) != 0)
@@ -701,6 +806,7 @@ off_t fcfs_lseek(int fd, off_t offset, int whence)
         return -1;
     }
 
+    fcfs_write_buffer_sync(file);
     if ((result=fcfs_api_lseek(&file->fi, offset, whence)) != 0) {
         errno = result;
         return -1;
@@ -718,6 +824,7 @@ off_t fcfs_ltell(int fd)
         return -1;
     }
 
+    fcfs_write_buffer_sync(file);
     return file->fi.offset;
 }
 
@@ -726,11 +833,13 @@ int fcfs_fallocate(int fd, int mode, off_t offset, off_t length)
     int result;
     FCFSPosixAPIFileInfo *file;
 
+    PAPI_FD_DIR_CACHE_EXPIRE(fd);
     if ((file=fcfs_fd_manager_get(fd)) == NULL) {
         errno = EBADF;
         return -1;
     }
 
+    fcfs_write_buffer_sync(file);
     if ((result=fcfs_api_fallocate_ex(&file->fi, mode, offset, length,
                     fcfs_posix_api_gettid(file->tpid_type))) != 0)
     {
@@ -748,6 +857,7 @@ int fcfs_truncate_ex(FCFSPosixAPIContext *ctx,
     char full_fname[PATH_MAX];
     int result;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_path(ctx, "truncate", &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
@@ -771,11 +881,13 @@ int fcfs_ftruncate(int fd, off_t length)
     int result;
     FCFSPosixAPIFileInfo *file;
 
+    PAPI_FD_DIR_CACHE_EXPIRE(fd);
     if ((file=fcfs_fd_manager_get(fd)) == NULL) {
         errno = EBADF;
         return -1;
     }
 
+    fcfs_write_buffer_sync(file);
     if ((result=fcfs_api_ftruncate_ex(&file->fi, length,
                     fcfs_posix_api_gettid(file->tpid_type))) != 0)
     {
@@ -798,6 +910,10 @@ int fcfs_lstat_ex(FCFSPosixAPIContext *ctx,
         return result;
     }
 
+    if (fcfs_dir_cache_stat_by_path(&ctx->dir_cache, path, false, buf)) {
+        return 0;
+    }
+
     if ((result=fcfs_api_lstat_ex(&ctx->api_ctx, path,
                     &ctx->api_ctx.owner.oper, buf)) != 0)
     {
@@ -821,6 +937,10 @@ int fcfs_stat_ex(FCFSPosixAPIContext *ctx,
         return result;
     }
 
+    if (fcfs_dir_cache_stat_by_path(&ctx->dir_cache, path, true, buf)) {
+        return 0;
+    }
+
     if ((result=fcfs_api_stat_ex(&ctx->api_ctx, path, &ctx->
                     api_ctx.owner.oper, buf, flags)) != 0)
     {
@@ -841,6 +961,7 @@ int fcfs_fstat(int fd, struct stat *buf)
         return -1;
     }
 
+    fcfs_write_buffer_sync(file);
     if ((result=fcfs_api_fstat(&file->fi, buf)) != 0) {
         errno = result;
         return -1;
@@ -853,18 +974,35 @@ int fcfs_fstatat_ex(FCFSPosixAPIContext *ctx, int fd,
         const char *path, struct stat *buf, int flags)
 {
     char full_fname[PATH_MAX];
+    int64_t parent_inode;
+    string_t name;
+    bool follow;
     int result;
 
-    if ((result=papi_resolve_pathat(ctx, "fstatat", fd, &path,
+    follow = ((flags & AT_SYMLINK_NOFOLLOW) == 0);
+    if (papi_resolve_pnameat(fd, path, &parent_inode, &name)) {
+        if (fcfs_dir_cache_stat_by_pname(&ctx->dir_cache,
+                    parent_inode, &name, follow, buf))
+        {
+            return 0;
+        }
+        result = fcfs_api_stat_by_pname_ex(&ctx->api_ctx, parent_inode,
+                &name, &ctx->api_ctx.owner.oper, buf, (follow ?
+                    FDIR_FLAGS_FOLLOW_SYMLINK : 0));
+    } else if ((result=papi_resolve_pathat(ctx, "fstatat", fd, &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
         return result;
+    } else if (fcfs_dir_cache_stat_by_path(&ctx->dir_cache,
+                path, follow, buf))
+    {
+        return 0;
+    } else {
+        result = fcfs_api_stat_ex(&ctx->api_ctx, path, &ctx->api_ctx.
+                owner.oper, buf, (follow ? FDIR_FLAGS_FOLLOW_SYMLINK : 0));
     }
 
-    if ((result=fcfs_api_stat_ex(&ctx->api_ctx, path, &ctx->api_ctx.owner.
-                    oper, buf, ((flags & AT_SYMLINK_NOFOLLOW) != 0 ? 0 :
-                        FDIR_FLAGS_FOLLOW_SYMLINK))) != 0)
-    {
+    if (result != 0) {
         errno = result;
         return -1;
     } else {
@@ -988,6 +1126,10 @@ int fcfs_symlinkat_ex(FCFSPosixAPIContext *ctx, const char *link,
         int fd, const char *path)
 {
     char full_fname[PATH_MAX];
+    int64_t parent_inode;
+    string_t name;
+    string_t target;
+    FDIRDEntryInfo dentry;
     int result;
 
     if (*link == '/') {
@@ -995,15 +1137,21 @@ int fcfs_symlinkat_ex(FCFSPosixAPIContext *ctx, const char *link,
         link += ctx->mountpoint.len;
     }
 
-    if ((result=papi_resolve_pathat(ctx, "symlinkat", fd, &path,
+    if (papi_resolve_pnameat(fd, path, &parent_inode, &name)) {
+        FC_SET_STRING(target, (char *)link);
+        result = fcfs_api_symlink_dentry_by_pname_ex(&ctx->api_ctx,
+                &target, parent_inode, &name, &ctx->api_ctx.owner.oper,
+                ACCESSPERMS, &dentry);
+    } else if ((result=papi_resolve_pathat(ctx, "symlinkat", fd, &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
         return result;
+    } else {
+        result = fcfs_api_symlink_ex(&ctx->api_ctx, link, path,
+                &ctx->api_ctx.owner.oper, ACCESSPERMS);
     }
 
-    if ((result=fcfs_api_symlink_ex(&ctx->api_ctx, link, path,
-                    &ctx->api_ctx.owner.oper, ACCESSPERMS)) != 0)
-    {
+    if (result != 0) {
         errno = result;
         return -1;
     } else {
@@ -1019,6 +1167,7 @@ int fcfs_link_ex(FCFSPosixAPIContext *ctx,
     char full_fname2[PATH_MAX];
     int result;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_path(ctx, "linkat", &path1,
                     full_fname1, sizeof(full_fname1))) != 0)
     {
@@ -1047,6 +1196,7 @@ int fcfs_linkat_ex(FCFSPosixAPIContext *ctx, int fd1,
     char full_fname2[PATH_MAX];
     int result;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_pathat(ctx, "linkat", fd1, &path1,
                     full_fname1, sizeof(full_fname1))) != 0)
     {
@@ -1097,17 +1247,28 @@ ssize_t fcfs_readlinkat_ex(FCFSPosixAPIContext *ctx, int fd,
         const char *path, char *buff, size_t size)
 {
     char full_fname[PATH_MAX];
-    int result;
-
-    if ((result=papi_resolve_pathat(ctx, "readlinkat", fd, &path,
+    FDIRClientOperPnamePair opname;
+    int64_t parent_inode;
+    string_t name;
+    string_t link;
+    int result;
+
+    if (papi_resolve_pnameat(fd, path, &parent_inode, &name)) {
+        FCFSAPI_SET_PATH_OPER_PNAME(opname, ctx->api_ctx.owner.oper,
+                parent_inode, &name);
+        link.str = buff;
+        result = fcfs_api_readlink_by_pname_ex(&ctx->api_ctx,
+                &opname, &link, size);
+    } else if ((result=papi_resolve_pathat(ctx, "readlinkat", fd, &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
         return result;
+    } else {
+        result = fcfs_api_readlink(&ctx->api_ctx, path, &ctx->
+                api_ctx.owner.oper, buff, size);
     }
 
-    if ((result=fcfs_api_readlink(&ctx->api_ctx, path, &ctx->
-                    api_ctx.owner.oper, buff, size)) != 0)
-    {
+    if (result != 0) {
         errno = result;
         return -1;
     } else {
@@ -1141,17 +1302,29 @@ int fcfs_mknodat_ex(FCFSPosixAPIContext *ctx, int fd,
         const char *path, mode_t mode, dev_t dev)
 {
     char full_fname[PATH_MAX];
+    int64_t parent_inode;
+    string_t name;
+    FDIRDEntryInfo dentry;
     int result;
 
-    if ((result=papi_resolve_pathat(ctx, "mknodat", fd, &path,
+    if (papi_resolve_pnameat(fd, path, &parent_inode, &name)) {
+        if (!(S_ISCHR(mode) || S_ISBLK(mode))) {
+            result = EINVAL;
+        } else {
+            result = fcfs_api_create_dentry_by_pname_ex(&ctx->api_ctx,
+                    parent_inode, &name, &ctx->api_ctx.owner.oper,
+                    mode, dev, &dentry);
+        }
+    } else if ((result=papi_resolve_pathat(ctx, "mknodat", fd, &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
         return result;
+    } else {
+        result = fcfs_api_mknod_ex(&ctx->api_ctx, path, &ctx->
+                api_ctx.owner.oper, mode, dev);
     }
 
-    if ((result=fcfs_api_mknod_ex(&ctx->api_ctx, path, &ctx->
-                    api_ctx.owner.oper, mode, dev)) != 0)
-    {
+    if (result != 0) {
         errno = result;
         return -1;
     } else {
@@ -1185,17 +1358,25 @@ int fcfs_mkfifoat_ex(FCFSPosixAPIContext *ctx, int fd,
         const char *path, mode_t mode)
 {
     char full_fname[PATH_MAX];
+    int64_t parent_inode;
+    string_t name;
+    FDIRDEntryInfo dentry;
     int result;
 
-    if ((result=papi_resolve_pathat(ctx, "mkfifoat", fd, &path,
+    if (papi_resolve_pnameat(fd, path, &parent_inode, &name)) {
+        result = fcfs_api_create_dentry_by_pname_ex(&ctx->api_ctx,
+                parent_inode, &name, &ctx->api_ctx.owner.oper,
+                ((mode & (~S_IFMT)) | S_IFIFO), 0, &dentry);
+    } else if ((result=papi_resolve_pathat(ctx, "mkfifoat", fd, &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
         return result;
+    } else {
+        result = fcfs_api_mkfifo_ex(&ctx->api_ctx, path,
+                &ctx->api_ctx.owner.oper, mode);
     }
 
-    if ((result=fcfs_api_mkfifo_ex(&ctx->api_ctx, path,
-                    &ctx->api_ctx.owner.oper, mode)) != 0)
-    {
+    if (result != 0) {
         errno = result;
         return -1;
     } else {
@@ -1230,19 +1411,27 @@ int fcfs_faccessat_ex(FCFSPosixAPIContext *ctx, int fd,
             const char *path, int mode, int flags)
 {
     char full_fname[PATH_MAX];
+    int64_t parent_inode;
+    string_t name;
     int result;
 
-    if ((result=papi_resolve_pathat(ctx, "faccessat", fd, &path,
+    if (papi_resolve_pnameat(fd, path, &parent_inode, &name)) {
+        result = fcfs_api_access_by_pname_ex(&ctx->api_ctx,
+                parent_inode, &name, mode, &ctx->api_ctx.owner.oper,
+                (flags & AT_SYMLINK_NOFOLLOW) ? 0 :
+                FDIR_FLAGS_FOLLOW_SYMLINK);
+    } else if ((result=papi_resolve_pathat(ctx, "faccessat", fd, &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
         return result;
+    } else {
+        result = fcfs_api_access_ex(&ctx->api_ctx, path,
+                mode, &ctx->api_ctx.owner.oper,
+                (flags & AT_SYMLINK_NOFOLLOW) ? 0 :
+                FDIR_FLAGS_FOLLOW_SYMLINK);
     }
 
-    if ((result=fcfs_api_access_ex(&ctx->api_ctx, path,
-                    mode, &ctx->api_ctx.owner.oper,
-                    (flags & AT_SYMLINK_NOFOLLOW) ? 0 :
-                    FDIR_FLAGS_FOLLOW_SYMLINK)) != 0)
-    {
+    if (result != 0) {
         errno = result;
         return -1;
     } else {
@@ -1280,6 +1469,7 @@ int fcfs_utime_ex(FCFSPosixAPIContext *ctx, const char *path,
     int result;
     FDIRClientOperFnamePair fname;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_path(ctx, "utime", &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
@@ -1304,6 +1494,7 @@ int fcfs_utimes_ex(FCFSPosixAPIContext *ctx, const char *path,
     int result;
     FDIRClientOperFnamePair fname;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_path(ctx, "utimes", &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
@@ -1330,6 +1521,7 @@ int fcfs_futimes_ex(FCFSPosixAPIContext *ctx,
     FDIRClientOperInodePair oino;
     int result;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((file=fcfs_fd_manager_get(fd)) == NULL) {
         errno = EBADF;
         return -1;
@@ -1355,6 +1547,7 @@ int fcfs_futimesat_ex(FCFSPosixAPIContext *ctx, int fd,
     int result;
     FDIRClientOperFnamePair fname;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_pathat(ctx, "futimesat", fd, &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
@@ -1381,6 +1574,7 @@ int fcfs_futimens_ex(FCFSPosixAPIContext *ctx, int fd,
     int result;
     FDIRClientOperInodePair oino;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((file=fcfs_fd_manager_get(fd)) == NULL) {
         errno = EBADF;
         return -1;
@@ -1405,6 +1599,7 @@ int fcfs_utimensat_ex(FCFSPosixAPIContext *ctx, int fd,
     int result;
     FDIRClientOperFnamePair fname;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_pathat(ctx, "futimensat", fd, &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
@@ -1430,6 +1625,7 @@ int fcfs_unlink_ex(FCFSPosixAPIContext *ctx, const char *path)
     int result;
     FDIRClientOperFnamePair fname;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_path(ctx, "unlink", &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
@@ -1453,21 +1649,34 @@ int fcfs_unlinkat_ex(FCFSPosixAPIContext *ctx, int fd,
 {
     char full_fname[PATH_MAX];
     int result;
+    int64_t parent_inode;
+    string_t name;
     FDIRClientOperFnamePair fname;
-
-    if ((result=papi_resolve_pathat(ctx, "unlinkat", fd, &path,
+    FDIRClientOperPnamePair opname;
+
+    PAPI_DIR_CACHE_EXPIRE(ctx);
+    if (papi_resolve_pnameat(fd, path, &parent_inode, &name)) {
+        FCFSAPI_SET_PATH_OPER_PNAME(opname, ctx->api_ctx.owner.oper,
+                parent_inode, &name);
+        result = fcfs_api_remove_dentry_by_pname_ex(&ctx->api_ctx,
+                &opname, ((flags & AT_REMOVEDIR) ?
+                    FDIR_UNLINK_FLAGS_MATCH_DIR :
+                    FDIR_UNLINK_FLAGS_MATCH_FILE), fcfs_posix_api_gettid(
+                        fcfs_papi_tpid_type_tid));
+    } else if ((result=papi_resolve_pathat(ctx, "unlinkat", fd, &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
         return result;
+    } else {
+        FCFSAPI_SET_PATH_OPER_FNAME(fname, &ctx->api_ctx,
+                ctx->api_ctx.owner.oper, path);
+        result = fcfs_api_remove_dentry_ex(&ctx->api_ctx, &fname,
+                ((flags & AT_REMOVEDIR) ? FDIR_UNLINK_FLAGS_MATCH_DIR :
+                 FDIR_UNLINK_FLAGS_MATCH_FILE), fcfs_posix_api_gettid(
+                     fcfs_papi_tpid_type_tid));
     }
 
-    FCFSAPI_SET_PATH_OPER_FNAME(fname, &ctx->api_ctx,
-            ctx->api_ctx.owner.oper, path);
-    if ((result=fcfs_api_remove_dentry_ex(&ctx->api_ctx, &fname,
-                    ((flags & AT_REMOVEDIR) ? FDIR_UNLINK_FLAGS_MATCH_DIR :
-                     FDIR_UNLINK_FLAGS_MATCH_FILE), fcfs_posix_api_gettid(
-                         fcfs_papi_tpid_type_tid))) != 0)
-    {
+    if (result != 0) {
         errno = result;
         return -1;
     } else {
@@ -1483,6 +1692,7 @@ int fcfs_rename_ex(FCFSPosixAPIContext *ctx,
     char full_fname1[PATH_MAX];
     char full_fname2[PATH_MAX];
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_path(ctx, "rename", &path1,
                     full_fname1, sizeof(full_fname1))) != 0)
     {
@@ -1513,6 +1723,26 @@ static inline int do_renameat(FCFSPosixAPIContext *ctx,
     int result;
     char full_fname1[PATH_MAX];
     char full_fname2[PATH_MAX];
+    int64_t parent_inode1;
+    int64_t parent_inode2;
+    string_t name1;
+    string_t name2;
+
+    PAPI_DIR_CACHE_EXPIRE(ctx);
+    if (papi_resolve_pnameat(fd1, path1, &parent_inode1, &name1) &&
+            papi_resolve_pnameat(fd2, path2, &parent_inode2, &name2))
+    {
+        if ((result=fcfs_api_rename_dentry_by_pname_ex(&ctx->api_ctx,
+                        parent_inode1, &name1, parent_inode2, &name2,
+                        &ctx->api_ctx.owner.oper, flags,
+                        fcfs_posix_api_gettid(fcfs_papi_tpid_type_tid))) != 0)
+        {
+            errno = result;
+            return -1;
+        } else {
+            return 0;
+        }
+    }
 
     if ((result=papi_resolve_pathat(ctx, func_name, fd1, &path1,
                     full_fname1, sizeof(full_fname1))) != 0)
@@ -1587,17 +1817,25 @@ int fcfs_mkdirat_ex(FCFSPosixAPIContext *ctx, int fd,
         const char *path, mode_t mode)
 {
     char full_fname[PATH_MAX];
+    int64_t parent_inode;
+    string_t name;
+    FDIRDEntryInfo dentry;
     int result;
 
-    if ((result=papi_resolve_pathat(ctx, "mkdirat", fd, &path,
+    if (papi_resolve_pnameat(fd, path, &parent_inode, &name)) {
+        result = fcfs_api_create_dentry_by_pname_ex(&ctx->api_ctx,
+                parent_inode, &name, &ctx->api_ctx.owner.oper,
+                ((mode & (~S_IFMT)) | S_IFDIR), 0, &dentry);
+    } else if ((result=papi_resolve_pathat(ctx, "mkdirat", fd, &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
         return result;
+    } else {
+        result = fcfs_api_mkdir_ex(&ctx->api_ctx, path,
+                &ctx->api_ctx.owner.oper, mode);
     }
 
-    if ((result=fcfs_api_mkdir_ex(&ctx->api_ctx, path,
-                    &ctx->api_ctx.owner.oper, mode)) != 0)
-    {
+    if (result != 0) {
         errno = result;
         return -1;
     } else {
@@ -1612,6 +1850,7 @@ int fcfs_rmdir_ex(FCFSPosixAPIContext *ctx, const char *path)
     char full_fname[PATH_MAX];
     FDIRClientOperFnamePair fname;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_path(ctx, "rmdir", &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
@@ -1638,6 +1877,7 @@ int fcfs_chown_ex(FCFSPosixAPIContext *ctx, const char *path,
     char full_fname[PATH_MAX];
     FDIRClientOperFnamePair fname;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_path(ctx, "chown", &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
@@ -1664,6 +1904,7 @@ int fcfs_lchown_ex(FCFSPosixAPIContext *ctx, const char *path,
     char full_fname[PATH_MAX];
     FDIRClientOperFnamePair fname;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_path(ctx, "lchown", &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
@@ -1689,6 +1930,7 @@ int fcfs_fchown(int fd, uid_t owner, gid_t group)
     FCFSPosixAPIFileInfo *file;
     FDIRClientOperInodePair oino;
 
+    PAPI_FD_DIR_CACHE_EXPIRE(fd);
     if ((file=fcfs_fd_manager_get(fd)) == NULL) {
         errno = EBADF;
         return -1;
@@ -1713,6 +1955,7 @@ int fcfs_fchownat_ex(FCFSPosixAPIContext *ctx, int fd,
     char full_fname[PATH_MAX];
     FDIRClientOperFnamePair fname;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_pathat(ctx, "fchownat", fd, &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
@@ -1740,6 +1983,7 @@ int fcfs_chmod_ex(FCFSPosixAPIContext *ctx,
     char full_fname[PATH_MAX];
     FDIRClientOperFnamePair fname;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_path(ctx, "chmod", &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
@@ -1765,6 +2009,7 @@ int fcfs_fchmod(int fd, mode_t mode)
     FCFSPosixAPIFileInfo *file;
     FDIRClientOperInodePair oino;
 
+    PAPI_FD_DIR_CACHE_EXPIRE(fd);
     if ((file=fcfs_fd_manager_get(fd)) == NULL) {
         errno = EBADF;
         return -1;
@@ -1789,6 +2034,7 @@ int fcfs_fchmodat_ex(FCFSPosixAPIContext *ctx, int fd,
     char full_fname[PATH_MAX];
     FDIRClientOperFnamePair fname;
 
+    PAPI_DIR_CACHE_EXPIRE(ctx);
     if ((result=papi_resolve_pathat(ctx, "fchmodat", fd, &path,
                     full_fname, sizeof(full_fname))) != 0)
     {
@@ -2134,7 +2380,6 @@ int fcfs_fremovexattr(int fd, const char *name)
 static FCFSPosixAPIDIR *do_opendir(FCFSPosixAPIContext *ctx,
         FCFSPosixAPIFileInfo *file)
 {
-    FDIRClientOperInodePair oino;
     FCFSPosixAPIDIR *dir;
     int result;
 
@@ -2144,20 +2389,16 @@ static FCFSPosixAPIDIR *do_opendir(FCFSPosixAPIContext *ctx,
         return NULL;
     }
 
-    FCFSAPI_SET_OPER_INODE_PAIR(oino, file->fi.ctx->
-            owner.oper, file->fi.dentry.inode);
-    dir->file = file;
-    dir->magic = FCFS_PAPI_MAGIC_NUMBER;
-    dir->offset = 0;
-    fdir_client_compact_dentry_array_init(&dir->darray);
-    if ((result=fcfs_api_list_compact_dentry_by_inode_ex(
-                    &ctx->api_ctx, &oino, &dir->darray)) != 0)
-    {
+    /* the attributes of the entries are listed too for the stat after */
+    if ((dir->listing=fcfs_dir_listing_create(ctx, file, &result)) == NULL) {
         free(dir);
         errno = result;
         return NULL;
     }
 
+    dir->file = file;
+    dir->magic = FCFS_PAPI_MAGIC_NUMBER;
+    dir->offset = 0;
     return dir;
 }
 
@@ -2223,7 +2464,7 @@ int fcfs_closedir_ex(FCFSPosixAPIContext *ctx, DIR *dirp)
 {
     FCFS_CONVERT_DIRP(dirp);
 
-    fdir_client_compact_dentry_array_free(&dir->darray);
+    fcfs_dir_listing_release(dir->listing);
     fcfs_api_close(&dir->file->fi);
     fcfs_fd_manager_free(dir->file);
     dir->magic = 0;
@@ -2233,11 +2474,25 @@ int fcfs_closedir_ex(FCFSPosixAPIContext *ctx, DIR *dirp)
 
 static inline struct dirent *do_readdir(FCFSPosixAPIDIR *dir)
 {
-    if (dir->offset < 0 || dir->offset >= dir->darray.count) {
+    FDIRClientDentry *cd;
+    int len;
+
+    if (dir->offset < 0 || dir->offset >= dir->listing->array.count) {
         return NULL;
     }
 
-    return dir->darray.entries + dir->offset++;
+    cd = dir->listing->array.entries + dir->offset++;
+    len = cd->name.len < (int)sizeof(dir->dirent.d_name) ?
+        cd->name.len : (int)sizeof(dir->dirent.d_name) - 1;
+    dir->dirent.d_ino = cd->dentry.inode;
+#ifdef OS_LINUX
+    dir->dirent.d_off = dir->offset;
+#endif
+    dir->dirent.d_reclen = sizeof(struct dirent);
+    dir->dirent.d_type = IFTODT(cd->dentry.stat.mode);
+    memcpy(dir->dirent.d_name, cd->name.str, len);
+    dir->dirent.d_name[len] = '\0';
+    return &dir->dirent;
 }
 
 struct dirent *fcfs_readdir_ex(FCFSPosixAPIContext *ctx, DIR *dirp)
@@ -2253,7 +2508,7 @@ int fcfs_readdir_r_ex(FCFSPosixAPIContext *ctx, DIR *dirp,
     FCFS_CONVERT_DIRP(dirp);
 
     if ((current=do_readdir(dir)) != NULL) {
-        memcpy(entry, current, sizeof(FDIRDirent));
+        memcpy(entry, current, sizeof(struct dirent));
         *result = entry;
     } else {
         *result = NULL;
@@ -2292,23 +2547,95 @@ int fcfs_dirfd_ex(FCFSPosixAPIContext *ctx, DIR *dirp)
     return dir->file->fd;
 }
 
+ssize_t fcfs_getdents64(int fd, void *dirp, size_t count)
+{
+    FCFSPosixAPIFileInfo *file;
+    FCFSPosixDirListing *listing;
+    FDIRClientDentry *cd;
+    FDIRClientDentry *end;
+    FCFSPAPIDirent64 *ent;
+    char *p;
+    int reclen;
+    int result;
+
+    if ((file=fcfs_fd_manager_get(fd)) == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+
+    if (!S_ISDIR(file->fi.dentry.stat.mode)) {
+        errno = ENOTDIR;
+        return -1;
+    }
+
+    /* the offset of the directory is the entry index,
+     * list it again when rewound by lseek
+     */
+    if (file->listing == NULL || file->fi.offset == 0) {
+        if ((listing=fcfs_dir_listing_create(fcfs_posix_api_get_fd_context(
+                            fd), file, &result)) == NULL)
+        {
+            errno = result;
+            return -1;
+        }
+
+        if (file->listing != NULL) {
+            fcfs_dir_listing_release(file->listing);
+        }
+        file->listing = listing;
+    } else {
+        listing = file->listing;
+    }
+
+    if (file->fi.offset < 0 || file->fi.offset >= listing->array.count) {
+        return 0;
+    }
+
+    p = (char *)dirp;
+    end = listing->array.entries + listing->array.count;
+    for (cd=listing->array.entries + file->fi.offset; cd<end; cd++) {
+        reclen = MEM_ALIGN_CEIL(offsetof(FCFSPAPIDirent64, d_name) +
+                cd->name.len + 1, 8);
+        if ((size_t)((p - (char *)dirp) + reclen) > count) {
+            break;
+        }
+
+        ent = (FCFSPAPIDirent64 *)p;
+        ent->d_ino = cd->dentry.inode;
+        ent->d_off = (cd - listing->array.entries) + 1;
+        ent->d_reclen = reclen;
+        ent->d_type = IFTODT(cd->dentry.stat.mode);
+        memcpy(ent->d_name, cd->name.str, cd->name.len);
+        ent->d_name[cd->name.len] = '\0';
+        p += reclen;
+    }
+
+    if (p == (char *)dirp) {  //the buffer is too small
+        errno = EINVAL;
+        return -1;
+    }
+
+    file->fi.offset = cd - listing->array.entries;
+    return p - (char *)dirp;
+}
+
 static int do_scandir(FCFSPosixAPIContext *ctx, const char *path,
         struct dirent ***namelist, int (*filter)(const struct dirent *),
         int (*compar)(const struct dirent **, const struct dirent **))
 {
     FDIRClientOperFnamePair fname;
-    FCFSPosixAPIDIR dir;
+    FDIRClientCompactDentryArray darray;
     FDIRDirent *ent;
     FDIRDirent *end;
     FDIRDirent **cur;
     int result;
     int count;
 
-    fdir_client_compact_dentry_array_init(&dir.darray);
+    fdir_client_compact_dentry_array_init(&darray);
     FCFSAPI_SET_PATH_OPER_FNAME(fname, &ctx->api_ctx,
             ctx->api_ctx.owner.oper, path);
     if ((result=fcfs_api_list_compact_dentry_by_path_ex(&ctx->
-                    api_ctx, &fname, &dir.darray)) != 0)
+                    api_ctx, &fname, &darray)) != 0)
     {
         errno = result;
         return -1;
@@ -2316,7 +2643,7 @@ static int do_scandir(FCFSPosixAPIContext *ctx, const char *path,
 
     do {
         if ((*namelist=fc_malloc(sizeof(FDIRDirent *) *
-                        dir.darray.count)) == NULL)
+                        darray.count)) == NULL)
         {
             errno = ENOMEM;
             count = -1;
@@ -2324,13 +2651,13 @@ static int do_scandir(FCFSPosixAPIContext *ctx, const char *path,
         }
 
         count = 0;
-        if (dir.darray.count == 0) {
+        if (darray.count == 0) {
             break;
         }
 
         cur = (FDIRDirent **)*namelist;
-        end = dir.darray.entries + dir.darray.count;
-        for (ent=dir.darray.entries; ent<end; ent++) {
+        end = darray.entries + darray.count;
+        for (ent=darray.entries; ent<end; ent++) {
             if (filter != NULL && ((int (*)(const FDIRDirent *))
                     filter)(ent) == 0)
             {
@@ -2363,7 +2690,7 @@ static int do_scandir(FCFSPosixAPIContext *ctx, const char *path,
         }
     } while (0);
 
-    fdir_client_compact_dentry_array_free(&dir.darray);
+    fdir_client_compact_dentry_array_free(&darray);
     return count;
 }
 
@@ -2551,6 +2878,7 @@ int fcfs_lockf_ex(FCFSPosixAPIContext *ctx, int fd, int cmd, off_t len)
             return -1;
     }
 
+    fcfs_write_buffer_sync(file);
     lock.l_whence = SEEK_SET;
     lock.l_start = file->fi.offset;
     lock.l_len = len;
@@ -2570,6 +2898,7 @@ int fcfs_posix_fallocate_ex(FCFSPosixAPIContext *ctx,
         return -1;
     }
 
+    fcfs_write_buffer_sync(file);
     if ((result=fcfs_api_fallocate_ex(&file->fi, mode, offset, len,
                     fcfs_posix_api_gettid(file->tpid_type))) != 0)
     {
@@ -2620,12 +2949,7 @@ static int do_vdprintf(FCFSPosixAPIFileInfo *file,
     if (buff != fixed) {
         free(buff);
     }
-    if (result != 0) {
-        errno = result;
-        return -1;
-    } else {
-        return length;
-    }
+    return (result < 0 ? -1 : length);
 }
 
 int fcfs_dprintf(int fd, const char *format, ...)
@@ -467,6 +467,11 @@ extern "C" {
 
     void fcfs_rewinddir_ex(FCFSPosixAPIContext *ctx, DIR *dirp);
 
+    /* fill the buffer with the entries as the syscall getdents64,
+     * the attributes of the entries are kept in the attribute cache
+     */
+    ssize_t fcfs_getdents64(int fd, void *dirp, size_t count);
+
     int fcfs_dirfd_ex(FCFSPosixAPIContext *ctx, DIR *dirp);
 
     int fcfs_scandir_ex(FCFSPosixAPIContext *ctx, const char *path,
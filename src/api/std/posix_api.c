@@ -15,23 +15,36 @@
 
 #include "fastcommon/logger.h"
 #include "sf/idempotency/client/client_channel.h"
+#include "dir_cache.h"
+#include "write_buffer.h"
 #include "posix_api.h"
 
 #define DUMMY_MOUNTPOINT_STR  "/fastcfs/dummy/"
 #define DUMMY_MOUNTPOINT_LEN  (sizeof(DUMMY_MOUNTPOINT_STR) - 1)
 
 FCFSPosixAPIGlobalVars g_fcfs_papi_global_vars = {
-    {{NULL, NULL}, {DUMMY_MOUNTPOINT_STR, DUMMY_MOUNTPOINT_LEN}}
+    {{NULL, NULL}, {DUMMY_MOUNTPOINT_STR, DUMMY_MOUNTPOINT_LEN}},
+    NULL, {{&g_fcfs_papi_global_vars.ctx}, 1}
 };
 
 static int load_posix_api_config(FCFSPosixAPIContext *ctx,
-        const char *ns, IniFullContext *ini_ctx,
+        const char *ns, const char *mountpoint, IniFullContext *ini_ctx,
         const char *fdir_section_name)
 {
     int result;
 
+    if (ctx->mountpoint.str != NULL && ctx->mountpoint.str ==
+            ctx->nsmp.mountpoint)
+    {
+        return 0;  //loaded by fcfs_posix_api_load_mountpoint_ex
+    }
+
     ctx->nsmp.ns = (char *)ns;
-    FC_SET_STRING_NULL(ctx->mountpoint);
+    if (mountpoint != NULL) {
+        FC_SET_STRING(ctx->mountpoint, (char *)mountpoint);
+    } else {
+        FC_SET_STRING_NULL(ctx->mountpoint);
+    }
     if ((result=fcfs_api_load_ns_mountpoint(ini_ctx,
                     fdir_section_name, &ctx->nsmp,
                     &ctx->mountpoint, false)) != 0)
@@ -42,7 +55,34 @@ static int load_posix_api_config(FCFSPosixAPIContext *ctx,
     return 0;
 }
 
-int fcfs_posix_api_init_ex1(FCFSPosixAPIContext *ctx, const char
+int fcfs_posix_api_load_mountpoint_ex(FCFSPosixAPIContext *ctx,
+        const char *ns, const char *mountpoint, IniFullContext *ini_ctx,
+        const char *fdir_section_name)
+{
+    return load_posix_api_config(ctx, ns, mountpoint,
+            ini_ctx, fdir_section_name);
+}
+
+int fcfs_posix_api_register_context(FCFSPosixAPIContext *ctx)
+{
+    int index;
+
+    index = __sync_fetch_and_add(&g_fcfs_papi_global_vars.
+            contexts.count, 1);
+    if (index >= FCFS_POSIX_API_MAX_CONTEXTS) {
+        __sync_sub_and_fetch(&g_fcfs_papi_global_vars.contexts.count, 1);
+        logError("file: "__FILE__", line: %d, "
+                "too many POSIX API contexts, exceeds %d",
+                __LINE__, FCFS_POSIX_API_MAX_CONTEXTS);
+        return ENOSPC;
+    }
+
+    ctx->index = index;
+    g_fcfs_papi_global_vars.contexts.entries[index] = ctx;
+    return 0;
+}
+
+static int init_clients(FCFSPosixAPIContext *ctx, const char
         *log_prefix_name, const char *ns, const char *config_filename,
         const char *fdir_section_name, const char *fs_section_name,
         const bool publish)
@@ -54,6 +94,10 @@ int fcfs_posix_api_init_ex1(FCFSPosixAPIContext *ctx, const char
     IniFullContext ini_ctx;
 
     log_try_init();
+    if ((result=fcfs_dir_cache_init(&ctx->dir_cache)) != 0) {
+        return result;
+    }
+
     if ((result=iniLoadFromFile(config_filename, &iniContext)) != 0) {
         logError("file: "__FILE__", line: %d, "
                 "load conf file \"%s\" fail, ret code: %d",
@@ -64,17 +108,26 @@ int fcfs_posix_api_init_ex1(FCFSPosixAPIContext *ctx, const char
     FAST_INI_SET_FULL_CTX_EX(ini_ctx, config_filename,
             NULL, &iniContext);
     do {
-        if ((result=load_posix_api_config(ctx, ns, &ini_ctx,
+        if ((result=load_posix_api_config(ctx, ns, NULL, &ini_ctx,
                         fdir_section_name)) != 0)
         {
             break;
         }
 
-        if ((result=fcfs_api_pooled_init_ex1(&ctx->api_ctx,
-                        ns, &ini_ctx, fdir_section_name,
-                        fs_section_name, need_lock,
-                        persist_additional_gids)) != 0)
-        {
+        if (ctx->clients != NULL) {
+            ctx->api_ctx.secondary = true;
+            ctx->clients->fsapi.fs = &ctx->clients->fs;
+            result = fcfs_api_init_ex2(&ctx->api_ctx, &ctx->clients->fdir,
+                    &ctx->clients->fsapi, ctx->nsmp.ns, &ini_ctx,
+                    fdir_section_name, fs_section_name,
+                    conn_manager_type_pooled, NULL, need_lock,
+                    persist_additional_gids);
+        } else {
+            result = fcfs_api_pooled_init_ex1(&ctx->api_ctx,
+                    ctx->nsmp.ns, &ini_ctx, fdir_section_name,
+                    fs_section_name, need_lock, persist_additional_gids);
+        }
+        if (result != 0) {
             break;
         }
 
@@ -84,7 +137,8 @@ int fcfs_posix_api_init_ex1(FCFSPosixAPIContext *ctx, const char
             break;
         }
 
-        if ((result=fcfs_api_load_idempotency_config_ex(log_prefix_name,
+        if (ctx->clients == NULL && (result=
+                    fcfs_api_load_idempotency_config_ex(log_prefix_name,
                         &ini_ctx, fdir_section_name, fs_section_name)) != 0)
         {
             break;
@@ -96,14 +150,104 @@ int fcfs_posix_api_init_ex1(FCFSPosixAPIContext *ctx, const char
         return result;
     }
 
-    if ((result=fcfs_api_client_session_create(
-                    &ctx->api_ctx, publish)) != 0)
+    return fcfs_api_client_session_create(&ctx->api_ctx, publish);
+}
+
+int fcfs_posix_api_init_ex1(FCFSPosixAPIContext *ctx, const char
+        *log_prefix_name, const char *ns, const char *config_filename,
+        const char *fdir_section_name, const char *fs_section_name,
+        const bool publish)
+{
+    int result;
+
+    if ((result=init_clients(ctx, log_prefix_name, ns, config_filename,
+                    fdir_section_name, fs_section_name, publish)) != 0)
     {
         return result;
     }
+
+    if ((result=fcfs_write_buffer_init()) != 0) {
+        return result;
+    }
     return fcfs_fd_manager_init();
 }
 
+int fcfs_posix_api_init_secondary_ex(FCFSPosixAPIContext *ctx,
+        const char *log_prefix_name, const char *ns,
+        const char *config_filename, const char *fdir_section_name,
+        const char *fs_section_name, const bool publish)
+{
+    int result;
+
+    if (ctx->index == 0 && (result=
+                fcfs_posix_api_register_context(ctx)) != 0)
+    {
+        return result;
+    }
+
+    if (ctx->clients == NULL) {
+        ctx->clients = fc_malloc(sizeof(FCFSPosixAPIClients));
+        if (ctx->clients == NULL) {
+            return ENOMEM;
+        }
+        memset(ctx->clients, 0, sizeof(FCFSPosixAPIClients));
+    }
+
+    return init_clients(ctx, log_prefix_name, ns, config_filename,
+            fdir_section_name, fs_section_name, publish);
+}
+
+void fcfs_posix_api_fork_prepare_ex(FCFSPosixAPIContext *ctx)
+{
+    fcfs_write_buffer_flush_all();
+    fcfs_api_fork_prepare_ex(&ctx->api_ctx);
+    if (ctx->index == 0) {
+        fcfs_fd_manager_fork_prepare();
+    }
+}
+
+void fcfs_posix_api_fork_parent_ex(FCFSPosixAPIContext *ctx)
+{
+    if (ctx->index == 0) {
+        fcfs_fd_manager_fork_parent();
+    }
+    fcfs_api_fork_parent_ex(&ctx->api_ctx);
+}
+
+void fcfs_posix_api_fork_child_ex(FCFSPosixAPIContext *ctx)
+{
+    /* the lock may be held by another thread of the parent process */
+    fcfs_dir_cache_init(&ctx->dir_cache);
+    if (ctx->index == 0) {  //the write buffers and the fds are global
+        fcfs_write_buffer_fork_child();
+        fcfs_fd_manager_fork_child();
+    }
+    fcfs_api_fork_child_ex(&ctx->api_ctx);
+}
+
+int fcfs_posix_api_rebuild_ex1(FCFSPosixAPIContext *ctx, const char
+        *log_prefix_name, const char *ns, const char *config_filename,
+        const char *fdir_section_name, const char *fs_section_name,
+        const bool publish)
+{
+    int result;
+
+    if (ctx->api_ctx.rdma.enabled) {
+        logError("file: "__FILE__", line: %d, "
+                "the RDMA connections can't be rebuilt after fork",
+                __LINE__);
+        return EOPNOTSUPP;
+    }
+
+    /* the namespace, the mountpoint and the fd table are kept */
+    if ((result=init_clients(ctx, log_prefix_name, ns, config_filename,
+                    fdir_section_name, fs_section_name, publish)) != 0)
+    {
+        return result;
+    }
+    return fcfs_api_start_ex(&ctx->api_ctx);
+}
+
 void fcfs_posix_api_log_configs_ex(FCFSPosixAPIContext *ctx,
         const char *fdir_section_name, const char *fs_section_name)
 {
@@ -136,6 +280,12 @@ void fcfs_posix_api_destroy_ex(FCFSPosixAPIContext *ctx)
     if (ctx->mountpoint.str != NULL) {
         fcfs_api_free_ns_mountpoint(&ctx->nsmp);
         ctx->mountpoint.str = NULL;
+        fcfs_dir_cache_destroy(&ctx->dir_cache);
         fcfs_api_destroy_ex(&ctx->api_ctx);
     }
+
+    if (ctx->clients != NULL) {
+        free(ctx->clients);
+        ctx->clients = NULL;
+    }
 }
@@ -22,6 +22,7 @@
 #include "fastcommon/shared_func.h"
 #include "api_types.h"
 #include "fd_manager.h"
+#include "write_buffer.h"
 #include "papi.h"
 #include "capi.h"
 
@@ -31,6 +32,56 @@ extern "C" {
 
     extern FCFSPosixAPIGlobalVars g_fcfs_papi_global_vars;
 
+    /** load the namespace and the mountpoint only, without the connection
+     *  to the servers, the following init reuses them
+     * parameters:
+     *   ctx: the POSIX API context
+     *   ns: the namespace/poolname of FastDIR, NULL for the item
+     *       namespace of the FastDIR section
+     *   mountpoint: the mountpoint, NULL for the item mountpoint
+     *               of the config file
+     *   ini_ctx: the ini context of the config file, the section name
+     *            should be NULL
+     *   fdir_section_name: the section name of FastDIR
+     * return: error no, 0 for success, != 0 fail
+    */
+    int fcfs_posix_api_load_mountpoint_ex(FCFSPosixAPIContext *ctx,
+            const char *ns, const char *mountpoint, IniFullContext *ini_ctx,
+            const char *fdir_section_name);
+
+    /** load the namespace and the mountpoint to the global context
+     * parameters:
+     *   ns: the namespace/poolname of FastDIR
+     *   ini_ctx: the ini context of the config file, the section name
+     *            should be NULL
+     * return: error no, 0 for success, != 0 fail
+    */
+    static inline int fcfs_posix_api_load_mountpoint(
+            const char *ns, IniFullContext *ini_ctx)
+    {
+        return fcfs_posix_api_load_mountpoint_ex(&g_fcfs_papi_global_vars.
+                ctx, ns, NULL, ini_ctx, FCFS_API_DEFAULT_FASTDIR_SECTION_NAME);
+    }
+
+    /** register the context to dispatch the fds without the path check,
+     *  the index of the context is set and encoded in its fds
+     * parameters:
+     *   ctx: the POSIX API context
+     * return: error no, 0 for success, != 0 fail
+    */
+    int fcfs_posix_api_register_context(FCFSPosixAPIContext *ctx);
+
+    /* get the owning context of the FastCFS fd */
+    static inline FCFSPosixAPIContext *fcfs_posix_api_get_fd_context(
+            const int fd)
+    {
+        FCFSPosixAPIContext *ctx;
+
+        ctx = g_fcfs_papi_global_vars.contexts.entries[
+            FCFS_PAPI_FD_CTX_INDEX(fd) % FCFS_POSIX_API_MAX_CONTEXTS];
+        return (ctx != NULL ? ctx : &g_fcfs_papi_global_vars.ctx);
+    }
+
     /** FastCFS POSIX API init
      * parameters:
      *   ctx: the POSIX API context
@@ -79,6 +130,100 @@ extern "C" {
                 log_prefix_name, ns, config_filename);
     }
 
+    /** FastCFS POSIX API init of the secondary context such as the extra
+     *  mountpoint of another namespace or cluster, it has its own client
+     *  contexts and shares the fd table with the global context,
+     *  it accesses without RPC idempotency
+     * parameters:
+     *   ctx: the POSIX API context, the mountpoint should be loaded
+     *        by fcfs_posix_api_load_mountpoint_ex
+     *   log_prefix_name: the prefix name for log filename, NULL for stderr
+     *   ns: the namespace/poolname of FastDIR
+     *   config_filename: the config filename, eg. /etc/fastcfs/fcfs/fuse.conf
+     *   fdir_section_name: the section name of FastDIR
+     *   fs_section_name: the section name of FastStore
+     *   publish: if publish the session, this parameter is valid when auth enabled
+     * return: error no, 0 for success, != 0 fail
+    */
+    int fcfs_posix_api_init_secondary_ex(FCFSPosixAPIContext *ctx,
+            const char *log_prefix_name, const char *ns,
+            const char *config_filename, const char *fdir_section_name,
+            const char *fs_section_name, const bool publish);
+
+    static inline int fcfs_posix_api_init_secondary(FCFSPosixAPIContext *ctx,
+            const char *log_prefix_name, const char *ns,
+            const char *config_filename)
+    {
+        const bool publish = true;
+        return fcfs_posix_api_init_secondary_ex(ctx, log_prefix_name, ns,
+                config_filename, FCFS_API_DEFAULT_FASTDIR_SECTION_NAME,
+                FCFS_API_DEFAULT_FASTSTORE_SECTION_NAME, publish);
+    }
+
+    /** call before fork in the parent process
+     * parameters:
+     *   ctx: the POSIX API context
+     * return: none
+    */
+    void fcfs_posix_api_fork_prepare_ex(FCFSPosixAPIContext *ctx);
+
+    /** call after fork in the parent process
+     * parameters:
+     *   ctx: the POSIX API context
+     * return: none
+    */
+    void fcfs_posix_api_fork_parent_ex(FCFSPosixAPIContext *ctx);
+
+    /** call after fork in the child process, the inherited connections
+     *  are closed and the client contexts should be rebuilt before use
+     * parameters:
+     *   ctx: the POSIX API context
+     * return: none
+    */
+    void fcfs_posix_api_fork_child_ex(FCFSPosixAPIContext *ctx);
+
+    /** rebuild the client contexts and start the background threads in
+     *  the child process after fork, the opened fds are kept
+     * parameters:
+     *   ctx: the POSIX API context
+     *   log_prefix_name: the prefix name for log filename, NULL for stderr
+     *   ns: the namespace/poolname of FastDIR
+     *   config_filename: the config filename, eg. /etc/fastcfs/fcfs/fuse.conf
+     *   fdir_section_name: the section name of FastDIR
+     *   fs_section_name: the section name of FastStore
+     *   publish: if publish the session, this parameter is valid when auth enabled
+     * return: error no, 0 for success, != 0 fail
+    */
+    int fcfs_posix_api_rebuild_ex1(FCFSPosixAPIContext *ctx,
+            const char *log_prefix_name, const char *ns,
+            const char *config_filename, const char *fdir_section_name,
+            const char *fs_section_name, const bool publish);
+
+    static inline void fcfs_posix_api_fork_prepare()
+    {
+        fcfs_posix_api_fork_prepare_ex(&g_fcfs_papi_global_vars.ctx);
+    }
+
+    static inline void fcfs_posix_api_fork_parent()
+    {
+        fcfs_posix_api_fork_parent_ex(&g_fcfs_papi_global_vars.ctx);
+    }
+
+    static inline void fcfs_posix_api_fork_child()
+    {
+        fcfs_posix_api_fork_child_ex(&g_fcfs_papi_global_vars.ctx);
+    }
+
+    static inline int fcfs_posix_api_rebuild(const char *log_prefix_name,
+            const char *ns, const char *config_filename)
+    {
+        const bool publish = true;
+        return fcfs_posix_api_rebuild_ex1(&g_fcfs_papi_global_vars.ctx,
+                log_prefix_name, ns, config_filename,
+                FCFS_API_DEFAULT_FASTDIR_SECTION_NAME,
+                FCFS_API_DEFAULT_FASTSTORE_SECTION_NAME, publish);
+    }
+
     /** log configs of FastCFS POSIX API
      * parameters:
      *   ctx: the POSIX API context
@@ -140,6 +285,8 @@ extern "C" {
     */
     static inline void fcfs_posix_api_stop_ex(FCFSPosixAPIContext *ctx)
     {
+        fcfs_write_buffer_flush_all();
+        fcfs_write_buffer_terminate();
         fcfs_api_terminate_ex(&ctx->api_ctx);
     }
 
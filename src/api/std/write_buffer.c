@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fastcommon/shared_func.h"
+#include "fastcommon/pthread_func.h"
+#include "fastcommon/fc_atomic.h"
+#include "fastcommon/logger.h"
+#include "sf/sf_global.h"
+#include "posix_api.h"
+#include "write_buffer.h"
+
+#define WRITE_BUFFER_FLUSH_BATCH_SIZE  64
+
+typedef struct fcfs_write_buffer_context {
+    pthread_mutex_t lock;
+    struct fc_list_head head;  //element: FCFSPosixWriteBuffer
+    int check_interval_ms;     //of the flush thread
+    volatile bool running;
+    volatile bool continue_flag;
+} FCFSWriteBufferContext;
+
+static FCFSWriteBufferContext wb_ctx;
+
+int fcfs_write_buffer_init()
+{
+    int result;
+
+    if ((result=init_pthread_lock(&wb_ctx.lock)) != 0) {
+        return result;
+    }
+    FC_INIT_LIST_HEAD(&wb_ctx.head);
+    return 0;
+}
+
+/* the caller should hold the lock of the buffer */
+static int do_flush(FCFSPosixWriteBuffer *wbuffer)
+{
+    FCFSPosixAPIFileInfo *file;
+    int write_bytes;
+    int result;
+
+    if (wbuffer->length == 0) {
+        return 0;
+    }
+
+    file = wbuffer->file;
+    if ((result=fcfs_api_write_ex(&file->fi, wbuffer->buff,
+                    wbuffer->length, &write_bytes,
+                    fcfs_posix_api_gettid(file->tpid_type))) == 0)
+    {
+        if (write_bytes != wbuffer->length) {
+            result = EIO;
+        }
+    }
+
+    if (result != 0) {
+        logError("file: "__FILE__", line: %d, "
+                "flush %d bytes of file: %s fail, errno: %d, error info: %s",
+                __LINE__, wbuffer->length, file->filename.str,
+                result, STRERROR(result));
+        wbuffer->error_no = result;
+    }
+    wbuffer->length = 0;
+    return result;
+}
+
+/* the due buffers are collected with their locks held under the global
+ * lock, and flushed after the global lock released, so the flush RPCs
+ * do not block the open and close of the buffered files
+ */
+static int flush_expired(const int64_t current_time_ms)
+{
+    FCFSPosixWriteBuffer *wbuffers[WRITE_BUFFER_FLUSH_BATCH_SIZE];
+    FCFSPosixWriteBuffer *wbuffer;
+    int count;
+    int total;
+    int i;
+
+    total = 0;
+    do {
+        count = 0;
+        PTHREAD_MUTEX_LOCK(&wb_ctx.lock);
+        fc_list_for_each_entry(wbuffer, &wb_ctx.head, dlink) {
+            /* skip the buffer in use, it is flushed by the writer */
+            if (pthread_mutex_trylock(&wbuffer->lock) != 0) {
+                continue;
+            }
+
+            if (wbuffer->length > 0 && current_time_ms -
+                    wbuffer->first_time_ms >= wbuffer->flush_interval_ms)
+            {
+                wbuffers[count++] = wbuffer;
+                if (count == WRITE_BUFFER_FLUSH_BATCH_SIZE) {
+                    break;
+                }
+            } else {
+                PTHREAD_MUTEX_UNLOCK(&wbuffer->lock);
+            }
+        }
+        PTHREAD_MUTEX_UNLOCK(&wb_ctx.lock);
+
+        for (i=0; i<count; i++) {
+            do_flush(wbuffers[i]);
+            PTHREAD_MUTEX_UNLOCK(&wbuffers[i]->lock);
+        }
+        total += count;
+    } while (count == WRITE_BUFFER_FLUSH_BATCH_SIZE);
+
+    return total;
+}
+
+static void *flush_thread_func(void *arg)
+{
+#ifdef OS_LINUX
+    prctl(PR_SET_NAME, "papi-wbuffer");
+#endif
+
+    while (FC_ATOMIC_GET(wb_ctx.continue_flag)) {
+        fc_sleep_ms(wb_ctx.check_interval_ms);
+        flush_expired(get_current_time_ms());
+    }
+
+    FC_ATOMIC_SET(wb_ctx.running, false);
+    return NULL;
+}
+
+/* the caller should hold the global lock */
+static int start_flush_thread()
+{
+    pthread_t tid;
+    int result;
+
+    wb_ctx.continue_flag = true;
+    wb_ctx.running = true;
+    if ((result=fc_create_thread(&tid, flush_thread_func,
+                    NULL, SF_G_THREAD_STACK_SIZE)) != 0)
+    {
+        wb_ctx.running = false;
+    }
+    return result;
+}
+
+/* the flush thread does not exist in the child process after fork */
+static inline void check_flush_thread()
+{
+    if (!FC_ATOMIC_GET(wb_ctx.running)) {
+        PTHREAD_MUTEX_LOCK(&wb_ctx.lock);
+        if (!wb_ctx.running) {
+            start_flush_thread();
+        }
+        PTHREAD_MUTEX_UNLOCK(&wb_ctx.lock);
+    }
+}
+
+int fcfs_write_buffer_create(FCFSPosixAPIContext *ctx,
+        FCFSPosixAPIFileInfo *file)
+{
+    FCFSPosixWriteBuffer *wbuffer;
+    int check_interval_ms;
+    int result;
+
+    wbuffer = (FCFSPosixWriteBuffer *)fc_malloc(sizeof(
+                FCFSPosixWriteBuffer) + ctx->append_buffer.size);
+    if (wbuffer == NULL) {
+        return ENOMEM;
+    }
+
+    if ((result=init_pthread_lock(&wbuffer->lock)) != 0) {
+        free(wbuffer);
+        return result;
+    }
+    wbuffer->buff = (char *)(wbuffer + 1);
+    wbuffer->size = ctx->append_buffer.size;
+    wbuffer->length = 0;
+    wbuffer->error_no = 0;
+    wbuffer->flush_interval_ms = ctx->append_buffer.flush_interval_ms;
+    wbuffer->first_time_ms = 0;
+    wbuffer->file = file;
+
+    result = 0;
+    check_interval_ms = wbuffer->flush_interval_ms / 2;
+    if (check_interval_ms <= 0) {
+        check_interval_ms = 1;
+    }
+
+    PTHREAD_MUTEX_LOCK(&wb_ctx.lock);
+    if (wb_ctx.check_interval_ms == 0 || check_interval_ms <
+            wb_ctx.check_interval_ms)
+    {
+        wb_ctx.check_interval_ms = check_interval_ms;
+    }
+    fc_list_add_tail(&wbuffer->dlink, &wb_ctx.head);
+    if (!wb_ctx.running) {
+        result = start_flush_thread();
+    }
+    PTHREAD_MUTEX_UNLOCK(&wb_ctx.lock);
+
+    if (result != 0) {  //write through without the flush thread
+        PTHREAD_MUTEX_LOCK(&wb_ctx.lock);
+        fc_list_del_init(&wbuffer->dlink);
+        PTHREAD_MUTEX_UNLOCK(&wb_ctx.lock);
+        pthread_mutex_destroy(&wbuffer->lock);
+        free(wbuffer);
+        return result;
+    }
+
+    file->wbuffer = wbuffer;
+    return 0;
+}
+
+int fcfs_write_buffer_destroy(FCFSPosixAPIFileInfo *file)
+{
+    FCFSPosixWriteBuffer *wbuffer;
+    int result;
+
+    wbuffer = file->wbuffer;
+    PTHREAD_MUTEX_LOCK(&wb_ctx.lock);
+    fc_list_del_init(&wbuffer->dlink);
+    PTHREAD_MUTEX_UNLOCK(&wb_ctx.lock);
+
+    PTHREAD_MUTEX_LOCK(&wbuffer->lock);
+    if ((result=do_flush(wbuffer)) == 0) {
+        result = wbuffer->error_no;
+    }
+    PTHREAD_MUTEX_UNLOCK(&wbuffer->lock);
+
+    file->wbuffer = NULL;
+    pthread_mutex_destroy(&wbuffer->lock);
+    free(wbuffer);
+    return result;
+}
+
+static inline int write_through(FCFSPosixAPIFileInfo *file,
+        const void *buff, const size_t count, int *write_bytes)
+{
+    return fcfs_api_write_ex(&file->fi, buff, count, write_bytes,
+            fcfs_posix_api_gettid(file->tpid_type));
+}
+
+ssize_t fcfs_write_buffer_write(FCFSPosixAPIFileInfo *file,
+        const void *buff, const size_t count)
+{
+    FCFSPosixWriteBuffer *wbuffer;
+    int64_t current_time_ms;
+    int write_bytes;
+    int result;
+    bool buffered;
+
+    wbuffer = file->wbuffer;
+    PTHREAD_MUTEX_LOCK(&wbuffer->lock);
+    do {
+        if (wbuffer->error_no != 0) {
+            result = wbuffer->error_no;
+            wbuffer->error_no = 0;
+            break;
+        }
+
+        /* keep the order of the writes */
+        if (count >= FCFS_WRITE_BUFFER_SMALL_WRITE_SIZE ||
+                wbuffer->length + count > wbuffer->size)
+        {
+            if ((result=do_flush(wbuffer)) != 0) {
+                wbuffer->error_no = 0;
+                break;
+            }
+        }
+
+        if (count >= FCFS_WRITE_BUFFER_SMALL_WRITE_SIZE ||
+                count > wbuffer->size)
+        {
+            result = write_through(file, buff, count, &write_bytes);
+            break;
+        }
+
+        current_time_ms = get_current_time_ms();
+        if (wbuffer->length == 0) {
+            wbuffer->first_time_ms = current_time_ms;
+        }
+        memcpy(wbuffer->buff + wbuffer->length, buff, count);
+        wbuffer->length += count;
+        write_bytes = count;
+
+        /* the data is written even if the flush fails */
+        if (wbuffer->length == wbuffer->size || current_time_ms -
+                wbuffer->first_time_ms >= wbuffer->flush_interval_ms)
+        {
+            do_flush(wbuffer);
+        }
+        result = 0;
+    } while (0);
+    buffered = (wbuffer->length > 0);
+    PTHREAD_MUTEX_UNLOCK(&wbuffer->lock);
+
+    if (result != 0) {
+        errno = result;
+        return -1;
+    }
+
+    if (buffered) {
+        check_flush_thread();
+    }
+    return write_bytes;
+}
+
+int fcfs_write_buffer_flush_ex(FCFSPosixAPIFileInfo *file,
+        const bool report_error)
+{
+    FCFSPosixWriteBuffer *wbuffer;
+    int result;
+
+    wbuffer = file->wbuffer;
+    PTHREAD_MUTEX_LOCK(&wbuffer->lock);
+    if ((result=do_flush(wbuffer)) == 0) {
+        result = wbuffer->error_no;
+    }
+    if (report_error) {
+        wbuffer->error_no = 0;
+    }
+    PTHREAD_MUTEX_UNLOCK(&wbuffer->lock);
+
+    return result;
+}
+
+void fcfs_write_buffer_flush_all()
+{
+    FCFSPosixWriteBuffer *wbuffer;
+
+    PTHREAD_MUTEX_LOCK(&wb_ctx.lock);
+    fc_list_for_each_entry(wbuffer, &wb_ctx.head, dlink) {
+        PTHREAD_MUTEX_LOCK(&wbuffer->lock);
+        do_flush(wbuffer);
+        PTHREAD_MUTEX_UNLOCK(&wbuffer->lock);
+    }
+    PTHREAD_MUTEX_UNLOCK(&wb_ctx.lock);
+}
+
+void fcfs_write_buffer_terminate()
+{
+    FC_ATOMIC_SET(wb_ctx.continue_flag, false);
+}
+
+void fcfs_write_buffer_fork_child()
+{
+    FCFSPosixWriteBuffer *wbuffer;
+
+    init_pthread_lock(&wb_ctx.lock);
+    wb_ctx.running = false;
+    fc_list_for_each_entry(wbuffer, &wb_ctx.head, dlink) {
+        init_pthread_lock(&wbuffer->lock);
+        wbuffer->length = 0;
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _FCFS_WRITE_BUFFER_H
+#define _FCFS_WRITE_BUFFER_H
+
+#include "api_types.h"
+
+/* the writes not less than this size are written through */
+#define FCFS_WRITE_BUFFER_SMALL_WRITE_SIZE  (4 * 1024)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    int fcfs_write_buffer_init();
+
+    /* create the write buffer of the file opened by O_APPEND */
+    int fcfs_write_buffer_create(FCFSPosixAPIContext *ctx,
+            FCFSPosixAPIFileInfo *file);
+
+    /* flush and free the write buffer of the file,
+     * return the error of the flush
+     */
+    int fcfs_write_buffer_destroy(FCFSPosixAPIFileInfo *file);
+
+    /* return the written bytes, -1 for error and errno is set */
+    ssize_t fcfs_write_buffer_write(FCFSPosixAPIFileInfo *file,
+            const void *buff, const size_t count);
+
+    /* flush the buffered data of the file
+     * parameters:
+     *   file: the file info
+     *   report_error: if return and clear the error of the
+     *       former background flush
+     * return: error no, 0 for success, != 0 fail
+     */
+    int fcfs_write_buffer_flush_ex(FCFSPosixAPIFileInfo *file,
+            const bool report_error);
+
+    static inline int fcfs_write_buffer_flush(FCFSPosixAPIFileInfo *file)
+    {
+        return fcfs_write_buffer_flush_ex(file, true);
+    }
+
+    void fcfs_write_buffer_flush_all();
+
+    /* the background flush thread */
+    void fcfs_write_buffer_terminate();
+
+    /* the buffered data belongs to the parent process,
+     * discard it in the child
+     */
+    void fcfs_write_buffer_fork_child();
+
+    /* for the read-your-writes of the fd, the error is kept for
+     * the later write, fsync or close
+     */
+    static inline void fcfs_write_buffer_sync(FCFSPosixAPIFileInfo *file)
+    {
+        if (file->wbuffer != NULL) {
+            fcfs_write_buffer_flush_ex(file, false);
+        }
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
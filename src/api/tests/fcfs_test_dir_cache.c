@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "fastcommon/logger.h"
+#include "fastcfs/api/std/posix_api.h"
+#include "fastcfs/api/std/dir_cache.h"
+
+static void usage(char *argv[])
+{
+    fprintf(stderr, "Usage: %s [-c config_filename=%s] "
+            "[-n namespace=fs] [-t cache_timeout_ms=10000] "
+            "<fs_dirname>\n\n", argv[0],
+            FCFS_FUSE_DEFAULT_CONFIG_FILENAME);
+}
+
+/* check that ls -l of the directory makes one listing RPC only: the
+ * lstat of every entry after the readdir must be served by the dir cache
+ */
+int main(int argc, char *argv[])
+{
+    const char *log_prefix_name = NULL;
+    const char *config_filename = FCFS_FUSE_DEFAULT_CONFIG_FILENAME;
+    char *ns = "fs";
+    char *dirname;
+    char path[PATH_MAX];
+    char full_path[PATH_MAX];
+    struct dirent *ent;
+    struct stat cached;
+    struct stat st;
+    DIR *dirp;
+    int timeout_ms = 10000;
+    int dir_len;
+    int entry_count;
+    int hit_count;
+    int ch;
+    int result;
+
+    while ((ch=getopt(argc, argv, "hc:n:t:")) != -1) {
+        switch (ch) {
+            case 'h':
+                usage(argv);
+                return 0;
+            case 'c':
+                config_filename = optarg;
+                break;
+            case 'n':
+                ns = optarg;
+                break;
+            case 't':
+                timeout_ms = strtol(optarg, NULL, 10);
+                break;
+            default:
+                usage(argv);
+                return 1;
+        }
+    }
+
+    if (optind >= argc || timeout_ms <= 0) {
+        usage(argv);
+        return 1;
+    }
+
+    log_init();
+    dirname = argv[optind];
+    if ((result=fcfs_posix_api_init(log_prefix_name,
+                    ns, config_filename)) != 0)
+    {
+        return result;
+    }
+    if ((result=fcfs_posix_api_start()) != 0) {
+        return result;
+    }
+    G_FCFS_PAPI_CTX.dir_cache.timeout_ms = timeout_ms;
+
+    if (!FCFS_API_IS_MY_MOUNTPOINT(dirname)) {
+        fprintf(stderr, "%s is not under the mountpoint: %s\n",
+                dirname, G_FCFS_PAPI_CTX.mountpoint.str);
+        return EINVAL;
+    }
+
+    /* the dir part of the paths relative to the mountpoint */
+    dir_len = snprintf(path, sizeof(path), "%s",
+            dirname + G_FCFS_PAPI_CTX.mountpoint.len);
+    while (dir_len > 0 && path[dir_len - 1] == '/') {
+        path[--dir_len] = '\0';
+    }
+
+    if ((dirp=fcfs_opendir(dirname)) == NULL) {
+        result = errno != 0 ? errno : EIO;
+        logError("file: "__FILE__", line: %d, "
+                "opendir %s fail, errno: %d, error info: %s",
+                __LINE__, dirname, result, STRERROR(result));
+        return result;
+    }
+
+    entry_count = hit_count = 0;
+    result = 0;
+    while ((ent=fcfs_readdir(dirp)) != NULL) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) {
+            continue;
+        }
+
+        entry_count++;
+        snprintf(path + dir_len, sizeof(path) - dir_len, "/%s", ent->d_name);
+        if (!fcfs_dir_cache_stat_by_path(&G_FCFS_PAPI_CTX.dir_cache,
+                    path, false, &cached))
+        {
+            logError("file: "__FILE__", line: %d, "
+                    "the lstat of %s is not served by the dir cache",
+                    __LINE__, path);
+            result = ENOENT;
+            continue;
+        }
+        hit_count++;
+
+        snprintf(full_path, sizeof(full_path), "%s%s",
+                G_FCFS_PAPI_CTX.mountpoint.str, path);
+        if (fcfs_lstat(full_path, &st) != 0 || st.st_ino != cached.st_ino) {
+            logError("file: "__FILE__", line: %d, "
+                    "the cached inode of %s is not the same as lstat",
+                    __LINE__, path);
+            result = EIO;
+        }
+    }
+    fcfs_closedir(dirp);
+
+    printf("dir: %s, entry count: %d, listing RPCs: 1, "
+            "dir cache hit count: %d\n", dirname, entry_count, hit_count);
+
+    fcfs_posix_api_stop();
+    fcfs_posix_api_destroy();
+    return result;
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "fastcommon/logger.h"
+#include "fastcommon/shared_func.h"
+#include "fastcfs/api/fcfs_api.h"
+
+static void usage(char *argv[])
+{
+    fprintf(stderr, "Usage: %s [-c config_filename=%s] "
+            "[-n namespace=fs] \n\t[-d dir_count=2] "
+            "[-f files_per_dir=16] [-s file_size=1024] <base_path>\n\n",
+            argv[0], FCFS_FUSE_DEFAULT_CONFIG_FILENAME);
+}
+
+/* the content of each file is different, so a mixed up file is detected */
+static void fill_content(char *buff, const int size, const int index)
+{
+    int i;
+
+    for (i=0; i<size; i++) {
+        buff[i] = 'a' + (index + i) % 26;
+    }
+}
+
+static int check_file(const char *path, FCFSAPIFileContext *fctx,
+        const char *expect, const int size, char *buff)
+{
+    FCFSAPIFileInfo fi;
+    int read_bytes;
+    int result;
+
+    if ((result=fcfs_api_open(&fi, path, O_RDONLY, fctx)) != 0) {
+        logError("file: "__FILE__", line: %d, "
+                "open file %s fail, errno: %d, error info: %s",
+                __LINE__, path, result, STRERROR(result));
+        return result;
+    }
+
+    /* read one more byte to catch the file larger than expected */
+    result = fcfs_api_read(&fi, buff, size + 1, &read_bytes);
+    fcfs_api_close(&fi);
+    if (result != 0) {
+        logError("file: "__FILE__", line: %d, "
+                "read file %s fail, errno: %d, error info: %s",
+                __LINE__, path, result, STRERROR(result));
+        return result;
+    }
+
+    if (read_bytes != size) {
+        logError("file: "__FILE__", line: %d, "
+                "file %s, read bytes: %d != file size: %d",
+                __LINE__, path, read_bytes, size);
+        return EIO;
+    }
+    if (memcmp(buff, expect, size) != 0) {
+        logError("file: "__FILE__", line: %d, "
+                "file %s, the content is not the same as written",
+                __LINE__, path);
+        return EIO;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const bool publish = false;
+    const char *config_filename = FCFS_FUSE_DEFAULT_CONFIG_FILENAME;
+    FCFSAPIFileContext fctx;
+    FCFSAPIPutFileEntry *entries;
+    FCFSAPIPutFileEntry *entry;
+    char *ns = "fs";
+    char *base_path;
+    char *paths;
+    char *contents;
+    char *in_buff;
+    char dir_path[PATH_MAX];
+    int dir_count = 2;
+    int files_per_dir = 16;
+    int file_size = 1024;
+    int count;
+    int fail_count;
+    int ch;
+    int i;
+    int k;
+    int result;
+
+    fctx.tid = getpid();
+    fctx.mode = 0755;
+    FDIR_SET_OPERATOR(fctx.oper, geteuid(), getegid(), 0, NULL);
+    while ((ch=getopt(argc, argv, "hc:n:d:f:s:")) != -1) {
+        switch (ch) {
+            case 'h':
+                usage(argv);
+                return 0;
+            case 'c':
+                config_filename = optarg;
+                break;
+            case 'n':
+                ns = optarg;
+                break;
+            case 'd':
+                dir_count = strtol(optarg, NULL, 10);
+                break;
+            case 'f':
+                files_per_dir = strtol(optarg, NULL, 10);
+                break;
+            case 's':
+                file_size = strtol(optarg, NULL, 10);
+                break;
+            default:
+                usage(argv);
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        fprintf(stderr, "expect base path\n");
+        usage(argv);
+        return 1;
+    }
+    if (dir_count <= 0 || files_per_dir <= 0 || file_size < 0) {
+        fprintf(stderr, "invalid dir count, files per dir or file size\n");
+        usage(argv);
+        return EINVAL;
+    }
+
+    log_init();
+    base_path = argv[optind];
+    count = dir_count * files_per_dir;
+    entries = (FCFSAPIPutFileEntry *)fc_malloc(
+            sizeof(FCFSAPIPutFileEntry) * count);
+    paths = (char *)fc_malloc(PATH_MAX * count);
+    contents = (char *)fc_malloc((file_size + 1) * count);
+    in_buff = (char *)fc_malloc(file_size + 1);
+    if (entries == NULL || paths == NULL ||
+            contents == NULL || in_buff == NULL)
+    {
+        return ENOMEM;
+    }
+
+    if ((result=fcfs_api_pooled_init_with_auth(ns,
+                    config_filename, publish)) != 0)
+    {
+        return result;
+    }
+    if ((result=fcfs_api_start()) != 0) {
+        return result;
+    }
+
+    /* the entries are grouped by directory as the api expects */
+    entry = entries;
+    for (i=0; i<dir_count; i++) {
+        snprintf(dir_path, sizeof(dir_path), "%s/dir%03d", base_path, i);
+        if ((result=fcfs_api_mkdir_ex(&g_fcfs_api_ctx, dir_path,
+                        &fctx.oper, 0755)) != 0 && result != EEXIST)
+        {
+            logError("file: "__FILE__", line: %d, "
+                    "mkdir %s fail, errno: %d, error info: %s",
+                    __LINE__, dir_path, result, STRERROR(result));
+            return result;
+        }
+
+        for (k=0; k<files_per_dir; k++, entry++) {
+            snprintf(paths + PATH_MAX * (entry - entries), PATH_MAX,
+                    "%s/file%05d", dir_path, k);
+            entry->path = paths + PATH_MAX * (entry - entries);
+            entry->mode = 0644;
+            entry->data.str = contents + (file_size + 1) * (entry - entries);
+            entry->data.len = file_size;
+            fill_content(entry->data.str, file_size, entry - entries);
+            entry->result = 0;
+        }
+    }
+
+    result = fcfs_api_put_files(entries, count, &fctx);
+    fail_count = 0;
+    for (entry=entries; entry<entries+count; entry++) {
+        if (entry->result != 0) {
+            fail_count++;
+            logError("file: "__FILE__", line: %d, "
+                    "put file %s fail, errno: %d, error info: %s",
+                    __LINE__, entry->path, entry->result,
+                    STRERROR(entry->result));
+            continue;
+        }
+
+        /* without async report, the size is reported when the put
+         * returns, with async report it may lag behind */
+        if (g_fcfs_api_ctx.async_report.enabled) {
+            continue;
+        }
+        if (check_file(entry->path, &fctx, entry->data.str,
+                    file_size, in_buff) != 0)
+        {
+            fail_count++;
+        }
+    }
+
+    printf("put files: %d, dirs: %d, file size: %d, fail count: %d, "
+            "result: %d\n", count, dir_count, file_size, fail_count, result);
+
+    fcfs_api_destroy();
+    free(in_buff);
+    free(contents);
+    free(paths);
+    free(entries);
+    return (fail_count == 0 ? 0 : EIO);
+}
@@ -196,6 +196,52 @@ int fcfs_auth_client_proto_session_subscribe(
     return result;
 }
 
+int fcfs_auth_client_proto_session_subscribe_v2(
+        FCFSAuthClientContext *client_ctx, ConnectionInfo *conn,
+        int64_t *epoch, int64_t *version, int *count, bool *snapshot)
+{
+    FCFSAuthProtoHeader *header;
+    FCFSAuthProtoSessionSubscribeV2Req *req;
+    FCFSAuthProtoSessionSubscribeV2Resp resp;
+    char out_buff[sizeof(FCFSAuthProtoHeader) +
+        sizeof(FCFSAuthProtoSessionSubscribeV2Req) +
+        NAME_MAX + FCFS_AUTH_PASSWD_LEN];
+    SFResponseInfo response;
+    int out_bytes;
+    int result;
+
+    header = (FCFSAuthProtoHeader *)out_buff;
+    req = (FCFSAuthProtoSessionSubscribeV2Req *)(header + 1);
+    out_bytes = sizeof(FCFSAuthProtoHeader) + sizeof(*req) +
+        client_ctx->auth_cfg.username.len;
+    SF_PROTO_SET_HEADER(header,
+            FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_V2_REQ,
+            out_bytes - sizeof(FCFSAuthProtoHeader));
+    long2buff(*epoch, req->epoch);
+    long2buff(*version, req->version);
+    if ((result=pack_user_passwd_pair(&client_ctx->auth_cfg.username,
+                    &client_ctx->auth_cfg.passwd, &req->up_pair)) != 0)
+    {
+        return result;
+    }
+
+    response.error.length = 0;
+    if ((result=sf_send_and_recv_response(conn, out_buff, out_bytes,
+                    &response, client_ctx->common_cfg.network_timeout,
+                    FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_V2_RESP,
+                    (char *)&resp, sizeof(resp))) == 0)
+    {
+        *epoch = buff2long(resp.epoch);
+        *version = buff2long(resp.version);
+        *count = buff2int(resp.count);
+        *snapshot = resp.snapshot;
+    } else if (result != EINVAL) {  //EINVAL for the old master
+        auth_log_network_error(&response, conn, result);
+    }
+
+    return result;
+}
+
 int fcfs_auth_client_proto_session_validate(
         FCFSAuthClientContext *client_ctx, ConnectionInfo *conn,
         const string_t *session_id, const string_t *validate_key,
@@ -323,19 +369,67 @@ int fcfs_auth_client_proto_user_passwd(FCFSAuthClientContext *client_ctx,
 typedef int (*client_proto_list_func)(FCFSAuthClientContext *client_ctx,
         ConnectionInfo *conn, const string_t *username,
         const string_t *poolname, const SFListLimitInfo *limit,
-        SFProtoRecvBuffer *buffer, struct fast_mpool_man *mpool,
-        void *array, bool *is_last);
+        FCFSAuthListCursor *cursor, SFProtoRecvBuffer *buffer,
+        struct fast_mpool_man *mpool, void *array, bool *is_last);
+
+/* the cursor is NULL for the old server which does NOT support it */
+static inline int pack_list_cursor(const FCFSAuthListCursor *cursor,
+        FCFSAuthProtoNameInfo *proto_cursor)
+{
+    string_t cs;
+
+    if (cursor == NULL) {
+        return 0;
+    }
+    FC_SET_STRING_EX(cs, (char *)cursor->str, cursor->len);
+    return fcfs_auth_pack_list_cursor(&cs, proto_cursor);
+}
+
+static int unpack_list_cursor(SFResponseInfo *response, const char *p,
+        SFProtoRecvBuffer *buffer, FCFSAuthListCursor *cursor)
+{
+    string_t cs;
+
+    if (cursor == NULL) {
+        if (response->header.body_len != p - buffer->buff) {
+            logError("file: "__FILE__", line: %d, "
+                    "response body length: %d != expect: %d",
+                    __LINE__, response->header.body_len,
+                    (int)(p - buffer->buff));
+            return EINVAL;
+        }
+        return 0;
+    }
+
+    if (fcfs_auth_parse_list_cursor(p, buffer->buff + response->
+                header.body_len, &cs) != 0)
+    {
+        logError("file: "__FILE__", line: %d, "
+                "response body length: %d is invalid, parsed length: %d",
+                __LINE__, response->header.body_len,
+                (int)(p - buffer->buff));
+        return EINVAL;
+    }
+
+    if (cs.len > 0) {
+        memcpy(cursor->str, cs.str, cs.len);
+        cursor->len = cs.len;
+    }
+    return 0;
+}
 
 static int client_proto_user_list_do(FCFSAuthClientContext *client_ctx,
         ConnectionInfo *conn, const string_t *username,
         const string_t *poolname, const SFListLimitInfo *limit,
-        SFProtoRecvBuffer *buffer, struct fast_mpool_man *mpool,
-        FCFSAuthUserArray *array, bool *is_last)
+        FCFSAuthListCursor *cursor, SFProtoRecvBuffer *buffer,
+        struct fast_mpool_man *mpool, FCFSAuthUserArray *array,
+        bool *is_last)
 {
     FCFSAuthProtoHeader *header;
     FCFSAuthProtoUserListReq *req;
     char out_buff[sizeof(FCFSAuthProtoHeader) +
-        sizeof(FCFSAuthProtoUserListReq) + NAME_MAX];
+        sizeof(FCFSAuthProtoUserListReq) + 2 * NAME_MAX +
+        sizeof(FCFSAuthProtoNameInfo)];
     SFResponseInfo response;
     FCFSAuthProtoListRespHeader *resp_header;
     FCFSAuthProtoUserListRespBodyPart *body_part;
@@ -354,6 +448,8 @@ static int client_proto_user_list_do(FCFSAuthClientContext *client_ctx,
 
     out_bytes = sizeof(FCFSAuthProtoHeader) +
         sizeof(FCFSAuthProtoUserListReq) + username->len;
+    out_bytes += pack_list_cursor(cursor, (FCFSAuthProtoNameInfo *)
+            (out_buff + out_bytes));
     SF_PROTO_SET_HEADER(header, FCFS_AUTH_SERVICE_PROTO_USER_LIST_REQ,
             out_bytes - sizeof(FCFSAuthProtoHeader));
     sf_proto_pack_limit(limit, &req->limit);
@@ -391,18 +487,18 @@ static int client_proto_user_list_do(FCFSAuthClientContext *client_ctx,
         p += sizeof(FCFSAuthProtoUserListRespBodyPart) + user->name.len;
     }
 
-    if (response.header.body_len != p - buffer->buff) {
-        logError("file: "__FILE__", line: %d, "
-                "response body length: %d != expect: %d",
-                __LINE__, response.header.body_len,
-                (int)(p - buffer->buff));
-        return EINVAL;
+    if ((result=unpack_list_cursor(&response, p, buffer, cursor)) != 0) {
+        return result;
     }
 
     array->count += count;
     return result;
 }
 
+/* list the entries page by page with the cursor returned by the server,
+ * the offset of the limit is only used by the first page. fall back to
+ * the offset paging when the old server rejects the cursor
+ */
 static int client_proto_list_wrapper(client_proto_list_func list_func,
         FCFSAuthClientContext *client_ctx, ConnectionInfo *conn,
         const string_t *username, const string_t *poolname,
@@ -410,23 +506,33 @@ static int client_proto_list_wrapper(client_proto_list_func list_func,
         void *array, int *count)
 {
     int result;
+    int old_count;
     bool is_last;
     SFProtoRBufferFixedWrapper buffer_wrapper;
     SFListLimitInfo new_limit;
+    FCFSAuthListCursor cursor;
+    FCFSAuthListCursor old_cursor;
+    FCFSAuthListCursor *pcursor;
 
     sf_init_recv_buffer_by_wrapper(&buffer_wrapper);
     if (limit->count > 0 && limit->count <= 64) {
-        result = list_func(client_ctx, conn,
-                username, poolname, limit, &buffer_wrapper.buffer,
+        result = list_func(client_ctx, conn, username, poolname,
+                limit, NULL, &buffer_wrapper.buffer,
                 mpool, array, &is_last);
         sf_free_recv_buffer(&buffer_wrapper.buffer);
         return result;
     }
 
+    cursor.len = 0;
+    pcursor = &cursor;
     result = 0;
     is_last = false;
     while (!is_last) {
-        new_limit.offset = limit->offset + *count;
+        if (pcursor != NULL) {
+            new_limit.offset = (cursor.len > 0) ? 0 : limit->offset;
+        } else {
+            new_limit.offset = limit->offset + *count;
+        }
         if (limit->count <= 0) {
             new_limit.count = 0;
         } else {
@@ -436,9 +542,23 @@ static int client_proto_list_wrapper(client_proto_list_func list_func,
             }
         }
 
-        if ((result=list_func(client_ctx, conn, username,
-                        poolname, &new_limit, &buffer_wrapper.buffer,
+        old_count = *count;
+        old_cursor = cursor;
+        if ((result=list_func(client_ctx, conn, username, poolname,
+                        &new_limit, pcursor, &buffer_wrapper.buffer,
                         mpool, array, &is_last)) != 0)
+        {
+            if (result == EINVAL && pcursor != NULL && cursor.len == 0) {
+                pcursor = NULL;  //the old server without the cursor
+                continue;
+            }
+            break;
+        }
+
+        /* avoid dead loop, the filtered pages maybe empty */
+        if (*count == old_count && (pcursor == NULL ||
+                    (cursor.len == old_cursor.len && memcmp(cursor.str,
+                        old_cursor.str, cursor.len) == 0)))
         {
             break;
         }
@@ -448,6 +568,27 @@ static int client_proto_list_wrapper(client_proto_list_func list_func,
     return result;
 }
 
+static int client_proto_list_page(client_proto_list_func list_func,
+        FCFSAuthClientContext *client_ctx, ConnectionInfo *conn,
+        const string_t *username, FCFSAuthListCursor *cursor,
+        const int count, struct fast_mpool_man *mpool,
+        void *array, bool *is_last)
+{
+    const string_t poolname = {"", 0};
+    int result;
+    SFProtoRBufferFixedWrapper buffer_wrapper;
+    SFListLimitInfo limit;
+
+    limit.offset = 0;
+    limit.count = count;
+    sf_init_recv_buffer_by_wrapper(&buffer_wrapper);
+    result = list_func(client_ctx, conn, username, &poolname,
+            &limit, cursor, &buffer_wrapper.buffer,
+            mpool, array, is_last);
+    sf_free_recv_buffer(&buffer_wrapper.buffer);
+    return result;
+}
+
 int fcfs_auth_client_proto_user_list(FCFSAuthClientContext *client_ctx,
         ConnectionInfo *conn, const string_t *username,
         const SFListLimitInfo *limit, struct fast_mpool_man *mpool,
@@ -459,6 +600,17 @@ int fcfs_auth_client_proto_user_list(FCFSAuthClientContext *client_ctx,
             poolname, limit, mpool, array, &array->count);
 }
 
+int fcfs_auth_client_proto_user_list_page(FCFSAuthClientContext *client_ctx,
+        ConnectionInfo *conn, FCFSAuthListCursor *cursor, const int count,
+        struct fast_mpool_man *mpool, FCFSAuthUserArray *array,
+        bool *is_last)
+{
+    const string_t username = {"", 0};
+    return client_proto_list_page((client_proto_list_func)
+            client_proto_user_list_do, client_ctx, conn, &username,
+            cursor, count, mpool, array, is_last);
+}
+
 int fcfs_auth_client_proto_user_grant(FCFSAuthClientContext *client_ctx,
         ConnectionInfo *conn, const string_t *username, const int64_t priv)
 {
@@ -579,15 +731,17 @@ int fcfs_auth_client_proto_spool_create(FCFSAuthClientContext *client_ctx,
     return 0;
 }
 
-int client_proto_spool_list_do(FCFSAuthClientContext *client_ctx,
+static int client_proto_spool_list_do(FCFSAuthClientContext *client_ctx,
         ConnectionInfo *conn, const string_t *username,
         const string_t *poolname, const SFListLimitInfo *limit,
-        SFProtoRecvBuffer *buffer, struct fast_mpool_man *mpool,
-        FCFSAuthStoragePoolArray *array, bool *is_last)
+        FCFSAuthListCursor *cursor, SFProtoRecvBuffer *buffer,
+        struct fast_mpool_man *mpool, FCFSAuthStoragePoolArray *array,
+        bool *is_last)
 {
     FCFSAuthProtoHeader *header;
     char out_buff[sizeof(FCFSAuthProtoHeader) +
-        sizeof(FCFSAuthProtoSPoolListReq) + 2 * NAME_MAX];
+        sizeof(FCFSAuthProtoSPoolListReq) + 3 * NAME_MAX +
+        sizeof(FCFSAuthProtoNameInfo)];
     SFResponseInfo response;
     FCFSAuthProtoSPoolListReq *req;
     FCFSAuthProtoListRespHeader *resp_header;
@@ -603,6 +757,8 @@ int client_proto_spool_list_do(FCFSAuthClientContext *client_ctx,
     out_bytes = sizeof(FCFSAuthProtoHeader) +
         sizeof(FCFSAuthProtoSPoolListReq) +
         username->len + poolname->len;
+    out_bytes += pack_list_cursor(cursor, (FCFSAuthProtoNameInfo *)
+            (out_buff + out_bytes));
     SF_PROTO_SET_HEADER(header, FCFS_AUTH_SERVICE_PROTO_SPOOL_LIST_REQ,
             out_bytes - sizeof(FCFSAuthProtoHeader));
 
@@ -647,12 +803,8 @@ int client_proto_spool_list_do(FCFSAuthClientContext *client_ctx,
         p += sizeof(FCFSAuthProtoSPoolListRespBodyPart) + spool->name.len;
     }
 
-    if (response.header.body_len != p - buffer->buff) {
-        logError("file: "__FILE__", line: %d, "
-                "response body length: %d != expect: %d",
-                __LINE__, response.header.body_len,
-                (int)(p - buffer->buff));
-        return EINVAL;
+    if ((result=unpack_list_cursor(&response, p, buffer, cursor)) != 0) {
+        return result;
     }
 
     array->count += count;
@@ -669,6 +821,17 @@ int fcfs_auth_client_proto_spool_list(FCFSAuthClientContext *client_ctx,
             poolname, limit, mpool, array, &array->count);
 }
 
+int fcfs_auth_client_proto_spool_list_page(FCFSAuthClientContext *client_ctx,
+        ConnectionInfo *conn, const string_t *username,
+        FCFSAuthListCursor *cursor, const int count,
+        struct fast_mpool_man *mpool, FCFSAuthStoragePoolArray *array,
+        bool *is_last)
+{
+    return client_proto_list_page((client_proto_list_func)
+            client_proto_spool_list_do, client_ctx, conn, username,
+            cursor, count, mpool, array, is_last);
+}
+
 int fcfs_auth_client_proto_spool_remove(FCFSAuthClientContext *client_ctx,
         ConnectionInfo *conn, const string_t *poolname)
 {
@@ -846,12 +1009,14 @@ int fcfs_auth_client_proto_gpool_withdraw(FCFSAuthClientContext
 static int client_proto_gpool_list_do(FCFSAuthClientContext
         *client_ctx, ConnectionInfo *conn, const string_t *username,
         const string_t *poolname, const SFListLimitInfo *limit,
-        SFProtoRecvBuffer *buffer, struct fast_mpool_man *mpool,
-        FCFSAuthGrantedPoolArray *array, bool *is_last)
+        FCFSAuthListCursor *cursor, SFProtoRecvBuffer *buffer,
+        struct fast_mpool_man *mpool, FCFSAuthGrantedPoolArray *array,
+        bool *is_last)
 {
     FCFSAuthProtoHeader *header;
     char out_buff[sizeof(FCFSAuthProtoHeader) +
-        sizeof(FCFSAuthProtoGPoolListReq) + 2 * NAME_MAX];
+        sizeof(FCFSAuthProtoGPoolListReq) + 3 * NAME_MAX +
+        sizeof(FCFSAuthProtoNameInfo)];
     SFResponseInfo response;
     FCFSAuthProtoGPoolListReq *req;
     FCFSAuthProtoListRespHeader *resp_header;
@@ -868,6 +1033,8 @@ static int client_proto_gpool_list_do(FCFSAuthClientContext
     out_bytes = sizeof(FCFSAuthProtoHeader) +
         sizeof(FCFSAuthProtoGPoolListReq) +
         username->len + poolname->len;
+    out_bytes += pack_list_cursor(cursor, (FCFSAuthProtoNameInfo *)
+            (out_buff + out_bytes));
     SF_PROTO_SET_HEADER(header, FCFS_AUTH_SERVICE_PROTO_GPOOL_LIST_REQ,
             out_bytes - sizeof(FCFSAuthProtoHeader));
 
@@ -923,12 +1090,8 @@ static int client_proto_gpool_list_do(FCFSAuthClientContext
             + gpool->username.len + gpool->pool_name.len;
     }
 
-    if (response.header.body_len != p - buffer->buff) {
-        logError("file: "__FILE__", line: %d, "
-                "response body length: %d != expect: %d",
-                __LINE__, response.header.body_len,
-                (int)(p - buffer->buff));
-        return EINVAL;
+    if ((result=unpack_list_cursor(&response, p, buffer, cursor)) != 0) {
+        return result;
     }
 
     array->count += count;
@@ -945,6 +1108,17 @@ int fcfs_auth_client_proto_gpool_list(FCFSAuthClientContext
             poolname, limit, mpool, array, &array->count);
 }
 
+int fcfs_auth_client_proto_gpool_list_page(FCFSAuthClientContext
+        *client_ctx, ConnectionInfo *conn, const string_t *username,
+        FCFSAuthListCursor *cursor, const int count,
+        struct fast_mpool_man *mpool, FCFSAuthGrantedPoolArray *array,
+        bool *is_last)
+{
+    return client_proto_list_page((client_proto_list_func)
+            client_proto_gpool_list_do, client_ctx, conn, username,
+            cursor, count, mpool, array, is_last);
+}
+
 int fcfs_auth_client_get_master(FCFSAuthClientContext *client_ctx,
         FCFSAuthClientServerEntry *master)
 {
@@ -44,6 +44,17 @@ int fcfs_auth_client_cluster_stat(FCFSAuthClientContext *client_ctx,
 int fcfs_auth_client_proto_session_subscribe(
         FCFSAuthClientContext *client_ctx, ConnectionInfo *conn);
 
+/* epoch and version: input the last applied position of the session log,
+ * output the current position of the master's session log.
+ * count: output the entry count to push for the snapshot or the resume
+ * snapshot: output if the master pushes the whole sessions
+ *
+ * return EINVAL when the master does NOT support the V2 subscription
+ */
+int fcfs_auth_client_proto_session_subscribe_v2(
+        FCFSAuthClientContext *client_ctx, ConnectionInfo *conn,
+        int64_t *epoch, int64_t *version, int *count, bool *snapshot);
+
 int fcfs_auth_client_proto_session_validate(
         FCFSAuthClientContext *client_ctx, ConnectionInfo *conn,
         const string_t *session_id, const string_t *validate_key,
@@ -67,6 +78,11 @@ int fcfs_auth_client_proto_user_list(FCFSAuthClientContext *client_ctx,
         const SFListLimitInfo *limit, struct fast_mpool_man *mpool,
         FCFSAuthUserArray *array);
 
+int fcfs_auth_client_proto_user_list_page(FCFSAuthClientContext *client_ctx,
+        ConnectionInfo *conn, FCFSAuthListCursor *cursor, const int count,
+        struct fast_mpool_man *mpool, FCFSAuthUserArray *array,
+        bool *is_last);
+
 int fcfs_auth_client_proto_user_grant(FCFSAuthClientContext *client_ctx,
         ConnectionInfo *conn, const string_t *username, const int64_t priv);
 
@@ -82,6 +98,12 @@ int fcfs_auth_client_proto_spool_list(FCFSAuthClientContext *client_ctx,
         const string_t *poolname, const SFListLimitInfo *limit,
         struct fast_mpool_man *mpool, FCFSAuthStoragePoolArray *array);
 
+int fcfs_auth_client_proto_spool_list_page(FCFSAuthClientContext *client_ctx,
+        ConnectionInfo *conn, const string_t *username,
+        FCFSAuthListCursor *cursor, const int count,
+        struct fast_mpool_man *mpool, FCFSAuthStoragePoolArray *array,
+        bool *is_last);
+
 int fcfs_auth_client_proto_spool_remove(FCFSAuthClientContext *client_ctx,
         ConnectionInfo *conn, const string_t *poolname);
 
@@ -104,6 +126,12 @@ int fcfs_auth_client_proto_gpool_list(FCFSAuthClientContext
         const string_t *poolname, const SFListLimitInfo *limit,
         struct fast_mpool_man *mpool, FCFSAuthGrantedPoolArray *array);
 
+int fcfs_auth_client_proto_gpool_list_page(FCFSAuthClientContext
+        *client_ctx, ConnectionInfo *conn, const string_t *username,
+        FCFSAuthListCursor *cursor, const int count,
+        struct fast_mpool_man *mpool, FCFSAuthGrantedPoolArray *array,
+        bool *is_last);
+
 #ifdef __cplusplus
 }
 #endif
@@ -252,6 +252,16 @@ int fcfs_auth_client_user_list(FCFSAuthClientContext *client_ctx,
             username, limit, mpool, array);
 }
 
+int fcfs_auth_client_user_list_page(FCFSAuthClientContext *client_ctx,
+        FCFSAuthListCursor *cursor, const int count,
+        struct fast_mpool_man *mpool, FCFSAuthUserArray *array,
+        bool *is_last)
+{
+    SF_CLIENT_IDEMPOTENCY_QUERY_WRAPPER(client_ctx, &client_ctx->cm,
+            GET_MASTER_CONNECTION, 0, fcfs_auth_client_proto_user_list_page,
+            cursor, count, mpool, array, is_last);
+}
+
 int fcfs_auth_client_user_grant(FCFSAuthClientContext *client_ctx,
         const string_t *username, const int64_t priv)
 {
@@ -287,6 +297,16 @@ int fcfs_auth_client_spool_list(FCFSAuthClientContext *client_ctx,
             username, poolname, limit, mpool, array);
 }
 
+int fcfs_auth_client_spool_list_page(FCFSAuthClientContext *client_ctx,
+        const string_t *username, FCFSAuthListCursor *cursor,
+        const int count, struct fast_mpool_man *mpool,
+        FCFSAuthStoragePoolArray *array, bool *is_last)
+{
+    SF_CLIENT_IDEMPOTENCY_QUERY_WRAPPER(client_ctx, &client_ctx->cm,
+            GET_MASTER_CONNECTION, 0, fcfs_auth_client_proto_spool_list_page,
+            username, cursor, count, mpool, array, is_last);
+}
+
 int fcfs_auth_client_spool_remove(FCFSAuthClientContext *client_ctx,
         const string_t *poolname)
 {
@@ -337,3 +357,13 @@ int fcfs_auth_client_gpool_list(FCFSAuthClientContext *client_ctx,
             GET_MASTER_CONNECTION, 0, fcfs_auth_client_proto_gpool_list,
             username, poolname, limit, mpool, array);
 }
+
+int fcfs_auth_client_gpool_list_page(FCFSAuthClientContext *client_ctx,
+        const string_t *username, FCFSAuthListCursor *cursor,
+        const int count, struct fast_mpool_man *mpool,
+        FCFSAuthGrantedPoolArray *array, bool *is_last)
+{
+    SF_CLIENT_IDEMPOTENCY_QUERY_WRAPPER(client_ctx, &client_ctx->cm,
+            GET_MASTER_CONNECTION, 0, fcfs_auth_client_proto_gpool_list_page,
+            username, cursor, count, mpool, array, is_last);
+}
@@ -118,6 +118,16 @@ int fcfs_auth_client_user_list(FCFSAuthClientContext *client_ctx,
         const string_t *username, const SFListLimitInfo *limit,
         struct fast_mpool_man *mpool, FCFSAuthUserArray *array);
 
+/* list one page of the users after the cursor, the cursor is updated
+ * for the next page, set cursor->len to 0 to list from the beginning.
+ * the users are appended to the array.
+ * return EINVAL when the server is too old to support the cursor
+ */
+int fcfs_auth_client_user_list_page(FCFSAuthClientContext *client_ctx,
+        FCFSAuthListCursor *cursor, const int count,
+        struct fast_mpool_man *mpool, FCFSAuthUserArray *array,
+        bool *is_last);
+
 int fcfs_auth_client_user_grant(FCFSAuthClientContext *client_ctx,
         const string_t *username, const int64_t priv);
 
@@ -134,6 +144,12 @@ int fcfs_auth_client_spool_list(FCFSAuthClientContext *client_ctx,
         const SFListLimitInfo *limit, struct fast_mpool_man *mpool,
         FCFSAuthStoragePoolArray *array);
 
+/* list one page of the storage pools of the user after the cursor */
+int fcfs_auth_client_spool_list_page(FCFSAuthClientContext *client_ctx,
+        const string_t *username, FCFSAuthListCursor *cursor,
+        const int count, struct fast_mpool_man *mpool,
+        FCFSAuthStoragePoolArray *array, bool *is_last);
+
 int fcfs_auth_client_spool_remove(FCFSAuthClientContext *client_ctx,
         const string_t *poolname);
 
@@ -156,6 +172,12 @@ int fcfs_auth_client_gpool_list(FCFSAuthClientContext *client_ctx,
         const SFListLimitInfo *limit, struct fast_mpool_man *mpool,
         FCFSAuthGrantedPoolArray *array);
 
+/* list one page of the granted pools of the user after the cursor */
+int fcfs_auth_client_gpool_list_page(FCFSAuthClientContext *client_ctx,
+        const string_t *username, FCFSAuthListCursor *cursor,
+        const int count, struct fast_mpool_man *mpool,
+        FCFSAuthGrantedPoolArray *array, bool *is_last);
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,6 +15,7 @@
 
 #include "sf/idempotency/client/rpc_wrapper.h"
 #include "../common/auth_func.h"
+#include "validate_cache.h"
 #include "fcfs_auth_for_server.h"
 
 int fcfs_auth_for_server_check_priv(FCFSAuthClientContext *client_ctx,
@@ -35,7 +36,7 @@ int fcfs_auth_for_server_check_priv(FCFSAuthClientContext *client_ctx,
     session.part1.id = buff2long(request->body);
     session.part2.id = buff2long(request->body + 8);
 
-    if (session.part1.fields.publish) {
+    if (session.part1.fields.publish && session_sync_is_synced()) {
         switch (priv_type) {
             case fcfs_auth_validate_priv_type_user:
                 result = server_session_user_priv_granted(
@@ -63,10 +64,18 @@ int fcfs_auth_for_server_check_priv(FCFSAuthClientContext *client_ctx,
 
     if (validate) {
         const int64_t pool_id = 0;
-        FC_SET_STRING_EX(session_id, request->body, FCFS_AUTH_SESSION_ID_LEN);
-        result = fcfs_auth_client_session_validate(client_ctx,
-                &session_id, &g_server_session_cfg.validate_key,
-                priv_type, pool_id, the_priv);
+        if (validate_cache_exists(&session, priv_type, pool_id, the_priv)) {
+            result = 0;
+        } else {
+            FC_SET_STRING_EX(session_id, request->body,
+                    FCFS_AUTH_SESSION_ID_LEN);
+            if ((result=fcfs_auth_client_session_validate(client_ctx,
+                            &session_id, &g_server_session_cfg.validate_key,
+                            priv_type, pool_id, the_priv)) == 0)
+            {
+                validate_cache_add(&session, priv_type, pool_id, the_priv);
+            }
+        }
     }
 
     /*
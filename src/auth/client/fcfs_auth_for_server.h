@@ -20,6 +20,7 @@
 #include "fcfs_auth_client.h"
 #include "server_session.h"
 #include "session_sync.h"
+#include "validate_cache.h"
 
 #define fcfs_auth_for_server_init(auth, ini_ctx, cluster_filename) \
     fcfs_auth_for_server_init_ex(auth, ini_ctx, cluster_filename, NULL)
@@ -53,6 +54,9 @@ static inline int fcfs_auth_for_server_init_ex(FCFSAuthClientFullContext
         if ((result=session_sync_init()) != 0) {
             return result;
         }
+        if ((result=validate_cache_init()) != 0) {
+            return result;
+        }
     }
 
     return result;
@@ -18,6 +18,7 @@
 #include <limits.h>
 #include "fastcommon/shared_func.h"
 #include "fastcommon/logger.h"
+#include "fastcommon/fc_atomic.h"
 #include "sf/sf_proto.h"
 #include "sf/sf_global.h"
 #include "auth_proto.h"
@@ -25,16 +26,14 @@
 #include "server_session.h"
 #include "client_global.h"
 #include "client_proto.h"
+#include "validate_cache.h"
 #include "session_sync.h"
 
-typedef struct synced_session_entry {
-    char operation;
-    struct {
-        uint64_t id1;
-        uint64_t id2;
-    } session;
-    SessionSyncedFields fields;
-} SyncedSessionEntry;
+/* keep the synced sessions for resuming after disconnected, the kept
+ * sessions are NOT trusted until the resume completed */
+#define SESSION_SYNC_KEEP_SECONDS  10
+
+typedef FCFSAuthSessionPushEntry SyncedSessionEntry;
 
 typedef struct synced_session_array {
     int alloc;
@@ -45,6 +44,19 @@ typedef struct synced_session_array {
 
 static SyncedSessionArray session_array;
 
+/* the position of the session log applied */
+static struct {
+    int proto_version;  //the subscription format of the master
+    int64_t epoch;
+    int64_t version;    //the applied version, -1 for none
+    int64_t target;     //the master's version when subscribed
+    bool resumable;     //false when the snapshot not completed
+    time_t disconnect_time;  //0 for connected or the sessions cleared
+} sync_position = {FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V2, 0, -1, 0, false, 0};
+
+/* if the local sessions are up to date with the master */
+static volatile int session_synced = 0;
+
 static int synced_session_array_init(SyncedSessionArray *array)
 {
     int result;
@@ -94,61 +106,70 @@ static int check_realloc_session_array(SyncedSessionArray *array,
     return 0;
 }
 
-static int parse_session_push(SFResponseInfo *response)
+static int parse_session_push(SFResponseInfo *response, int64_t *version)
 {
     FCFSAuthProtoSessionPushRespBodyHeader *body_header;
-    FCFSAuthProtoSessionPushRespBodyPart *body_part;
+    FCFSAuthProtoSessionPushRespBodyHeaderV2 *header_v2;
     SyncedSessionEntry *entry;
     SyncedSessionEntry *end;
-    char *p;
+    const char *p;
+    const char *body_end;
+    uint64_t prev_id1;
     int count;
     int result;
 
-    body_header = (FCFSAuthProtoSessionPushRespBodyHeader *)
-        session_array.buffer.buff;
-    p = (char *)(body_header + 1);
-    count = buff2int(body_header->count);
+    body_end = session_array.buffer.buff + response->header.body_len;
+    if (sync_position.proto_version == FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V2) {
+        if (response->header.body_len < sizeof(
+                    FCFSAuthProtoSessionPushRespBodyHeaderV2))
+        {
+            response->error.length = sprintf(response->error.message,
+                    "body length: %d is too small",
+                    response->header.body_len);
+            return EINVAL;
+        }
+
+        header_v2 = (FCFSAuthProtoSessionPushRespBodyHeaderV2 *)
+            session_array.buffer.buff;
+        p = (const char *)(header_v2 + 1);
+        count = buff2int(header_v2->count);
+        *version = buff2long(header_v2->version);
+    } else {
+        body_header = (FCFSAuthProtoSessionPushRespBodyHeader *)
+            session_array.buffer.buff;
+        p = (const char *)(body_header + 1);
+        count = buff2int(body_header->count);
+        *version = 0;
+    }
+
     if ((result=check_realloc_session_array(
                     &session_array, count)) != 0)
     {
         return result;
     }
 
+    prev_id1 = 0;
     end = session_array.entries + count;
     for (entry=session_array.entries; entry<end; entry++) {
-        if ((p - session_array.buffer.buff) + sizeof(
-                    FCFSAuthProtoSessionPushRespBodyPart) >
-                response->header.body_len)
+        if (sync_position.proto_version ==
+                FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V2)
         {
-            response->error.length = sprintf(
-                    response->error.message,
-                    "body length: %d is too small",
+            result = fcfs_auth_unpack_session_push_entry(&p,
+                    body_end, &prev_id1, entry);
+        } else {
+            result = fcfs_auth_unpack_session_push_entry_v1(
+                    &p, body_end, entry);
+        }
+        if (result != 0) {
+            response->error.length = sprintf(response->error.message,
+                    "the %dth entry is malformed, body length: %d",
+                    (int)(entry - session_array.entries) + 1,
                     response->header.body_len);
             return EINVAL;
         }
-
-        body_part = (FCFSAuthProtoSessionPushRespBodyPart *)p;
-        entry->operation = body_part->operation;
-        entry->session.id1 = buff2long(body_part->session.id1);
-        entry->session.id2 = buff2long(body_part->session.id2);
-        if (entry->operation == FCFS_AUTH_SESSION_OP_TYPE_CREATE) {
-            entry->fields.user.id = buff2long(body_part->entry->user.id);
-            entry->fields.user.priv = buff2long(body_part->entry->user.priv);
-            entry->fields.pool.id = buff2long(body_part->entry->pool.id);
-            entry->fields.pool.available = body_part->entry->pool.available;
-            entry->fields.pool.privs.fdir = buff2int(
-                    body_part->entry->pool.privs.fdir);
-            entry->fields.pool.privs.fstore = buff2int(
-                    body_part->entry->pool.privs.fstore);
-
-            p += sizeof(FCFSAuthProtoSessionPushRespBodyPart) +
-                sizeof(FCFSAuthProtoSessionPushEntry);
-        } else {
-            p += sizeof(FCFSAuthProtoSessionPushRespBodyPart);
-        }
     }
 
-    if (response->header.body_len != (p - session_array.buffer.buff)) {
+    if (p != body_end) {
         response->error.length = sprintf(response->error.message,
                 "body length: %d != expect: %d",
                 response->header.body_len,
@@ -192,6 +213,9 @@ static void deal_session_array()
 
         session.id_info.part1.id = entry->session.id1;
         session.id_info.part2.id = entry->session.id2;
+
+        /* the privileges changed or the session removed */
+        validate_cache_remove(&session.id_info);
         if (entry->operation == FCFS_AUTH_SESSION_OP_TYPE_CREATE) {
             session.fields = &entry->fields;
             server_session_add(&session, publish);
@@ -201,25 +225,64 @@ static void deal_session_array()
     }
 }
 
+static void clear_synced_sessions()
+{
+    server_session_clear();
+
+    /* the revocations would be lost during the disconnection */
+    validate_cache_clear();
+}
+
+static inline void reset_sync_position()
+{
+    sync_position.epoch = 0;
+    sync_position.version = -1;
+    sync_position.target = 0;
+    sync_position.resumable = false;
+    sync_position.disconnect_time = 0;
+}
+
+static void update_sync_position(const int64_t version)
+{
+    if (version <= 0) {  //0 for the middle entries of the snapshot
+        return;
+    }
+
+    sync_position.version = version;
+    if (version >= sync_position.target) {
+        sync_position.resumable = true;
+        FC_ATOMIC_SET(session_synced, 1);
+    }
+}
+
 static int session_sync(ConnectionInfo *conn)
 {
     const int network_timeout = 2;
     int result;
+    int header_size;
+    int64_t version;
     SFResponseInfo response;
 
+    if (sync_position.proto_version == FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V2) {
+        header_size = sizeof(FCFSAuthProtoSessionPushRespBodyHeaderV2);
+    } else {
+        header_size = sizeof(FCFSAuthProtoSessionPushRespBodyHeader);
+    }
+
     response.error.length = 0;
     while (SF_G_CONTINUE_FLAG) {
         result = sf_recv_vary_response(conn, &response, network_timeout,
                 FCFS_AUTH_SERVICE_PROTO_SESSION_PUSH_REQ, &session_array.
-                buffer, sizeof(FCFSAuthProtoSessionPushRespBodyHeader));
+                buffer, header_size);
         if (result == 0) {
-            if ((result=parse_session_push(&response)) != 0) {
+            if ((result=parse_session_push(&response, &version)) != 0) {
                 if (response.error.length > 0) {
                     auth_log_network_error(&response, conn, result);
                 }
                 break;
             }
             deal_session_array();
+            update_sync_position(version);
         } else if (result == ETIMEDOUT) {
             if ((result=sf_active_test(conn, &response,
                             g_fcfs_auth_client_vars.client_ctx.
@@ -234,12 +297,103 @@ static int session_sync(ConnectionInfo *conn)
     }
 
     if (SF_G_CONTINUE_FLAG) {
-        server_session_clear();
+        /* the revocations during the disconnection can't be seen */
+        FC_ATOMIC_SET(session_synced, 0);
+        if (sync_position.proto_version ==
+                FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V2)
+        {
+            /* keep the sessions for a while to resume from the log */
+            sync_position.disconnect_time = g_current_time;
+        } else {
+            clear_synced_sessions();
+            reset_sync_position();
+
+            /* the master maybe upgraded */
+            sync_position.proto_version = FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V2;
+        }
     }
 
     return result;
 }
 
+static void check_clear_synced_sessions()
+{
+    if (sync_position.disconnect_time > 0 && g_current_time -
+            sync_position.disconnect_time > SESSION_SYNC_KEEP_SECONDS)
+    {
+        clear_synced_sessions();
+        reset_sync_position();
+    }
+}
+
+static int session_subscribe_v2(ConnectionInfo *conn)
+{
+    int64_t epoch;
+    int64_t version;
+    int count;
+    bool snapshot;
+    char formatted_ip[FORMATTED_IP_SIZE];
+    int result;
+
+    epoch = sync_position.epoch;
+    version = (sync_position.resumable ? sync_position.version : -1);
+    if ((result=fcfs_auth_client_proto_session_subscribe_v2(
+                    &g_fcfs_auth_client_vars.client_ctx, conn,
+                    &epoch, &version, &count, &snapshot)) != 0)
+    {
+        if (result == EINVAL) {
+            format_ip_address(conn->ip_addr, formatted_ip);
+            logWarning("file: "__FILE__", line: %d, "
+                    "the auth master %s:%u does NOT support the session "
+                    "subscription V2, fall back to V1", __LINE__,
+                    formatted_ip, conn->port);
+            sync_position.proto_version = FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V1;
+        }
+        return result;
+    }
+
+    if (snapshot) {
+        clear_synced_sessions();
+        sync_position.epoch = epoch;
+        sync_position.version = version;
+        sync_position.resumable = false;
+    }
+    sync_position.target = version;
+    sync_position.disconnect_time = 0;
+    if (count == 0) {  //nothing to push, synced already
+        sync_position.version = version;
+        sync_position.resumable = true;
+        FC_ATOMIC_SET(session_synced, 1);
+    }
+
+    logDebug("file: "__FILE__", line: %d, "
+            "session subscribe %s, master's epoch: %"PRId64", "
+            "version: %"PRId64", entry count: %d", __LINE__,
+            snapshot ? "snapshot" : "resume", epoch, version, count);
+    return 0;
+}
+
+static int session_subscribe(ConnectionInfo *conn)
+{
+    int result;
+
+    if (sync_position.proto_version == FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V2) {
+        return session_subscribe_v2(conn);
+    }
+
+    if ((result=fcfs_auth_client_proto_session_subscribe(
+                    &g_fcfs_auth_client_vars.client_ctx, conn)) != 0)
+    {
+        return result;
+    }
+
+    /* the V1 master pushes the whole sessions */
+    clear_synced_sessions();
+    reset_sync_position();
+    FC_ATOMIC_SET(session_synced, 1);
+    return 0;
+}
+
 static void *session_sync_thread_func(void *arg)
 {
     const bool shared = false;
@@ -256,13 +410,12 @@ static void *session_sync_thread_func(void *arg)
         if ((conn=cm->ops.get_master_connection(cm, 0,
                         shared, &result)) == NULL)
         {
+            check_clear_synced_sessions();
             sleep(1);
             continue;
         }
 
-        if ((result=fcfs_auth_client_proto_session_subscribe(
-                        &g_fcfs_auth_client_vars.client_ctx, conn)) == 0)
-        {
+        if ((result=session_subscribe(conn)) == 0) {
             session_sync(conn);
         } else if (result == ENOENT) {
             sleep(5);
@@ -284,6 +437,7 @@ static void *session_sync_thread_func(void *arg)
             sleep(10);
         }
 
+        check_clear_synced_sessions();
         cm->ops.close_connection(cm, conn);
         sleep(1);
     }
@@ -302,6 +456,11 @@ int session_sync_init()
     return 0;
 }
 
+bool session_sync_is_synced()
+{
+    return FC_ATOMIC_GET(session_synced) != 0;
+}
+
 int session_sync_start()
 {
     pthread_t tid;
@@ -17,6 +17,8 @@
 #ifndef _FCFS_AUTH_SESSION_SYNC_H
 #define _FCFS_AUTH_SESSION_SYNC_H
 
+#include "fastcommon/common_define.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -25,6 +27,10 @@ int session_sync_init();
 
 int session_sync_start();
 
+/* if the synced sessions are up to date with the auth master,
+ * false during the disconnection and before the resume completed */
+bool session_sync_is_synced();
+
 #ifdef __cplusplus
 }
 #endif
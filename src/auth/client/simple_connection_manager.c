@@ -17,6 +17,7 @@
 #include <limits.h>
 #include "fastcommon/shared_func.h"
 #include "fastcommon/logger.h"
+#include "fastcommon/pthread_func.h"
 #include "fastcommon/connection_pool.h"
 #include "client_global.h"
 #include "client_func.h"
@@ -237,15 +238,31 @@ static void copy_to_server_group_array(FCFSAuthClientContext *client_ctx,
     */
 }
 
-int fcfs_auth_simple_connection_manager_init(FCFSAuthClientContext *client_ctx,
-        SFConnectionManager *cm, const int server_group_index)
+static int init_connection_pool(FCFSAuthCMSimpleExtra *extra,
+        FCFSAuthClientContext *client_ctx, SFConnectionManager *cm,
+        const int server_count)
 {
     const int max_count_per_entry = 0;
     const int max_idle_time = 3600;
+    int htable_init_capacity;
+
+    htable_init_capacity = 4 * server_count;
+    if (htable_init_capacity < 256) {
+        htable_init_capacity = 256;
+    }
+    return conn_pool_init_ex1(&extra->cpool, client_ctx->common_cfg.
+            connect_timeout, max_count_per_entry, max_idle_time,
+            htable_init_capacity, NULL, client_ctx,
+            sf_cm_validate_connection_callback, cm,
+            sizeof(SFConnectionParameters), NULL);
+}
+
+int fcfs_auth_simple_connection_manager_init(FCFSAuthClientContext *client_ctx,
+        SFConnectionManager *cm, const int server_group_index)
+{
     FCFSAuthCMSimpleExtra *extra;
     FCFSAuthServerGroup *cluster_sarray;
     int server_count;
-    int htable_init_capacity;
     int result;
 
     cluster_sarray = (FCFSAuthServerGroup *)fc_malloc(
@@ -268,15 +285,8 @@ int fcfs_auth_simple_connection_manager_init(FCFSAuthClientContext *client_ctx,
     }
     memset(extra, 0, sizeof(FCFSAuthCMSimpleExtra));
 
-    htable_init_capacity = 4 * server_count;
-    if (htable_init_capacity < 256) {
-        htable_init_capacity = 256;
-    }
-    if ((result=conn_pool_init_ex1(&extra->cpool, client_ctx->common_cfg.
-                    connect_timeout, max_count_per_entry, max_idle_time,
-                    htable_init_capacity, NULL, client_ctx,
-                    sf_cm_validate_connection_callback, cm,
-                    sizeof(SFConnectionParameters), NULL)) != 0)
+    if ((result=init_connection_pool(extra, client_ctx,
+                    cm, server_count)) != 0)
     {
         return result;
     }
@@ -313,3 +323,33 @@ void fcfs_auth_simple_connection_manager_destroy(SFConnectionManager *cm)
         extra->cluster_sarray = NULL;
     }
 }
+
+void fcfs_auth_simple_connection_manager_fork_prepare(SFConnectionManager *cm)
+{
+    FCFSAuthCMSimpleExtra *extra;
+
+    extra = (FCFSAuthCMSimpleExtra *)cm->extra;
+    PTHREAD_MUTEX_LOCK(&extra->cpool.lock);
+}
+
+void fcfs_auth_simple_connection_manager_fork_parent(SFConnectionManager *cm)
+{
+    FCFSAuthCMSimpleExtra *extra;
+
+    extra = (FCFSAuthCMSimpleExtra *)cm->extra;
+    PTHREAD_MUTEX_UNLOCK(&extra->cpool.lock);
+}
+
+int fcfs_auth_simple_connection_manager_fork_child(SFConnectionManager *cm)
+{
+    FCFSAuthCMSimpleExtra *extra;
+
+    extra = (FCFSAuthCMSimpleExtra *)cm->extra;
+    PTHREAD_MUTEX_UNLOCK(&extra->cpool.lock);
+
+    /* the connections are shared with the parent process */
+    extra->master_cache.valid = false;
+    conn_pool_destroy(&extra->cpool);
+    return init_connection_pool(extra, extra->client_ctx,
+            cm, extra->cluster_sarray->count);
+}
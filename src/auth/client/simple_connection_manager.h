@@ -27,6 +27,15 @@ int fcfs_auth_simple_connection_manager_init(FCFSAuthClientContext *client_ctx,
 
 void fcfs_auth_simple_connection_manager_destroy(SFConnectionManager *cm);
 
+/* the pool lock is held across fork, the connections inherited by
+ * the child process are dropped and the pool is initialized again
+ */
+void fcfs_auth_simple_connection_manager_fork_prepare(SFConnectionManager *cm);
+
+void fcfs_auth_simple_connection_manager_fork_parent(SFConnectionManager *cm);
+
+int fcfs_auth_simple_connection_manager_fork_child(SFConnectionManager *cm);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include "fastcommon/logger.h"
+#include "fastcommon/shared_func.h"
+#include "fastcommon/pthread_func.h"
+#include "fastcommon/fc_atomic.h"
+#include "sf/sf_global.h"
+#include "server_session.h"
+
+#define DEFAULT_CONFIG_FILENAME  "/etc/fastcfs/auth/server.conf"
+
+typedef struct {
+    int index;
+    volatile int64_t success_count;
+    volatile int64_t fail_count;
+} BenchThreadInfo;
+
+static struct {
+    const char *config_filename;
+    int session_count;
+    int thread_count;
+    int runtime;
+    int miss_ratio;  //percentage of the not exist sessions
+    bool with_writer;
+} cfg = {DEFAULT_CONFIG_FILENAME, 100000, 32, 10, 0, false};
+
+static struct {
+    volatile int running_count;
+    volatile char continue_flag;
+    volatile int64_t write_count;
+    ServerSessionIdInfo *sessions;
+    BenchThreadInfo *threads;
+} st = {0, 1, 0, NULL, NULL};
+
+static void usage(char *argv[])
+{
+    fprintf(stderr, "Usage: %s [-c config_filename=%s] "
+            "[-n session_count=%d] [-T threads=%d] [-t runtime=%d] "
+            "[-m miss_ratio=%d%%] [-w with a writer thread]\n\n"
+            "the config file should contain the item "
+            "session_config_filename\n", argv[0], DEFAULT_CONFIG_FILENAME,
+            cfg.session_count, cfg.thread_count, cfg.runtime,
+            cfg.miss_ratio);
+}
+
+static int parse_args(int argc, char *argv[])
+{
+    int ch;
+
+    while ((ch=getopt(argc, argv, "hc:n:T:t:m:w")) != -1) {
+        switch (ch) {
+            case 'h':
+                usage(argv);
+                return EINTR;
+            case 'c':
+                cfg.config_filename = optarg;
+                break;
+            case 'n':
+                cfg.session_count = strtol(optarg, NULL, 10);
+                break;
+            case 'T':
+                cfg.thread_count = strtol(optarg, NULL, 10);
+                break;
+            case 't':
+                cfg.runtime = strtol(optarg, NULL, 10);
+                break;
+            case 'm':
+                cfg.miss_ratio = strtol(optarg, NULL, 10);
+                break;
+            case 'w':
+                cfg.with_writer = true;
+                break;
+            default:
+                usage(argv);
+                return EINVAL;
+        }
+    }
+
+    if (cfg.session_count <= 0 || cfg.thread_count <= 0 ||
+            cfg.runtime <= 0 || cfg.miss_ratio < 0 ||
+            cfg.miss_ratio > 100)
+    {
+        usage(argv);
+        return EINVAL;
+    }
+
+    return 0;
+}
+
+static int add_sessions()
+{
+    SessionSyncedFields fields;
+    ServerSessionEntry holder;
+    ServerSessionEntry *entry;
+    int i;
+
+    if ((st.sessions=fc_malloc(sizeof(ServerSessionIdInfo) *
+                    cfg.session_count)) == NULL)
+    {
+        return ENOMEM;
+    }
+
+    memset(&fields, 0, sizeof(fields));
+    fields.user.priv = FCFS_AUTH_USER_PRIV_CREATE_POOL;
+    fields.pool.available = true;
+    fields.pool.privs.fdir = FCFS_AUTH_POOL_ACCESS_ALL;
+    fields.pool.privs.fstore = FCFS_AUTH_POOL_ACCESS_ALL;
+    holder.fields = &fields;
+    for (i=0; i<cfg.session_count; i++) {
+        holder.id_info.part1.id = holder.id_info.part2.id = 0;
+        if ((entry=server_session_add(&holder, false)) == NULL) {
+            return ENOMEM;
+        }
+        st.sessions[i] = entry->id_info;
+    }
+
+    return 0;
+}
+
+/* rand() takes a lock in glibc, use rand_r instead */
+static inline int rand_session_index(unsigned int *seed)
+{
+    return (int)((int64_t)rand_r(seed) * cfg.session_count /
+            ((int64_t)RAND_MAX + 1));
+}
+
+static void *reader_thread_func(void *arg)
+{
+    BenchThreadInfo *thread;
+    ServerSessionIdInfo session;
+    int64_t success_count;
+    int64_t fail_count;
+    unsigned int seed;
+
+    thread = (BenchThreadInfo *)arg;
+    seed = time(NULL) + thread->index;
+    success_count = fail_count = 0;
+    while (st.continue_flag) {
+        session = st.sessions[rand_session_index(&seed)];
+        if (cfg.miss_ratio > 0 && rand_r(&seed) % 100 < cfg.miss_ratio) {
+            session.part2.id++;
+        }
+
+        if (server_session_fdir_priv_granted(&session,
+                    FCFS_AUTH_POOL_ACCESS_READ) == 0)
+        {
+            success_count++;
+        } else {
+            fail_count++;
+        }
+
+        if ((success_count + fail_count) % 1024 == 0) {
+            FC_ATOMIC_SET(thread->success_count, success_count);
+            FC_ATOMIC_SET(thread->fail_count, fail_count);
+        }
+    }
+
+    FC_ATOMIC_SET(thread->success_count, success_count);
+    FC_ATOMIC_SET(thread->fail_count, fail_count);
+    __sync_sub_and_fetch(&st.running_count, 1);
+    return NULL;
+}
+
+/* remove and add back the sessions like the session sync does */
+static void *writer_thread_func(void *arg)
+{
+    SessionSyncedFields fields;
+    ServerSessionEntry holder;
+    unsigned int seed;
+    int index;
+
+    seed = time(NULL);
+    while (st.continue_flag) {
+        index = rand_session_index(&seed);
+        if (server_session_get_fields(st.sessions + index, &fields) != 0) {
+            continue;
+        }
+
+        server_session_delete(st.sessions + index);
+        holder.id_info = st.sessions[index];
+        holder.fields = &fields;
+        server_session_add(&holder, false);
+        __sync_add_and_fetch(&st.write_count, 1);
+        fc_sleep_ms(1);
+    }
+
+    __sync_sub_and_fetch(&st.running_count, 1);
+    return NULL;
+}
+
+static int start_threads()
+{
+    BenchThreadInfo *thread;
+    BenchThreadInfo *end;
+    pthread_t tid;
+    int result;
+
+    if ((st.threads=fc_malloc(sizeof(BenchThreadInfo) *
+                    cfg.thread_count)) == NULL)
+    {
+        return ENOMEM;
+    }
+    memset(st.threads, 0, sizeof(BenchThreadInfo) * cfg.thread_count);
+
+    end = st.threads + cfg.thread_count;
+    for (thread=st.threads; thread<end; thread++) {
+        thread->index = thread - st.threads;
+        __sync_add_and_fetch(&st.running_count, 1);
+        if ((result=fc_create_thread(&tid, reader_thread_func,
+                        thread, SF_G_THREAD_STACK_SIZE)) != 0)
+        {
+            return result;
+        }
+    }
+
+    if (cfg.with_writer) {
+        __sync_add_and_fetch(&st.running_count, 1);
+        if ((result=fc_create_thread(&tid, writer_thread_func,
+                        NULL, SF_G_THREAD_STACK_SIZE)) != 0)
+        {
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+static void output_stat(const int64_t time_used_ms)
+{
+    BenchThreadInfo *thread;
+    BenchThreadInfo *end;
+    int64_t success_count;
+    int64_t fail_count;
+    int64_t qps;
+    char count_buff[32];
+    char qps_buff[32];
+
+    success_count = fail_count = 0;
+    end = st.threads + cfg.thread_count;
+    for (thread=st.threads; thread<end; thread++) {
+        success_count += FC_ATOMIC_GET(thread->success_count);
+        fail_count += FC_ATOMIC_GET(thread->fail_count);
+    }
+
+    qps = (success_count + fail_count) * 1000 /
+        (time_used_ms > 0 ? time_used_ms : 1);
+    long_to_comma_str(success_count + fail_count, count_buff);
+    long_to_comma_str(qps, qps_buff);
+    printf("threads: %d, sessions: %d, lookups: %s, success: %"PRId64", "
+            "fail: %"PRId64", writes: %"PRId64", time used: %"PRId64" ms, "
+            "QPS: %s\n", cfg.thread_count, cfg.session_count, count_buff,
+            success_count, fail_count, FC_ATOMIC_GET(st.write_count),
+            time_used_ms, qps_buff);
+}
+
+int main(int argc, char *argv[])
+{
+    IniContext ini_context;
+    IniFullContext ini_ctx;
+    int64_t start_time_ms;
+    int result;
+
+    if ((result=parse_args(argc, argv)) != 0) {
+        return result == EINTR ? 0 : result;
+    }
+
+    log_init();
+    if ((result=iniLoadFromFile(cfg.config_filename, &ini_context)) != 0) {
+        logError("file: "__FILE__", line: %d, "
+                "load config file \"%s\" fail, ret code: %d",
+                __LINE__, cfg.config_filename, result);
+        return result;
+    }
+
+    FAST_INI_SET_FULL_CTX_EX(ini_ctx, cfg.config_filename,
+            NULL, &ini_context);
+    result = server_session_init(&ini_ctx);
+    iniFreeContext(&ini_context);
+    if (result != 0) {
+        return result;
+    }
+
+    if ((result=add_sessions()) != 0) {
+        return result;
+    }
+
+    start_time_ms = get_current_time_ms();
+    if ((result=start_threads()) != 0) {
+        return result;
+    }
+
+    sleep(cfg.runtime);
+    st.continue_flag = 0;
+    while (FC_ATOMIC_GET(st.running_count) > 0) {
+        fc_sleep_ms(10);
+    }
+
+    output_stat(get_current_time_ms() - start_time_ms);
+    return 0;
+}
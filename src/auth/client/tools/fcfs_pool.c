@@ -43,6 +43,8 @@ static struct {
 } privs;
 static string_t username = {0};
 static bool dryrun;
+static int page_size = 0;       //for option -l
+static FCFSAuthListCursor cursor = {0};  //for option -a
 
 static void usage(char *argv[])
 {
@@ -52,6 +54,7 @@ static void usage(char *argv[])
             "${admin_username}.key]\n"
             "\t[-d fastdir_access=rw]\n"
             "\t[-s faststore_access=rw]\n"
+            "\t[-l page_size=0] [-a after_cursor]\n"
             "\t<operation> [username] [pool_name] [quota]\n\n"
             "\tthe operations and following parameters: \n"
             "\t  create [pool_name] <quota> [%s]\n"
@@ -69,6 +72,9 @@ static void usage(char *argv[])
             "the pool name template in server.conf of the server side\n\n"
             "\t* the quota parameter is required for create and quota operations\n"
             "\t  the default unit of quota is GiB, %s for no limit\n\n"
+            "\t* plist and glist output one page when page_size > 0, "
+            "the cursor of the next page is printed\n"
+            "\t  when more entries exist, the cursor of glist is the pool id\n\n"
             "\tFastDIR and FastStore accesses are:\n"
             "\t  %c:  read only\n"
             "\t  %c:  write only\n"
@@ -266,10 +272,18 @@ static void output_gpools(FCFSAuthGrantedPoolArray *array)
     }
 }
 
+static inline void output_next_cursor(const bool is_last)
+{
+    if (!is_last) {
+        printf("\nnext cursor: %.*s\n", cursor.len, cursor.str);
+    }
+}
+
 static int list_spool(int argc, char *argv[])
 {
     struct fast_mpool_man mpool;
     FCFSAuthStoragePoolArray spool_array;
+    bool is_last;
     int result;
 
     if ((result=fast_mpool_init(&mpool, mpool_alloc_size_once,
@@ -279,11 +293,20 @@ static int list_spool(int argc, char *argv[])
     }
 
     fcfs_auth_spool_init_array(&spool_array);
-    if ((result=fcfs_auth_client_spool_list(&g_fcfs_auth_client_vars.
-                    client_ctx, &username, &spool.name, &limit,
-                    &mpool, &spool_array)) == 0)
-    {
+    if (page_size > 0 && spool.name.len == 0) {
+        result = fcfs_auth_client_spool_list_page(&g_fcfs_auth_client_vars.
+                client_ctx, &username, &cursor, page_size, &mpool,
+                &spool_array, &is_last);
+    } else {
+        is_last = true;
+        result = fcfs_auth_client_spool_list(&g_fcfs_auth_client_vars.
+                client_ctx, &username, &spool.name, &limit,
+                &mpool, &spool_array);
+    }
+
+    if (result == 0) {
         output_spools(&spool_array);
+        output_next_cursor(is_last);
     } else {
         fprintf(stderr, "list storage pool fail\n");
     }
@@ -297,6 +320,7 @@ static int list_gpool(int argc, char *argv[])
 {
     struct fast_mpool_man mpool;
     FCFSAuthGrantedPoolArray gpool_array;
+    bool is_last;
     int result;
 
     if ((result=fast_mpool_init(&mpool, mpool_alloc_size_once,
@@ -306,11 +330,20 @@ static int list_gpool(int argc, char *argv[])
     }
 
     fcfs_auth_granted_init_array(&gpool_array);
-    if ((result=fcfs_auth_client_gpool_list(&g_fcfs_auth_client_vars.
-                    client_ctx, &username, &spool.name, &limit,
-                    &mpool, &gpool_array)) == 0)
-    {
+    if (page_size > 0 && spool.name.len == 0) {
+        result = fcfs_auth_client_gpool_list_page(&g_fcfs_auth_client_vars.
+                client_ctx, &username, &cursor, page_size, &mpool,
+                &gpool_array, &is_last);
+    } else {
+        is_last = true;
+        result = fcfs_auth_client_gpool_list(&g_fcfs_auth_client_vars.
+                client_ctx, &username, &spool.name, &limit,
+                &mpool, &gpool_array);
+    }
+
+    if (result == 0) {
         output_gpools(&gpool_array);
+        output_next_cursor(is_last);
     } else {
         fprintf(stderr, "list storage pool fail\n");
     }
@@ -345,7 +378,7 @@ int main(int argc, char *argv[])
             "/etc/fastcfs/auth/keys/${username}.key");
     FC_SET_STRING_NULL(privs.fdir);
     FC_SET_STRING_NULL(privs.fstore);
-    while ((ch=getopt(argc, argv, "hc:u:k:d:s:")) != -1) {
+    while ((ch=getopt(argc, argv, "hc:u:k:d:s:l:a:")) != -1) {
         switch (ch) {
             case 'h':
                 usage(argv);
@@ -365,6 +398,14 @@ int main(int argc, char *argv[])
             case 's':
                 FC_SET_STRING(privs.fstore, optarg);
                 break;
+            case 'l':
+                page_size = strtol(optarg, NULL, 10);
+                break;
+            case 'a':
+                if (fcfs_auth_set_list_cursor(optarg, &cursor) != 0) {
+                    return EINVAL;
+                }
+                break;
             default:
                 usage(argv);
                 return 1;
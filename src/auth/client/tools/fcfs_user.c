@@ -34,6 +34,8 @@ static int current_index;
 static FCFSAuthUserInfo user;
 static bool priv_set = false;
 static bool confirmed = false;  //for option -y
+static int page_size = 0;       //for option -l
+static FCFSAuthListCursor cursor = {0};  //for option -a
 
 static void usage(char *argv[])
 {
@@ -50,7 +52,8 @@ static void usage(char *argv[])
             "[-y]: regenerate user's secret key\n"
             "\t  grant <username>, the option <-p priviledges> is required\n"
             "\t  delete | remove <username>\n"
-            "\t  list [username]\n\n"
+            "\t  list [username] [-l page_size] [-a after_username]: "
+            "list one page of users when page_size > 0\n\n"
             "\t[user_secret_key_filename]: specify the filename to store the "
             "generated secret key of the user\n"
             "\t[priviledges]: the granted priviledges seperate by comma, "
@@ -194,6 +197,7 @@ static int list_user(int argc, char *argv[])
 {
     struct fast_mpool_man mpool;
     FCFSAuthUserArray user_array;
+    bool is_last;
     int result;
 
     if ((result=fast_mpool_init(&mpool, mpool_alloc_size_once,
@@ -203,11 +207,21 @@ static int list_user(int argc, char *argv[])
     }
 
     fcfs_auth_user_init_array(&user_array);
-    if ((result=fcfs_auth_client_user_list(&g_fcfs_auth_client_vars.
-                    client_ctx, &user.name, &limit, &mpool,
-                    &user_array)) == 0)
-    {
+    if (page_size > 0 && user.name.len == 0) {
+        result = fcfs_auth_client_user_list_page(&g_fcfs_auth_client_vars.
+                client_ctx, &cursor, page_size, &mpool,
+                &user_array, &is_last);
+    } else {
+        is_last = true;
+        result = fcfs_auth_client_user_list(&g_fcfs_auth_client_vars.
+                client_ctx, &user.name, &limit, &mpool, &user_array);
+    }
+
+    if (result == 0) {
         output_users(&user_array);
+        if (!is_last) {
+            printf("\nnext cursor: %.*s\n", cursor.len, cursor.str);
+        }
     } else {
         fprintf(stderr, "list user fail\n");
     }
@@ -239,7 +253,7 @@ int main(int argc, char *argv[])
     FC_SET_STRING(admin.key_filename,
             "/etc/fastcfs/auth/keys/${username}.key");
     FC_SET_STRING_NULL(privs);
-    while ((ch=getopt(argc, argv, "hc:u:k:p:y")) != -1) {
+    while ((ch=getopt(argc, argv, "hc:u:k:p:l:a:y")) != -1) {
         switch (ch) {
             case 'h':
                 usage(argv);
@@ -259,6 +273,14 @@ int main(int argc, char *argv[])
             case 'y':
                 confirmed = true;
                 break;
+            case 'l':
+                page_size = strtol(optarg, NULL, 10);
+                break;
+            case 'a':
+                if (fcfs_auth_set_list_cursor(optarg, &cursor) != 0) {
+                    return EINVAL;
+                }
+                break;
             default:
                 usage(argv);
                 return 1;
@@ -172,3 +172,19 @@ const char *fcfs_auth_pool_access_to_string(const int priv, string_t *str)
     str->len = p - str->str;
     return str->str;
 }
+
+int fcfs_auth_set_list_cursor(const char *str, FCFSAuthListCursor *cursor)
+{
+    int len;
+
+    len = strlen(str);
+    if (len > NAME_MAX) {
+        fprintf(stderr, "cursor length: %d is too long, exceeds %d\n",
+                len, NAME_MAX);
+        return EINVAL;
+    }
+
+    memcpy(cursor->str, str, len);
+    cursor->len = len;
+    return 0;
+}
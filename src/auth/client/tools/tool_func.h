@@ -57,6 +57,8 @@ extern "C" {
 
     const char *fcfs_auth_pool_access_to_string(const int priv, string_t *str);
 
+    int fcfs_auth_set_list_cursor(const char *str, FCFSAuthListCursor *cursor);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdlib.h>
+#include "fastcommon/shared_func.h"
+#include "fastcommon/pthread_func.h"
+#include "fastcommon/sched_thread.h"
+#include "validate_cache.h"
+
+static FCFSAuthValidateCacheContext cache_ctx;
+
+#define VALIDATE_CACHE_HASH_CODE(session) \
+    ((session)->part1.id ^ (session)->part2.id)
+
+#define VALIDATE_CACHE_GET_SHARDING(hash_code) \
+    (cache_ctx.shardings + (hash_code) % \
+     FCFS_AUTH_VALIDATE_CACHE_SHARDING_COUNT)
+
+#define VALIDATE_CACHE_GET_BUCKET(sharding, hash_code) \
+    ((sharding)->buckets + ((hash_code) / \
+      FCFS_AUTH_VALIDATE_CACHE_SHARDING_COUNT) % cache_ctx.capacity)
+
+#define VALIDATE_CACHE_SESSION_EQUALS(s1, s2) \
+    ((s1)->part1.id == (s2)->part1.id && (s1)->part2.id == (s2)->part2.id)
+
+int validate_cache_init()
+{
+    FCFSAuthValidateCacheSharding *sharding;
+    FCFSAuthValidateCacheSharding *end;
+    int64_t bytes;
+    int result;
+
+    if (!g_server_session_cfg.validate_cache.enabled) {
+        return 0;
+    }
+
+    cache_ctx.max_count = g_server_session_cfg.validate_cache.max_count /
+        FCFS_AUTH_VALIDATE_CACHE_SHARDING_COUNT;
+    if (cache_ctx.max_count <= 0) {
+        cache_ctx.max_count = 1;
+    }
+    cache_ctx.capacity = cache_ctx.max_count;
+    bytes = sizeof(FCFSAuthValidateCacheEntry *) * cache_ctx.capacity;
+
+    end = cache_ctx.shardings + FCFS_AUTH_VALIDATE_CACHE_SHARDING_COUNT;
+    for (sharding=cache_ctx.shardings; sharding<end; sharding++) {
+        if ((result=init_pthread_lock(&sharding->lock)) != 0) {
+            return result;
+        }
+
+        sharding->buckets = (FCFSAuthValidateCacheEntry **)fc_malloc(bytes);
+        if (sharding->buckets == NULL) {
+            return ENOMEM;
+        }
+        memset(sharding->buckets, 0, bytes);
+        FC_INIT_LIST_HEAD(&sharding->lru);
+
+        if ((result=fast_mblock_init_ex1(&sharding->allocator,
+                        "validate_cache", sizeof(FCFSAuthValidateCacheEntry),
+                        1024, 0, NULL, NULL, false)) != 0)
+        {
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+static inline void remove_entry(FCFSAuthValidateCacheSharding *sharding,
+        FCFSAuthValidateCacheEntry **bucket,
+        FCFSAuthValidateCacheEntry *previous,
+        FCFSAuthValidateCacheEntry *entry)
+{
+    if (previous == NULL) {
+        *bucket = entry->next;
+    } else {
+        previous->next = entry->next;
+    }
+
+    fc_list_del_init(&entry->dlink);
+    fast_mblock_free_object(&sharding->allocator, entry);
+    sharding->count--;
+}
+
+static void remove_oldest_entry(FCFSAuthValidateCacheSharding *sharding)
+{
+    FCFSAuthValidateCacheEntry **bucket;
+    FCFSAuthValidateCacheEntry *oldest;
+    FCFSAuthValidateCacheEntry *previous;
+    FCFSAuthValidateCacheEntry *entry;
+    uint64_t hash_code;
+
+    if ((oldest=fc_list_first_entry(&sharding->lru,
+                    FCFSAuthValidateCacheEntry, dlink)) == NULL)
+    {
+        return;
+    }
+
+    hash_code = VALIDATE_CACHE_HASH_CODE(&oldest->session);
+    bucket = VALIDATE_CACHE_GET_BUCKET(sharding, hash_code);
+    previous = NULL;
+    entry = *bucket;
+    while (entry != NULL) {
+        if (entry == oldest) {
+            remove_entry(sharding, bucket, previous, entry);
+            return;
+        }
+        previous = entry;
+        entry = entry->next;
+    }
+}
+
+static inline FCFSAuthValidateCacheEntry *find_entry(
+        FCFSAuthValidateCacheEntry **bucket,
+        const ServerSessionIdInfo *session, const int priv_type,
+        const int64_t pool_id, const int64_t priv,
+        FCFSAuthValidateCacheEntry **previous)
+{
+    FCFSAuthValidateCacheEntry *entry;
+
+    *previous = NULL;
+    entry = *bucket;
+    while (entry != NULL) {
+        if (VALIDATE_CACHE_SESSION_EQUALS(&entry->session, session) &&
+                entry->priv_type == priv_type && entry->pool_id ==
+                pool_id && entry->priv == priv)
+        {
+            return entry;
+        }
+        *previous = entry;
+        entry = entry->next;
+    }
+
+    return NULL;
+}
+
+bool validate_cache_exists(const ServerSessionIdInfo *session,
+        const int priv_type, const int64_t pool_id, const int64_t priv)
+{
+    FCFSAuthValidateCacheSharding *sharding;
+    FCFSAuthValidateCacheEntry **bucket;
+    FCFSAuthValidateCacheEntry *previous;
+    FCFSAuthValidateCacheEntry *entry;
+    uint64_t hash_code;
+    bool found;
+
+    if (!g_server_session_cfg.validate_cache.enabled) {
+        return false;
+    }
+
+    hash_code = VALIDATE_CACHE_HASH_CODE(session);
+    sharding = VALIDATE_CACHE_GET_SHARDING(hash_code);
+    bucket = VALIDATE_CACHE_GET_BUCKET(sharding, hash_code);
+    PTHREAD_MUTEX_LOCK(&sharding->lock);
+    if ((entry=find_entry(bucket, session, priv_type,
+                    pool_id, priv, &previous)) != NULL)
+    {
+        if (entry->expires >= g_current_time) {
+            fc_list_move_tail(&entry->dlink, &sharding->lru);
+            found = true;
+        } else {
+            remove_entry(sharding, bucket, previous, entry);
+            found = false;
+        }
+    } else {
+        found = false;
+    }
+    PTHREAD_MUTEX_UNLOCK(&sharding->lock);
+
+    return found;
+}
+
+int validate_cache_add(const ServerSessionIdInfo *session,
+        const int priv_type, const int64_t pool_id, const int64_t priv)
+{
+    FCFSAuthValidateCacheSharding *sharding;
+    FCFSAuthValidateCacheEntry **bucket;
+    FCFSAuthValidateCacheEntry *previous;
+    FCFSAuthValidateCacheEntry *entry;
+    uint64_t hash_code;
+    int result;
+
+    if (!g_server_session_cfg.validate_cache.enabled) {
+        return 0;
+    }
+
+    hash_code = VALIDATE_CACHE_HASH_CODE(session);
+    sharding = VALIDATE_CACHE_GET_SHARDING(hash_code);
+    bucket = VALIDATE_CACHE_GET_BUCKET(sharding, hash_code);
+    PTHREAD_MUTEX_LOCK(&sharding->lock);
+    if ((entry=find_entry(bucket, session, priv_type,
+                    pool_id, priv, &previous)) == NULL)
+    {
+        if (sharding->count >= cache_ctx.max_count) {
+            remove_oldest_entry(sharding);
+        }
+
+        entry = (FCFSAuthValidateCacheEntry *)fast_mblock_alloc_object(
+                &sharding->allocator);
+        if (entry != NULL) {
+            entry->session = *session;
+            entry->priv_type = priv_type;
+            entry->pool_id = pool_id;
+            entry->priv = priv;
+            entry->next = *bucket;
+            *bucket = entry;
+            fc_list_add_tail(&entry->dlink, &sharding->lru);
+            sharding->count++;
+        }
+    } else {
+        fc_list_move_tail(&entry->dlink, &sharding->lru);
+    }
+
+    if (entry != NULL) {
+        entry->expires = g_current_time +
+            g_server_session_cfg.validate_cache.ttl;
+        result = 0;
+    } else {
+        result = ENOMEM;
+    }
+    PTHREAD_MUTEX_UNLOCK(&sharding->lock);
+
+    return result;
+}
+
+int validate_cache_remove(const ServerSessionIdInfo *session)
+{
+    FCFSAuthValidateCacheSharding *sharding;
+    FCFSAuthValidateCacheEntry **bucket;
+    FCFSAuthValidateCacheEntry *previous;
+    FCFSAuthValidateCacheEntry *entry;
+    FCFSAuthValidateCacheEntry *deleted;
+    uint64_t hash_code;
+    int count;
+
+    if (!g_server_session_cfg.validate_cache.enabled) {
+        return 0;
+    }
+
+    count = 0;
+    hash_code = VALIDATE_CACHE_HASH_CODE(session);
+    sharding = VALIDATE_CACHE_GET_SHARDING(hash_code);
+    bucket = VALIDATE_CACHE_GET_BUCKET(sharding, hash_code);
+    PTHREAD_MUTEX_LOCK(&sharding->lock);
+    previous = NULL;
+    entry = *bucket;
+    while (entry != NULL) {
+        if (VALIDATE_CACHE_SESSION_EQUALS(&entry->session, session)) {
+            deleted = entry;
+            entry = entry->next;
+            remove_entry(sharding, bucket, previous, deleted);
+            count++;
+        } else {
+            previous = entry;
+            entry = entry->next;
+        }
+    }
+    PTHREAD_MUTEX_UNLOCK(&sharding->lock);
+
+    return count;
+}
+
+void validate_cache_clear()
+{
+    FCFSAuthValidateCacheSharding *sharding;
+    FCFSAuthValidateCacheSharding *end;
+
+    if (!g_server_session_cfg.validate_cache.enabled) {
+        return;
+    }
+
+    end = cache_ctx.shardings + FCFS_AUTH_VALIDATE_CACHE_SHARDING_COUNT;
+    for (sharding=cache_ctx.shardings; sharding<end; sharding++) {
+        PTHREAD_MUTEX_LOCK(&sharding->lock);
+        while (sharding->count > 0) {
+            remove_oldest_entry(sharding);
+        }
+        PTHREAD_MUTEX_UNLOCK(&sharding->lock);
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _FCFS_AUTH_VALIDATE_CACHE_H
+#define _FCFS_AUTH_VALIDATE_CACHE_H
+
+#include "fastcommon/fc_list.h"
+#include "fastcommon/fast_mblock.h"
+#include "server_session.h"
+
+#define FCFS_AUTH_VALIDATE_CACHE_SHARDING_COUNT  61
+
+typedef struct fcfs_auth_validate_cache_entry {
+    ServerSessionIdInfo session;
+    int64_t pool_id;
+    int64_t priv;
+    int priv_type;
+    int expires;
+    struct fcfs_auth_validate_cache_entry *next;  //for hashtable chain
+    struct fc_list_head dlink;  //for LRU
+} FCFSAuthValidateCacheEntry;
+
+typedef struct fcfs_auth_validate_cache_sharding {
+    pthread_mutex_t lock;
+    int count;
+    FCFSAuthValidateCacheEntry **buckets;
+    struct fc_list_head lru;  //element: FCFSAuthValidateCacheEntry
+    struct fast_mblock_man allocator; //element: FCFSAuthValidateCacheEntry
+} FCFSAuthValidateCacheSharding;
+
+typedef struct fcfs_auth_validate_cache_context {
+    int capacity;   //bucket count per sharding
+    int max_count;  //max entries per sharding
+    FCFSAuthValidateCacheSharding shardings[
+        FCFS_AUTH_VALIDATE_CACHE_SHARDING_COUNT];
+} FCFSAuthValidateCacheContext;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the cache of the positive results of the session validation
+ * from the auth server, the cached results are removed when the
+ * session changed or removed by the session sync
+ */
+int validate_cache_init();
+
+bool validate_cache_exists(const ServerSessionIdInfo *session,
+        const int priv_type, const int64_t pool_id, const int64_t priv);
+
+int validate_cache_add(const ServerSessionIdInfo *session,
+        const int priv_type, const int64_t pool_id, const int64_t priv);
+
+/* remove all cached results of the session */
+int validate_cache_remove(const ServerSessionIdInfo *session);
+
+void validate_cache_clear();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -19,6 +19,152 @@ void fcfs_auth_proto_init()
 {
 }
 
+int fcfs_auth_pack_session_push_entry_v1(
+        const FCFSAuthSessionPushEntry *entry, char *buff)
+{
+    FCFSAuthProtoSessionPushRespBodyPart *body_part;
+
+    body_part = (FCFSAuthProtoSessionPushRespBodyPart *)buff;
+    long2buff(entry->session.id1, body_part->session.id1);
+    long2buff(entry->session.id2, body_part->session.id2);
+    body_part->operation = entry->operation;
+    if (entry->operation != FCFS_AUTH_SESSION_OP_TYPE_CREATE) {
+        return sizeof(FCFSAuthProtoSessionPushRespBodyPart);
+    }
+
+    long2buff(entry->fields.user.id, body_part->entry->user.id);
+    long2buff(entry->fields.user.priv, body_part->entry->user.priv);
+    long2buff(entry->fields.pool.id, body_part->entry->pool.id);
+    body_part->entry->pool.available = entry->fields.pool.available;
+    int2buff(entry->fields.pool.privs.fdir,
+            body_part->entry->pool.privs.fdir);
+    int2buff(entry->fields.pool.privs.fstore,
+            body_part->entry->pool.privs.fstore);
+    return FCFS_AUTH_SESSION_PUSH_ENTRY_V1_SIZE;
+}
+
+int fcfs_auth_unpack_session_push_entry_v1(const char **p,
+        const char *end, FCFSAuthSessionPushEntry *entry)
+{
+    FCFSAuthProtoSessionPushRespBodyPart *body_part;
+
+    if (*p + sizeof(FCFSAuthProtoSessionPushRespBodyPart) > end) {
+        return EINVAL;
+    }
+
+    body_part = (FCFSAuthProtoSessionPushRespBodyPart *)*p;
+    entry->operation = body_part->operation;
+    entry->session.id1 = buff2long(body_part->session.id1);
+    entry->session.id2 = buff2long(body_part->session.id2);
+    if (entry->operation != FCFS_AUTH_SESSION_OP_TYPE_CREATE) {
+        memset(&entry->fields, 0, sizeof(entry->fields));
+        *p += sizeof(FCFSAuthProtoSessionPushRespBodyPart);
+        return 0;
+    }
+
+    if (*p + FCFS_AUTH_SESSION_PUSH_ENTRY_V1_SIZE > end) {
+        return EINVAL;
+    }
+    entry->fields.user.id = buff2long(body_part->entry->user.id);
+    entry->fields.user.priv = buff2long(body_part->entry->user.priv);
+    entry->fields.pool.id = buff2long(body_part->entry->pool.id);
+    entry->fields.pool.available = body_part->entry->pool.available;
+    entry->fields.pool.privs.fdir = buff2int(
+            body_part->entry->pool.privs.fdir);
+    entry->fields.pool.privs.fstore = buff2int(
+            body_part->entry->pool.privs.fstore);
+    *p += FCFS_AUTH_SESSION_PUSH_ENTRY_V1_SIZE;
+    return 0;
+}
+
+#define ZIGZAG_ENCODE(v)  (((uint64_t)(v) << 1) ^ (uint64_t)((v) >> 63))
+#define ZIGZAG_DECODE(v)  ((int64_t)((v) >> 1) ^ -(int64_t)((v) & 1))
+
+int fcfs_auth_pack_session_push_entry(const FCFSAuthSessionPushEntry *entry,
+        uint64_t *prev_id1, char *buff)
+{
+    char *p;
+    int64_t delta;
+
+    p = buff;
+    *p++ = entry->operation;
+    delta = (int64_t)(entry->session.id1 - *prev_id1);
+    p += fcfs_auth_pack_varint(ZIGZAG_ENCODE(delta), p);
+    long2buff(entry->session.id2, p);
+    p += 8;
+    *prev_id1 = entry->session.id1;
+
+    if (entry->operation == FCFS_AUTH_SESSION_OP_TYPE_CREATE) {
+        p += fcfs_auth_pack_varint(entry->fields.user.id, p);
+        p += fcfs_auth_pack_varint(entry->fields.user.priv, p);
+        p += fcfs_auth_pack_varint(entry->fields.pool.id, p);
+        *p++ = entry->fields.pool.available;
+        p += fcfs_auth_pack_varint((uint32_t)
+                entry->fields.pool.privs.fdir, p);
+        p += fcfs_auth_pack_varint((uint32_t)
+                entry->fields.pool.privs.fstore, p);
+    }
+
+    return p - buff;
+}
+
+int fcfs_auth_unpack_session_push_entry(const char **p, const char *end,
+        uint64_t *prev_id1, FCFSAuthSessionPushEntry *entry)
+{
+    uint64_t v;
+    int result;
+
+    if (*p >= end) {
+        return EINVAL;
+    }
+    entry->operation = *(*p)++;
+    if ((result=fcfs_auth_unpack_varint(p, end, &v)) != 0) {
+        return result;
+    }
+    entry->session.id1 = *prev_id1 + (uint64_t)ZIGZAG_DECODE(v);
+    *prev_id1 = entry->session.id1;
+
+    if (*p + 8 > end) {
+        return EINVAL;
+    }
+    entry->session.id2 = buff2long(*p);
+    *p += 8;
+
+    if (entry->operation == FCFS_AUTH_SESSION_OP_TYPE_REMOVE) {
+        memset(&entry->fields, 0, sizeof(entry->fields));
+        return 0;
+    } else if (entry->operation != FCFS_AUTH_SESSION_OP_TYPE_CREATE) {
+        return EINVAL;
+    }
+
+    if ((result=fcfs_auth_unpack_varint(p, end, &v)) != 0) {
+        return result;
+    }
+    entry->fields.user.id = v;
+    if ((result=fcfs_auth_unpack_varint(p, end, &v)) != 0) {
+        return result;
+    }
+    entry->fields.user.priv = v;
+    if ((result=fcfs_auth_unpack_varint(p, end, &v)) != 0) {
+        return result;
+    }
+    entry->fields.pool.id = v;
+
+    if (*p >= end) {
+        return EINVAL;
+    }
+    entry->fields.pool.available = *(*p)++;
+    if ((result=fcfs_auth_unpack_varint(p, end, &v)) != 0) {
+        return result;
+    }
+    entry->fields.pool.privs.fdir = (uint32_t)v;
+    if ((result=fcfs_auth_unpack_varint(p, end, &v)) != 0) {
+        return result;
+    }
+    entry->fields.pool.privs.fstore = (uint32_t)v;
+    return 0;
+}
+
 const char *fcfs_auth_get_cmd_caption(const int cmd)
 {
     switch (cmd) {
@@ -38,6 +184,10 @@ const char *fcfs_auth_get_cmd_caption(const int cmd)
             return "SESSION_VALIDATE_REQ";
         case FCFS_AUTH_SERVICE_PROTO_SESSION_VALIDATE_RESP:
             return "SESSION_VALIDATE_RESP";
+        case FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_V2_REQ:
+            return "SESSION_SUBSCRIBE_V2_REQ";
+        case FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_V2_RESP:
+            return "SESSION_SUBSCRIBE_V2_RESP";
         case FCFS_AUTH_SERVICE_PROTO_USER_CREATE_REQ:
             return "USER_CREATE_REQ";
         case FCFS_AUTH_SERVICE_PROTO_USER_CREATE_RESP:
@@ -114,6 +264,10 @@ const char *fcfs_auth_get_cmd_caption(const int cmd)
             return "PRE_SET_NEXT_MASTER";
         case FCFS_AUTH_CLUSTER_PROTO_COMMIT_NEXT_MASTER:
             return "COMMIT_NEXT_MASTER";
+        case FCFS_AUTH_CLUSTER_PROTO_PRE_VOTE_REQ:
+            return "PRE_VOTE_REQ";
+        case FCFS_AUTH_CLUSTER_PROTO_PRE_VOTE_RESP:
+            return "PRE_VOTE_RESP";
         default:
             return sf_get_cmd_caption(cmd);
     }
@@ -29,6 +29,14 @@
 #define FCFS_AUTH_SERVICE_PROTO_SESSION_VALIDATE_REQ      15
 #define FCFS_AUTH_SERVICE_PROTO_SESSION_VALIDATE_RESP     16
 
+/* the subscription resumed from the session log, the push body
+ * of this subscriber is in the compact V2 format */
+#define FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_V2_REQ  17
+#define FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_V2_RESP 18
+
+#define FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V1   1
+#define FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V2   2
+
 #define FCFS_AUTH_SERVICE_PROTO_USER_CREATE_REQ           21
 #define FCFS_AUTH_SERVICE_PROTO_USER_CREATE_RESP          22
 #define FCFS_AUTH_SERVICE_PROTO_USER_LIST_REQ             23
@@ -71,6 +79,8 @@
 #define FCFS_AUTH_CLUSTER_PROTO_PING_MASTER_RESP         206
 #define FCFS_AUTH_CLUSTER_PROTO_PRE_SET_NEXT_MASTER      207  //notify next leader to other servers
 #define FCFS_AUTH_CLUSTER_PROTO_COMMIT_NEXT_MASTER       208  //commit next leader to other servers
+#define FCFS_AUTH_CLUSTER_PROTO_PRE_VOTE_REQ             209  //ask if the master lost
+#define FCFS_AUTH_CLUSTER_PROTO_PRE_VOTE_RESP            210
 
 typedef SFCommonProtoHeader  FCFSAuthProtoHeader;
 
@@ -108,6 +118,20 @@ typedef struct fcfs_auth_proto_session_subscribe_req {
     FCFSAuthProtoUserPasswdPair up_pair;
 } FCFSAuthProtoSessionSubscribeReq;
 
+typedef struct fcfs_auth_proto_session_subscribe_v2_req {
+    char epoch[8];    //the session log epoch of the last subscription
+    char version[8];  //the last applied session log version, -1 for none
+    FCFSAuthProtoUserPasswdPair up_pair;
+} FCFSAuthProtoSessionSubscribeV2Req;
+
+typedef struct fcfs_auth_proto_session_subscribe_v2_resp {
+    char epoch[8];    //the session log epoch of the master
+    char version[8];  //the current session log version of the master
+    char count[4];    //the entries queued for the snapshot or the resume
+    char snapshot;    //the subscriber should clear the sessions when true
+    char padding[3];
+} FCFSAuthProtoSessionSubscribeV2Resp;
+
 typedef struct fcfs_auth_proto_session_validate_req {
     union {
         char session_id[FCFS_AUTH_SESSION_ID_LEN];
@@ -153,6 +177,51 @@ typedef struct fcfs_auth_proto_session_push_resp_body_part {
     FCFSAuthProtoSessionPushEntry entry[0];
 } FCFSAuthProtoSessionPushRespBodyPart;
 
+/* the V2 body header is followed by count entries, each entry encoded as:
+ *   operation: 1 byte
+ *   id1: zigzag varint of the delta to the id1 of the previous entry
+ *   id2: 8 bytes
+ *   for create only: varint of user.id, user.priv and pool.id,
+ *                    1 byte pool.available,
+ *                    varint of pool.privs.fdir and pool.privs.fstore
+ */
+typedef struct fcfs_auth_proto_session_push_resp_body_header_v2 {
+    char count[4];
+    char padding[4];
+    char version[8];  //the session log version of the last entry
+} FCFSAuthProtoSessionPushRespBodyHeaderV2;
+
+#define FCFS_AUTH_SESSION_PUSH_ENTRY_V1_SIZE  \
+    (sizeof(FCFSAuthProtoSessionPushRespBodyPart) + \
+     sizeof(FCFSAuthProtoSessionPushEntry))
+
+#define FCFS_AUTH_SESSION_PUSH_ENTRY_MAX_SIZE  (1 + 10 + 8 + 3 * 10 + 1 + 2 * 5)
+
+#define FCFS_AUTH_SESSION_OP_TYPE_CREATE   'C'
+#define FCFS_AUTH_SESSION_OP_TYPE_REMOVE   'R'
+
+typedef struct session_synced_fields {
+    struct {
+        int64_t id;
+        int64_t priv;
+    } user;
+
+    struct {
+        int64_t id;
+        bool available;
+        FCFSAuthSPoolPriviledges privs;
+    } pool;
+} SessionSyncedFields;
+
+typedef struct fcfs_auth_session_push_entry {
+    char operation;
+    struct {
+        uint64_t id1;
+        uint64_t id2;
+    } session;
+    SessionSyncedFields fields;
+} FCFSAuthSessionPushEntry;
+
 typedef struct fcfs_auth_proto_user_create_req {
     char priv[8];
     FCFSAuthProtoUserPasswdPair up_pair;
@@ -162,6 +231,11 @@ typedef struct fcfs_auth_proto_user_passwd_req {
     FCFSAuthProtoUserPasswdPair up_pair;
 } FCFSAuthProtoUserPasswdReq;
 
+/* the list requests may be followed by the resume cursor (after the
+ * names) as FCFSAuthProtoNameInfo, the offset of the limit is ignored
+ * when the cursor is not empty. the list responses are followed by the
+ * cursor of the last entry after the body parts
+ */
 typedef struct fcfs_auth_proto_user_list_req {
     SFProtoLimitInfo limit;
     FCFSAuthProtoNameInfo username;
@@ -259,6 +333,17 @@ typedef struct fcfs_auth_proto_get_server_status_resp {
     char padding[3];
 } FCFSAuthProtoGetServerStatusResp;
 
+typedef struct fcfs_auth_proto_pre_vote_req {
+    char server_id[4];     //the requester server id
+    char candidate_id[4];  //the candidate server id for the next master
+    char config_sign[SF_CLUSTER_CONFIG_SIGN_LEN];
+} FCFSAuthProtoPreVoteReq;
+
+typedef struct fcfs_auth_proto_pre_vote_resp {
+    char granted;  //the responder lost the master too
+    char padding[7];
+} FCFSAuthProtoPreVoteResp;
+
 typedef struct fcfs_auth_proto_join_master_req {
     char server_id[4];     //the slave server id
     char padding[4];
@@ -330,6 +415,93 @@ static inline void fcfs_auth_pack_user_pool_pair(const string_t *username,
     }
 }
 
+static inline int fcfs_auth_pack_list_cursor(const string_t *cursor,
+        FCFSAuthProtoNameInfo *proto_cursor)
+{
+    proto_cursor->len = cursor->len;
+    if (cursor->len > 0) {
+        memcpy(proto_cursor->str, cursor->str, cursor->len);
+    }
+    return sizeof(FCFSAuthProtoNameInfo) + cursor->len;
+}
+
+static inline int fcfs_auth_parse_list_cursor(const char *p,
+        const char *end, string_t *cursor)
+{
+    const FCFSAuthProtoNameInfo *proto_cursor;
+
+    if (p >= end) {
+        FC_SET_STRING_EX(*cursor, "", 0);
+        return (p == end) ? 0 : EINVAL;  //without cursor when p == end
+    }
+
+    proto_cursor = (const FCFSAuthProtoNameInfo *)p;
+    if (p + sizeof(FCFSAuthProtoNameInfo) + proto_cursor->len != end) {
+        return EINVAL;
+    }
+    FC_SET_STRING_EX(*cursor, (char *)proto_cursor->str, proto_cursor->len);
+    return 0;
+}
+
+static inline int fcfs_auth_pack_varint(uint64_t v, char *buff)
+{
+    unsigned char *p;
+
+    p = (unsigned char *)buff;
+    while (v >= 0x80) {
+        *p++ = (v & 0x7F) | 0x80;
+        v >>= 7;
+    }
+    *p++ = v;
+    return (char *)p - buff;
+}
+
+static inline int fcfs_auth_unpack_varint(const char **p,
+        const char *end, uint64_t *v)
+{
+    const unsigned char *current;
+    int shift;
+
+    *v = 0;
+    current = (const unsigned char *)*p;
+    for (shift=0; shift<64; shift+=7) {
+        if ((const char *)current >= end) {
+            return EINVAL;
+        }
+
+        *v |= (uint64_t)(*current & 0x7F) << shift;
+        if ((*current++ & 0x80) == 0) {
+            *p = (const char *)current;
+            return 0;
+        }
+    }
+
+    return EINVAL;
+}
+
+/* pack the entry in the V1 format, the buff size should be
+ * >= FCFS_AUTH_SESSION_PUSH_ENTRY_V1_SIZE
+ *
+ * return the packed bytes
+ */
+int fcfs_auth_pack_session_push_entry_v1(
+        const FCFSAuthSessionPushEntry *entry, char *buff);
+
+/* return 0 for success, EINVAL for the malformed entry */
+int fcfs_auth_unpack_session_push_entry_v1(const char **p,
+        const char *end, FCFSAuthSessionPushEntry *entry);
+
+/* pack the entry to buff whose size >= FCFS_AUTH_SESSION_PUSH_ENTRY_MAX_SIZE,
+ * the prev_id1 should be set to 0 for the first entry of the batch
+ *
+ * return the packed bytes
+ */
+int fcfs_auth_pack_session_push_entry(const FCFSAuthSessionPushEntry *entry,
+        uint64_t *prev_id1, char *buff);
+
+/* return 0 for success, EINVAL for the malformed entry */
+int fcfs_auth_unpack_session_push_entry(const char **p, const char *end,
+        uint64_t *prev_id1, FCFSAuthSessionPushEntry *entry);
 
 #ifdef __cplusplus
 }
@@ -16,6 +16,7 @@
 #ifndef _FCFS_AUTH_TYPES_H
 #define _FCFS_AUTH_TYPES_H
 
+#include <limits.h>
 #include "fastcommon/common_define.h"
 #include "sf/sf_types.h"
 
@@ -135,6 +136,12 @@ typedef struct fcfs_auth_user_array {
     int alloc;
 } FCFSAuthUserArray;
 
+/* the opaque position to resume the listing, returned by the server */
+typedef struct fcfs_auth_list_cursor {
+    int len;  //0 for listing from the beginning
+    char str[NAME_MAX];
+} FCFSAuthListCursor;
+
 typedef struct {
     char filter_by;
     char is_online;
@@ -16,6 +16,7 @@
 
 #include <sys/stat.h>
 #include <limits.h>
+#include <sched.h>
 #include "fastcommon/shared_func.h"
 #include "fastcommon/pthread_func.h"
 #include "fastcommon/fast_mblock.h"
@@ -38,6 +39,26 @@
 #define SESSION_MAX_VALIDATE_WITHIN_FRESH_SECONDS     31536000
 #define SESSION_DEFAULT_VALIDATE_WITHIN_FRESH_SECONDS        5
 
+#define SESSION_MIN_VALIDATE_CACHE_TTL                1
+#define SESSION_MAX_VALIDATE_CACHE_TTL             3600
+#define SESSION_DEFAULT_VALIDATE_CACHE_TTL           10
+
+#define SESSION_MIN_VALIDATE_CACHE_MAX_COUNT       1024
+#define SESSION_MAX_VALIDATE_CACHE_MAX_COUNT   10000000
+#define SESSION_DEFAULT_VALIDATE_CACHE_MAX_COUNT  65536
+
+#define SESSION_MIN_SUBSCRIBE_LOG_CAPACITY         1024
+#define SESSION_MAX_SUBSCRIBE_LOG_CAPACITY     10000000
+#define SESSION_DEFAULT_SUBSCRIBE_LOG_CAPACITY    65536
+
+/* the lock-free readers retry when the chain changed during the read,
+ * and fall back to the mutex after the max retries */
+#define SESSION_LOCKLESS_READ_MAX_RETRIES             8
+#define SESSION_LOCKLESS_READ_MAX_STEPS            1024
+
+/* the removed entries are freed delay for the lock-free readers */
+#define SESSION_ENTRY_DELAY_FREE_SECONDS             10
+
 typedef struct {
     ServerSessionHashEntry **buckets;
     int capacity;
@@ -49,9 +70,14 @@ typedef struct {
     struct fast_mblock_man *allocators;
 } ServerSessionAllocatorArray;
 
+typedef struct {
+    pthread_mutex_t lock;  //for the writers
+    volatile unsigned int seq;  //odd when the writer in progress
+} ServerSessionLock;
+
 typedef struct {
     int count;
-    pthread_mutex_t *locks;
+    ServerSessionLock *locks;
 } ServerSessionLockArray;
 
 typedef struct {
@@ -68,7 +94,7 @@ static ServerSessionContext session_ctx = {0, 0, {0, 0, NULL}};
 
 #define SESSION_SET_HASHTABLE_LOCK(htable, session_id) \
     int32_t bucket_index;  \
-    pthread_mutex_t *lock; \
+    ServerSessionLock *lock; \
     bucket_index = session_id % (htable).capacity; \
     lock = session_ctx.lock_array.locks + (bucket_index %  \
             session_ctx.lock_array.count)
@@ -90,9 +116,20 @@ void server_session_cfg_to_string_ex(char *buff,
             g_server_session_cfg.hashtable_capacity,
             g_server_session_cfg.validate_key_filename.str);
     if (output_all) {
-        snprintf(buff + len, size - len,
-                ", validate_within_fresh_seconds: %d}",
-                g_server_session_cfg.validate_within_fresh_seconds);
+        len += snprintf(buff + len, size - len,
+                ", validate_within_fresh_seconds: %d, "
+                "subscribe_log_capacity: %d, validate_cache: {enabled: %d",
+                g_server_session_cfg.validate_within_fresh_seconds,
+                g_server_session_cfg.subscribe_log_capacity,
+                g_server_session_cfg.validate_cache.enabled);
+        if (g_server_session_cfg.validate_cache.enabled) {
+            snprintf(buff + len, size - len, ", ttl: %d s, "
+                    "max_count: %d}}", g_server_session_cfg.
+                    validate_cache.ttl, g_server_session_cfg.
+                    validate_cache.max_count);
+        } else {
+            snprintf(buff + len, size - len, "}}");
+        }
     } else {
         snprintf(buff + len, size - len, "}");
     }
@@ -179,6 +216,25 @@ static int do_load_session_cfg(const char *session_filename)
             SESSION_MIN_VALIDATE_WITHIN_FRESH_SECONDS,
             SESSION_MAX_VALIDATE_WITHIN_FRESH_SECONDS);
 
+    g_server_session_cfg.validate_cache.enabled = iniGetBoolValue(NULL,
+            "validate_cache_enabled", &ini_context, false);
+    g_server_session_cfg.validate_cache.ttl = iniGetIntCorrectValue(
+            &ini_ctx, "validate_cache_ttl",
+            SESSION_DEFAULT_VALIDATE_CACHE_TTL,
+            SESSION_MIN_VALIDATE_CACHE_TTL,
+            SESSION_MAX_VALIDATE_CACHE_TTL);
+    g_server_session_cfg.validate_cache.max_count = iniGetIntCorrectValue(
+            &ini_ctx, "validate_cache_max_count",
+            SESSION_DEFAULT_VALIDATE_CACHE_MAX_COUNT,
+            SESSION_MIN_VALIDATE_CACHE_MAX_COUNT,
+            SESSION_MAX_VALIDATE_CACHE_MAX_COUNT);
+
+    g_server_session_cfg.subscribe_log_capacity = iniGetIntCorrectValue(
+            &ini_ctx, "subscribe_log_capacity",
+            SESSION_DEFAULT_SUBSCRIBE_LOG_CAPACITY,
+            SESSION_MIN_SUBSCRIBE_LOG_CAPACITY,
+            SESSION_MAX_SUBSCRIBE_LOG_CAPACITY);
+
     g_server_session_cfg.shared_allocator_count =
         session_ctx.allocator_array.count;
     g_server_session_cfg.shared_lock_count = session_ctx.lock_array.count;
@@ -250,20 +306,21 @@ static int init_lock_array(ServerSessionLockArray *array)
 {
     int result;
     int bytes;
-    pthread_mutex_t *lock;
-    pthread_mutex_t *end;
+    ServerSessionLock *lock;
+    ServerSessionLock *end;
 
-    bytes = sizeof(pthread_mutex_t) * array->count;
-    array->locks = (pthread_mutex_t *)fc_malloc(bytes);
+    bytes = sizeof(ServerSessionLock) * array->count;
+    array->locks = (ServerSessionLock *)fc_malloc(bytes);
     if (array->locks == NULL) {
         return ENOMEM;
     }
 
     end = array->locks + array->count;
     for (lock=array->locks; lock<end; lock++) {
-        if ((result=init_pthread_lock(lock)) != 0) {
+        if ((result=init_pthread_lock(&lock->lock)) != 0) {
             return result;
         }
+        lock->seq = 0;
     }
 
     return 0;
@@ -328,6 +385,20 @@ static inline int compare_session_id(const ServerSessionIdInfo *s1,
     }
 }
 
+/* the writers modify the chain between the begin and the end
+ * with the mutex locked */
+static inline void session_write_begin(ServerSessionLock *lock)
+{
+    PTHREAD_MUTEX_LOCK(&lock->lock);
+    __sync_add_and_fetch(&lock->seq, 1);
+}
+
+static inline void session_write_end(ServerSessionLock *lock)
+{
+    __sync_add_and_fetch(&lock->seq, 1);
+    PTHREAD_MUTEX_UNLOCK(&lock->lock);
+}
+
 static inline ServerSessionHashEntry *session_htable_find(ServerSessionHashEntry
         **bucket, const ServerSessionIdInfo *session, ServerSessionHashEntry **prev)
 {
@@ -363,7 +434,8 @@ static inline ServerSessionHashEntry *session_htable_find(ServerSessionHashEntry
     return NULL;
 }
 
-static int session_htable_insert(ServerSessionHashEntry *se, const bool replace)
+static int session_htable_insert(ServerSessionHashEntry *se,
+        const bool replace, ServerSessionHashEntry **replaced)
 {
     int result;
     ServerSessionHashEntry *previous;
@@ -371,28 +443,32 @@ static int session_htable_insert(ServerSessionHashEntry *se, const bool replace)
 
     SESSION_SET_BUCKET_AND_LOCK(session_ctx.htable,
             se->entry.id_info.part1.id);
-    PTHREAD_MUTEX_LOCK(lock);
+    session_write_begin(lock);
     if ((found=session_htable_find(bucket, &se->entry.id_info,
                     &previous)) == NULL)
     {
         if (previous == NULL) {
             se->next = *bucket;
+            __sync_synchronize();
             *bucket = se;
         } else {
             se->next = previous->next;
+            __sync_synchronize();
             previous->next = se;
         }
+        *replaced = NULL;
         result = 0;
     } else {
         if (replace) {
-            found->entry = se->entry;
-            fast_mblock_free_object(se->allocator, se);
+            memcpy(found->entry.fields, se->entry.fields,
+                    session_ctx.fields_size);
+            *replaced = found;
             result = 0;
         } else {
             result = EEXIST;
         }
     }
-    PTHREAD_MUTEX_UNLOCK(lock);
+    session_write_end(lock);
 
     return result;
 }
@@ -404,6 +480,7 @@ ServerSessionEntry *server_session_add_ex(const ServerSessionEntry *entry,
     bool replace;
     struct fast_mblock_man *allocator;
     ServerSessionHashEntry *se;
+    ServerSessionHashEntry *replaced;
 
     allocator = session_ctx.allocator_array.allocators +
         (__sync_fetch_and_add(&session_ctx.allocator_array.next, 1) %
@@ -438,13 +515,17 @@ ServerSessionEntry *server_session_add_ex(const ServerSessionEntry *entry,
                     se->entry.id_info.part2.fields.rn);
                     */
 
-            result = session_htable_insert(se, replace);
+            result = session_htable_insert(se, replace, &replaced);
         } while (result == EEXIST);
     } else {
         replace = true;
         se->entry.id_info.part1.id = entry->id_info.part1.id;
         se->entry.id_info.part2.id = entry->id_info.part2.id;
-        session_htable_insert(se, replace);
+        session_htable_insert(se, replace, &replaced);
+        if (replaced != NULL) {  //the fields are updated in place
+            fast_mblock_free_object(se->allocator, se);
+            return &replaced->entry;
+        }
     }
 
     if (session_ctx.callbacks.add_func != NULL) {
@@ -453,98 +534,137 @@ ServerSessionEntry *server_session_add_ex(const ServerSessionEntry *entry,
     return &se->entry;
 }
 
-int server_session_get_fields(const ServerSessionIdInfo *session, void *fields)
+/* return 0 for found, ENOENT for not found, EAGAIN for too many steps
+ * which occurs when the chain is very long or changed by the writer */
+static inline int session_htable_lockless_find(ServerSessionHashEntry
+        **bucket, const ServerSessionIdInfo *session,
+        ServerSessionHashEntry **found)
+{
+    ServerSessionHashEntry *current;
+    int steps;
+    int sub;
+
+    steps = 0;
+    current = *bucket;
+    while (current != NULL) {
+        if (++steps > SESSION_LOCKLESS_READ_MAX_STEPS) {
+            return EAGAIN;
+        }
+
+        sub = compare_session_id(&current->entry.id_info, session);
+        if (sub == 0) {
+            *found = current;
+            return 0;
+        } else if (sub > 0) {
+            break;
+        }
+        current = current->next;
+    }
+
+    return ENOENT;
+}
+
+/* read the fields of the session without lock in the common case:
+ * the reader walks the chain and copies the fields, then checks the
+ * sequence of the lock stripe, retry when the writer changed it.
+ * the removed entries are freed delay, so the memory is always valid.
+ *
+ * return 0 for success, SF_SESSION_ERROR_NOT_EXIST for not found
+ */
+static int session_htable_read(const ServerSessionIdInfo *session,
+        void *fields, const int size)
 {
-    int result;
     ServerSessionHashEntry *previous;
     ServerSessionHashEntry *found;
+    unsigned int seq;
+    int retries;
+    int result;
 
     SESSION_SET_BUCKET_AND_LOCK(session_ctx.htable, session->part1.id);
-    PTHREAD_MUTEX_LOCK(lock);
+    for (retries=0; retries<SESSION_LOCKLESS_READ_MAX_RETRIES; retries++) {
+        seq = lock->seq;
+        if ((seq & 1) != 0) {  //the writer in progress
+            sched_yield();
+            continue;
+        }
+        __sync_synchronize();
+
+        if ((result=session_htable_lockless_find(bucket,
+                        session, &found)) == 0)
+        {
+            memcpy(fields, found->entry.fields, size);
+        } else if (result == ENOENT) {
+            result = SF_SESSION_ERROR_NOT_EXIST;
+        } else {
+            break;
+        }
+
+        __sync_synchronize();
+        if (lock->seq == seq) {
+            return result;
+        }
+    }
+
+    PTHREAD_MUTEX_LOCK(&lock->lock);
     if ((found=session_htable_find(bucket, session, &previous)) != NULL) {
-        memcpy(fields, found->entry.fields, session_ctx.fields_size);
+        memcpy(fields, found->entry.fields, size);
         result = 0;
     } else {
         result = SF_SESSION_ERROR_NOT_EXIST;
     }
-    PTHREAD_MUTEX_UNLOCK(lock);
+    PTHREAD_MUTEX_UNLOCK(&lock->lock);
 
     return result;
 }
 
+int server_session_get_fields(const ServerSessionIdInfo *session, void *fields)
+{
+    return session_htable_read(session, fields, session_ctx.fields_size);
+}
+
 int server_session_user_priv_granted(const ServerSessionIdInfo *session,
         const int64_t the_priv)
 {
     int result;
-    ServerSessionHashEntry *previous;
-    ServerSessionHashEntry *found;
-    SessionSyncedFields *fields;
+    SessionSyncedFields fields;
 
-    SESSION_SET_BUCKET_AND_LOCK(session_ctx.htable, session->part1.id);
-    PTHREAD_MUTEX_LOCK(lock);
-    if ((found=session_htable_find(bucket, session, &previous)) != NULL) {
-        fields = (SessionSyncedFields *)found->entry.fields;
-        if ((fields->user.priv & the_priv) == the_priv) {
-            result = 0;
-        } else {
-            result = EPERM;
-        }
-    } else {
-        result = SF_SESSION_ERROR_NOT_EXIST;
+    if ((result=session_htable_read(session, &fields,
+                    sizeof(fields))) != 0)
+    {
+        return result;
     }
-    PTHREAD_MUTEX_UNLOCK(lock);
 
-    return result;
+    return (fields.user.priv & the_priv) == the_priv ? 0 : EPERM;
 }
 
 int server_session_fstore_priv_granted(const ServerSessionIdInfo *session,
         const int the_priv)
 {
     int result;
-    ServerSessionHashEntry *previous;
-    ServerSessionHashEntry *found;
-    SessionSyncedFields *fields;
+    SessionSyncedFields fields;
 
-    SESSION_SET_BUCKET_AND_LOCK(session_ctx.htable, session->part1.id);
-    PTHREAD_MUTEX_LOCK(lock);
-    if ((found=session_htable_find(bucket, session, &previous)) != NULL) {
-        fields = (SessionSyncedFields *)found->entry.fields;
-        if ((fields->pool.privs.fstore & the_priv) == the_priv) {
-            result = 0;
-        } else {
-            result = EPERM;
-        }
-    } else {
-        result = SF_SESSION_ERROR_NOT_EXIST;
+    if ((result=session_htable_read(session, &fields,
+                    sizeof(fields))) != 0)
+    {
+        return result;
     }
-    PTHREAD_MUTEX_UNLOCK(lock);
 
-    return result;
+    return (fields.pool.privs.fstore & the_priv) == the_priv ? 0 : EPERM;
 }
 
 int server_session_fdir_priv_granted(const ServerSessionIdInfo *session,
         const int the_priv)
 {
     int result;
-    ServerSessionHashEntry *previous;
-    ServerSessionHashEntry *found;
-    SessionSyncedFields *fields;
+    SessionSyncedFields fields;
 
-    SESSION_SET_BUCKET_AND_LOCK(session_ctx.htable, session->part1.id);
-    PTHREAD_MUTEX_LOCK(lock);
-    if ((found=session_htable_find(bucket, session, &previous)) != NULL) {
-        fields = (SessionSyncedFields *)found->entry.fields;
-        if ((fields->pool.privs.fdir & the_priv) == the_priv) {
-            result = 0;
-        } else {
-            result = EPERM;
-        }
-    } else {
-        result = SF_SESSION_ERROR_NOT_EXIST;
+    if ((result=session_htable_read(session, &fields,
+                    sizeof(fields))) != 0)
+    {
+        return result;
     }
-    PTHREAD_MUTEX_UNLOCK(lock);
 
-    return result;
+    return (fields.pool.privs.fdir & the_priv) == the_priv ? 0 : EPERM;
 }
 
 static inline void free_hash_entry(ServerSessionHashEntry *entry)
@@ -553,7 +673,8 @@ static inline void free_hash_entry(ServerSessionHashEntry *entry)
         session_ctx.callbacks.del_func(&entry->entry);
     }
 
-    fast_mblock_free_object(entry->allocator, entry);
+    fast_mblock_delay_free_object(entry->allocator, entry,
+            SESSION_ENTRY_DELAY_FREE_SECONDS);
 }
 
 int server_session_delete(const ServerSessionIdInfo *session)
@@ -562,7 +683,7 @@ int server_session_delete(const ServerSessionIdInfo *session)
     ServerSessionHashEntry *found;
 
     SESSION_SET_BUCKET_AND_LOCK(session_ctx.htable, session->part1.id);
-    PTHREAD_MUTEX_LOCK(lock);
+    session_write_begin(lock);
     if ((found=session_htable_find(bucket, session, &previous)) != NULL) {
         if (previous == NULL) {
             *bucket = (*bucket)->next;
@@ -570,7 +691,7 @@ int server_session_delete(const ServerSessionIdInfo *session)
             previous->next = found->next;
         }
     }
-    PTHREAD_MUTEX_UNLOCK(lock);
+    session_write_end(lock);
 
     if (found != NULL) {
         free_hash_entry(found);
@@ -601,7 +722,7 @@ void server_session_clear()
     ServerSessionHashEntry **end;
     ServerSessionHashChain keep;
     ServerSessionHashChain remove;
-    pthread_mutex_t *lock;
+    ServerSessionLock *lock;
     int64_t keep_count;
     int64_t remove_count;
 
@@ -611,7 +732,7 @@ void server_session_clear()
     for (bucket=session_ctx.htable.buckets; bucket<end; bucket++) {
         lock = session_ctx.lock_array.locks + ((bucket - session_ctx.
                     htable.buckets) % session_ctx.lock_array.count);
-        PTHREAD_MUTEX_LOCK(lock);
+        session_write_begin(lock);
         if (*bucket != NULL) {
             keep.head = keep.tail = NULL;
             remove.head = remove.tail = NULL;
@@ -638,7 +759,7 @@ void server_session_clear()
                 remove.tail->next = NULL;
             }
         }
-        PTHREAD_MUTEX_UNLOCK(lock);
+        session_write_end(lock);
 
         while (current != NULL) {
             deleted = current;
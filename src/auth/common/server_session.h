@@ -18,16 +18,19 @@
 #define _FCFS_AUTH_SERVER_SESSION_H
 
 #include "fastcommon/ini_file_reader.h"
-#include "auth_types.h"
-
-#define FCFS_AUTH_SESSION_OP_TYPE_CREATE   'C'
-#define FCFS_AUTH_SESSION_OP_TYPE_REMOVE   'R'
+#include "auth_proto.h"
 
 typedef struct server_session_config {
     int shared_allocator_count;
     int shared_lock_count;
     int hashtable_capacity;
     int validate_within_fresh_seconds;
+    struct {
+        bool enabled;
+        int ttl;        //in seconds
+        int max_count;  //max cached results
+    } validate_cache;
+    int subscribe_log_capacity;  //for the subscribers to resume
     string_t validate_key;
     string_t validate_key_filename;
     unsigned char validate_key_buff[FCFS_AUTH_PASSWD_LEN];
@@ -54,19 +57,6 @@ typedef struct server_session_id_info {
     } part2;
 } ServerSessionIdInfo;
 
-typedef struct session_synced_fields {
-    struct {
-        int64_t id;
-        int64_t priv;
-    } user;
-
-    struct {
-        int64_t id;
-        bool available;
-        FCFSAuthSPoolPriviledges privs;
-    } pool;
-} SessionSyncedFields;
-
 typedef struct server_session_entry {
     ServerSessionIdInfo id_info;
     void *fields;
@@ -159,29 +159,51 @@ static inline ServerSessionSubscriber *cluster_subscriber_queue_pop(
     return subscriber;
 }
 
-static int cluster_deal_session_subscribe(struct fast_task_info *task)
+static int cluster_deal_session_subscribe(struct fast_task_info *task,
+        const int proto_version)
 {
-    FCFSAuthProtoSessionSubscribeReq *req;
+    FCFSAuthProtoUserPasswdPair *up_pair;
+    FCFSAuthProtoSessionSubscribeV2Req *v2_req;
+    FCFSAuthProtoSessionSubscribeV2Resp *resp;
+    ServerSessionSubscribePosition position;
     const DBUserInfo *dbuser;
+    bool snapshot;
     char formatted_ip[FORMATTED_IP_SIZE];
     string_t username;
     string_t passwd;
+    int64_t last_version;
+    int fixed_size;
+    int count;
     int result;
 
-    if ((result=server_check_min_body_length(sizeof(
-                        FCFSAuthProtoSessionSubscribeReq) + 1)) != 0)
-    {
+    if (proto_version == FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V2) {
+        fixed_size = sizeof(FCFSAuthProtoSessionSubscribeV2Req);
+    } else {
+        fixed_size = sizeof(FCFSAuthProtoSessionSubscribeReq);
+    }
+    if ((result=server_check_min_body_length(fixed_size + 1)) != 0) {
         return result;
     }
 
-    req = (FCFSAuthProtoSessionSubscribeReq *)REQUEST.body;
-    FC_SET_STRING_EX(username, req->up_pair.username.str,
-            req->up_pair.username.len);
-    FC_SET_STRING_EX(passwd, req->up_pair.passwd,
-            FCFS_AUTH_PASSWD_LEN);
-    if ((result=server_expect_body_length(
-                    sizeof(FCFSAuthProtoSessionSubscribeReq)
-                    + username.len)) != 0)
+    if (proto_version == FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V2) {
+        v2_req = (FCFSAuthProtoSessionSubscribeV2Req *)REQUEST.body;
+        up_pair = &v2_req->up_pair;
+        position.epoch = buff2long(v2_req->epoch);
+        position.version = buff2long(v2_req->version);
+    } else {
+        /* the legacy subscriber always fetches the whole sessions */
+        up_pair = &((FCFSAuthProtoSessionSubscribeReq *)
+                REQUEST.body)->up_pair;
+        position.epoch = 0;
+        position.version = -1;
+    }
+    last_version = position.version;
+
+    FC_SET_STRING_EX(username, up_pair->username.str,
+            up_pair->username.len);
+    FC_SET_STRING_EX(passwd, up_pair->passwd, FCFS_AUTH_PASSWD_LEN);
+    if ((result=server_expect_body_length(fixed_size +
+                    username.len)) != 0)
     {
         return result;
     }
@@ -216,18 +238,43 @@ static int cluster_deal_session_subscribe(struct fast_task_info *task)
 
 
     SESSION_SUBSCRIBER->nio.task = task;
-    session_subscribe_register(SESSION_SUBSCRIBER);
+    SESSION_SUBSCRIBER->proto_version = proto_version;
+    if ((result=session_subscribe_register(SESSION_SUBSCRIBER,
+                    &position, &snapshot, &count)) != 0)
+    {
+        session_subscribe_release(SESSION_SUBSCRIBER);
+        SESSION_SUBSCRIBER = NULL;
+        RESPONSE.error.length = sprintf(RESPONSE.error.message,
+                "session subscribe register fail");
+        return result;
+    }
     if (!fc_queue_empty(&SESSION_SUBSCRIBER->queue)) {
         cluster_subscriber_queue_push_ex(SESSION_SUBSCRIBER, false);
     }
 
     format_ip_address(task->client_ip, formatted_ip);
     logInfo("file: "__FILE__", line: %d, "
-            "session subscriber %s:%u joined", __LINE__,
-            formatted_ip, task->port);
+            "session subscriber %s:%u joined, proto version: %d, "
+            "%s from version: %"PRId64", entry count: %d", __LINE__,
+            formatted_ip, task->port, proto_version, snapshot ?
+            "snapshot" : "resume", (snapshot ? position.version :
+                last_version), count);
 
     SERVER_TASK_TYPE = AUTH_SERVER_TASK_TYPE_SUBSCRIBE;
-    RESPONSE.header.cmd = FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_RESP;
+    if (proto_version == FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V2) {
+        resp = (FCFSAuthProtoSessionSubscribeV2Resp *)
+            SF_PROTO_SEND_BODY(task);
+        long2buff(position.epoch, resp->epoch);
+        long2buff(position.version, resp->version);
+        int2buff(count, resp->count);
+        resp->snapshot = (snapshot ? 1 : 0);
+        memset(resp->padding, 0, sizeof(resp->padding));
+        RESPONSE.header.body_len = sizeof(*resp);
+        RESPONSE.header.cmd = FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_V2_RESP;
+        TASK_ARG->context.common.response_done = true;
+    } else {
+        RESPONSE.header.cmd = FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_RESP;
+    }
     return 0;
 }
 
@@ -377,6 +424,43 @@ static int cluster_deal_get_server_status(struct fast_task_info *task)
     return 0;
 }
 
+static int cluster_deal_pre_vote(struct fast_task_info *task)
+{
+    int result;
+    int server_id;
+    int candidate_id;
+    FCFSAuthProtoPreVoteReq *req;
+    FCFSAuthProtoPreVoteResp *resp;
+    FCFSAuthClusterServerInfo *master;
+
+    if ((result=server_expect_body_length(sizeof(
+                        FCFSAuthProtoPreVoteReq))) != 0)
+    {
+        return result;
+    }
+
+    req = (FCFSAuthProtoPreVoteReq *)REQUEST.body;
+    server_id = buff2int(req->server_id);
+    if ((result=cluster_check_config_sign(task, server_id,
+                    req->config_sign)) != 0)
+    {
+        return result;
+    }
+
+    /* grant when I lost the master too or the candidate is my master */
+    candidate_id = buff2int(req->candidate_id);
+    master = CLUSTER_MASTER_ATOM_PTR;
+    resp = (FCFSAuthProtoPreVoteResp *)SF_PROTO_SEND_BODY(task);
+    memset(resp, 0, sizeof(*resp));
+    resp->granted = fcfs_vote_election_pre_vote_grant((master != NULL ?
+                master->server->id : 0), candidate_id);
+
+    RESPONSE.header.body_len = sizeof(FCFSAuthProtoPreVoteResp);
+    RESPONSE.header.cmd = FCFS_AUTH_CLUSTER_PROTO_PRE_VOTE_RESP;
+    TASK_CTX.common.response_done = true;
+    return 0;
+}
+
 static int cluster_deal_join_master(struct fast_task_info *task)
 {
     int result;
@@ -505,7 +589,9 @@ static int cluster_process(struct fast_task_info *task)
 
     cmd = REQUEST.header.cmd;
     if (!MYSELF_IS_MASTER) {
-        if (cmd == FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_REQ) {
+        if (cmd == FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_REQ ||
+                cmd == FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_V2_REQ)
+        {
             RESPONSE.error.length = sprintf(
                     RESPONSE.error.message,
                     "i am not master");
@@ -535,11 +621,17 @@ static int cluster_process(struct fast_task_info *task)
             RESPONSE.header.cmd = SF_PROTO_ACTIVE_TEST_RESP;
             return sf_proto_deal_active_test(task, &REQUEST, &RESPONSE);
         case FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_REQ:
-            return  cluster_deal_session_subscribe(task);
+            return cluster_deal_session_subscribe(task,
+                    FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V1);
+        case FCFS_AUTH_SERVICE_PROTO_SESSION_SUBSCRIBE_V2_REQ:
+            return cluster_deal_session_subscribe(task,
+                    FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V2);
         case FCFS_AUTH_SERVICE_PROTO_SESSION_VALIDATE_REQ:
             return cluster_deal_session_validate(task);
         case FCFS_AUTH_CLUSTER_PROTO_GET_SERVER_STATUS_REQ:
             return cluster_deal_get_server_status(task);
+        case FCFS_AUTH_CLUSTER_PROTO_PRE_VOTE_REQ:
+            return cluster_deal_pre_vote(task);
         case FCFS_AUTH_CLUSTER_PROTO_PRE_SET_NEXT_MASTER:
         case FCFS_AUTH_CLUSTER_PROTO_COMMIT_NEXT_MASTER:
             return cluster_deal_next_master(task);
@@ -605,9 +697,11 @@ static int cluster_deal_queue(AuthServerContext *server_context,
     ServerSessionSubscribeEntry *entry;
     FCFSAuthProtoHeader *proto_header;
     FCFSAuthProtoSessionPushRespBodyHeader *body_header;
-    FCFSAuthProtoSessionPushRespBodyPart *body_part;
+    FCFSAuthProtoSessionPushRespBodyHeaderV2 *header_v2;
+    uint64_t prev_id1;
     char *p;
     char *end;
+    int entry_max_size;
     int count;
     int result;
 
@@ -626,38 +720,33 @@ static int cluster_deal_queue(AuthServerContext *server_context,
     previous = NULL;
     entry = (ServerSessionSubscribeEntry *)qinfo.head;
     proto_header = (FCFSAuthProtoHeader *)task->send.ptr->data;
-    body_header = (FCFSAuthProtoSessionPushRespBodyHeader *)
-        (proto_header + 1);
-    p = (char *)(body_header + 1);
+    if (subscriber->proto_version == FCFS_AUTH_SESSION_SUBSCRIBE_PROTO_V2) {
+        header_v2 = (FCFSAuthProtoSessionPushRespBodyHeaderV2 *)
+            (proto_header + 1);
+        body_header = NULL;
+        p = (char *)(header_v2 + 1);
+        entry_max_size = FCFS_AUTH_SESSION_PUSH_ENTRY_MAX_SIZE;
+    } else {
+        body_header = (FCFSAuthProtoSessionPushRespBodyHeader *)
+            (proto_header + 1);
+        header_v2 = NULL;
+        p = (char *)(body_header + 1);
+        entry_max_size = FCFS_AUTH_SESSION_PUSH_ENTRY_V1_SIZE;
+    }
     end = SF_SEND_BUFF_END(task);
     count = 0;
+    prev_id1 = 0;
     while (entry != NULL) {
-        body_part = (FCFSAuthProtoSessionPushRespBodyPart *)p;
-        if (p + sizeof(FCFSAuthProtoSessionPushRespBodyPart) +
-            sizeof(FCFSAuthProtoSessionPushEntry) > end)
-        {
+        if (p + entry_max_size > end) {
             break;
         }
 
-        long2buff(entry->session.id1, body_part->session.id1);
-        long2buff(entry->session.id2, body_part->session.id2);
-        body_part->operation = entry->operation;
-        if (entry->operation == FCFS_AUTH_SESSION_OP_TYPE_CREATE) {
-            long2buff(entry->fields.user.id, body_part->entry->user.id);
-            long2buff(entry->fields.user.priv, body_part->entry->user.priv);
-            long2buff(entry->fields.pool.id, body_part->entry->pool.id);
-            body_part->entry->pool.available = entry->fields.pool.available;
-            int2buff(entry->fields.pool.privs.fdir,
-                    body_part->entry->pool.privs.fdir);
-            int2buff(entry->fields.pool.privs.fstore,
-                    body_part->entry->pool.privs.fstore);
-
-            p += sizeof(FCFSAuthProtoSessionPushRespBodyPart) +
-                sizeof(FCFSAuthProtoSessionPushEntry);
+        if (header_v2 != NULL) {
+            p += fcfs_auth_pack_session_push_entry(
+                    &entry->entry, &prev_id1, p);
         } else {
-            p += sizeof(FCFSAuthProtoSessionPushRespBodyPart);
+            p += fcfs_auth_pack_session_push_entry_v1(&entry->entry, p);
         }
-
         ++count;
         previous = entry;
         entry = entry->next;
@@ -675,9 +764,15 @@ static int cluster_deal_queue(AuthServerContext *server_context,
                 &subscriber->queue, &remain_qinfo);
         result = EAGAIN;
     }
+    if (header_v2 != NULL) {
+        int2buff(count, header_v2->count);
+        memset(header_v2->padding, 0, sizeof(header_v2->padding));
+        long2buff(previous->version, header_v2->version);
+    } else {
+        int2buff(count, body_header->count);
+    }
     session_subscribe_free_entries(qinfo.head);
 
-    int2buff(count, body_header->count);
     task->send.ptr->length = p - task->send.ptr->data;
     SF_PROTO_SET_HEADER(proto_header, FCFS_AUTH_SERVICE_PROTO_SESSION_PUSH_REQ,
             task->send.ptr->length - sizeof(FCFSAuthProtoHeader));
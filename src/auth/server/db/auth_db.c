@@ -21,20 +21,32 @@
 #include "fastcommon/uniq_skiplist.h"
 #include "fastcommon/fast_allocator.h"
 #include "fastcommon/fc_atomic.h"
+#include "fastcommon/pthread_func.h"
 #include "sf/sf_global.h"
 #include "../../common/auth_func.h"
 #include "../server_global.h"
 #include "dao/user.h"
 #include "dao/storage_pool.h"
 #include "dao/granted_pool.h"
+#include "dao/dao.h"
 #include "auth_db.h"
 
 #define SKIPLIST_INIT_LEVEL_COUNT   2
 
+/* stop watching the pool when its usage falls below the watch ratio
+ * by this percents
+ */
+#define POOL_QUOTA_UNWATCH_RATIO_GAP  5
+
 static int auth_db_init();
 
 typedef struct auth_db_context {
-    pthread_mutex_t lock;
+    /* the index of the users and pools is read mostly, the lookups and
+     * listings take the read lock, the modifications take the write lock.
+     * the quota and used bytes of the pools are accessed atomically
+     * without the lock
+     */
+    pthread_rwlock_t rwlock;
     struct fast_allocator_context name_acontext;
     bool inited;
 
@@ -46,6 +58,10 @@ typedef struct auth_db_context {
 
     struct {
         volatile int64_t auto_id;
+        struct {
+            pthread_mutex_t lock;
+            struct fc_list_head head;  //element: DBStoragePoolInfo
+        } watch;
         struct {
             UniqSkiplistFactory created;
             UniqSkiplistFactory granted;
@@ -65,6 +81,106 @@ typedef struct auth_db_context {
 
 static AuthDBContext adb_ctx;
 
+typedef struct auth_db_user_pools {
+    FCFSAuthStoragePoolInfo *spools;
+    FCFSAuthGrantedPoolInfo *gpools;
+    int spool_count;
+    int gpool_count;
+} AuthDBUserPools;
+
+struct auth_db_load_context;
+typedef struct auth_db_load_worker {
+    FDIRClientContext dao_ctx;    //the FastDIR client can't be shared
+    bool dao_inited;
+    struct fast_mpool_man mpool;  //for user passwd and pool name
+    FCFSAuthStoragePoolArray spool_array;
+    FCFSAuthGrantedPoolArray granted_array;
+    struct auth_db_load_context *lctx;
+} AuthDBLoadWorker;
+
+typedef struct auth_db_load_context {
+    AuthServerContext *server_ctx;
+    FCFSAuthUserArray *user_array;
+    AuthDBUserPools *user_pools;  //indexed by the user array
+    volatile int next_index;
+    volatile int running_count;
+    volatile int result;  //the first error
+    int worker_count;
+    AuthDBLoadWorker *workers;
+    pthread_lock_cond_pair_t lcp;
+} AuthDBLoadContext;
+
+static inline void adb_rdlock()
+{
+    int result;
+    if ((result=pthread_rwlock_rdlock(&adb_ctx.rwlock)) != 0) {
+        logError("file: "__FILE__", line: %d, "
+                "call pthread_rwlock_rdlock fail, "
+                "errno: %d, error info: %s",
+                __LINE__, result, STRERROR(result));
+    }
+}
+
+static inline void adb_wrlock()
+{
+    int result;
+    if ((result=pthread_rwlock_wrlock(&adb_ctx.rwlock)) != 0) {
+        logError("file: "__FILE__", line: %d, "
+                "call pthread_rwlock_wrlock fail, "
+                "errno: %d, error info: %s",
+                __LINE__, result, STRERROR(result));
+    }
+}
+
+static inline void adb_unlock()
+{
+    int result;
+    if ((result=pthread_rwlock_unlock(&adb_ctx.rwlock)) != 0) {
+        logError("file: "__FILE__", line: %d, "
+                "call pthread_rwlock_unlock fail, "
+                "errno: %d, error info: %s",
+                __LINE__, result, STRERROR(result));
+    }
+}
+
+static int init_rwlock()
+{
+    pthread_rwlockattr_t attr;
+    int result;
+
+    if ((result=pthread_rwlockattr_init(&attr)) != 0) {
+        return result;
+    }
+#ifdef __linux__
+    /* avoid the writers starved by the frequent lookups */
+    pthread_rwlockattr_setkind_np(&attr,
+            PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    result = pthread_rwlock_init(&adb_ctx.rwlock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+    if (result != 0) {
+        logError("file: "__FILE__", line: %d, "
+                "init rwlock fail, errno: %d, error info: %s",
+                __LINE__, result, STRERROR(result));
+    }
+    return result;
+}
+
+/* position the iterator after the key for the cursor based listing */
+static void skiplist_iterator_after(UniqSkiplist *sl,
+        void *key, UniqSkiplistIterator *it)
+{
+    UniqSkiplistNode *node;
+
+    node = uniq_skiplist_find_ge_node(sl, key);
+    if (node != NULL && sl->factory->compare_func(node->data, key) == 0) {
+        node = node->links[0];
+    }
+
+    it->current = (node != NULL) ? node : sl->factory->tail;
+    it->tail = sl->factory->tail;
+}
+
 static int user_compare(const DBUserInfo *user1, const DBUserInfo *user2)
 {
     return fc_string_compare(&user1->user.name, &user2->user.name);
@@ -116,7 +232,7 @@ static inline int init_name_allocators(
 
     FAST_ALLOCATOR_INIT_REGION(regions[0], 0, 256, 8, 1024);
     return fast_allocator_init_ex(name_acontext, "name", obj_size,
-            NULL, regions, NAME_REGION_COUNT, 0, 0.00, 0, false);
+            NULL, regions, NAME_REGION_COUNT, 0, 0.00, 0, true);
 }
 
 static int init_allocators()
@@ -159,6 +275,12 @@ static void free_storage_pool_func(UniqSkiplist *sl,
     DBStoragePoolInfo *dbspool;
 
     dbspool = (DBStoragePoolInfo *)ptr;
+    PTHREAD_MUTEX_LOCK(&adb_ctx.pool.watch.lock);
+    if (dbspool->watch.watched) {
+        dbspool->watch.watched = false;
+        fc_list_del_init(&dbspool->watch.dlink);
+    }
+    PTHREAD_MUTEX_UNLOCK(&adb_ctx.pool.watch.lock);
     uniq_skiplist_delete(adb_ctx.pool.sl_pairs.by_id.skiplist, dbspool);
     uniq_skiplist_delete(adb_ctx.pool.sl_pairs.by_name.skiplist, dbspool);
 
@@ -239,10 +361,15 @@ static int auth_db_init()
 {
     int result;
 
-    if ((result=init_pthread_lock(&adb_ctx.lock)) != 0) {
+    if ((result=init_rwlock()) != 0) {
         return result;
     }
 
+    if ((result=init_pthread_lock(&adb_ctx.pool.watch.lock)) != 0) {
+        return result;
+    }
+    FC_INIT_LIST_HEAD(&adb_ctx.pool.watch.head);
+
     if ((result=init_name_allocators(&adb_ctx.name_acontext)) != 0) {
         return result;
     }
@@ -265,7 +392,7 @@ void auth_db_destroy()
         destroy_skiplists();
         destroy_allocators();
         fast_allocator_destroy(&adb_ctx.name_acontext);
-        pthread_mutex_destroy(&adb_ctx.lock);
+        pthread_rwlock_destroy(&adb_ctx.rwlock);
         adb_ctx.inited = false;
     }
 }
@@ -331,7 +458,7 @@ static int user_create(AuthServerContext *server_ctx, DBUserInfo **dbuser,
         (*dbuser)->user.id = user->id;
     }
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_wrlock();
     (*dbuser)->user.status = user->status;
     if (need_insert) {
         if ((result=uniq_skiplist_insert(adb_ctx.user.sl_pair.
@@ -340,7 +467,7 @@ static int user_create(AuthServerContext *server_ctx, DBUserInfo **dbuser,
             adb_ctx.user.count++;
         }
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     return 0;
 }
@@ -352,14 +479,14 @@ int adb_user_create(AuthServerContext *server_ctx,
     int result;
     DBUserInfo *dbuser;
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     dbuser = user_get(server_ctx, &user->name);
     if (dbuser != NULL && dbuser->user.status == FCFS_AUTH_USER_STATUS_NORMAL) {
         result = EEXIST;
     } else {
         result = ENOENT;
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     if (result == ENOENT) {
         result = user_create(server_ctx, &dbuser, user, addto_backend);
@@ -372,9 +499,9 @@ const DBUserInfo *adb_user_get(AuthServerContext *server_ctx,
 {
     DBUserInfo *user;
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     user = user_get(server_ctx, username);
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     if (user != NULL && user->user.status == FCFS_AUTH_USER_STATUS_NORMAL) {
         return user;
@@ -388,21 +515,30 @@ int adb_user_remove(AuthServerContext *server_ctx, const string_t *username)
     DBUserInfo *user;
     int result;
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     user = user_get(server_ctx, username);
-    if (user != NULL && user->user.status == FCFS_AUTH_USER_STATUS_NORMAL) {
-        if ((result=dao_user_remove(server_ctx->dao_ctx,
-                        user->user.id)) == 0)
-        {
-            user->user.status = FCFS_AUTH_USER_STATUS_DELETED;
-            adb_ctx.user.count--;
-        }
-    } else {
-        result = ENOENT;
+    adb_unlock();
+
+    if (!(user != NULL && user->user.status ==
+                FCFS_AUTH_USER_STATUS_NORMAL))
+    {
+        return ENOENT;
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
 
-    return result;
+    if ((result=dao_user_remove(server_ctx->dao_ctx,
+                    user->user.id)) != 0)
+    {
+        return result;
+    }
+
+    adb_wrlock();
+    if (user->user.status == FCFS_AUTH_USER_STATUS_NORMAL) {
+        user->user.status = FCFS_AUTH_USER_STATUS_DELETED;
+        adb_ctx.user.count--;
+    }
+    adb_unlock();
+
+    return 0;
 }
 
 int adb_user_update_priv(AuthServerContext *server_ctx,
@@ -412,8 +548,10 @@ int adb_user_update_priv(AuthServerContext *server_ctx,
     int result;
     bool changed;
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     user = user_get(server_ctx, username);
+    adb_unlock();
+
     if (user != NULL && user->user.status == FCFS_AUTH_USER_STATUS_NORMAL) {
         if (user->user.priv == priv) {
             result = 0;
@@ -421,7 +559,9 @@ int adb_user_update_priv(AuthServerContext *server_ctx,
         } else if ((result=dao_user_update_priv(server_ctx->dao_ctx,
                         user->user.id, priv)) == 0)
         {
+            adb_wrlock();
             user->user.priv = priv;
+            adb_unlock();
             changed = true;
         } else {
             changed = false;
@@ -430,7 +570,6 @@ int adb_user_update_priv(AuthServerContext *server_ctx,
         result = ENOENT;
         changed = false;
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
 
     if (changed) {
         g_db_priv_change_callbacks.user_priv_changed(user->user.id, priv);
@@ -444,27 +583,31 @@ int adb_user_update_passwd(AuthServerContext *server_ctx,
     DBUserInfo *user;
     int result;
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     user = user_get(server_ctx, username);
+    adb_unlock();
+
     if (user != NULL && user->user.status == FCFS_AUTH_USER_STATUS_NORMAL) {
         if ((result=dao_user_update_passwd(server_ctx->dao_ctx,
                         user->user.id, passwd)) == 0)
         {
-            user_set_passwd(user, passwd);
+            adb_wrlock();
+            result = user_set_passwd(user, passwd);
+            adb_unlock();
         }
     } else {
         result = ENOENT;
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
 
     return result;
 }
 
 int adb_user_list(AuthServerContext *server_ctx,
-        const SFListLimitInfo *limit,
+        const string_t *cursor, const SFListLimitInfo *limit,
         FCFSAuthUserArray *array)
 {
     UniqSkiplistIterator it;
+    DBUserInfo target;
     DBUserInfo *dbuser;
     int result;
 
@@ -475,9 +618,15 @@ int adb_user_list(AuthServerContext *server_ctx,
         return result;
     }
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
-    uniq_skiplist_iterator_at(adb_ctx.user.sl_pair.skiplist,
-            limit->offset, &it);
+    adb_rdlock();
+    if (cursor->len > 0) {
+        target.user.name = *cursor;
+        skiplist_iterator_after(adb_ctx.user.sl_pair.
+                skiplist, &target, &it);
+    } else {
+        uniq_skiplist_iterator_at(adb_ctx.user.sl_pair.skiplist,
+                limit->offset, &it);
+    }
     while ((array->count < limit->count) && (dbuser=(DBUserInfo *)
                 uniq_skiplist_next(&it)) != NULL)
     {
@@ -485,7 +634,7 @@ int adb_user_list(AuthServerContext *server_ctx,
             array->users[array->count++] = dbuser->user;
         }
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     return 0;
 }
@@ -552,6 +701,9 @@ static int storage_pool_create(AuthServerContext *server_ctx,
             return result;
         }
         (*dbspool)->user = dbuser;
+        (*dbspool)->pool.used = 0;
+        (*dbspool)->watch.watched = false;
+        FC_INIT_LIST_HEAD(&(*dbspool)->watch.dlink);
         need_insert = true;
     } else {
         result = 0;
@@ -573,7 +725,7 @@ static int storage_pool_create(AuthServerContext *server_ctx,
         (*dbspool)->pool.id = pool->id;
     }
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_wrlock();
     (*dbspool)->pool.status = pool->status;
     if (need_insert) {
         if ((result=spool_global_skiplists_insert(*dbspool)) == 0) {
@@ -581,7 +733,7 @@ static int storage_pool_create(AuthServerContext *server_ctx,
                     created, *dbspool);
         }
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     if (result != 0) {
         dao_spool_remove(server_ctx->dao_ctx, (*dbspool)->pool.id);  //rollback
@@ -605,7 +757,7 @@ int adb_spool_create(AuthServerContext *server_ctx, const string_t
 
     result = ENOENT;
     dbspool = NULL;
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     user = user_get(server_ctx, username);
     if (user != NULL) {
         if (user->user.status == FCFS_AUTH_USER_STATUS_NORMAL) {
@@ -623,7 +775,7 @@ int adb_spool_create(AuthServerContext *server_ctx, const string_t
             user = NULL;
         }
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     if (user != NULL && result == ENOENT) {
         return storage_pool_create(server_ctx, user,
@@ -639,14 +791,14 @@ const FCFSAuthStoragePoolInfo *adb_spool_get(AuthServerContext *server_ctx,
     DBUserInfo *user;
     DBStoragePoolInfo *spool;
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     user = user_get(server_ctx, username);
     if (user != NULL) {
         spool = user_spool_get(server_ctx, user, poolname);
     } else {
         spool = NULL;
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     if (spool != NULL && spool->pool.status == FCFS_AUTH_POOL_STATUS_NORMAL) {
         return &spool->pool;
@@ -655,6 +807,53 @@ const FCFSAuthStoragePoolInfo *adb_spool_get(AuthServerContext *server_ctx,
     }
 }
 
+/* watch the normal pool which used bytes reach the ratio of the quota.
+ * the pool over the quota is unavailable already so it is not watched,
+ * and the watch is kept until the used bytes fall below the ratio by
+ * POOL_QUOTA_UNWATCH_RATIO_GAP percents to avoid the flapping
+ */
+static void spool_check_watch(DBStoragePoolInfo *dbpool)
+{
+    int64_t quota;
+    int64_t used;
+    double percent;
+    bool watch;
+    bool keep;
+
+    keep = false;
+    if (POOL_QUOTA_WATCH_RATIO > 0 && dbpool->pool.status ==
+            FCFS_AUTH_POOL_STATUS_NORMAL)
+    {
+        quota = FC_ATOMIC_GET(dbpool->pool.quota);
+        used = FC_ATOMIC_GET(dbpool->pool.used);
+        if (quota == FCFS_AUTH_UNLIMITED_QUOTA_VAL || used >= quota) {
+            watch = false;
+        } else {
+            percent = (double)used * 100 / (double)quota;
+            watch = (percent >= POOL_QUOTA_WATCH_RATIO);
+            keep = !watch && (percent >= POOL_QUOTA_WATCH_RATIO -
+                    POOL_QUOTA_UNWATCH_RATIO_GAP);
+        }
+    } else {
+        watch = false;
+    }
+
+    PTHREAD_MUTEX_LOCK(&adb_ctx.pool.watch.lock);
+    if (keep) {
+        watch = dbpool->watch.watched;
+    }
+    if (watch) {
+        if (!dbpool->watch.watched) {
+            dbpool->watch.watched = true;
+            fc_list_add_tail(&dbpool->watch.dlink, &adb_ctx.pool.watch.head);
+        }
+    } else if (dbpool->watch.watched) {
+        dbpool->watch.watched = false;
+        fc_list_del_init(&dbpool->watch.dlink);
+    }
+    PTHREAD_MUTEX_UNLOCK(&adb_ctx.pool.watch.lock);
+}
+
 int adb_spool_remove(AuthServerContext *server_ctx,
         const string_t *username, const string_t *poolname)
 {
@@ -662,14 +861,14 @@ int adb_spool_remove(AuthServerContext *server_ctx,
     DBStoragePoolInfo *spool;
     int result;
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     user = user_get(server_ctx, username);
     if (user != NULL) {
         spool = user_spool_get(server_ctx, user, poolname);
     } else {
         spool = NULL;
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     if (!(spool != NULL && spool->pool.status ==
             FCFS_AUTH_POOL_STATUS_NORMAL))
@@ -683,10 +882,11 @@ int adb_spool_remove(AuthServerContext *server_ctx,
         return result;
     }
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_wrlock();
     spool->pool.status = FCFS_AUTH_POOL_STATUS_DELETED;
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
+    spool_check_watch(spool);
     return 0;
 }
 
@@ -695,7 +895,7 @@ static void call_pool_quota_avail_func(const DBStoragePoolInfo *dbpool,
 {
     bool new_avail;
 
-    new_avail = FCFS_AUTH_POOL_AVAILABLE(dbpool->pool);
+    new_avail = adb_spool_available(dbpool);
     if (new_avail != old_avail) {
         g_db_priv_change_callbacks.pool_quota_avail_changed(
                 dbpool->pool.id, new_avail);
@@ -710,20 +910,19 @@ int adb_spool_set_quota(AuthServerContext *server_ctx,
     DBStoragePoolInfo *spool;
     int64_t old_quota;
     int result;
-    bool changed;
     bool old_avail;
 
     old_quota = 0;
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     user = user_get(server_ctx, username);
     if (user != NULL) {
         if ((spool=user_spool_get(server_ctx, user, poolname)) != NULL) {
-            old_quota = spool->pool.quota;
+            old_quota = FC_ATOMIC_GET(spool->pool.quota);
         }
     } else {
         spool = NULL;
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     if (!(spool != NULL && spool->pool.status ==
                 FCFS_AUTH_POOL_STATUS_NORMAL))
@@ -737,20 +936,9 @@ int adb_spool_set_quota(AuthServerContext *server_ctx,
         {
             return result;
         }
-        old_avail = FCFS_AUTH_POOL_AVAILABLE(spool->pool);
-        changed = true;
-    } else {
-        old_avail = false;
-        changed = false;
-    }
-
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
-    if (changed) {
-        spool->pool.quota = quota;
-    }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
-
-    if (changed) {
+        old_avail = adb_spool_available(spool);
+        FC_ATOMIC_SET(spool->pool.quota, quota);
+        spool_check_watch(spool);
         call_pool_quota_avail_func(spool, old_avail);
     }
 
@@ -763,10 +951,10 @@ int adb_spool_get_quota(AuthServerContext *server_ctx,
     DBStoragePoolInfo *spool;
     int result;
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     if ((spool=get_spool_by_name(poolname)) != NULL) {
         if (spool->pool.status == FCFS_AUTH_POOL_STATUS_NORMAL) {
-            *quota = spool->pool.quota;
+            *quota = FC_ATOMIC_GET(spool->pool.quota);
             result = 0;
         } else {
             *quota = 0;
@@ -776,7 +964,7 @@ int adb_spool_get_quota(AuthServerContext *server_ctx,
         *quota = 0;
         result = ENOENT;
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     return result;
 }
@@ -791,20 +979,63 @@ int adb_spool_set_used_bytes(const string_t *poolname,
         return ENOENT;
     }
 
-    if (dbpool->pool.used == used_bytes) {
+    if (FC_ATOMIC_GET(dbpool->pool.used) == used_bytes) {
         return 0;
     }
 
-    old_avail = FCFS_AUTH_POOL_AVAILABLE(dbpool->pool);
-    dbpool->pool.used = used_bytes;
+    /* lock free for the usage refresh of all pools */
+    old_avail = adb_spool_available(dbpool);
+    FC_ATOMIC_SET(dbpool->pool.used, used_bytes);
+    spool_check_watch(dbpool);
     call_pool_quota_avail_func(dbpool, old_avail);
     return 0;
 }
 
+static int spool_name_array_realloc(DBSPoolNameArray *array)
+{
+    char (*names)[NAME_MAX + 1];
+    int alloc;
+
+    alloc = (array->alloc > 0) ? 2 * array->alloc : 16;
+    names = (char (*)[NAME_MAX + 1])fc_realloc(array->names,
+            sizeof(*names) * alloc);
+    if (names == NULL) {
+        return ENOMEM;
+    }
+
+    array->names = names;
+    array->alloc = alloc;
+    return 0;
+}
+
+int adb_spool_get_watched(DBSPoolNameArray *array)
+{
+    DBStoragePoolInfo *dbpool;
+    int result;
+
+    result = 0;
+    array->count = 0;
+    PTHREAD_MUTEX_LOCK(&adb_ctx.pool.watch.lock);
+    fc_list_for_each_entry(dbpool, &adb_ctx.pool.watch.head, watch.dlink) {
+        if (array->count == array->alloc) {
+            if ((result=spool_name_array_realloc(array)) != 0) {
+                break;
+            }
+        }
+        snprintf(array->names[array->count++], NAME_MAX + 1, "%.*s",
+                dbpool->pool.name.len, dbpool->pool.name.str);
+    }
+    PTHREAD_MUTEX_UNLOCK(&adb_ctx.pool.watch.lock);
+
+    return result;
+}
+
 int adb_spool_list(AuthServerContext *server_ctx, const string_t *username,
-        const SFListLimitInfo *limit, FCFSAuthStoragePoolArray *array)
+        const string_t *cursor, const SFListLimitInfo *limit,
+        FCFSAuthStoragePoolArray *array)
 {
     UniqSkiplistIterator it;
+    DBStoragePoolInfo target;
     DBUserInfo *user;
     DBStoragePoolInfo *spool;
     int result;
@@ -816,11 +1047,17 @@ int adb_spool_list(AuthServerContext *server_ctx, const string_t *username,
         return result;
     }
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     user = user_get(server_ctx, username);
     if (user != NULL) {
-        uniq_skiplist_iterator_at(user->storage_pools.created,
-                limit->offset, &it);
+        if (cursor->len > 0) {
+            target.pool.name = *cursor;
+            skiplist_iterator_after(user->storage_pools.
+                    created, &target, &it);
+        } else {
+            uniq_skiplist_iterator_at(user->storage_pools.created,
+                    limit->offset, &it);
+        }
         while ((array->count < limit->count) && (spool=(DBStoragePoolInfo *)
                     uniq_skiplist_next(&it)) != NULL)
         {
@@ -831,13 +1068,14 @@ int adb_spool_list(AuthServerContext *server_ctx, const string_t *username,
     } else {
         result = ENOENT;
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     return result;
 }
 
 static int convert_spool_array(AuthServerContext *server_ctx,
-        DBUserInfo *dbuser, const FCFSAuthStoragePoolArray *spool_array)
+        DBUserInfo *dbuser, const FCFSAuthStoragePoolInfo *spools,
+        const int count)
 {
     const bool addto_backend = false;
     int result;
@@ -845,8 +1083,8 @@ static int convert_spool_array(AuthServerContext *server_ctx,
     const FCFSAuthStoragePoolInfo *spool;
     const FCFSAuthStoragePoolInfo *end;
 
-    end = spool_array->spools + spool_array->count;
-    for (spool=spool_array->spools; spool<end; spool++) {
+    end = spools + count;
+    for (spool=spools; spool<end; spool++) {
         dbspool = NULL;
 
         if ((result=storage_pool_create(server_ctx, dbuser,
@@ -859,29 +1097,6 @@ static int convert_spool_array(AuthServerContext *server_ctx,
     return 0;
 }
 
-static int load_user_spool(AuthServerContext *server_ctx,
-        struct fast_mpool_man *mpool, DBUserInfo *dbuser)
-{
-    FCFSAuthStoragePoolArray spool_array;
-    int result;
-
-    fcfs_auth_spool_init_array(&spool_array);
-    if ((result=dao_spool_list(server_ctx->dao_ctx, &dbuser->
-                    user.name, mpool, &spool_array)) != 0)
-    {
-        return result;
-    }
-
-    if ((result=convert_spool_array(server_ctx,
-                    dbuser, &spool_array)) != 0)
-    {
-        return result;
-    }
-
-    fcfs_auth_spool_free_array(&spool_array);
-    return 0;
-}
-
 static int granted_pool_create(AuthServerContext *server_ctx,
         DBUserInfo *dbuser, DBGrantedPoolInfo **dbgranted,
         const FCFSAuthGrantedPoolInfo *granted, const bool addto_backend)
@@ -916,7 +1131,7 @@ static int granted_pool_create(AuthServerContext *server_ctx,
     }
 
     if (need_insert) {
-        PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+        adb_wrlock();
         if (((*dbgranted)->sp=get_spool_by_id(granted->pool_id)) != NULL) {
             result = uniq_skiplist_insert(dbuser->storage_pools.
                     granted, *dbgranted);
@@ -926,7 +1141,7 @@ static int granted_pool_create(AuthServerContext *server_ctx,
                     __LINE__, granted->pool_id);
             result = ENOENT;
         }
-        PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+        adb_unlock();
 
         if (result != 0) {
             fast_mblock_free_object(&adb_ctx.pool.
@@ -938,19 +1153,20 @@ static int granted_pool_create(AuthServerContext *server_ctx,
 }
 
 static int convert_granted_array(AuthServerContext *server_ctx,
-        DBUserInfo *dbuser, const FCFSAuthGrantedPoolArray *granted_array)
+        DBUserInfo *dbuser, const FCFSAuthGrantedPoolInfo *gpools,
+        const int count)
 {
     const bool addto_backend = false;
     int result;
     DBGrantedPoolInfo *dbgranted;
-    const FCFSAuthGrantedPoolFullInfo *gf;
-    const FCFSAuthGrantedPoolFullInfo *end;
+    const FCFSAuthGrantedPoolInfo *granted;
+    const FCFSAuthGrantedPoolInfo *end;
 
-    end = granted_array->gpools + granted_array->count;
-    for (gf=granted_array->gpools; gf<end; gf++) {
+    end = gpools + count;
+    for (granted=gpools; granted<end; granted++) {
         dbgranted = NULL;
         if ((result=granted_pool_create(server_ctx, dbuser, &dbgranted,
-                        &gf->granted, addto_backend)) != 0)
+                        granted, addto_backend)) != 0)
         {
             return result;
         }
@@ -959,61 +1175,281 @@ static int convert_granted_array(AuthServerContext *server_ctx,
     return 0;
 }
 
-static int load_granted_pool(AuthServerContext *server_ctx, DBUserInfo *dbuser)
+static int fetch_user_pools(AuthDBLoadWorker *worker,
+        FCFSAuthUserInfo *user, AuthDBUserPools *pools)
 {
-    FCFSAuthGrantedPoolArray granted_array;
+    FDIRClientContext *dao_ctx;
+    FCFSAuthGrantedPoolFullInfo *gf;
+    FCFSAuthGrantedPoolFullInfo *end;
+    FCFSAuthGrantedPoolInfo *granted;
     int result;
 
-    fcfs_auth_granted_init_array(&granted_array);
-    if ((result=dao_granted_list(server_ctx->dao_ctx, &dbuser->
-                    user.name, &granted_array)) != 0)
+    dao_ctx = &worker->dao_ctx;
+    if ((result=dao_user_load_attrs(dao_ctx, &worker->mpool, user)) != 0) {
+        return result;
+    }
+
+    if ((result=dao_spool_list(dao_ctx, &user->name, &worker->mpool,
+                    &worker->spool_array)) != 0)
     {
         return result;
     }
+    if (worker->spool_array.count > 0) {
+        pools->spools = (FCFSAuthStoragePoolInfo *)fc_malloc(
+                sizeof(FCFSAuthStoragePoolInfo) *
+                worker->spool_array.count);
+        if (pools->spools == NULL) {
+            return ENOMEM;
+        }
+        memcpy(pools->spools, worker->spool_array.spools,
+                sizeof(FCFSAuthStoragePoolInfo) *
+                worker->spool_array.count);
+        pools->spool_count = worker->spool_array.count;
+    }
 
-    if ((result=convert_granted_array(server_ctx,
-                    dbuser, &granted_array)) != 0)
+    if ((result=dao_granted_list(dao_ctx, &user->name,
+                    &worker->granted_array)) != 0)
     {
         return result;
     }
+    if (worker->granted_array.count > 0) {
+        pools->gpools = (FCFSAuthGrantedPoolInfo *)fc_malloc(
+                sizeof(FCFSAuthGrantedPoolInfo) *
+                worker->granted_array.count);
+        if (pools->gpools == NULL) {
+            return ENOMEM;
+        }
+        end = worker->granted_array.gpools + worker->granted_array.count;
+        for (gf=worker->granted_array.gpools, granted=pools->gpools;
+                gf<end; gf++, granted++)
+        {
+            *granted = gf->granted;
+        }
+        pools->gpool_count = worker->granted_array.count;
+    }
+
+    return 0;
+}
+
+static void *load_worker_func(void *arg)
+{
+    AuthDBLoadWorker *worker;
+    AuthDBLoadContext *lctx;
+    int index;
+    int result;
+
+    worker = (AuthDBLoadWorker *)arg;
+    lctx = worker->lctx;
+    while (FC_ATOMIC_GET(lctx->result) == 0) {
+        index = __sync_fetch_and_add(&lctx->next_index, 1);
+        if (index >= lctx->user_array->count) {
+            break;
+        }
+
+        if ((result=fetch_user_pools(worker, lctx->user_array->users +
+                        index, lctx->user_pools + index)) != 0)
+        {
+            logError("file: "__FILE__", line: %d, "
+                    "load pools of user: %.*s fail, "
+                    "errno: %d, error info: %s", __LINE__,
+                    lctx->user_array->users[index].name.len,
+                    lctx->user_array->users[index].name.str,
+                    result, STRERROR(result));
+            __sync_bool_compare_and_swap(&lctx->result, 0, result);
+            break;
+        }
+    }
+
+    PTHREAD_MUTEX_LOCK(&lctx->lcp.lock);
+    if (--lctx->running_count == 0) {
+        pthread_cond_signal(&lctx->lcp.cond);
+    }
+    PTHREAD_MUTEX_UNLOCK(&lctx->lcp.lock);
+    return NULL;
+}
+
+static int init_load_context(AuthDBLoadContext *lctx,
+        AuthServerContext *server_ctx, FCFSAuthUserArray *user_array)
+{
+    const int alloc_size_once = 64 * 1024;
+    const int discard_size = 8;
+    AuthDBLoadWorker *worker;
+    AuthDBLoadWorker *end;
+    int bytes;
+    int result;
+
+    memset(lctx, 0, sizeof(*lctx));
+    lctx->server_ctx = server_ctx;
+    lctx->user_array = user_array;
+    if ((result=init_pthread_lock_cond_pair(&lctx->lcp)) != 0) {
+        return result;
+    }
+
+    if (user_array->count > 0) {
+        bytes = sizeof(AuthDBUserPools) * user_array->count;
+        if ((lctx->user_pools=fc_malloc(bytes)) == NULL) {
+            return ENOMEM;
+        }
+        memset(lctx->user_pools, 0, bytes);
+    }
+
+    lctx->worker_count = FC_MIN(DATA_LOAD_THREAD_COUNT,
+            FC_MAX(user_array->count, 1));
+    bytes = sizeof(AuthDBLoadWorker) * lctx->worker_count;
+    if ((lctx->workers=fc_malloc(bytes)) == NULL) {
+        return ENOMEM;
+    }
+    memset(lctx->workers, 0, bytes);
+
+    end = lctx->workers + lctx->worker_count;
+    for (worker=lctx->workers; worker<end; worker++) {
+        worker->lctx = lctx;
+        fcfs_auth_spool_init_array(&worker->spool_array);
+        fcfs_auth_granted_init_array(&worker->granted_array);
+        if ((result=fast_mpool_init(&worker->mpool, alloc_size_once,
+                        discard_size)) != 0)
+        {
+            return result;
+        }
+
+        /* the thread index > 0 for NOT resetting the shared session */
+        if ((result=dao_init_context((worker - lctx->workers) + 1,
+                        &worker->dao_ctx, NULL)) != 0)
+        {
+            return result;
+        }
+        worker->dao_inited = true;
+    }
 
-    fcfs_auth_granted_free_array(&granted_array);
     return 0;
 }
 
-static int convert_user_array(AuthServerContext *server_ctx,
-        struct fast_mpool_man *mpool,
-        const FCFSAuthUserArray *user_array)
+static void destroy_load_context(AuthDBLoadContext *lctx)
+{
+    AuthDBLoadWorker *worker;
+    AuthDBLoadWorker *end;
+    AuthDBUserPools *pools;
+    AuthDBUserPools *pend;
+
+    if (lctx->user_pools != NULL) {
+        pend = lctx->user_pools + lctx->user_array->count;
+        for (pools=lctx->user_pools; pools<pend; pools++) {
+            if (pools->spools != NULL) {
+                free(pools->spools);
+            }
+            if (pools->gpools != NULL) {
+                free(pools->gpools);
+            }
+        }
+        free(lctx->user_pools);
+    }
+
+    if (lctx->workers != NULL) {
+        end = lctx->workers + lctx->worker_count;
+        for (worker=lctx->workers; worker<end; worker++) {
+            fcfs_auth_spool_free_array(&worker->spool_array);
+            fcfs_auth_granted_free_array(&worker->granted_array);
+            fast_mpool_destroy(&worker->mpool);
+            if (worker->dao_inited) {
+                fdir_client_destroy_ex(&worker->dao_ctx);
+            }
+        }
+        free(lctx->workers);
+    }
+
+    destroy_pthread_lock_cond_pair(&lctx->lcp);
+}
+
+/* fetch the user attributes, storage pools and granted pools
+ * from FastDIR with the worker threads including the caller
+ */
+static int fetch_user_array(AuthDBLoadContext *lctx)
+{
+    AuthDBLoadWorker *worker;
+    AuthDBLoadWorker *end;
+    pthread_t tid;
+    int result;
+
+    lctx->running_count = lctx->worker_count;
+    end = lctx->workers + lctx->worker_count;
+    for (worker=lctx->workers + 1; worker<end; worker++) {
+        if ((result=fc_create_thread(&tid, load_worker_func,
+                        worker, SF_G_THREAD_STACK_SIZE)) != 0)
+        {
+            __sync_bool_compare_and_swap(&lctx->result, 0, result);
+            PTHREAD_MUTEX_LOCK(&lctx->lcp.lock);
+            lctx->running_count -= end - worker;
+            PTHREAD_MUTEX_UNLOCK(&lctx->lcp.lock);
+            break;
+        }
+    }
+
+    load_worker_func(lctx->workers);
+    PTHREAD_MUTEX_LOCK(&lctx->lcp.lock);
+    while (lctx->running_count > 0) {
+        pthread_cond_wait(&lctx->lcp.cond, &lctx->lcp.lock);
+    }
+    PTHREAD_MUTEX_UNLOCK(&lctx->lcp.lock);
+
+    return lctx->result;
+}
+
+/* build the memory database serially, because the granted pools
+ * refer to the storage pools of the other users
+ */
+static int convert_user_array(AuthDBLoadContext *lctx)
 {
     const bool addto_backend = false;
     int result;
-    DBUserInfo *dbuser;
+    DBUserInfo **dbusers;
+    DBUserInfo **dbuser;
     const FCFSAuthUserInfo *user;
     const FCFSAuthUserInfo *end;
-    UniqSkiplistIterator it;
+    AuthDBUserPools *pools;
+
+    if (lctx->user_array->count == 0) {
+        return 0;
+    }
+
+    dbusers = (DBUserInfo **)fc_malloc(sizeof(DBUserInfo *) *
+            lctx->user_array->count);
+    if (dbusers == NULL) {
+        return ENOMEM;
+    }
 
-    end = user_array->users + user_array->count;
-    for (user=user_array->users; user<end; user++) {
-        dbuser = NULL;
-        if ((result=user_create(server_ctx, &dbuser,
+    result = 0;
+    end = lctx->user_array->users + lctx->user_array->count;
+    for (user=lctx->user_array->users, dbuser=dbusers, pools=
+            lctx->user_pools; user<end; user++, dbuser++, pools++)
+    {
+        *dbuser = NULL;
+        if ((result=user_create(lctx->server_ctx, dbuser,
                         user, addto_backend)) != 0)
         {
-            return result;
+            break;
         }
 
-        if ((result=load_user_spool(server_ctx, mpool, dbuser)) != 0) {
-            return result;
+        if ((result=convert_spool_array(lctx->server_ctx, *dbuser,
+                        pools->spools, pools->spool_count)) != 0)
+        {
+            break;
         }
     }
 
-    uniq_skiplist_iterator(adb_ctx.user.sl_pair.skiplist, &it);
-    while ((dbuser=(DBUserInfo *)uniq_skiplist_next(&it)) != NULL) {
-        if ((result=load_granted_pool(server_ctx, dbuser)) != 0) {
-            return result;
+    if (result == 0) {
+        for (dbuser=dbusers, pools=lctx->user_pools; dbuser<dbusers +
+                lctx->user_array->count; dbuser++, pools++)
+        {
+            if ((result=convert_granted_array(lctx->server_ctx, *dbuser,
+                            pools->gpools, pools->gpool_count)) != 0)
+            {
+                break;
+            }
         }
     }
 
-    return 0;
+    free(dbusers);
+    return result;
 }
 
 static int load_pool_auto_id(AuthServerContext *server_ctx)
@@ -1040,9 +1476,12 @@ int adb_load_data(AuthServerContext *server_ctx)
 {
     const int alloc_size_once = 64 * 1024;
     const int discard_size = 8;
+    const bool with_attrs = false;
     int result;
+    int64_t start_time_ms;
     struct fast_mpool_man mpool;
     FCFSAuthUserArray user_array;
+    AuthDBLoadContext lctx;
 
     if ((result=auth_db_init()) != 0) {
         return result;
@@ -1054,21 +1493,38 @@ int adb_load_data(AuthServerContext *server_ctx)
         return result;
     }
 
+    start_time_ms = get_current_time_ms();
     fcfs_auth_user_init_array(&user_array);
-    if ((result=dao_user_list(server_ctx->dao_ctx,
-                    &mpool, &user_array)) != 0)
+    if ((result=dao_user_list_ex(server_ctx->dao_ctx, &mpool,
+                    &user_array, with_attrs)) != 0)
     {
+        fcfs_auth_user_free_array(&user_array);
+        fast_mpool_destroy(&mpool);
         return result;
     }
 
-    result = convert_user_array(server_ctx, &mpool, &user_array);
+    if ((result=init_load_context(&lctx, server_ctx, &user_array)) == 0) {
+        if ((result=fetch_user_array(&lctx)) == 0) {
+            result = convert_user_array(&lctx);
+        }
+    }
+    destroy_load_context(&lctx);
     fcfs_auth_user_free_array(&user_array);
     fast_mpool_destroy(&mpool);
 
     if (result != 0) {
         return result;
     }
-    return load_pool_auto_id(server_ctx);
+
+    if ((result=load_pool_auto_id(server_ctx)) != 0) {
+        return result;
+    }
+
+    logInfo("file: "__FILE__", line: %d, "
+            "load %d users with %d threads, time used: %"PRId64" ms",
+            __LINE__, adb_ctx.user.count, lctx.worker_count,
+            get_current_time_ms() - start_time_ms);
+    return 0;
 }
 
 int adb_check_generate_admin_user(AuthServerContext *server_ctx)
@@ -1126,7 +1582,7 @@ int adb_granted_create(AuthServerContext *server_ctx, const string_t *username,
     DBGrantedPoolInfo *dbgranted;
 
     dbgranted = NULL;
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     dbuser = user_get(server_ctx, username);
     if (dbuser != NULL) {
         if (dbuser->user.status == FCFS_AUTH_USER_STATUS_NORMAL) {
@@ -1135,7 +1591,7 @@ int adb_granted_create(AuthServerContext *server_ctx, const string_t *username,
             dbuser = NULL;
         }
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     /*
     logInfo("username: %.*s, ptr: %p, dbgranted: %p", username->len,
@@ -1177,14 +1633,14 @@ int adb_granted_remove(AuthServerContext *server_ctx,
     DBGrantedPoolInfo *dbgranted;
 
     dbgranted = NULL;
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     dbuser = user_get(server_ctx, username);
     if (dbuser != NULL) {
         if (dbuser->user.status == FCFS_AUTH_USER_STATUS_NORMAL) {
             dbgranted = granted_pool_get(dbuser, pool_id);
         }
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     if (dbgranted != NULL) {
         if ((result=dao_granted_remove(server_ctx->dao_ctx,
@@ -1195,9 +1651,9 @@ int adb_granted_remove(AuthServerContext *server_ctx,
             g_db_priv_change_callbacks.pool_priv_changed(dbuser->user.id,
                     dbgranted->granted.pool_id, &privs);
 
-            PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+            adb_wrlock();
             uniq_skiplist_delete(dbuser->storage_pools.granted, dbgranted);
-            PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+            adb_unlock();
         }
         return result;
     } else {
@@ -1220,7 +1676,7 @@ int adb_granted_full_get(AuthServerContext *server_ctx, const string_t
     DBGrantedPoolInfo *dbgranted;
 
     dbgranted = NULL;
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     dbuser = user_get(server_ctx, username);
     if (dbuser != NULL) {
         if (dbuser->user.status == FCFS_AUTH_USER_STATUS_NORMAL) {
@@ -1229,7 +1685,7 @@ int adb_granted_full_get(AuthServerContext *server_ctx, const string_t
             }
         }
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     return (dbgranted != NULL) ? 0 : ENOENT;
 }
@@ -1241,7 +1697,7 @@ int adb_granted_privs_get(AuthServerContext *server_ctx,
     DBGrantedPoolInfo *dbgranted;
     int result;
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     if (dbpool->user == dbuser) {
         privs->fdir = privs->fstore = FCFS_AUTH_POOL_ACCESS_ALL;
         result = 0;
@@ -1253,15 +1709,17 @@ int adb_granted_privs_get(AuthServerContext *server_ctx,
     } else {
         result = ENOENT;
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     return result;
 }
 
 int adb_granted_list(AuthServerContext *server_ctx, const string_t *username,
-        const SFListLimitInfo *limit, FCFSAuthGrantedPoolArray *array)
+        const int64_t last_pool_id, const SFListLimitInfo *limit,
+        FCFSAuthGrantedPoolArray *array)
 {
     UniqSkiplistIterator it;
+    DBGrantedPoolInfo target;
     DBUserInfo *user;
     DBGrantedPoolInfo *dbgpool;
     int result;
@@ -1273,11 +1731,17 @@ int adb_granted_list(AuthServerContext *server_ctx, const string_t *username,
         return result;
     }
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     user = user_get(server_ctx, username);
     if (user != NULL) {
-        uniq_skiplist_iterator_at(user->storage_pools.granted,
-                limit->offset, &it);
+        if (last_pool_id > 0) {
+            target.granted.pool_id = last_pool_id;
+            skiplist_iterator_after(user->storage_pools.
+                    granted, &target, &it);
+        } else {
+            uniq_skiplist_iterator_at(user->storage_pools.granted,
+                    limit->offset, &it);
+        }
         while ((array->count < limit->count) && (dbgpool=(DBGrantedPoolInfo *)
                     uniq_skiplist_next(&it)) != NULL)
         {
@@ -1287,7 +1751,7 @@ int adb_granted_list(AuthServerContext *server_ctx, const string_t *username,
     } else {
         result = ENOENT;
     }
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     return result;
 }
@@ -1314,9 +1778,9 @@ DBStoragePoolInfo *adb_spool_global_get(const string_t *poolname)
 {
     DBStoragePoolInfo *dbpool;
 
-    PTHREAD_MUTEX_LOCK(&adb_ctx.lock);
+    adb_rdlock();
     dbpool = get_spool_by_name(poolname);
-    PTHREAD_MUTEX_UNLOCK(&adb_ctx.lock);
+    adb_unlock();
 
     return dbpool;
 }
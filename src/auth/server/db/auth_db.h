@@ -17,6 +17,8 @@
 #ifndef _FCFS_AUTH_DB_H
 #define _FCFS_AUTH_DB_H
 
+#include "fastcommon/fc_atomic.h"
+#include "fastcommon/fc_list.h"
 #include "../server_types.h"
 
 typedef struct db_user_info {
@@ -29,9 +31,19 @@ typedef struct db_user_info {
 
 typedef struct db_storage_pool_info {
     FCFSAuthStoragePoolInfo pool;
+    struct {
+        bool watched;  //the used bytes reach the quota watch ratio
+        struct fc_list_head dlink;
+    } watch;
     DBUserInfo *user;
 } DBStoragePoolInfo;
 
+typedef struct db_spool_name_array {
+    char (*names)[NAME_MAX + 1];
+    int count;
+    int alloc;
+} DBSPoolNameArray;
+
 typedef struct db_granted_pool_info {
     FCFSAuthGrantedPoolInfo granted;
     DBStoragePoolInfo *sp;
@@ -71,8 +83,11 @@ const DBUserInfo *adb_user_get(AuthServerContext *server_ctx,
 
 int adb_user_remove(AuthServerContext *server_ctx, const string_t *username);
 
+/* list from the limit offset when the cursor is empty,
+ * otherwise list the users after the cursor (the username)
+ */
 int adb_user_list(AuthServerContext *server_ctx,
-        const SFListLimitInfo *limit,
+        const string_t *cursor, const SFListLimitInfo *limit,
         FCFSAuthUserArray *array);
 
 int adb_user_update_priv(AuthServerContext *server_ctx,
@@ -110,12 +125,32 @@ int adb_spool_set_quota(AuthServerContext *server_ctx,
 int adb_spool_get_quota(AuthServerContext *server_ctx,
         const string_t *poolname, int64_t *quota);
 
+/* the cursor is the pool name */
 int adb_spool_list(AuthServerContext *server_ctx, const string_t *username,
-        const SFListLimitInfo *limit, FCFSAuthStoragePoolArray *array);
+        const string_t *cursor, const SFListLimitInfo *limit,
+        FCFSAuthStoragePoolArray *array);
 
 int adb_spool_set_used_bytes(const string_t *poolname,
         const int64_t used_bytes);
 
+/* get the names of the watched pools for the fast usage refresh.
+ * the idle pools are kept watched, so the writes are watched at once
+ * when they resume
+ */
+int adb_spool_get_watched(DBSPoolNameArray *array);
+
+/* the quota and used bytes are read atomically without lock */
+static inline bool adb_spool_available(const DBStoragePoolInfo *dbpool)
+{
+    FCFSAuthStoragePoolInfo *pool;
+    int64_t quota;
+
+    pool = (FCFSAuthStoragePoolInfo *)&dbpool->pool;
+    quota = FC_ATOMIC_GET(pool->quota);
+    return (quota == FCFS_AUTH_UNLIMITED_QUOTA_VAL) ||
+        (FC_ATOMIC_GET(pool->used) < quota);
+}
+
 /* granted pool */
 int adb_granted_create(AuthServerContext *server_ctx, const string_t *username,
         FCFSAuthGrantedPoolInfo *granted);
@@ -130,8 +165,12 @@ int adb_granted_privs_get(AuthServerContext *server_ctx,
         const DBUserInfo *dbuser, const DBStoragePoolInfo *dbpool,
         FCFSAuthSPoolPriviledges *privs);
 
+/* the granted pools are ordered by the pool id, list from
+ * the limit offset when last_pool_id is 0
+ */
 int adb_granted_list(AuthServerContext *server_ctx, const string_t *username,
-        const SFListLimitInfo *limit, FCFSAuthGrantedPoolArray *array);
+        const int64_t last_pool_id, const SFListLimitInfo *limit,
+        FCFSAuthGrantedPoolArray *array);
 
 #ifdef __cplusplus
 }
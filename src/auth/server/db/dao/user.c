@@ -127,16 +127,42 @@ int dao_user_remove(FDIRClientContext *client_ctx, const int64_t user_id)
             FCFS_AUTH_USER_STATUS_DELETED);
 }
 
+int dao_user_load_attrs(FDIRClientContext *client_ctx,
+        struct fast_mpool_man *mpool, FCFSAuthUserInfo *user)
+{
+    char buff[256];
+    string_t value;
+    int result;
+
+    value.str = buff;
+    if ((result=dao_get_xattr_string(client_ctx, user->id,
+                    &AUTH_XTTR_NAME_PASSWD, &value, sizeof(buff))) != 0)
+    {
+        return result;
+    }
+    if ((result=fast_mpool_alloc_string_ex2(mpool,
+                    &user->passwd, &value)) != 0)
+    {
+        return result;
+    }
+
+    if ((result=dao_get_xattr_int64(client_ctx, user->id,
+                    &AUTH_XTTR_NAME_PRIV, &user->priv)) != 0)
+    {
+        return result;
+    }
+    return dao_get_xattr_int32(client_ctx, user->id,
+            &AUTH_XTTR_NAME_STATUS, &user->status);
+}
+
 static int dump_to_user_array(FDIRClientContext *client_ctx,
         struct fast_mpool_man *mpool, const FDIRClientDentryArray *darray,
-        FCFSAuthUserArray *uarray)
+        FCFSAuthUserArray *uarray, const bool with_attrs)
 {
     const FDIRClientDentry *entry;
     const FDIRClientDentry *end;
     FCFSAuthUserInfo *new_users;
     FCFSAuthUserInfo *user;
-    char buff[256];
-    string_t value;
     int result;
 
     if (darray->count > uarray->alloc) {
@@ -159,28 +185,16 @@ static int dump_to_user_array(FDIRClientContext *client_ctx,
     {
         user->id = entry->dentry.inode;
         user->name = entry->name;
-
-        value.str = buff;
-        if ((result=dao_get_xattr_string(client_ctx, user->id,
-                        &AUTH_XTTR_NAME_PASSWD, &value, sizeof(buff))) != 0)
-        {
-            return result;
-        }
-        if ((result=fast_mpool_alloc_string_ex2(mpool,
-                        &user->passwd, &value)) != 0)
-        {
-            return result;
-        }
-
-        if ((result=dao_get_xattr_int64(client_ctx, user->id,
-                        &AUTH_XTTR_NAME_PRIV, &user->priv)) != 0)
-        {
-            return result;
-        }
-        if ((result=dao_get_xattr_int32(client_ctx, user->id,
-                        &AUTH_XTTR_NAME_STATUS, &user->status)) != 0)
-        {
-            return result;
+        if (with_attrs) {
+            if ((result=dao_user_load_attrs(client_ctx,
+                            mpool, user)) != 0)
+            {
+                return result;
+            }
+        } else {
+            FC_SET_STRING_NULL(user->passwd);
+            user->priv = 0;
+            user->status = 0;
         }
     }
 
@@ -188,8 +202,8 @@ static int dump_to_user_array(FDIRClientContext *client_ctx,
     return 0;
 }
 
-int dao_user_list(FDIRClientContext *client_ctx, struct fast_mpool_man
-        *mpool, FCFSAuthUserArray *user_array)
+int dao_user_list_ex(FDIRClientContext *client_ctx, struct fast_mpool_man
+        *mpool, FCFSAuthUserArray *user_array, const bool with_attrs)
 {
     const int flags = 0;
     int result;
@@ -240,7 +254,7 @@ int dao_user_list(FDIRClientContext *client_ctx, struct fast_mpool_man
     }
 
     result = dump_to_user_array(client_ctx, mpool,
-            &dentry_array, user_array);
+            &dentry_array, user_array, with_attrs);
     fdir_client_dentry_array_free(&dentry_array);
     return result;
 }
@@ -19,6 +19,9 @@
 #include "fastcommon/fast_mpool.h"
 #include "types.h"
 
+#define dao_user_list(client_ctx, mpool, user_array) \
+    dao_user_list_ex(client_ctx, mpool, user_array, true)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -33,8 +36,15 @@ int dao_user_update_priv(FDIRClientContext *client_ctx,
 int dao_user_update_passwd(FDIRClientContext *client_ctx,
         const int64_t user_id, const string_t *passwd);
 
-int dao_user_list(FDIRClientContext *client_ctx, struct fast_mpool_man
-        *mpool, FCFSAuthUserArray *user_array);
+/* list the users, the passwd, priv and status of the users are
+ * NOT loaded when with_attrs is false, call dao_user_load_attrs
+ * for each user to load them later
+ */
+int dao_user_list_ex(FDIRClientContext *client_ctx, struct fast_mpool_man
+        *mpool, FCFSAuthUserArray *user_array, const bool with_attrs);
+
+int dao_user_load_attrs(FDIRClientContext *client_ctx,
+        struct fast_mpool_man *mpool, FCFSAuthUserInfo *user);
 
 #ifdef __cplusplus
 }
@@ -32,6 +32,7 @@ typedef struct {
         volatile uint32_t next;
     } generation;
     FDIRClientNamespaceStatArray nss_array;
+    DBSPoolNameArray watched;
 } PoolUsageUpdaterContext;
 
 static PoolUsageUpdaterContext updater_ctx = {false, 0, {0, 0}};
@@ -75,9 +76,48 @@ static int nss_fetch(ConnectionInfo *conn)
     return result;
 }
 
-static int pool_usage_refresh(ConnectionInfo *conn)
+/* fetch the usage of the watched pools only */
+static void watched_fetch()
 {
+    FDIRClientNamespaceStat nstat;
+    string_t poolname;
     int i;
+
+    if (adb_spool_get_watched(&updater_ctx.watched) != 0) {
+        return;
+    }
+
+    for (i=0; i<updater_ctx.watched.count && IS_SAME_GENERATION; i++) {
+        FC_SET_STRING(poolname, updater_ctx.watched.names[i]);
+        if (fdir_client_namespace_stat(&g_fdir_client_vars.client_ctx,
+                    &poolname, &nstat) == 0)
+        {
+            adb_spool_set_used_bytes(&poolname, nstat.space.used);
+        }
+    }
+}
+
+/* wait for the refresh interval of all pools, the watched pools
+ * are refreshed every quota watch interval during the waiting
+ */
+static void wait_next_fetch()
+{
+    int64_t interval_ms;
+    int64_t waited_ms;
+
+    interval_ms = POOL_USAGE_REFRESH_INTERVAL * 1000LL;
+    waited_ms = 0;
+    while (waited_ms < interval_ms && IS_SAME_GENERATION) {
+        fc_sleep_ms(POOL_QUOTA_WATCH_INTERVAL_MS);
+        waited_ms += POOL_QUOTA_WATCH_INTERVAL_MS;
+        if (POOL_QUOTA_WATCH_RATIO > 0) {
+            watched_fetch();
+        }
+    }
+}
+
+static int pool_usage_refresh(ConnectionInfo *conn)
+{
     int result;
 
     if ((result=fdir_client_proto_nss_subscribe(&g_fdir_client_vars.
@@ -91,11 +131,7 @@ static int pool_usage_refresh(ConnectionInfo *conn)
             break;
         }
 
-        for (i=0; i<POOL_USAGE_REFRESH_INTERVAL &&
-                IS_SAME_GENERATION; i++)
-        {
-            sleep(1);
-        }
+        wait_next_fetch();
     }
 
     return result;
@@ -219,13 +219,17 @@ static void server_log_configs()
             "secret_key_filename: %s}, pool-generate: "
             "{auto_id_initial: %"PRId64", pool_name_template: %s}, "
             "master-election {quorum: %s, vote_node_enabled: %d, "
-            "master_lost_timeout: %ds, max_wait_time: %ds}",
+            "master_lost_timeout: %ds, max_wait_time: %ds, "
+            "heartbeat_interval_ms: %d, heartbeat_miss_window: %d, "
+            "heartbeat_miss_threshold: %d, pre_vote_enabled: %d}",
             (ADMIN_GENERATE_MODE == AUTH_ADMIN_GENERATE_MODE_FIRST ?
              "first" : "always"), ADMIN_GENERATE_USERNAME.str,
             ADMIN_GENERATE_KEY_FILENAME.str, AUTO_ID_INITIAL,
             POOL_NAME_TEMPLATE.str, sf_get_election_quorum_caption(
                 MASTER_ELECTION_QUORUM), VOTE_NODE_ENABLED,
-            ELECTION_MASTER_LOST_TIMEOUT, ELECTION_MAX_WAIT_TIME);
+            ELECTION_MASTER_LOST_TIMEOUT, ELECTION_MAX_WAIT_TIME,
+            ELECTION_HEARTBEAT_INTERVAL_MS, ELECTION_HEARTBEAT.miss_window,
+            ELECTION_HEARTBEAT.miss_threshold, ELECTION_PRE_VOTE_ENABLED);
 
     logInfo("FCFSAuth V%d.%d.%d, %s, %s, service: {%s}, %s",
             g_fcfs_auth_global_vars.version.major,
@@ -235,9 +239,14 @@ static void server_log_configs()
             sz_service_config, sz_server_config);
 
     logInfo("FastDIR {client_config_filename: %s, "
-            "pool_usage_refresh_interval: %d}, %s",
+            "pool_usage_refresh_interval: %d, "
+            "pool_quota_watch_ratio: %d%%, "
+            "pool_quota_watch_interval_ms: %d, "
+            "data_load_thread_count: %d}, %s",
             g_server_global_vars.fdir_client_cfg_filename,
-            POOL_USAGE_REFRESH_INTERVAL, sz_session_config);
+            POOL_USAGE_REFRESH_INTERVAL, POOL_QUOTA_WATCH_RATIO,
+            POOL_QUOTA_WATCH_INTERVAL_MS, DATA_LOAD_THREAD_COUNT,
+            sz_session_config);
 
     log_local_host_ip_addrs();
     log_cluster_server_config();
@@ -262,6 +271,15 @@ static int load_master_election_config(const char *cluster_filename)
             &ini_ctx, "master_lost_timeout", 3, 1, 30);
     ELECTION_MAX_WAIT_TIME = iniGetIntCorrectValue(
             &ini_ctx, "max_wait_time", 5, 1, 300);
+    ELECTION_HEARTBEAT_INTERVAL_MS = iniGetIntCorrectValue(
+            &ini_ctx, "heartbeat_interval_ms", 1000, 10, 10000);
+    ELECTION_HEARTBEAT.miss_window = iniGetIntCorrectValue(
+            &ini_ctx, "heartbeat_miss_window", 5, 1, 64);
+    ELECTION_HEARTBEAT.miss_threshold = iniGetIntCorrectValue(
+            &ini_ctx, "heartbeat_miss_threshold", 3, 1,
+            ELECTION_HEARTBEAT.miss_window);
+    ELECTION_PRE_VOTE_ENABLED = iniGetBoolValue(ini_ctx.section_name,
+            "pre_vote_enabled", ini_ctx.context, true);
     if ((result=sf_load_election_quorum_config(&MASTER_ELECTION_QUORUM,
                     &ini_ctx)) == 0)
     {
@@ -375,6 +393,30 @@ int server_load_config(const char *filename)
         POOL_USAGE_REFRESH_INTERVAL = 1;
     }
 
+    POOL_QUOTA_WATCH_RATIO = iniGetIntValue(SECTION_NAME_FASTDIR,
+            "pool_quota_watch_ratio", &ini_context, 90);
+    if (POOL_QUOTA_WATCH_RATIO < 0) {
+        POOL_QUOTA_WATCH_RATIO = 0;
+    } else if (POOL_QUOTA_WATCH_RATIO > 100) {
+        POOL_QUOTA_WATCH_RATIO = 100;
+    }
+
+    POOL_QUOTA_WATCH_INTERVAL_MS = iniGetIntValue(SECTION_NAME_FASTDIR,
+            "pool_quota_watch_interval_ms", &ini_context, 100);
+    if (POOL_QUOTA_WATCH_INTERVAL_MS < 10) {
+        POOL_QUOTA_WATCH_INTERVAL_MS = 10;
+    } else if (POOL_QUOTA_WATCH_INTERVAL_MS > 1000) {
+        POOL_QUOTA_WATCH_INTERVAL_MS = 1000;
+    }
+
+    DATA_LOAD_THREAD_COUNT = iniGetIntValue(SECTION_NAME_FASTDIR,
+            "data_load_thread_count", &ini_context, 16);
+    if (DATA_LOAD_THREAD_COUNT <= 0) {
+        DATA_LOAD_THREAD_COUNT = 1;
+    } else if (DATA_LOAD_THREAD_COUNT > 256) {
+        DATA_LOAD_THREAD_COUNT = 256;
+    }
+
     if ((result=sf_load_slow_log_config(filename, &ini_context,
                     &SLOW_LOG_CTX, &SLOW_LOG_CFG)) != 0)
     {
@@ -19,6 +19,7 @@
 
 #include "fastcommon/common_define.h"
 #include "sf/sf_global.h"
+#include "fastcfs/vote/vote_election.h"
 #include "../common/auth_global.h"
 #include "server_types.h"
 
@@ -36,8 +37,7 @@ typedef struct server_global_vars {
         struct {
             SFElectionQuorum quorum;
             bool vote_node_enabled;
-            int master_lost_timeout;
-            int max_wait_time;
+            FCFSVoteElectionParams params;
         } master_election;
 
         SFContext sf_context;  //for cluster communication
@@ -57,6 +57,11 @@ typedef struct server_global_vars {
 
     char *fdir_client_cfg_filename;
     int pool_usage_refresh_interval;
+    struct {
+        int ratio;  //percentage of the quota, 0 for disable
+        int interval_ms;
+    } pool_quota_watch;
+    int data_load_thread_count;
 
     SFSlowLogContext slow_log;
 } AuthServerGlobalVars;
@@ -65,10 +70,12 @@ typedef struct server_global_vars {
     master_election.quorum
 #define VOTE_NODE_ENABLED      g_server_global_vars.cluster. \
     master_election.vote_node_enabled
-#define ELECTION_MASTER_LOST_TIMEOUT g_server_global_vars.cluster. \
-    master_election.master_lost_timeout
-#define ELECTION_MAX_WAIT_TIME   g_server_global_vars.cluster. \
-    master_election.max_wait_time
+#define ELECTION_PARAMS g_server_global_vars.cluster.master_election.params
+#define ELECTION_MASTER_LOST_TIMEOUT ELECTION_PARAMS.master_lost_timeout
+#define ELECTION_MAX_WAIT_TIME   ELECTION_PARAMS.max_wait_time
+#define ELECTION_HEARTBEAT       ELECTION_PARAMS.heartbeat
+#define ELECTION_HEARTBEAT_INTERVAL_MS ELECTION_HEARTBEAT.interval_ms
+#define ELECTION_PRE_VOTE_ENABLED ELECTION_PARAMS.pre_vote_enabled
 
 #define CLUSTER_CONFIG          g_server_global_vars.cluster.config
 #define CLUSTER_SERVER_CONFIG   CLUSTER_CONFIG.server_cfg
@@ -101,6 +108,10 @@ typedef struct server_global_vars {
 
 #define POOL_USAGE_REFRESH_INTERVAL g_server_global_vars. \
     pool_usage_refresh_interval
+#define POOL_QUOTA_WATCH_RATIO  g_server_global_vars.pool_quota_watch.ratio
+#define POOL_QUOTA_WATCH_INTERVAL_MS g_server_global_vars. \
+    pool_quota_watch.interval_ms
+#define DATA_LOAD_THREAD_COUNT  g_server_global_vars.data_load_thread_count
 
 #define SLOW_LOG                g_server_global_vars.slow_log
 #define SLOW_LOG_CFG            SLOW_LOG.cfg
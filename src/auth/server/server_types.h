@@ -71,6 +71,7 @@ typedef struct server_session_fields {
 } ServerSessionFields;
 
 typedef struct server_session_subscriber {
+    int proto_version;         //the format of the pushed entries
     struct fc_queue queue;     //element: ServerSessionSubscribeEntry
     struct fc_list_head dlink; //for global subscriber's chain
     struct {
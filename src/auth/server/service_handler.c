@@ -304,13 +304,50 @@ static int service_parse_limit(struct fast_task_info *task,
     return 0;
 }
 
+/* the cursor is copied to the buffer because the response
+ * maybe overwrite the request. has_cursor is false for the old
+ * clients which send the request without the cursor field
+ */
+static int service_parse_list_cursor(struct fast_task_info *task,
+        const int names_len, const int req_size,
+        char *cursor_buff, string_t *cursor, bool *has_cursor)
+{
+    char *p;
+    string_t proto_cursor;
+
+    p = REQUEST.body + req_size + names_len;
+    *has_cursor = (p < REQUEST.body + REQUEST.header.body_len);
+    if (fcfs_auth_parse_list_cursor(p, REQUEST.body +
+                REQUEST.header.body_len, &proto_cursor) != 0)
+    {
+        RESPONSE.error.length = sprintf(RESPONSE.error.message,
+                "request body length: %d is invalid",
+                REQUEST.header.body_len);
+        return EINVAL;
+    }
+
+    if (proto_cursor.len > 0) {
+        memcpy(cursor_buff, proto_cursor.str, proto_cursor.len);
+    }
+    *(cursor_buff + proto_cursor.len) = '\0';
+    FC_SET_STRING_EX(*cursor, cursor_buff, proto_cursor.len);
+    return 0;
+}
+
+/* reserve the space of the cursor at the end of the response */
+#define LIST_RESP_BUFF_END(task) \
+    (SF_SEND_BUFF_END(task) - (sizeof(FCFSAuthProtoNameInfo) + NAME_MAX))
+
 static int service_deal_user_list(struct fast_task_info *task)
 {
     FCFSAuthUserArray array;
     const DBUserInfo *dbuser;
     const FCFSAuthUserInfo *user;
     const FCFSAuthUserInfo *end;
+    char cursor_buff[NAME_MAX + 1];
     string_t username;
+    string_t cursor;
+    bool has_cursor;
     SFListLimitInfo limit;
     FCFSAuthProtoUserListReq *req;
     FCFSAuthProtoListRespHeader *resp_header;
@@ -322,16 +359,17 @@ static int service_deal_user_list(struct fast_task_info *task)
     int result;
 
     if ((result=server_check_body_length(sizeof(FCFSAuthProtoUserListReq),
-                    sizeof(FCFSAuthProtoUserListReq) + NAME_MAX)) != 0)
+                    sizeof(FCFSAuthProtoUserListReq) + 2 * NAME_MAX +
+                    sizeof(FCFSAuthProtoNameInfo))) != 0)
     {
         return result;
     }
 
     req = (FCFSAuthProtoUserListReq *)REQUEST.body;
     FC_SET_STRING_EX(username, req->username.str, req->username.len);
-    if ((result=server_expect_body_length(
-                    sizeof(FCFSAuthProtoUserListReq)
-                    + username.len)) != 0)
+    if ((result=service_parse_list_cursor(task, username.len,
+                    sizeof(FCFSAuthProtoUserListReq),
+                    cursor_buff, &cursor, &has_cursor)) != 0)
     {
         return result;
     }
@@ -352,7 +390,9 @@ static int service_deal_user_list(struct fast_task_info *task)
             return result;
         }
         fcfs_auth_user_init_array(&array);
-        if ((result=adb_user_list(SERVER_CTX, &limit, &array)) != 0) {
+        if ((result=adb_user_list(SERVER_CTX, &cursor,
+                        &limit, &array)) != 0)
+        {
             fcfs_auth_user_free_array(&array);
             return result;
         }
@@ -360,7 +400,7 @@ static int service_deal_user_list(struct fast_task_info *task)
 
     resp_header = (FCFSAuthProtoListRespHeader *)SF_PROTO_SEND_BODY(task);
     p = (char *)(resp_header + 1);
-    buff_end = SF_SEND_BUFF_END(task);
+    buff_end = LIST_RESP_BUFF_END(task);
     end = array.users + array.count;
     truncated = false;
     for (user=array.users; user<end; user++) {
@@ -378,6 +418,15 @@ static int service_deal_user_list(struct fast_task_info *task)
     }
     resp_header->is_last = (array.count < limit.count) && !truncated;
     int2buff(user - array.users, resp_header->count);
+    if (!has_cursor) {
+        //the old client without the cursor
+    } else if (user > array.users) {
+        p += fcfs_auth_pack_list_cursor(&(user - 1)->name,
+                (FCFSAuthProtoNameInfo *)p);
+    } else {
+        p += fcfs_auth_pack_list_cursor(&cursor,
+                (FCFSAuthProtoNameInfo *)p);
+    }
     RESPONSE.header.body_len = p - SF_PROTO_SEND_BODY(task);
     RESPONSE.header.cmd = FCFS_AUTH_SERVICE_PROTO_USER_LIST_RESP;
     TASK_ARG->context.common.response_done = true;
@@ -579,8 +628,11 @@ static int service_deal_spool_list(struct fast_task_info *task)
     FCFSAuthStoragePoolArray array;
     const FCFSAuthStoragePoolInfo *spool;
     const FCFSAuthStoragePoolInfo *end;
+    char cursor_buff[NAME_MAX + 1];
     string_t username;
     string_t poolname;
+    string_t cursor;
+    bool has_cursor;
     SFListLimitInfo limit;
     FCFSAuthProtoSPoolListReq *req;
     FCFSAuthProtoListRespHeader *resp_header;
@@ -592,15 +644,17 @@ static int service_deal_spool_list(struct fast_task_info *task)
     int result;
 
     if ((result=server_check_body_length(sizeof(FCFSAuthProtoSPoolListReq),
-                    sizeof(FCFSAuthProtoSPoolListReq) + NAME_MAX * 2)) != 0)
+                    sizeof(FCFSAuthProtoSPoolListReq) + NAME_MAX * 3 +
+                    sizeof(FCFSAuthProtoNameInfo))) != 0)
     {
         return result;
     }
 
     req = (FCFSAuthProtoSPoolListReq *)REQUEST.body;
     fcfs_auth_parse_user_pool_pair(&req->up_pair, &username, &poolname);
-    if ((result=server_expect_body_length(sizeof(FCFSAuthProtoSPoolListReq)
-                    + username.len + poolname.len)) != 0)
+    if ((result=service_parse_list_cursor(task, username.len +
+                    poolname.len, sizeof(FCFSAuthProtoSPoolListReq),
+                    cursor_buff, &cursor, &has_cursor)) != 0)
     {
         return result;
     }
@@ -645,7 +699,7 @@ static int service_deal_spool_list(struct fast_task_info *task)
 
         fcfs_auth_spool_init_array(&array);
         if ((result=adb_spool_list(SERVER_CTX, &username,
-                        &limit, &array)) != 0)
+                        &cursor, &limit, &array)) != 0)
         {
             fcfs_auth_spool_free_array(&array);
             return result;
@@ -655,7 +709,7 @@ static int service_deal_spool_list(struct fast_task_info *task)
     resp_header = (FCFSAuthProtoListRespHeader *)SF_PROTO_SEND_BODY(task);
     p = (char *)(resp_header + 1);
     end = array.spools + array.count;
-    buff_end = SF_SEND_BUFF_END(task);
+    buff_end = LIST_RESP_BUFF_END(task);
     truncated = false;
     for (spool=array.spools; spool<end; spool++) {
         len = sizeof(FCFSAuthProtoSPoolListRespBodyPart) +
@@ -673,6 +727,15 @@ static int service_deal_spool_list(struct fast_task_info *task)
     }
     resp_header->is_last = (array.count < limit.count) && !truncated;
     int2buff(spool - array.spools, resp_header->count);
+    if (!has_cursor) {
+        //the old client without the cursor
+    } else if (spool > array.spools) {
+        p += fcfs_auth_pack_list_cursor(&(spool - 1)->name,
+                (FCFSAuthProtoNameInfo *)p);
+    } else {
+        p += fcfs_auth_pack_list_cursor(&cursor,
+                (FCFSAuthProtoNameInfo *)p);
+    }
     RESPONSE.header.body_len = p - SF_PROTO_SEND_BODY(task);
     RESPONSE.header.cmd = FCFS_AUTH_SERVICE_PROTO_SPOOL_LIST_RESP;
     TASK_ARG->context.common.response_done = true;
@@ -871,9 +934,14 @@ static int service_deal_gpool_list(struct fast_task_info *task)
     FCFSAuthGrantedPoolArray array;
     const FCFSAuthGrantedPoolFullInfo *gpool;
     const FCFSAuthGrantedPoolFullInfo *end;
+    const FCFSAuthGrantedPoolFullInfo *last;
     char pname_buff[NAME_MAX];
+    char cursor_buff[NAME_MAX + 1];
     string_t username;
     string_t poolname;
+    string_t cursor;
+    bool has_cursor;
+    int64_t last_pool_id;
     SFListLimitInfo limit;
     FCFSAuthProtoGPoolListReq *req;
     FCFSAuthProtoListRespHeader *resp_header;
@@ -886,19 +954,34 @@ static int service_deal_gpool_list(struct fast_task_info *task)
     int result;
 
     if ((result=server_check_body_length(sizeof(FCFSAuthProtoGPoolListReq),
-                    sizeof(FCFSAuthProtoGPoolListReq) + NAME_MAX * 2)) != 0)
+                    sizeof(FCFSAuthProtoGPoolListReq) + NAME_MAX * 3 +
+                    sizeof(FCFSAuthProtoNameInfo))) != 0)
     {
         return result;
     }
 
     req = (FCFSAuthProtoGPoolListReq *)REQUEST.body;
     fcfs_auth_parse_user_pool_pair(&req->up_pair, &username, &poolname);
-    if ((result=server_expect_body_length(sizeof(FCFSAuthProtoGPoolListReq)
-                    + username.len + poolname.len)) != 0)
+    if ((result=service_parse_list_cursor(task, username.len +
+                    poolname.len, sizeof(FCFSAuthProtoGPoolListReq),
+                    cursor_buff, &cursor, &has_cursor)) != 0)
     {
         return result;
     }
 
+    /* the cursor is the pool id in decimal */
+    if (cursor.len > 0) {
+        char *endptr;
+        last_pool_id = strtoll(cursor_buff, &endptr, 10);
+        if (*endptr != '\0' || last_pool_id <= 0) {
+            RESPONSE.error.length = sprintf(RESPONSE.error.message,
+                    "invalid cursor: %s", cursor_buff);
+            return EINVAL;
+        }
+    } else {
+        last_pool_id = 0;
+    }
+
     if (username.len == 0) {
         username = SESSION_USER.name;
     } else {
@@ -923,7 +1006,7 @@ static int service_deal_gpool_list(struct fast_task_info *task)
 
     fcfs_auth_granted_init_array(&array);
     if ((result=adb_granted_list(SERVER_CTX, &username,
-                    &limit, &array)) != 0)
+                    last_pool_id, &limit, &array)) != 0)
     {
         fcfs_auth_granted_free_array(&array);
         return result;
@@ -932,9 +1015,10 @@ static int service_deal_gpool_list(struct fast_task_info *task)
     count = 0;
     resp_header = (FCFSAuthProtoListRespHeader *)SF_PROTO_SEND_BODY(task);
     p = (char *)(resp_header + 1);
-    buff_end = SF_SEND_BUFF_END(task);
+    buff_end = LIST_RESP_BUFF_END(task);
     end = array.gpools + array.count;
     truncated = false;
+    last = NULL;
     for (gpool=array.gpools; gpool<end; gpool++) {
         if (poolname.len == 0 || fc_string_equals(
                     &gpool->pool_name, &poolname))
@@ -954,10 +1038,20 @@ static int service_deal_gpool_list(struct fast_task_info *task)
             p += len;
             count++;
         }
+        last = gpool;
     }
 
     resp_header->is_last = (array.count < limit.count) && !truncated;
     int2buff(count, resp_header->count);
+    if (has_cursor) {
+        if (last != NULL) {
+            cursor.str = cursor_buff;
+            cursor.len = sprintf(cursor_buff, "%"PRId64,
+                    last->granted.pool_id);
+        }
+        p += fcfs_auth_pack_list_cursor(&cursor,
+                (FCFSAuthProtoNameInfo *)p);
+    }
     RESPONSE.header.body_len = p - SF_PROTO_SEND_BODY(task);
     RESPONSE.header.cmd = FCFS_AUTH_SERVICE_PROTO_GPOOL_LIST_RESP;
     TASK_ARG->context.common.response_done = true;
@@ -37,46 +37,111 @@ typedef struct server_session_subscribe_context {
 
     /* queue element: ServerSessionFields */
     FCLockedList sessions;   //publish session only
+
+    /* the ring of the recent published entries for the subscribers
+     * to resume, protected by the lock of subscribers */
+    struct {
+        int64_t epoch;    //changed when the log reset
+        int64_t version;  //the version of the last entry
+        int count;
+        int capacity;
+        FCFSAuthSessionPushEntry *entries;  //indexed by version % capacity
+    } log;
 } ServerSessionSubscribeContext;
 
+typedef struct {
+    ServerSessionSubscribeEntry *head;
+    ServerSessionSubscribeEntry *tail;
+} ServerSessionSubscribeChain;
+
 static ServerSessionSubscribeContext subscribe_ctx;
 
-static void set_session_subscribe_entry(const ServerSessionEntry *session,
-        ServerSessionSubscribeEntry *subs_entry)
+static void set_session_push_entry(const ServerSessionEntry *session,
+        FCFSAuthSessionPushEntry *entry)
 {
     ServerSessionFields *fields;
 
-    subs_entry->operation = FCFS_AUTH_SESSION_OP_TYPE_CREATE;
-    subs_entry->session.id1 = session->id_info.part1.id;
-    subs_entry->session.id2 = session->id_info.part2.id;
+    entry->operation = FCFS_AUTH_SESSION_OP_TYPE_CREATE;
+    entry->session.id1 = session->id_info.part1.id;
+    entry->session.id2 = session->id_info.part2.id;
 
     fields = (ServerSessionFields *)(session->fields);
-    subs_entry->fields.user.id = fields->dbuser->user.id;
-    subs_entry->fields.user.priv = fields->dbuser->user.priv;
+    entry->fields.user.id = fields->dbuser->user.id;
+    entry->fields.user.priv = fields->dbuser->user.priv;
 
     if (fields->dbpool != NULL) {
-        subs_entry->fields.pool.id = fields->dbpool->pool.id;
-        subs_entry->fields.pool.available = FCFS_AUTH_POOL_AVAILABLE(
-                fields->dbpool->pool);
-        subs_entry->fields.pool.privs = fields->pool_privs;
+        entry->fields.pool.id = fields->dbpool->pool.id;
+        entry->fields.pool.available = adb_spool_available(
+                fields->dbpool);
+        entry->fields.pool.privs = fields->pool_privs;
+    } else {
+        entry->fields.pool.id = 0;
+        entry->fields.pool.available = 0;
+        entry->fields.pool.privs.fdir = 0;
+        entry->fields.pool.privs.fstore = 0;
+    }
+}
+
+static inline int add_to_subscribe_chain(ServerSessionSubscribeChain *chain,
+        const FCFSAuthSessionPushEntry *entry, const int64_t version)
+{
+    ServerSessionSubscribeEntry *subs_entry;
+
+    subs_entry = (ServerSessionSubscribeEntry *)
+        fast_mblock_alloc_object(&subscribe_ctx.entry_allocator);
+    if (subs_entry == NULL) {
+        return ENOMEM;
+    }
+
+    subs_entry->version = version;
+    subs_entry->entry = *entry;
+    if (chain->head == NULL) {
+        chain->head = subs_entry;
     } else {
-        subs_entry->fields.pool.id = 0;
-        subs_entry->fields.pool.available = 0;
-        subs_entry->fields.pool.privs.fdir = 0;
-        subs_entry->fields.pool.privs.fstore = 0;
+        chain->tail->next = subs_entry;
     }
+    chain->tail = subs_entry;
+    return 0;
+}
+
+static void push_chain_to_queue(ServerSessionSubscriber *subscriber,
+        ServerSessionSubscribeChain *chain, const int result)
+{
+    struct fc_queue_info qinfo;
+
+    if (chain->head == NULL) {
+        return;
+    }
+
+    chain->tail->next = NULL;
+    if (result != 0) {
+        session_subscribe_free_entries(chain->head);
+        return;
+    }
+
+    qinfo.head = chain->head;
+    qinfo.tail = chain->tail;
+    fc_queue_push_queue_to_tail_silence(&subscriber->queue, &qinfo);
 }
 
 static int publish_entry_to_all_subscribers(
-        const ServerSessionSubscribeEntry *src_entry)
+        const FCFSAuthSessionPushEntry *src_entry)
 {
     int result;
+    int64_t version;
     bool notify;
     ServerSessionSubscriber *subscriber;
     ServerSessionSubscribeEntry *subs_entry;
 
     result = 0;
     PTHREAD_MUTEX_LOCK(&subscribe_ctx.subscribers.lock);
+    version = ++subscribe_ctx.log.version;
+    subscribe_ctx.log.entries[version % subscribe_ctx.
+        log.capacity] = *src_entry;
+    if (subscribe_ctx.log.count < subscribe_ctx.log.capacity) {
+        subscribe_ctx.log.count++;
+    }
+
     fc_list_for_each_entry(subscriber, &subscribe_ctx.
             subscribers.head, dlink)
     {
@@ -87,7 +152,8 @@ static int publish_entry_to_all_subscribers(
             break;
         }
 
-        *subs_entry = *src_entry;
+        subs_entry->version = version;
+        subs_entry->entry = *src_entry;
         fc_queue_push_ex(&subscriber->queue, subs_entry, &notify);
         if (notify) {
             cluster_subscriber_queue_push(subscriber);
@@ -101,10 +167,10 @@ static int publish_entry_to_all_subscribers(
 static inline int publish_session_to_all_subscribers(
         const ServerSessionEntry *session)
 {
-    ServerSessionSubscribeEntry subs_entry;
+    FCFSAuthSessionPushEntry entry;
 
-    set_session_subscribe_entry(session, &subs_entry);
-    return publish_entry_to_all_subscribers(&subs_entry);
+    set_session_push_entry(session, &entry);
+    return publish_entry_to_all_subscribers(&entry);
 }
 
 static void server_session_add_callback(ServerSessionEntry *session)
@@ -121,17 +187,17 @@ static void server_session_add_callback(ServerSessionEntry *session)
 static void server_session_del_callback(ServerSessionEntry *session)
 {
     ServerSessionFields *fields;
-    ServerSessionSubscribeEntry subs_entry;
+    FCFSAuthSessionPushEntry entry;
 
     fields = (ServerSessionFields *)(session->fields);
     if (fields->publish && MYSELF_IS_MASTER) {
         locked_list_del(&fields->dlink, &subscribe_ctx.sessions);
 
-        memset(&subs_entry, 0, sizeof(subs_entry));
-        subs_entry.operation = FCFS_AUTH_SESSION_OP_TYPE_REMOVE;
-        subs_entry.session.id1 = session->id_info.part1.id;
-        subs_entry.session.id2 = session->id_info.part2.id;
-        publish_entry_to_all_subscribers(&subs_entry);
+        memset(&entry, 0, sizeof(entry));
+        entry.operation = FCFS_AUTH_SESSION_OP_TYPE_REMOVE;
+        entry.session.id1 = session->id_info.part1.id;
+        entry.session.id2 = session->id_info.part2.id;
+        publish_entry_to_all_subscribers(&entry);
     }
 }
 
@@ -152,10 +218,7 @@ static void publish_matched_server_sessions(
     ServerSessionEntry *session;
     int matched_count;
 
-    if (fc_list_empty(&subscribe_ctx.subscribers.head)) {
-        return;
-    }
-
+    /* publish even if no subscribers for the session log */
     matched_count = 0;
     PTHREAD_MUTEX_LOCK(&subscribe_ctx.sessions.lock);
     fc_list_for_each_entry(fields, &subscribe_ctx.sessions.head, dlink) {
@@ -226,50 +289,104 @@ DBPrivChangeCallbacks g_db_priv_change_callbacks = {
     pool_quota_avail_change_callback
 };
 
-static int push_all_sessions_to_queue(ServerSessionSubscriber *subscriber)
+static int compare_session_push_entry(const FCFSAuthSessionPushEntry *e1,
+        const FCFSAuthSessionPushEntry *e2)
+{
+    int sub;
+
+    if ((sub=fc_compare_int64(e1->session.id1, e2->session.id1)) != 0) {
+        return sub;
+    }
+    return fc_compare_int64(e1->session.id2, e2->session.id2);
+}
+
+/* push the published sessions sorted by id for the delta compression,
+ * the last entry carries the log version as the snapshot position */
+static int push_snapshot_to_queue(ServerSessionSubscriber *subscriber,
+        int *pushed_count)
 {
     int result;
+    int alloc;
+    int count;
+    int bytes;
     ServerSessionFields *fields;
-    ServerSessionEntry *session;
-    ServerSessionSubscribeEntry *head;
-    ServerSessionSubscribeEntry *tail;
-    ServerSessionSubscribeEntry *subs_entry;
+    FCFSAuthSessionPushEntry *entries;
+    FCFSAuthSessionPushEntry *new_entries;
+    FCFSAuthSessionPushEntry *entry;
+    FCFSAuthSessionPushEntry *end;
+    ServerSessionSubscribeChain chain;
 
     result = 0;
-    head = tail = NULL;
-    PTHREAD_MUTEX_LOCK(&subscribe_ctx.sessions.lock);
+    alloc = count = 0;
+    entries = NULL;
+    *pushed_count = 0;
     fc_list_for_each_entry(fields, &subscribe_ctx.sessions.head, dlink) {
-        session = FCFS_AUTH_SERVER_SESSION_BY_FIELDS(fields);
-        if (!session->id_info.part1.fields.publish) {
-            continue;
-        }
-
-        subs_entry = (ServerSessionSubscribeEntry *)
-            fast_mblock_alloc_object(&subscribe_ctx.entry_allocator);
-        if (subs_entry == NULL) {
-            result = ENOMEM;
-            break;
+        if (count == alloc) {
+            alloc = (alloc == 0) ? 1024 : 2 * alloc;
+            bytes = sizeof(FCFSAuthSessionPushEntry) * alloc;
+            if ((new_entries=(FCFSAuthSessionPushEntry *)fc_realloc(
+                            entries, bytes)) == NULL)
+            {
+                result = ENOMEM;
+                break;
+            }
+            entries = new_entries;
         }
 
-        set_session_subscribe_entry(session, subs_entry);
+        set_session_push_entry(FCFS_AUTH_SERVER_SESSION_BY_FIELDS(
+                    fields), entries + count++);
+    }
 
-        if (head == NULL) {
-            head = subs_entry;
-        } else {
-            tail->next = subs_entry;
+    if (result == 0 && count > 0) {
+        qsort(entries, count, sizeof(FCFSAuthSessionPushEntry),
+                (int (*)(const void *, const void *))
+                compare_session_push_entry);
+
+        chain.head = chain.tail = NULL;
+        end = entries + count;
+        for (entry=entries; entry<end; entry++) {
+            if ((result=add_to_subscribe_chain(&chain, entry, (entry ==
+                                end - 1) ? subscribe_ctx.log.version
+                            : 0)) != 0)
+            {
+                break;
+            }
+        }
+        push_chain_to_queue(subscriber, &chain, result);
+        if (result == 0) {
+            *pushed_count = count;
         }
-        tail = subs_entry;
     }
-    PTHREAD_MUTEX_UNLOCK(&subscribe_ctx.sessions.lock);
 
-    if (result == 0 && head != NULL) {
-        struct fc_queue_info qinfo;
+    if (entries != NULL) {
+        free(entries);
+    }
+    return result;
+}
+
+static int push_log_entries_to_queue(ServerSessionSubscriber *subscriber,
+        const int64_t last_version, int *pushed_count)
+{
+    int result;
+    int64_t version;
+    ServerSessionSubscribeChain chain;
 
-        tail->next = NULL;
-        qinfo.head = head;
-        qinfo.tail = tail;
-        fc_queue_push_queue_to_tail_silence(&subscriber->queue, &qinfo);
+    result = 0;
+    chain.head = chain.tail = NULL;
+    for (version=last_version + 1; version<=subscribe_ctx.log.version;
+            version++)
+    {
+        if ((result=add_to_subscribe_chain(&chain, subscribe_ctx.log.
+                        entries + version % subscribe_ctx.log.capacity,
+                        version)) != 0)
+        {
+            break;
+        }
     }
+
+    push_chain_to_queue(subscriber, &chain, result);
+    *pushed_count = (result == 0 ? subscribe_ctx.log.version -
+            last_version : 0);
     return result;
 }
 
@@ -283,6 +400,21 @@ int subscriber_alloc_init_func(ServerSessionSubscriber *subscriber, void *args)
 int session_subscribe_init()
 {
     int result;
+    int bytes;
+
+    subscribe_ctx.log.capacity = g_server_session_cfg.subscribe_log_capacity;
+    bytes = sizeof(FCFSAuthSessionPushEntry) * subscribe_ctx.log.capacity;
+    if ((subscribe_ctx.log.entries=(FCFSAuthSessionPushEntry *)
+                fc_malloc(bytes)) == NULL)
+    {
+        return ENOMEM;
+    }
+    /* the epoch is local to this master process, the log is not
+     * replicated to the followers, so the subscribers can resume only
+     * when they reconnect to the same master */
+    subscribe_ctx.log.epoch = get_current_time_us();
+    subscribe_ctx.log.version = 0;
+    subscribe_ctx.log.count = 0;
 
     if ((result=fast_mblock_init_ex1(&subscribe_ctx.entry_allocator,
                     "subscribe_entry", sizeof(ServerSessionSubscribeEntry),
@@ -320,11 +452,39 @@ ServerSessionSubscriber *session_subscribe_alloc()
             &subscribe_ctx.subs_allocator);
 }
 
-void session_subscribe_register(ServerSessionSubscriber *subscriber)
+int session_subscribe_register(ServerSessionSubscriber *subscriber,
+        ServerSessionSubscribePosition *position, bool *snapshot,
+        int *count)
 {
-    push_all_sessions_to_queue(subscriber);
-    locked_list_add_tail(&subscriber->dlink,
-            &subscribe_ctx.subscribers);
+    int result;
+
+    /* lock the sessions first as the same order of
+     * publish_matched_server_sessions */
+    PTHREAD_MUTEX_LOCK(&subscribe_ctx.sessions.lock);
+    PTHREAD_MUTEX_LOCK(&subscribe_ctx.subscribers.lock);
+    if (position->epoch == subscribe_ctx.log.epoch &&
+            position->version >= 0 && position->version <=
+            subscribe_ctx.log.version && subscribe_ctx.log.version -
+            position->version <= subscribe_ctx.log.count)
+    {
+        *snapshot = false;
+        result = push_log_entries_to_queue(subscriber,
+                position->version, count);
+    } else {
+        *snapshot = true;
+        result = push_snapshot_to_queue(subscriber, count);
+    }
+
+    if (result == 0) {
+        fc_list_add_tail(&subscriber->dlink,
+                &subscribe_ctx.subscribers.head);
+    }
+    position->epoch = subscribe_ctx.log.epoch;
+    position->version = subscribe_ctx.log.version;
+    PTHREAD_MUTEX_UNLOCK(&subscribe_ctx.subscribers.lock);
+    PTHREAD_MUTEX_UNLOCK(&subscribe_ctx.sessions.lock);
+
+    return result;
 }
 
 void session_subscribe_unregister(ServerSessionSubscriber *subscriber)
@@ -367,4 +527,11 @@ void session_subscribe_clear_session()
         fc_list_del_init(&fields->dlink);
     }
     PTHREAD_MUTEX_UNLOCK(&subscribe_ctx.sessions.lock);
+
+    /* the subscribers should fetch the snapshot from the new master */
+    PTHREAD_MUTEX_LOCK(&subscribe_ctx.subscribers.lock);
+    subscribe_ctx.log.epoch = get_current_time_us();
+    subscribe_ctx.log.version = 0;
+    subscribe_ctx.log.count = 0;
+    PTHREAD_MUTEX_UNLOCK(&subscribe_ctx.subscribers.lock);
 }
@@ -18,18 +18,20 @@
 #define _AUTH_SESSION_SUBSCRIBE_H
 
 #include "fastcommon/fast_mblock.h"
+#include "auth_proto.h"
 #include "server_types.h"
 
 typedef struct auth_session_subscribe_entry {
-    char operation;
-    struct {
-        uint64_t id1;
-        uint64_t id2;
-    } session;
-    SessionSyncedFields fields;
+    int64_t version;  //the session log version, 0 for the snapshot entry
+    FCFSAuthSessionPushEntry entry;
     struct auth_session_subscribe_entry *next;  //for fc_queue
 } ServerSessionSubscribeEntry;
 
+typedef struct auth_session_subscribe_position {
+    int64_t epoch;
+    int64_t version;
+} ServerSessionSubscribePosition;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -43,7 +45,20 @@ extern "C" {
 
     ServerSessionSubscriber *session_subscribe_alloc();
 
-    void session_subscribe_register(ServerSessionSubscriber *subscriber);
+    /* register the subscriber and push the session log entries after
+     * the position to the subscriber's queue, or push the sorted snapshot
+     * of all published sessions when the log can't cover the position.
+     * a position from another master (the epoch differs) always gets
+     * the snapshot, the resume works for the reconnect to the same master.
+     *
+     * position: input the subscriber's last applied position,
+     *           output the current position of the session log
+     * snapshot: output if the snapshot pushed
+     * count: output the entry count pushed for the snapshot or the resume
+     */
+    int session_subscribe_register(ServerSessionSubscriber *subscriber,
+            ServerSessionSubscribePosition *position, bool *snapshot,
+            int *count);
 
     void session_subscribe_unregister(ServerSessionSubscriber *subscriber);
 
@@ -31,71 +31,39 @@ static int counter = 0;
 //            log_level >= LOG_DEBUG) fprintf(stderr, format, ##__VA_ARGS__)
 
 
+/* bind the system functions only, the cluster setup is deferred to the
+ * first access of the FastCFS mountpoint, so the processes which never
+ * access FastCFS such as ls and sed need not connect to the servers
+ */
 __attribute__ ((constructor)) static void preload_global_init(void)
 {
-    int result;
-    pid_t pid;
-    char *ns = "fs";
-    char *config_filename;
+    int64_t start_time_us;
 
-    config_filename = getenv("FCFS_PRELOAD_CONFIG_FILENAME");
-    if (config_filename == NULL) {
-        config_filename = FCFS_FUSE_DEFAULT_CONFIG_FILENAME;
+    start_time_us = get_current_time_us();
+    g_fcfs_preload_global_vars.config_filename =
+        getenv("FCFS_PRELOAD_CONFIG_FILENAME");
+    if (g_fcfs_preload_global_vars.config_filename == NULL) {
+        g_fcfs_preload_global_vars.config_filename =
+            FCFS_FUSE_DEFAULT_CONFIG_FILENAME;
     }
 
     log_init();
-    pid = getpid();
-    fprintf(stderr, "pid: %d, file: "__FILE__", line: %d, inited: %d, "
-            "constructor, config_filename: %s\n", pid, __LINE__,
-            g_fcfs_preload_global_vars.inited, config_filename);
-
-    if ((result=fcfs_preload_global_init()) != 0) {
-        return;
-    }
-
-#ifdef FCFS_PRELOAD_WITH_CAPI
-    if ((result=fcfs_capi_init()) != 0) {
-        return;
-    }
-#endif
-
-    FCFS_LOG_DEBUG("file: "__FILE__", line: %d, pid: %d, "
-            "constructor\n", __LINE__, pid);
-
-    log_set_fd_flags(&g_log_context, O_CLOEXEC);
-    if ((result=fcfs_posix_api_init("fcfs_preload",
-                    ns, config_filename)) != 0)
-    {
-        return;
-    }
-
-    FCFS_LOG_DEBUG("pid: %d, file: "__FILE__", line: %d, "
-            "constructor\n", pid, __LINE__);
-    if ((result=fcfs_posix_api_start()) != 0) {
+    if (fcfs_preload_global_init() != 0) {
+        g_fcfs_preload_global_vars.stage = FCFS_PRELOAD_STAGE_FAILED;
         return;
     }
 
     g_fcfs_preload_global_vars.cwd_call_type =
         FCFS_PRELOAD_CALL_SYSTEM;
-    g_fcfs_preload_global_vars.inited = true;
-
-    FCFS_LOG_DEBUG("pid: %d, file: "__FILE__", line: %d, inited: %d, "
-            "log_fd: %d\n", pid, __LINE__, g_fcfs_preload_global_vars.inited,
-            g_log_context.log_fd);
-
-    fprintf(stderr, "pid: %d, parent pid: %d, base path: %s, "
-            "log_level: %d, log_fd: %d\n", getpid(), getppid(),
-            SF_G_BASE_PATH_STR, g_log_context.log_level,
-            g_log_context.log_fd);
+    g_fcfs_preload_global_vars.startup_stat.constructor_us =
+        get_current_time_us() - start_time_us;
 }
 
 __attribute__ ((destructor)) static void preload_global_destroy(void)
 {
     FCFS_LOG_DEBUG("pid: %d, file: "__FILE__", line: %d, "
             "destructor\n", getpid(), __LINE__);
-    if (g_fcfs_preload_global_vars.inited) {
-        fcfs_posix_api_stop();
-    }
+    fcfs_preload_global_stop();
 }
 
 static inline void *fcfs_dlsym1(const char *fname)
@@ -128,10 +96,11 @@ static inline void *fcfs_dlsym2(const char *fname1, const char *fname2)
 #ifdef FCFS_PRELOAD_WITH_PAPI
 static inline int do_open(const char *path, int flags, int mode)
 {
+    FCFSPosixAPIContext *ctx;
     int fd;
 
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        fd = fcfs_open(path, flags, mode);
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        fd = fcfs_open_ex(ctx, path, flags, mode);
     } else {
         fd = syscall(SYS_open, path, flags, mode);
     }
@@ -200,8 +169,10 @@ int __open64_2_(const char *path, int flags)
 
 static inline int do_creat(const char *path, mode_t mode)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_creat(path, mode);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_creat_ex(ctx, path, mode);
     } else {
         return syscall(SYS_creat, path, mode);
     }
@@ -219,8 +190,10 @@ int creat64(const char *path, mode_t mode)
 
 static inline int do_truncate(const char *path, off_t length)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_truncate(path, length);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_truncate_ex(ctx, path, length);
     } else {
         return syscall(SYS_truncate, path, length);
     }
@@ -238,10 +211,12 @@ int truncate64(const char *path, off_t length)
 
 int lstat(const char *path, struct stat *buf)
 {
+    FCFSPosixAPIContext *ctx;
+
     FCFS_LOG_DEBUG("%d. func: %s, line: %d\n", ++counter, __FUNCTION__, __LINE__);
 
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_lstat(path, buf);
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_lstat_ex(ctx, path, buf);
     } else {
         return syscall(SYS_lstat, path, buf);
     }
@@ -249,10 +224,12 @@ int lstat(const char *path, struct stat *buf)
 
 static inline int do_lxstat(int ver, const char *path, struct stat *buf)
 {
+    FCFSPosixAPIContext *ctx;
+
     FCFS_LOG_DEBUG("%d. func: %s, ver: %d, path: %s\n", ++counter, __FUNCTION__, ver, path);
 
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_lstat(path, buf);
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_lstat_ex(ctx, path, buf);
     } else {
         if (g_fcfs_preload_global_vars.__lxstat == NULL) {
             g_fcfs_preload_global_vars.__lxstat = fcfs_dlsym1("__lxstat");
@@ -273,9 +250,11 @@ int __lxstat64(int ver, const char *path, struct stat64 *buf)
 
 int stat(const char *path, struct stat *buf)
 {
+    FCFSPosixAPIContext *ctx;
+
     FCFS_LOG_DEBUG("%d. func: %s, line: %d, path: %s\n", ++counter, __FUNCTION__, __LINE__, path);
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_stat(path, buf);
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_stat_ex(ctx, path, buf);
     } else {
         return syscall(SYS_stat, path, buf);
     }
@@ -283,9 +262,11 @@ int stat(const char *path, struct stat *buf)
 
 static inline int do_xstat(int ver, const char *path, struct stat *buf)
 {
+    FCFSPosixAPIContext *ctx;
+
     FCFS_LOG_DEBUG("%d. func: %s, ver: %d, path: %s\n", ++counter, __FUNCTION__, ver, path);
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_stat(path, buf);
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_stat_ex(ctx, path, buf);
     } else {
         if (g_fcfs_preload_global_vars.__xstat == NULL) {
             g_fcfs_preload_global_vars.__xstat = fcfs_dlsym1("__xstat");
@@ -306,10 +287,17 @@ int __xstat64(int ver, const char *path, struct stat64 *buf)
 
 int link(const char *path1, const char *path2)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path1) ||
-            FCFS_PRELOAD_IS_MY_MOUNTPOINT(path2))
-    {
-        return fcfs_link(path1, path2);
+    FCFSPosixAPIContext *ctx1;
+    FCFSPosixAPIContext *ctx2;
+
+    ctx1 = FCFS_PRELOAD_GET_CONTEXT(path1);
+    ctx2 = FCFS_PRELOAD_GET_CONTEXT(path2);
+    if (ctx1 != NULL || ctx2 != NULL) {
+        if (ctx1 != ctx2) {  //across the filesystems
+            errno = EXDEV;
+            return -1;
+        }
+        return fcfs_link_ex(ctx1, path1, path2);
     } else {
         return syscall(SYS_link, path1, path2);
     }
@@ -317,8 +305,10 @@ int link(const char *path1, const char *path2)
 
 int symlink(const char *link, const char *path)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_symlink(link, path);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_symlink_ex(ctx, link, path);
     } else {
         return syscall(SYS_symlink, link, path);
     }
@@ -326,8 +316,10 @@ int symlink(const char *link, const char *path)
 
 ssize_t readlink(const char *path, char *buff, size_t size)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_readlink(path, buff, size);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_readlink_ex(ctx, path, buff, size);
     } else {
         return syscall(SYS_readlink, path, buff, size);
     }
@@ -335,8 +327,10 @@ ssize_t readlink(const char *path, char *buff, size_t size)
 
 int mknod(const char *path, mode_t mode, dev_t dev)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_mknod(path, mode, dev);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_mknod_ex(ctx, path, mode, dev);
     } else {
         return syscall(SYS_mknod, path, mode, dev);
     }
@@ -344,8 +338,10 @@ int mknod(const char *path, mode_t mode, dev_t dev)
 
 int __xmknod(int ver, const char *path, mode_t mode, dev_t *dev)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_mknod(path, mode, *dev);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_mknod_ex(ctx, path, mode, *dev);
     } else {
         if (g_fcfs_preload_global_vars.__xmknod == NULL) {
             g_fcfs_preload_global_vars.__xmknod = fcfs_dlsym1("__xmknod");
@@ -356,8 +352,10 @@ int __xmknod(int ver, const char *path, mode_t mode, dev_t *dev)
 
 int mkfifo(const char *path, mode_t mode)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_mkfifo(path, mode);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_mkfifo_ex(ctx, path, mode);
     } else {
         if (g_fcfs_preload_global_vars.mkfifo == NULL) {
             g_fcfs_preload_global_vars.mkfifo = fcfs_dlsym1("mkfifo");
@@ -368,10 +366,12 @@ int mkfifo(const char *path, mode_t mode)
 
 int access(const char *path, int mode)
 {
+    FCFSPosixAPIContext *ctx;
+
     FCFS_LOG_DEBUG("%d. func: %s, path: %s, mode: %o\n",
             ++counter, __FUNCTION__, path, mode);
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_access(path, mode);
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_access_ex(ctx, path, mode);
     } else {
         return syscall(SYS_access, path, mode);
     }
@@ -379,9 +379,11 @@ int access(const char *path, int mode)
 
 int eaccess(const char *path, int mode)
 {
+    FCFSPosixAPIContext *ctx;
+
     FCFS_LOG_DEBUG("func: %s, path: %s, mode: %o\n", __FUNCTION__, path, mode);
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_eaccess(path, mode);
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_eaccess_ex(ctx, path, mode);
     } else {
         if (g_fcfs_preload_global_vars.eaccess == NULL) {
             g_fcfs_preload_global_vars.eaccess = fcfs_dlsym1("eaccess");
@@ -392,9 +394,11 @@ int eaccess(const char *path, int mode)
 
 int euidaccess(const char *path, int mode)
 {
+    FCFSPosixAPIContext *ctx;
+
     FCFS_LOG_DEBUG("func: %s, path: %s, mode: %o\n", __FUNCTION__, path, mode);
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_euidaccess(path, mode);
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_euidaccess_ex(ctx, path, mode);
     } else {
         if (g_fcfs_preload_global_vars.euidaccess == NULL) {
             g_fcfs_preload_global_vars.euidaccess = fcfs_dlsym1("euidaccess");
@@ -405,8 +409,10 @@ int euidaccess(const char *path, int mode)
 
 int utime(const char *path, const struct utimbuf *times)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_utime(path, times);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_utime_ex(ctx, path, times);
     } else {
         return syscall(SYS_utime, path, times);
     }
@@ -414,8 +420,10 @@ int utime(const char *path, const struct utimbuf *times)
 
 int utimes(const char *path, const struct timeval times[2])
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_utimes(path, times);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_utimes_ex(ctx, path, times);
     } else {
         return syscall(SYS_utimes, path, times);
     }
@@ -423,8 +431,10 @@ int utimes(const char *path, const struct timeval times[2])
 
 int unlink(const char *path)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_unlink(path);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_unlink_ex(ctx, path);
     } else {
         return syscall(SYS_unlink, path);
     }
@@ -432,10 +442,17 @@ int unlink(const char *path)
 
 int rename(const char *path1, const char *path2)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path1) ||
-            FCFS_PRELOAD_IS_MY_MOUNTPOINT(path2))
-    {
-        return fcfs_rename(path1, path2);
+    FCFSPosixAPIContext *ctx1;
+    FCFSPosixAPIContext *ctx2;
+
+    ctx1 = FCFS_PRELOAD_GET_CONTEXT(path1);
+    ctx2 = FCFS_PRELOAD_GET_CONTEXT(path2);
+    if (ctx1 != NULL || ctx2 != NULL) {
+        if (ctx1 != ctx2) {  //across the filesystems
+            errno = EXDEV;
+            return -1;
+        }
+        return fcfs_rename_ex(ctx1, path1, path2);
     } else {
         return syscall(SYS_rename, path1, path2);
     }
@@ -443,8 +460,10 @@ int rename(const char *path1, const char *path2)
 
 int mkdir(const char *path, mode_t mode)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_mkdir(path, mode);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_mkdir_ex(ctx, path, mode);
     } else {
         return syscall(SYS_mkdir, path, mode);
     }
@@ -452,8 +471,10 @@ int mkdir(const char *path, mode_t mode)
 
 int rmdir(const char *path)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_rmdir(path);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_rmdir_ex(ctx, path);
     } else {
         return syscall(SYS_rmdir, path);
     }
@@ -461,8 +482,10 @@ int rmdir(const char *path)
 
 int chown(const char *path, uid_t owner, gid_t group)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_chown(path, owner, group);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_chown_ex(ctx, path, owner, group);
     } else {
         return syscall(SYS_chown, path, owner, group);
     }
@@ -470,8 +493,10 @@ int chown(const char *path, uid_t owner, gid_t group)
 
 int lchown(const char *path, uid_t owner, gid_t group)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_lchown(path, owner, group);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_lchown_ex(ctx, path, owner, group);
     } else {
         return syscall(SYS_lchown, path, owner, group);
     }
@@ -479,8 +504,10 @@ int lchown(const char *path, uid_t owner, gid_t group)
 
 int chmod(const char *path, mode_t mode)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_chmod(path, mode);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_chmod_ex(ctx, path, mode);
     } else {
         return syscall(SYS_chmod, path, mode);
     }
@@ -488,8 +515,10 @@ int chmod(const char *path, mode_t mode)
 
 static inline int do_statvfs(const char *path, struct statvfs *buf)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_statvfs(path, buf);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_statvfs_ex(ctx, path, buf);
     } else {
         if (g_fcfs_preload_global_vars.statvfs == NULL) {
             g_fcfs_preload_global_vars.statvfs = fcfs_dlsym2(
@@ -512,8 +541,10 @@ int statvfs64(const char *path, struct statvfs64 *buf)
 int setxattr(const char *path, const char *name,
         const void *value, size_t size, int flags)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_setxattr(path, name, value, size, flags);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_setxattr_ex(ctx, path, name, value, size, flags);
     } else {
         return syscall(SYS_setxattr, path, name, value, size, flags);
     }
@@ -522,8 +553,10 @@ int setxattr(const char *path, const char *name,
 int lsetxattr(const char *path, const char *name,
         const void *value, size_t size, int flags)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_lsetxattr(path, name, value, size, flags);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_lsetxattr_ex(ctx, path, name, value, size, flags);
     } else {
         return syscall(SYS_lsetxattr, path, name, value, size, flags);
     }
@@ -531,8 +564,10 @@ int lsetxattr(const char *path, const char *name,
 
 ssize_t getxattr(const char *path, const char *name, void *value, size_t size)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_getxattr(path, name, value, size);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_getxattr_ex(ctx, path, name, value, size);
     } else {
         return syscall(SYS_getxattr, path, name, value, size);
     }
@@ -540,8 +575,10 @@ ssize_t getxattr(const char *path, const char *name, void *value, size_t size)
 
 ssize_t lgetxattr(const char *path, const char *name, void *value, size_t size)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_lgetxattr(path, name, value, size);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_lgetxattr_ex(ctx, path, name, value, size);
     } else {
         return syscall(SYS_lgetxattr, path, name, value, size);
     }
@@ -549,8 +586,10 @@ ssize_t lgetxattr(const char *path, const char *name, void *value, size_t size)
 
 ssize_t listxattr(const char *path, char *list, size_t size)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_listxattr(path, list, size);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_listxattr_ex(ctx, path, list, size);
     } else {
         return syscall(SYS_listxattr, path, list, size);
     }
@@ -558,8 +597,10 @@ ssize_t listxattr(const char *path, char *list, size_t size)
 
 ssize_t llistxattr(const char *path, char *list, size_t size)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_llistxattr(path, list, size);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_llistxattr_ex(ctx, path, list, size);
     } else {
         return syscall(SYS_llistxattr, path, list, size);
     }
@@ -567,8 +608,10 @@ ssize_t llistxattr(const char *path, char *list, size_t size)
 
 int removexattr(const char *path, const char *name)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_removexattr(path, name);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_removexattr_ex(ctx, path, name);
     } else {
         return syscall(SYS_removexattr, path, name);
     }
@@ -576,8 +619,10 @@ int removexattr(const char *path, const char *name)
 
 int lremovexattr(const char *path, const char *name)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_lremovexattr(path, name);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_lremovexattr_ex(ctx, path, name);
     } else {
         return syscall(SYS_lremovexattr, path, name);
     }
@@ -585,13 +630,15 @@ int lremovexattr(const char *path, const char *name)
 
 int chdir(const char *path)
 {
+    FCFSPosixAPIContext *ctx;
     int result;
 
     FCFS_LOG_DEBUG("%d. func: %s, line: %d, path: %s\n",
             ++counter, __FUNCTION__, __LINE__, path);
 
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        if ((result=fcfs_chdir(path)) == 0) {
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        if ((result=fcfs_chdir_ex(ctx, path)) == 0) {
+            g_fcfs_preload_global_vars.cwd_ctx = ctx;
             g_fcfs_preload_global_vars.cwd_call_type =
                 FCFS_PRELOAD_CALL_FASTCFS;
         }
@@ -607,8 +654,10 @@ int chdir(const char *path)
 
 int chroot(const char *path)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_chroot(path);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_chroot_ex(ctx, path);
     } else {
         return syscall(SYS_chroot, path);
     }
@@ -616,15 +665,16 @@ int chroot(const char *path)
 
 DIR *opendir(const char *path)
 {
+    FCFSPosixAPIContext *ctx;
     FCFSPreloadDIRWrapper *wapper;
     DIR *dirp;
     int call_type;
 
     FCFS_LOG_DEBUG("%d. func: %s, path: %s\n", ++counter, __FUNCTION__, path);
 
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
         call_type = FCFS_PRELOAD_CALL_FASTCFS;
-        dirp = (DIR *)fcfs_opendir(path);
+        dirp = (DIR *)fcfs_opendir_ex(ctx, path);
     } else {
         call_type = FCFS_PRELOAD_CALL_SYSTEM;
         if (g_fcfs_preload_global_vars.opendir == NULL) {
@@ -646,8 +696,10 @@ DIR *opendir(const char *path)
 static inline int do_scandir(const char *path, struct dirent ***namelist,
         fcfs_dir_filter_func filter, fcfs_dir_compare_func compar)
 {
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
-        return fcfs_scandir(path, namelist, filter, compar);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
+        return fcfs_scandir_ex(ctx, path, namelist, filter, compar);
     } else {
         if (g_fcfs_preload_global_vars.scandir == NULL) {
             g_fcfs_preload_global_vars.scandir = fcfs_dlsym1("scandir");
@@ -677,6 +729,7 @@ int close(int fd)
     FCFS_LOG_DEBUG("%d. pid: %d, func: %s, line: %d, fd: %d\n", ++counter,
             getpid(), __FUNCTION__, __LINE__, fd);
 
+    /* the close is local only after fork, no need to rebuild */
     if (FCFS_PAPI_IS_MY_FD(fd)) {
         return fcfs_close(fd);
     } else {
@@ -686,7 +739,7 @@ int close(int fd)
 
 int fsync(int fd)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_fsync(fd);
     } else {
         return syscall(SYS_fsync, fd);
@@ -695,7 +748,7 @@ int fsync(int fd)
 
 int fdatasync(int fd)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_fdatasync(fd);
     } else {
         return syscall(SYS_fdatasync, fd);
@@ -704,7 +757,7 @@ int fdatasync(int fd)
 
 ssize_t write(int fd, const void *buff, size_t count)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_write(fd, buff, count);
     } else {
         return syscall(SYS_write, fd, buff, count);
@@ -714,7 +767,7 @@ ssize_t write(int fd, const void *buff, size_t count)
 static inline ssize_t do_pwrite(int fd, const void *buff,
         size_t count, off_t offset)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_pwrite(fd, buff, count, offset);
     } else {
         return syscall(SYS_pwrite64, fd, buff, count, offset);
@@ -733,7 +786,7 @@ ssize_t pwrite64(int fd, const void *buff, size_t count, off_t offset)
 
 ssize_t writev(int fd, const struct iovec *iov, int iovcnt)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_writev(fd, iov, iovcnt);
     } else {
         return syscall(SYS_writev, fd, iov, iovcnt);
@@ -743,7 +796,7 @@ ssize_t writev(int fd, const struct iovec *iov, int iovcnt)
 static inline ssize_t do_pwritev(int fd, const struct iovec *iov,
         int iovcnt, off_t offset)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_pwritev(fd, iov, iovcnt, offset);
     } else {
         return syscall(SYS_writev, fd, iov, iovcnt, offset);
@@ -764,7 +817,7 @@ ssize_t read(int fd, void *buff, size_t count)
 {
     FCFS_LOG_DEBUG("%d. line: %d, func: %s, fd: %d, count: %d\n",
             ++counter, __LINE__, __FUNCTION__, fd, (int)count);
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_read(fd, buff, count);
     } else {
         return syscall(SYS_read, fd, buff, count);
@@ -783,7 +836,7 @@ ssize_t __read_chk(int fd, void *buff, size_t count, size_t size)
 ssize_t readahead(int fd, off64_t offset, size_t count)
 {
     FCFS_LOG_DEBUG("func: %s, fd: %d\n", __FUNCTION__, fd);
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_readahead(fd, offset, count);
     } else {
         return syscall(SYS_readahead, fd, offset, count);
@@ -793,7 +846,7 @@ ssize_t readahead(int fd, off64_t offset, size_t count)
 static inline ssize_t do_pread(int fd, void *buff, size_t count, off_t offset)
 {
     FCFS_LOG_DEBUG("%d. func: %s, fd: %d\n", ++counter, __FUNCTION__, fd);
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_pread(fd, buff, count, offset);
     } else {
         return syscall(SYS_pread64, fd, buff, count, offset);
@@ -833,7 +886,7 @@ ssize_t __pread64_chk(int fd, void *buff, size_t count,
 ssize_t readv(int fd, const struct iovec *iov, int iovcnt)
 {
     FCFS_LOG_DEBUG("%d. func: %s, fd: %d\n", ++counter, __FUNCTION__, fd);
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_readv(fd, iov, iovcnt);
     } else {
         return syscall(SYS_readv, fd, iov, iovcnt);
@@ -843,7 +896,7 @@ ssize_t readv(int fd, const struct iovec *iov, int iovcnt)
 static inline ssize_t do_preadv(int fd, const struct iovec *iov,
         int iovcnt, off_t offset)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_preadv(fd, iov, iovcnt, offset);
     } else {
         return syscall(SYS_preadv, fd, iov, iovcnt, offset);
@@ -864,7 +917,7 @@ ssize_t preadv64(int fd, const struct iovec *iov, int iovcnt, off_t offset)
 
 static inline off_t do_lseek(int fd, off_t offset, int whence)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_lseek(fd, offset, whence);
     } else {
         return syscall(SYS_lseek, fd, offset, whence);
@@ -891,7 +944,7 @@ off_t lseek64(int fd, off_t offset, int whence)
 
 static inline int do_fallocate(int fd, int mode, off_t offset, off_t length)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_fallocate(fd, mode, offset, length);
     } else {
         return syscall(SYS_fallocate, fd, mode, offset, length);
@@ -910,7 +963,7 @@ int fallocate64(int fd, int mode, off_t offset, off_t length)
 
 static inline int do_ftruncate(int fd, off_t length)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_ftruncate(fd, length);
     } else {
         return syscall(SYS_ftruncate, fd, length);
@@ -930,7 +983,7 @@ int ftruncate64(int fd, off_t length)
 int fstat(int fd, struct stat *buf)
 {
     FCFS_LOG_DEBUG("%d. func: %s, fd: %d\n", ++counter, __FUNCTION__, fd);
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_fstat(fd, buf);
     } else {
         return syscall(SYS_fstat, fd, buf);
@@ -940,7 +993,7 @@ int fstat(int fd, struct stat *buf)
 static inline int do_fxstat(int ver, int fd, struct stat *buf)
 {
     FCFS_LOG_DEBUG("%d. func: %s, ver: %d, fd: %d\n", ++counter, __FUNCTION__, ver, fd);
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_fstat(fd, buf);
     } else {
         if (g_fcfs_preload_global_vars.__fxstat == NULL) {
@@ -965,7 +1018,7 @@ int __fxstat64(int ver, int fd, struct stat64 *buf)
 int flock(int fd, int operation)
 {
     FCFS_LOG_DEBUG("func: %s, fd: %d, operation: %d\n", __FUNCTION__, fd, operation);
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_flock(fd, operation);
     } else {
         return syscall(SYS_flock, fd, operation);
@@ -982,7 +1035,7 @@ static int do_fcntl(int fd, int cmd, void *arg)
         case F_SETLK:
         case F_SETLKW:
             lock = (struct flock *)arg;
-            if (FCFS_PAPI_IS_MY_FD(fd)) {
+            if (FCFS_PRELOAD_IS_MY_FD(fd)) {
                 return fcfs_fcntl(fd, cmd, lock); 
             } else {
                 return syscall(SYS_fcntl, fd, cmd, lock);
@@ -993,7 +1046,7 @@ static int do_fcntl(int fd, int cmd, void *arg)
             FCFS_LOG_DEBUG("func: %s, fd: %d, cmd: %d, flags: %d\n",
                     __FUNCTION__, fd, cmd, flags);
 
-            if (FCFS_PAPI_IS_MY_FD(fd)) {
+            if (FCFS_PRELOAD_IS_MY_FD(fd)) {
                 return fcfs_fcntl(fd, cmd, flags); 
             } else {
                 return syscall(SYS_fcntl, fd, cmd, flags);
@@ -1029,8 +1082,8 @@ int fcntl64(int fd, int cmd, ...)
 
 int futimes(int fd, const struct timeval times[2])
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
-        return fcfs_futimes(fd, times);
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
+        return fcfs_futimes_ex(FCFS_PRELOAD_GET_FD_CONTEXT(fd), fd, times);
     } else {
         if (g_fcfs_preload_global_vars.futimes == NULL) {
             g_fcfs_preload_global_vars.futimes = fcfs_dlsym1("futimes");
@@ -1041,8 +1094,8 @@ int futimes(int fd, const struct timeval times[2])
 
 int futimens(int fd, const struct timespec times[2])
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
-        return fcfs_futimens(fd, times);
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
+        return fcfs_futimens_ex(FCFS_PRELOAD_GET_FD_CONTEXT(fd), fd, times);
     } else {
         if (g_fcfs_preload_global_vars.futimens == NULL) {
             g_fcfs_preload_global_vars.futimens = fcfs_dlsym1("futimens");
@@ -1053,7 +1106,7 @@ int futimens(int fd, const struct timespec times[2])
 
 int fchown(int fd, uid_t owner, gid_t group)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_fchown(fd, owner, group);
     } else {
         return syscall(SYS_fchown, fd, owner, group);
@@ -1062,7 +1115,7 @@ int fchown(int fd, uid_t owner, gid_t group)
 
 int fchmod(int fd, mode_t mode)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_fchmod(fd, mode);
     } else {
         return syscall(SYS_fchmod, fd, mode);
@@ -1072,7 +1125,7 @@ int fchmod(int fd, mode_t mode)
 int fsetxattr(int fd, const char *name, const
         void *value, size_t size, int flags)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_fsetxattr(fd, name, value, size, flags);
     } else {
         return syscall(SYS_fsetxattr, fd, name, value, size, flags);
@@ -1081,7 +1134,7 @@ int fsetxattr(int fd, const char *name, const
 
 ssize_t fgetxattr(int fd, const char *name, void *value, size_t size)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_fgetxattr(fd, name, value, size);
     } else {
         return syscall(SYS_fgetxattr, fd, name, value, size);
@@ -1090,7 +1143,7 @@ ssize_t fgetxattr(int fd, const char *name, void *value, size_t size)
 
 ssize_t flistxattr(int fd, char *list, size_t size)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_flistxattr(fd, list, size);
     } else {
         return syscall(SYS_flistxattr, fd, list, size);
@@ -1099,7 +1152,7 @@ ssize_t flistxattr(int fd, char *list, size_t size)
 
 int fremovexattr(int fd, const char *name)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_fremovexattr(fd, name);
     } else {
         return syscall(SYS_fremovexattr, fd, name);
@@ -1110,8 +1163,10 @@ int fchdir(int fd)
 {
     int result;
 
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         if ((result=fcfs_fchdir(fd)) == 0) {
+            g_fcfs_preload_global_vars.cwd_ctx =
+                FCFS_PRELOAD_GET_FD_CONTEXT(fd);
             g_fcfs_preload_global_vars.cwd_call_type =
                 FCFS_PRELOAD_CALL_FASTCFS;
         }
@@ -1127,7 +1182,7 @@ int fchdir(int fd)
 
 static inline int do_fstatvfs(int fd, struct statvfs *buf)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_fstatvfs(fd, buf);
     } else {
         if (g_fcfs_preload_global_vars.fstatvfs == NULL) {
@@ -1151,7 +1206,7 @@ int fstatvfs64(int fd, struct statvfs64 *buf)
 int dup(int fd)
 {
     FCFS_LOG_DEBUG("#func: %s, fd: %d\n", __FUNCTION__, fd);
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_dup(fd);
     } else {
         return syscall(SYS_dup, fd);
@@ -1161,7 +1216,7 @@ int dup(int fd)
 int dup2(int fd1, int fd2)
 {
     FCFS_LOG_DEBUG("#func: %s, fd1: %d, fd2: %d\n", __FUNCTION__, fd1, fd2);
-    if (FCFS_PAPI_IS_MY_FD(fd1) && FCFS_PAPI_IS_MY_FD(fd2)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd1) && FCFS_PRELOAD_IS_MY_FD(fd2)) {
         return fcfs_dup2(fd1, fd2);
     } else {
         return syscall(SYS_dup2, fd1, fd2);
@@ -1173,7 +1228,7 @@ static inline void *do_mmap(void *addr, size_t length, int prot,
 {
     FCFS_LOG_DEBUG("func: %s, fd: %d, offset: %"PRId64"\n",
             __FUNCTION__, fd, (int64_t)offset);
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_mmap(addr, length, prot, flags, fd, offset);
     } else {
         return (void *)syscall(SYS_mmap, addr, length,
@@ -1200,9 +1255,9 @@ DIR *fdopendir(int fd)
     int call_type;
 
     FCFS_LOG_DEBUG("%d. func: %s, fd: %d\n", ++counter, __FUNCTION__, fd);
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         call_type = FCFS_PRELOAD_CALL_FASTCFS;
-        dirp = (DIR *)fcfs_fdopendir(fd);
+        dirp = (DIR *)fcfs_fdopendir_ex(FCFS_PRELOAD_GET_FD_CONTEXT(fd), fd);
     } else {
         call_type = FCFS_PRELOAD_CALL_SYSTEM;
         if (g_fcfs_preload_global_vars.fdopendir == NULL) {
@@ -1223,8 +1278,10 @@ DIR *fdopendir(int fd)
 
 int symlinkat(const char *link, int fd, const char *path)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_symlinkat(link, fd, path);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_symlinkat_ex(ctx, link, fd, path);
     } else {
         return syscall(SYS_symlinkat, link, fd, path);
     }
@@ -1232,9 +1289,11 @@ int symlinkat(const char *link, int fd, const char *path)
 
 static inline int do_openat(int fd, const char *path, int flags, int mode)
 {
+    FCFSPosixAPIContext *ctx;
+
     FCFS_LOG_DEBUG("func: %s, path: %s, mode: %o\n", __FUNCTION__, path, mode);
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_openat(fd, path, flags, mode);
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_openat_ex(ctx, fd, path, flags, mode);
     } else {
         return syscall(SYS_openat, fd, path, flags, mode);
     }
@@ -1280,9 +1339,11 @@ int __openat64_2(int fd, const char *path, int flags)
 
 int fstatat(int fd, const char *path, struct stat *buf, int flags)
 {
+    FCFSPosixAPIContext *ctx;
+
     FCFS_LOG_DEBUG("func: %s, fd: %d, path: %s\n", __FUNCTION__, fd, path);
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_fstatat(fd, path, buf, flags);
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_fstatat_ex(ctx, fd, path, buf, flags);
     } else {
         if (g_fcfs_preload_global_vars.fstatat == NULL) {
             g_fcfs_preload_global_vars.fstatat = fcfs_dlsym1("fstatat");
@@ -1294,9 +1355,11 @@ int fstatat(int fd, const char *path, struct stat *buf, int flags)
 static inline int do_fxstatat(int ver, int fd,
         const char *path, struct stat *buf, int flags)
 {
+    FCFSPosixAPIContext *ctx;
+
     FCFS_LOG_DEBUG("%d. line: %d, func: %s, fd: %d, path: %s\n", ++counter, __LINE__, __FUNCTION__, fd, path);
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_fstatat(fd, path, buf, flags);
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_fstatat_ex(ctx, fd, path, buf, flags);
     } else {
         if (g_fcfs_preload_global_vars.__fxstatat == NULL) {
             g_fcfs_preload_global_vars.__fxstatat = fcfs_dlsym1("__fxstatat");
@@ -1319,8 +1382,10 @@ int __fxstatat64(int ver, int fd, const char *path,
 
 ssize_t readlinkat(int fd, const char *path, char *buff, size_t size)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_readlinkat(fd, path, buff, size);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_readlinkat_ex(ctx, fd, path, buff, size);
     } else {
         return syscall(SYS_readlinkat, fd, path, buff, size);
     }
@@ -1328,8 +1393,10 @@ ssize_t readlinkat(int fd, const char *path, char *buff, size_t size)
 
 int mknodat(int fd, const char *path, mode_t mode, dev_t dev)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_mknodat(fd, path, mode, dev);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_mknodat_ex(ctx, fd, path, mode, dev);
     } else {
         return syscall(SYS_mknodat, fd, path, mode, dev);
     }
@@ -1337,8 +1404,10 @@ int mknodat(int fd, const char *path, mode_t mode, dev_t dev)
 
 int __xmknodat(int ver, int fd, const char *path, mode_t mode, dev_t *dev)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_mknodat(fd, path, mode, *dev);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_mknodat_ex(ctx, fd, path, mode, *dev);
     } else {
         if (g_fcfs_preload_global_vars.__xmknodat == NULL) {
             g_fcfs_preload_global_vars.__xmknodat = fcfs_dlsym1("__xmknodat");
@@ -1349,8 +1418,10 @@ int __xmknodat(int ver, int fd, const char *path, mode_t mode, dev_t *dev)
 
 int mkfifoat(int fd, const char *path, mode_t mode)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_mkfifoat(fd, path, mode);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_mkfifoat_ex(ctx, fd, path, mode);
     } else {
         if (g_fcfs_preload_global_vars.mkfifoat == NULL) {
             g_fcfs_preload_global_vars.mkfifoat = fcfs_dlsym1("mkfifoat");
@@ -1361,9 +1432,11 @@ int mkfifoat(int fd, const char *path, mode_t mode)
 
 int faccessat(int fd, const char *path, int mode, int flags)
 {
+    FCFSPosixAPIContext *ctx;
+
     FCFS_LOG_DEBUG("%d. func: %s, path: %s, mode: %o\n", ++counter, __FUNCTION__, path, mode);
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_faccessat(fd, path, mode, flags);
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_faccessat_ex(ctx, fd, path, mode, flags);
     } else {
         return syscall(SYS_faccessat, fd, path, mode, flags);
     }
@@ -1371,8 +1444,10 @@ int faccessat(int fd, const char *path, int mode, int flags)
 
 int futimesat(int fd, const char *path, const struct timeval times[2])
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_futimesat(fd, path, times);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_futimesat_ex(ctx, fd, path, times);
     } else {
         return syscall(SYS_futimesat, fd, path, times);
     }
@@ -1380,8 +1455,10 @@ int futimesat(int fd, const char *path, const struct timeval times[2])
 
 int utimensat(int fd, const char *path, const struct timespec times[2], int flags)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_utimensat(fd, path, times, flags);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_utimensat_ex(ctx, fd, path, times, flags);
     } else {
         return syscall(SYS_utimensat, fd, path, times, flags);
     }
@@ -1389,8 +1466,10 @@ int utimensat(int fd, const char *path, const struct timespec times[2], int flag
 
 int unlinkat(int fd, const char *path, int flags)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_unlinkat(fd, path, flags);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_unlinkat_ex(ctx, fd, path, flags);
     } else {
         return syscall(SYS_unlinkat, fd, path, flags);
     }
@@ -1398,8 +1477,10 @@ int unlinkat(int fd, const char *path, int flags)
 
 int mkdirat(int fd, const char *path, mode_t mode)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_mkdirat(fd, path, mode);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_mkdirat_ex(ctx, fd, path, mode);
     } else {
         return syscall(SYS_futimesat, fd, path, mode);
     }
@@ -1407,8 +1488,10 @@ int mkdirat(int fd, const char *path, mode_t mode)
 
 int fchownat(int fd, const char *path, uid_t owner, gid_t group, int flags)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_fchownat(fd, path, owner, group, flags);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_fchownat_ex(ctx, fd, path, owner, group, flags);
     } else {
         return syscall(SYS_fchownat, fd, path, owner, group, flags);
     }
@@ -1416,8 +1499,10 @@ int fchownat(int fd, const char *path, uid_t owner, gid_t group, int flags)
 
 int fchmodat(int fd, const char *path, mode_t mode, int flags)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_fchmodat(fd, path, mode, flags);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_fchmodat_ex(ctx, fd, path, mode, flags);
     } else {
         return syscall(SYS_fchmodat, fd, path, mode, flags);
     }
@@ -1425,10 +1510,17 @@ int fchmodat(int fd, const char *path, mode_t mode, int flags)
 
 int linkat(int fd1, const char *path1, int fd2, const char *path2, int flags)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd1, path1) ||
-            FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd2, path2))
-    {
-        return fcfs_linkat(fd1, path1, fd2, path2, flags);
+    FCFSPosixAPIContext *ctx1;
+    FCFSPosixAPIContext *ctx2;
+
+    ctx1 = FCFS_PRELOAD_GET_AT_CONTEXT(fd1, path1);
+    ctx2 = FCFS_PRELOAD_GET_AT_CONTEXT(fd2, path2);
+    if (ctx1 != NULL || ctx2 != NULL) {
+        if (ctx1 != ctx2) {  //across the filesystems
+            errno = EXDEV;
+            return -1;
+        }
+        return fcfs_linkat_ex(ctx1, fd1, path1, fd2, path2, flags);
     } else {
         return syscall(SYS_linkat, fd1, path1, fd2, path2, flags);
     }
@@ -1436,10 +1528,17 @@ int linkat(int fd1, const char *path1, int fd2, const char *path2, int flags)
 
 int renameat(int fd1, const char *path1, int fd2, const char *path2)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd1, path1) ||
-            FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd2, path2))
-    {
-        return fcfs_renameat(fd1, path1, fd2, path2);
+    FCFSPosixAPIContext *ctx1;
+    FCFSPosixAPIContext *ctx2;
+
+    ctx1 = FCFS_PRELOAD_GET_AT_CONTEXT(fd1, path1);
+    ctx2 = FCFS_PRELOAD_GET_AT_CONTEXT(fd2, path2);
+    if (ctx1 != NULL || ctx2 != NULL) {
+        if (ctx1 != ctx2) {  //across the filesystems
+            errno = EXDEV;
+            return -1;
+        }
+        return fcfs_renameat_ex(ctx1, fd1, path1, fd2, path2);
     } else {
         return syscall(SYS_renameat, fd1, path1, fd2, path2);
     }
@@ -1448,10 +1547,17 @@ int renameat(int fd1, const char *path1, int fd2, const char *path2)
 int renameat2(int fd1, const char *path1, int fd2,
         const char *path2, unsigned int flags)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd1, path1) ||
-            FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd2, path2))
-    {
-        return fcfs_renameat2(fd1, path1, fd2, path2, flags);
+    FCFSPosixAPIContext *ctx1;
+    FCFSPosixAPIContext *ctx2;
+
+    ctx1 = FCFS_PRELOAD_GET_AT_CONTEXT(fd1, path1);
+    ctx2 = FCFS_PRELOAD_GET_AT_CONTEXT(fd2, path2);
+    if (ctx1 != NULL || ctx2 != NULL) {
+        if (ctx1 != ctx2) {  //across the filesystems
+            errno = EXDEV;
+            return -1;
+        }
+        return fcfs_renameat2_ex(ctx1, fd1, path1, fd2, path2, flags);
     } else {
         return syscall(SYS_renameat2, fd1, path1, fd2, path2, flags);
     }
@@ -1461,8 +1567,10 @@ static inline int do_scandirat(int fd, const char *path,
         struct dirent ***namelist, fcfs_dir_filter_func filter,
         fcfs_dir_compare_func compar)
 {
-    if (FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path)) {
-        return fcfs_scandirat(fd, path, namelist, filter, compar);
+    FCFSPosixAPIContext *ctx;
+
+    if ((ctx=FCFS_PRELOAD_GET_AT_CONTEXT(fd, path)) != NULL) {
+        return fcfs_scandirat_ex(ctx, fd, path, namelist, filter, compar);
     } else {
         if (g_fcfs_preload_global_vars.scandirat == NULL) {
             g_fcfs_preload_global_vars.scandirat = fcfs_dlsym1("scandirat");
@@ -1495,7 +1603,8 @@ char *getcwd(char *buf, size_t size)
     if (g_fcfs_preload_global_vars.cwd_call_type ==
             FCFS_PRELOAD_CALL_FASTCFS)
     {
-        return fcfs_getcwd(buf, size);
+        return fcfs_getcwd_ex(g_fcfs_preload_global_vars.
+                cwd_ctx, buf, size);
     } else {
         return g_fcfs_preload_global_vars.getcwd(buf, size);
     }
@@ -1506,7 +1615,7 @@ char *getwd(char *buf)
     if (g_fcfs_preload_global_vars.cwd_call_type ==
             FCFS_PRELOAD_CALL_FASTCFS)
     {
-        return fcfs_getwd(buf);
+        return fcfs_getwd_ex(g_fcfs_preload_global_vars.cwd_ctx, buf);
     } else {
         return g_fcfs_preload_global_vars.getwd(buf);
     }
@@ -1520,7 +1629,7 @@ int closedir(DIR *dirp)
     FCFS_LOG_DEBUG("%d. func: %s, line: %d\n", ++counter, __FUNCTION__, __LINE__);
     wapper = (FCFSPreloadDIRWrapper *)dirp;
     if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
-        result = fcfs_closedir(wapper->dirp);
+        result = fcfs_closedir(wapper->dirp);  //no need to rebuild
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.closedir == NULL) {
             g_fcfs_preload_global_vars.closedir = fcfs_dlsym1("closedir");
@@ -1540,7 +1649,7 @@ static inline struct dirent *do_readdir(DIR *dirp)
     FCFSPreloadDIRWrapper *wapper;
 
     wapper = (FCFSPreloadDIRWrapper *)dirp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_readdir(wapper->dirp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.readdir == NULL) {
@@ -1572,7 +1681,7 @@ static inline int do_readdir_r(DIR *dirp, struct dirent *entry,
 
     wapper = (FCFSPreloadDIRWrapper *)dirp;
 
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_readdir_r(wapper->dirp, entry, result);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.readdir_r == NULL) {
@@ -1597,12 +1706,22 @@ int readdir64_r(DIR *dirp, struct dirent64 *entry, struct dirent64 **result)
     return do_readdir_r(dirp, (struct dirent *)entry, (struct dirent **)result);
 }
 
+ssize_t getdents64(int fd, void *dirp, size_t count)
+{
+    FCFS_LOG_DEBUG("%d. func: %s, fd: %d, count: %d\n", ++counter, __FUNCTION__, fd, (int)count);
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
+        return fcfs_getdents64(fd, dirp, count);
+    } else {
+        return syscall(SYS_getdents64, fd, dirp, count);
+    }
+}
+
 void seekdir(DIR *dirp, long loc)
 {
     FCFSPreloadDIRWrapper *wapper;
 
     wapper = (FCFSPreloadDIRWrapper *)dirp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_seekdir(wapper->dirp, loc);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.seekdir == NULL) {
@@ -1617,7 +1736,7 @@ long telldir(DIR *dirp)
     FCFSPreloadDIRWrapper *wapper;
 
     wapper = (FCFSPreloadDIRWrapper *)dirp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_telldir(wapper->dirp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.telldir == NULL) {
@@ -1635,7 +1754,7 @@ void rewinddir(DIR *dirp)
     FCFSPreloadDIRWrapper *wapper;
 
     wapper = (FCFSPreloadDIRWrapper *)dirp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_rewinddir(wapper->dirp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.rewinddir == NULL) {
@@ -1650,7 +1769,7 @@ int dirfd(DIR *dirp)
     FCFSPreloadDIRWrapper *wapper;
 
     wapper = (FCFSPreloadDIRWrapper *)dirp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_dirfd(wapper->dirp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.dirfd == NULL) {
@@ -1665,7 +1784,7 @@ int dirfd(DIR *dirp)
 
 int vdprintf(int fd, const char *format, va_list ap)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_vdprintf(fd, format, ap);
     } else {
         if (g_fcfs_preload_global_vars.vdprintf == NULL) {
@@ -1688,7 +1807,7 @@ int dprintf(int fd, const char *format, ...)
 
 static inline int do_lockf(int fd, int cmd, off_t len)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_lockf(fd, cmd, len);
     } else {
         if (g_fcfs_preload_global_vars.lockf == NULL) {
@@ -1711,7 +1830,7 @@ int lockf64(int fd, int cmd, off_t len)
 
 static inline int do_posix_fallocate(int fd, off_t offset, off_t len)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_posix_fallocate(fd, offset, len);
     } else {
         if (g_fcfs_preload_global_vars.posix_fallocate == NULL) {
@@ -1734,7 +1853,7 @@ int posix_fallocate64(int fd, off_t offset, off_t len)
 
 int _posix_fadvise_(int fd, off_t offset, off_t len, int advice)
 {
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         return fcfs_posix_fadvise(fd, offset, len, advice);
     } else {
         if (g_fcfs_preload_global_vars.posix_fadvise == NULL) {
@@ -1777,13 +1896,14 @@ int clearenv(void)
 #ifdef FCFS_PRELOAD_WITH_CAPI
 static inline FILE *do_fopen(const char *path, const char *mode)
 {
+    FCFSPosixAPIContext *ctx;
     FCFSPreloadFILEWrapper *wapper;
     FILE *fp;
     int call_type;
 
-    if (FCFS_PRELOAD_IS_MY_MOUNTPOINT(path)) {
+    if ((ctx=FCFS_PRELOAD_GET_CONTEXT(path)) != NULL) {
         call_type = FCFS_PRELOAD_CALL_FASTCFS;
-        fp = fcfs_fopen(path, mode);
+        fp = fcfs_fopen_ex(ctx, path, mode);
     } else {
         call_type = FCFS_PRELOAD_CALL_SYSTEM;
         if (g_fcfs_preload_global_vars.fopen == NULL) {
@@ -1830,9 +1950,9 @@ FILE *_IO_fdopen(int fd, const char *mode)
     FCFS_LOG_DEBUG("====== func: %s, line: %d, fd: %d, mode: %s\n",
             __FUNCTION__, __LINE__, fd, mode);
 
-    if (FCFS_PAPI_IS_MY_FD(fd)) {
+    if (FCFS_PRELOAD_IS_MY_FD(fd)) {
         call_type = FCFS_PRELOAD_CALL_FASTCFS;
-        fp = fcfs_fdopen(fd, mode);
+        fp = fcfs_fdopen_ex(FCFS_PRELOAD_GET_FD_CONTEXT(fd), fd, mode);
     } else {
         call_type = FCFS_PRELOAD_CALL_SYSTEM;
         if (g_fcfs_preload_global_vars.fdopen == NULL) {
@@ -1859,12 +1979,15 @@ FILE *fdopen(int fd, const char *mode)
 FILE *_freopen_(const char *path, const char *mode, FILE *fp)
 {
     FCFSPreloadFILEWrapper *wapper;
+    FCFSPosixAPIContext *ctx;
 
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("====== func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
-        fp = fcfs_freopen(path, mode, wapper->fp);
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
+        ctx = (path != NULL ? FCFS_PRELOAD_GET_CONTEXT(path) : NULL);
+        fp = fcfs_freopen_ex(ctx != NULL ? ctx : &G_FCFS_PAPI_CTX,
+                path, mode, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.freopen == NULL) {
             g_fcfs_preload_global_vars.freopen = fcfs_dlsym1("freopen");
@@ -1914,7 +2037,7 @@ int fclose(FILE *fp)
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
 
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fclose(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fclose == NULL) {
@@ -1948,7 +2071,7 @@ void flockfile(FILE *fp)
 
     CHECK_DEAL_STDIO_VOID(flockfile, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         fcfs_flockfile(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.flockfile == NULL) {
@@ -1964,7 +2087,7 @@ int ftrylockfile(FILE *fp)
 
     CHECK_DEAL_STD_STREAM(ftrylockfile, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_ftrylockfile(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.ftrylockfile == NULL) {
@@ -1983,7 +2106,7 @@ void funlockfile(FILE *fp)
 
     CHECK_DEAL_STDIO_VOID(funlockfile, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         fcfs_funlockfile(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.funlockfile == NULL) {
@@ -2001,7 +2124,7 @@ int fseek(FILE *fp, long offset, int whence)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fseek(wapper->fp, offset, whence);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fseek == NULL) {
@@ -2023,7 +2146,7 @@ int _fseeko_(FILE *fp, off_t offset, int whence)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fseeko(wapper->fp, offset, whence);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fseeko == NULL) {
@@ -2057,7 +2180,7 @@ long ftell(FILE *fp)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_ftell(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.ftell == NULL) {
@@ -2082,7 +2205,7 @@ static inline off_t do_ftello(FILE *fp)
     CHECK_DEAL_STD_STREAM(ftello, fp);
     FCFS_LOG_DEBUG("func: %s, line: %d\n", __FUNCTION__, __LINE__);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_ftello(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.ftello == NULL) {
@@ -2121,7 +2244,7 @@ void rewind(FILE *fp)
 
     FCFS_LOG_DEBUG("func: %s, line: %d\n", __FUNCTION__, __LINE__);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         fcfs_rewind(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.rewind == NULL) {
@@ -2139,7 +2262,7 @@ int _fgetpos_(FILE *fp, fpos_t *pos)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fgetpos(wapper->fp, pos);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fgetpos == NULL) {
@@ -2175,7 +2298,7 @@ int _fsetpos_(FILE *fp, const fpos_t *pos)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fsetpos(wapper->fp, pos);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fsetpos == NULL) {
@@ -2211,7 +2334,7 @@ int fgetc_unlocked(FILE *fp)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fgetc_unlocked(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fgetc_unlocked == NULL) {
@@ -2230,7 +2353,7 @@ int fputc_unlocked(int c, FILE *fp)
 
     CHECK_DEAL_STD_STREAM(fputc_unlocked, c, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fputc_unlocked(c, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fputc_unlocked == NULL) {
@@ -2249,7 +2372,7 @@ int getc_unlocked(FILE *fp)
 
     CHECK_DEAL_STD_STREAM(getc_unlocked, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_getc_unlocked(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.getc_unlocked == NULL) {
@@ -2268,7 +2391,7 @@ int putc_unlocked(int c, FILE *fp)
 
     CHECK_DEAL_STD_STREAM(putc_unlocked, c, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_putc_unlocked(c, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.putc_unlocked == NULL) {
@@ -2287,7 +2410,7 @@ void clearerr_unlocked(FILE *fp)
 
     CHECK_DEAL_STDIO_VOID(clearerr_unlocked, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         fcfs_clearerr_unlocked(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.clearerr_unlocked == NULL) {
@@ -2304,7 +2427,7 @@ int feof_unlocked(FILE *fp)
     CHECK_DEAL_STD_STREAM(feof_unlocked, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d", __FUNCTION__, __LINE__);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_feof_unlocked(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.feof_unlocked == NULL) {
@@ -2333,7 +2456,7 @@ int ferror_unlocked(FILE *fp)
     CHECK_DEAL_STD_STREAM(ferror_unlocked, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d", __FUNCTION__, __LINE__);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_ferror_unlocked(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.ferror_unlocked == NULL) {
@@ -2362,7 +2485,7 @@ int fileno_unlocked(FILE *fp)
     CHECK_DEAL_STD_STREAM(fileno_unlocked, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d", __FUNCTION__, __LINE__);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fileno_unlocked(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fileno_unlocked == NULL) {
@@ -2386,7 +2509,7 @@ int fflush_unlocked(FILE *fp)
 
     CHECK_DEAL_STD_STREAM(fflush_unlocked, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fflush_unlocked(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fflush_unlocked == NULL) {
@@ -2409,7 +2532,7 @@ size_t fread_unlocked(void *buff, size_t size, size_t n, FILE *fp)
             __LINE__, (int)size, (int)n);
 
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fread_unlocked(buff, size, n, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fread_unlocked == NULL) {
@@ -2435,7 +2558,7 @@ size_t fwrite_unlocked(const void *buff, size_t size, size_t n, FILE *fp)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fwrite_unlocked(buff, size, n, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fwrite_unlocked == NULL) {
@@ -2457,7 +2580,7 @@ char *fgets_unlocked(char *s, int size, FILE *fp)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fgets_unlocked(s, size, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fgets_unlocked == NULL) {
@@ -2478,7 +2601,7 @@ ssize_t __libc_readline_unlocked (FILE *fp, char *buff, size_t size)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_readline_unlocked(wapper->fp, buff, size);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.__libc_readline_unlocked == NULL) {
@@ -2499,7 +2622,7 @@ int fputs_unlocked(const char *s, FILE *fp)
 
     CHECK_DEAL_STD_STREAM(fputs_unlocked, s, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fputs_unlocked(s, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fputs_unlocked == NULL) {
@@ -2518,7 +2641,7 @@ void clearerr(FILE *fp)
 
     CHECK_DEAL_STDIO_VOID(clearerr, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         fcfs_clearerr(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.clearerr == NULL) {
@@ -2537,7 +2660,7 @@ int _IO_feof(FILE *fp)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_feof(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.feof == NULL) {
@@ -2563,7 +2686,7 @@ int _ferror_(FILE *fp)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_ferror(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.ferror == NULL) {
@@ -2589,7 +2712,7 @@ int fileno(FILE *fp)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fileno(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fileno == NULL) {
@@ -2610,7 +2733,7 @@ int fgetc(FILE *fp)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fgetc(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fgetc == NULL) {
@@ -2631,7 +2754,7 @@ char *fgets(char *s, int size, FILE *fp)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fgets(s, size, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fgets == NULL) {
@@ -2656,7 +2779,7 @@ int getc(FILE *fp)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_getc(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.getc == NULL) {
@@ -2676,7 +2799,7 @@ int ungetc(int c, FILE *fp)
     CHECK_DEAL_STD_STREAM(ungetc, c, fp);
 
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_ungetc(c, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.ungetc == NULL) {
@@ -2695,7 +2818,7 @@ int fputc(int c, FILE *fp)
 
     CHECK_DEAL_STD_STREAM(fputc, c, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fputc(c, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fputc == NULL) {
@@ -2714,7 +2837,7 @@ int fputs(const char *s, FILE *fp)
 
     CHECK_DEAL_STD_STREAM(fputs, s, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fputs(s, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fputs == NULL) {
@@ -2737,7 +2860,7 @@ int putc(int c, FILE *fp)
 
     CHECK_DEAL_STD_STREAM(putc, c, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_putc(c, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.putc == NULL) {
@@ -2760,7 +2883,7 @@ size_t fread(void *buff, size_t size, size_t nmemb, FILE *fp)
             __LINE__, (int)size, (int)nmemb);
 
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fread(buff, size, nmemb, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fread == NULL) {
@@ -2780,7 +2903,7 @@ size_t fwrite(const void *buff, size_t size, size_t nmemb, FILE *fp)
     CHECK_DEAL_STD_STREAM(fwrite, buff, size, nmemb, fp);
 
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fwrite(buff, size, nmemb, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fwrite == NULL) {
@@ -2799,7 +2922,7 @@ int vfprintf(FILE *fp, const char *format, va_list ap)
 
     CHECK_DEAL_STD_STREAM(vfprintf, fp, format, ap);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_vfprintf(wapper->fp, format, ap);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.vfprintf == NULL) {
@@ -2830,7 +2953,7 @@ int __vfprintf_chk(FILE *fp, int flag, const char *format, va_list ap)
 
     CHECK_DEAL_STD_STREAM(__vfprintf_chk, fp, flag, format, ap);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_vfprintf(wapper->fp, format, ap);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.__vfprintf_chk == NULL) {
@@ -2866,7 +2989,7 @@ ssize_t getdelim(char **line, size_t *size, int delim, FILE *fp)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_getdelim(line, size, delim, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.getdelim == NULL) {
@@ -2892,7 +3015,7 @@ ssize_t getline(char **line, size_t *size, FILE *fp)
     wapper = (FCFSPreloadFILEWrapper *)fp;
     FCFS_LOG_DEBUG("func: %s, line: %d, wapper: %p, fp: %p\n",
             __FUNCTION__, __LINE__, wapper, wapper->fp);
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_getline(line, size, wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.getline == NULL) {
@@ -2917,7 +3040,7 @@ int vfscanf(FILE *fp, const char *format, va_list ap)
     CHECK_DEAL_STD_STREAM(vfscanf, fp, format, ap);
 
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         //TODO
         errno = EOPNOTSUPP;
         return EOF;
@@ -2951,7 +3074,7 @@ int setvbuf(FILE *fp, char *buf, int mode, size_t size)
 
     CHECK_DEAL_STD_STREAM(setvbuf, fp, buf, mode, size);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_setvbuf(wapper->fp, buf, mode, size);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.setvbuf == NULL) {
@@ -2976,7 +3099,7 @@ void setbuf(FILE *fp, char *buf)
 
     CHECK_DEAL_STD_STREAM(setbuf, fp, buf);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         fcfs_setbuf(wapper->fp, buf);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.setbuf == NULL) {
@@ -2992,7 +3115,7 @@ void setbuffer(FILE *fp, char *buf, size_t size)
 
     CHECK_DEAL_STD_STREAM(setbuffer, fp, buf, size);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         fcfs_setbuffer(wapper->fp, buf, size);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.setbuffer == NULL) {
@@ -3013,7 +3136,7 @@ void setlinebuf(FILE *fp)
 
     CHECK_DEAL_STD_STREAM(setlinebuf, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         fcfs_setlinebuf(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.setlinebuf == NULL) {
@@ -3033,7 +3156,7 @@ int fflush(FILE *fp)
 
     CHECK_DEAL_STD_STREAM(fflush, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return fcfs_fflush(wapper->fp);
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.fflush == NULL) {
@@ -3057,7 +3180,7 @@ int __uflow(FILE *fp)
 
     CHECK_DEAL_STD_STREAM(__uflow, fp);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return 0;
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.__uflow == NULL) {
@@ -3076,7 +3199,7 @@ int __overflow(FILE *fp, int ch)
 
     CHECK_DEAL_STD_STREAM(__overflow, fp, ch);
     wapper = (FCFSPreloadFILEWrapper *)fp;
-    if (wapper->call_type == FCFS_PRELOAD_CALL_FASTCFS) {
+    if (FCFS_PRELOAD_IS_MY_WRAPPER(wapper)) {
         return 0;
     } else if (wapper->call_type == FCFS_PRELOAD_CALL_SYSTEM) {
         if (g_fcfs_preload_global_vars.__overflow == NULL) {
@@ -17,13 +17,24 @@
 #ifndef _FCFS_PRELOAD_API_H
 #define _FCFS_PRELOAD_API_H
 
-#include "types.h"
+#include "global.h"
 
-#define FCFS_PRELOAD_IS_MY_MOUNTPOINT(path) \
-    FCFS_API_IS_MY_MOUNTPOINT(path)
+#define FCFS_PRELOAD_GET_CONTEXT(path) \
+    fcfs_preload_get_context(path)
 
-#define FCFS_PRELOAD_IS_MY_FD_MOUNTPOINT(fd, path) \
-    (FCFS_PAPI_IS_MY_FD(fd) || FCFS_PRELOAD_IS_MY_MOUNTPOINT(path))
+#define FCFS_PRELOAD_IS_MY_FD(fd) \
+    (FCFS_PAPI_IS_MY_FD(fd) && fcfs_preload_check_forked())
+
+/* the fd encodes its owning context, no path check */
+#define FCFS_PRELOAD_GET_FD_CONTEXT(fd) \
+    fcfs_posix_api_get_fd_context(fd)
+
+#define FCFS_PRELOAD_GET_AT_CONTEXT(fd, path) \
+    fcfs_preload_get_at_context(fd, path)
+
+#define FCFS_PRELOAD_IS_MY_WRAPPER(wrapper) \
+    ((wrapper)->call_type == FCFS_PRELOAD_CALL_FASTCFS && \
+     fcfs_preload_check_forked())
 
 #ifdef fread_unlocked
 #undef fread_unlocked
@@ -48,6 +59,8 @@ int _readdir_r_(DIR *dirp, struct dirent *entry, struct dirent **result)
 
 int readdir64_r(DIR *dirp, struct dirent64 *entry, struct dirent64 **result);
 
+ssize_t getdents64(int fd, void *dirp, size_t count);
+
 void seekdir(DIR *dirp, long loc);
 
 long telldir(DIR *dirp);
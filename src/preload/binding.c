@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <limits.h>
+#include "fastcommon/shared_func.h"
+#include "fastcommon/logger.h"
+#include "global.h"
+#include "binding.h"
+
+#define FCFS_PRELOAD_BINDING_ITEM_NAME  "mount_binding"
+
+#define BINDINGS  g_fcfs_preload_global_vars.bindings
+
+static int trie_add(FCFSPosixAPIContext *ctx)
+{
+    FCFSPreloadTrieNode *node;
+    FCFSPreloadTrieNode *child;
+    const char *p;
+    const char *end;
+    string_t name;
+
+    node = &BINDINGS.root;
+    p = ctx->mountpoint.str;
+    end = ctx->mountpoint.str + ctx->mountpoint.len;
+    while (p < end) {
+        name.str = (char *)++p;  //skip the slash
+        while (p < end && *p != '/') {
+            p++;
+        }
+        name.len = p - name.str;
+
+        for (child=node->children; child!=NULL; child=child->next) {
+            if (fc_string_equal(&child->name, &name)) {
+                break;
+            }
+        }
+
+        if (child == NULL) {
+            if ((child=fc_malloc(sizeof(FCFSPreloadTrieNode))) == NULL) {
+                return ENOMEM;
+            }
+            memset(child, 0, sizeof(FCFSPreloadTrieNode));
+            child->name = name;  //refer to the mountpoint of the context
+            child->next = node->children;
+            node->children = child;
+        }
+        node = child;
+    }
+
+    if (node->ctx != NULL) {
+        logError("file: "__FILE__", line: %d, "
+                "mountpoint: %.*s already bound to namespace: %s",
+                __LINE__, ctx->mountpoint.len, ctx->mountpoint.str,
+                node->ctx->nsmp.ns);
+        return EEXIST;
+    }
+
+    node->ctx = ctx;
+    return 0;
+}
+
+FCFSPosixAPIContext *fcfs_preload_binding_find(const char *path)
+{
+    FCFSPreloadTrieNode *node;
+    FCFSPreloadTrieNode *child;
+    FCFSPosixAPIContext *matched;
+    const char *p;
+    const char *start;
+    int len;
+
+    matched = NULL;
+    node = &BINDINGS.root;
+    p = path;
+    while (*p == '/') {
+        if (node->ctx != NULL) {  //the path is longer than the mountpoint
+            matched = node->ctx;
+        }
+
+        start = ++p;
+        while (*p != '\0' && *p != '/') {
+            p++;
+        }
+        len = p - start;
+
+        for (child=node->children; child!=NULL; child=child->next) {
+            if (child->name.len == len && memcmp(child->name.str,
+                        start, len) == 0)
+            {
+                break;
+            }
+        }
+        if (child == NULL) {
+            break;
+        }
+        node = child;
+    }
+
+    return matched;
+}
+
+/* the format: mountpoint namespace [config_filename] */
+static int load_binding(IniFullContext *ini_ctx, const char *value)
+{
+    const bool ignore_empty = true;
+    FCFSPreloadBinding *binding;
+    string_t input;
+    string_t parts[4];
+    char mountpoint[PATH_MAX];
+    char ns[NAME_MAX];
+    int count;
+    int result;
+
+    FC_SET_STRING(input, (char *)value);
+    count = split_string_ex(&input, ' ', parts, sizeof(parts) /
+            sizeof(string_t), ignore_empty);
+    if (count < 2 || count > 3) {
+        logError("file: "__FILE__", line: %d, "
+                "config file: %s, invalid %s: %s, the format: "
+                "mountpoint namespace [config_filename]", __LINE__,
+                ini_ctx->filename, FCFS_PRELOAD_BINDING_ITEM_NAME, value);
+        return EINVAL;
+    }
+
+    if (BINDINGS.count >= FCFS_PRELOAD_MAX_BINDINGS) {
+        logError("file: "__FILE__", line: %d, "
+                "config file: %s, too many %s, exceeds %d", __LINE__,
+                ini_ctx->filename, FCFS_PRELOAD_BINDING_ITEM_NAME,
+                FCFS_PRELOAD_MAX_BINDINGS - 1);
+        return ENOSPC;
+    }
+
+    binding = BINDINGS.entries + BINDINGS.count;
+    if ((binding->ctx=fc_malloc(sizeof(FCFSPosixAPIContext))) == NULL) {
+        return ENOMEM;
+    }
+    memset(binding->ctx, 0, sizeof(FCFSPosixAPIContext));
+
+    if (count == 3) {
+        if ((binding->config_filename=fc_strdup1(parts[2].str,
+                        parts[2].len)) == NULL)
+        {
+            return ENOMEM;
+        }
+    } else {
+        binding->config_filename = ini_ctx->filename;
+    }
+
+    snprintf(mountpoint, sizeof(mountpoint), "%.*s",
+            parts[0].len, parts[0].str);
+    snprintf(ns, sizeof(ns), "%.*s", parts[1].len, parts[1].str);
+    if ((result=fcfs_posix_api_load_mountpoint_ex(binding->ctx, ns,
+                    mountpoint, ini_ctx,
+                    FCFS_API_DEFAULT_FASTDIR_SECTION_NAME)) != 0)
+    {
+        return result;
+    }
+
+    if ((result=trie_add(binding->ctx)) != 0) {
+        return result;
+    }
+
+    BINDINGS.count++;
+    return 0;
+}
+
+int fcfs_preload_binding_load(IniFullContext *ini_ctx,
+        const char *section_name)
+{
+    char *values[FCFS_PRELOAD_MAX_BINDINGS];
+    int count;
+    int i;
+    int result;
+
+    /* the namespace of the FastDIR section of the config file */
+    if ((result=fcfs_posix_api_load_mountpoint(NULL, ini_ctx)) != 0) {
+        return result;
+    }
+
+    BINDINGS.entries[0].ctx = &g_fcfs_papi_global_vars.ctx;
+    BINDINGS.entries[0].config_filename = ini_ctx->filename;
+    if ((result=trie_add(BINDINGS.entries[0].ctx)) != 0) {
+        return result;
+    }
+    BINDINGS.count = 1;
+
+    count = iniGetValues(section_name, FCFS_PRELOAD_BINDING_ITEM_NAME,
+            ini_ctx->context, values, FCFS_PRELOAD_MAX_BINDINGS);
+    for (i=0; i<count; i++) {
+        if ((result=load_binding(ini_ctx, values[i])) != 0) {
+            return result;
+        }
+    }
+
+    return 0;
+}
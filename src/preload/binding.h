@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* the bindings of the mountpoints to the namespaces, the path is
+ * matched by a trie of the path components, the longest mountpoint wins
+ */
+
+#ifndef _FCFS_PRELOAD_BINDING_H
+#define _FCFS_PRELOAD_BINDING_H
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /** load the mountpoint of the config file and the items mount_binding
+     *  without the connection to the servers
+     * parameters:
+     *   ini_ctx: the ini context of the config file, the section name
+     *            should be NULL
+     *   section_name: the section name of the items mount_binding
+     * return: error no, 0 for success, != 0 fail
+    */
+    int fcfs_preload_binding_load(IniFullContext *ini_ctx,
+            const char *section_name);
+
+    /* return the context of the binding which the path belongs to,
+     * NULL for none, the relative path never matches
+     */
+    FCFSPosixAPIContext *fcfs_preload_binding_find(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
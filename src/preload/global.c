@@ -14,7 +14,22 @@
  */
 
 #include <dlfcn.h>
+#include <sys/ipc.h>
+#include <sys/sem.h>
+#include <sys/vfs.h>
+#include <sys/syscall.h>
+#include "fastcommon/shared_func.h"
+#include "fastcommon/pthread_func.h"
+#include "fastcommon/fc_atomic.h"
 #include "global.h"
+#include "binding.h"
+
+#define FCFS_PRELOAD_LOG_PREFIX_NAME  "fcfs_preload"
+#define FCFS_PRELOAD_SECTION_NAME  "preload"
+#define FCFS_PRELOAD_FUSE_SUPER_MAGIC  0x65735546
+#define FCFS_PRELOAD_MAX_APPEND_BUFFER_SIZE  (16 * 1024 * 1024)
+
+#define BINDINGS  g_fcfs_preload_global_vars.bindings
 
 FCFSPreloadGlobalVars g_fcfs_preload_global_vars;
 
@@ -181,7 +196,551 @@ static inline int dlsym_all()
     return dlsym_capi();
 }
 
+static int load_config()
+{
+    IniContext ini_context;
+    IniFullContext ini_ctx;
+    int64_t start_time_us;
+    double dir_attr_cache_timeout;
+    char *append_buffer_size;
+    int64_t buffer_size;
+    int flush_interval_ms;
+    int result;
+    int i;
+
+    start_time_us = get_current_time_us();
+    if ((result=iniLoadFromFile(g_fcfs_preload_global_vars.
+                    config_filename, &ini_context)) != 0)
+    {
+        logError("file: "__FILE__", line: %d, "
+                "load conf file \"%s\" fail, ret code: %d", __LINE__,
+                g_fcfs_preload_global_vars.config_filename, result);
+        return result;
+    }
+
+    FAST_INI_SET_FULL_CTX_EX(ini_ctx, g_fcfs_preload_global_vars.
+            config_filename, FCFS_PRELOAD_SECTION_NAME, &ini_context);
+    g_fcfs_preload_global_vars.agent.enabled = iniGetBoolValue(
+            FCFS_PRELOAD_SECTION_NAME, "agent_enabled",
+            &ini_context, false);
+    g_fcfs_preload_global_vars.agent.max_direct_processes =
+        iniGetIntCorrectValue(&ini_ctx, "max_direct_processes",
+                16, 0, 10000);
+    dir_attr_cache_timeout = iniGetDoubleValue(FCFS_PRELOAD_SECTION_NAME,
+            "dir_attr_cache_timeout", &ini_context, 1.0);
+
+    append_buffer_size = iniGetStrValue(FCFS_PRELOAD_SECTION_NAME,
+            "append_buffer_size", &ini_context);
+    if (append_buffer_size == NULL || *append_buffer_size == '\0') {
+        buffer_size = 0;
+    } else if ((result=parse_bytes(append_buffer_size, 1,
+                    &buffer_size)) != 0)
+    {
+        logError("file: "__FILE__", line: %d, "
+                "config file: %s, invalid append_buffer_size: %s",
+                __LINE__, g_fcfs_preload_global_vars.config_filename,
+                append_buffer_size);
+        iniFreeContext(&ini_context);
+        return result;
+    } else if (buffer_size > FCFS_PRELOAD_MAX_APPEND_BUFFER_SIZE) {
+        logWarning("file: "__FILE__", line: %d, "
+                "config file: %s, append_buffer_size: %"PRId64" is too "
+                "large, set to %d", __LINE__, g_fcfs_preload_global_vars.
+                config_filename, buffer_size,
+                FCFS_PRELOAD_MAX_APPEND_BUFFER_SIZE);
+        buffer_size = FCFS_PRELOAD_MAX_APPEND_BUFFER_SIZE;
+    }
+    flush_interval_ms = iniGetIntCorrectValue(&ini_ctx,
+            "append_flush_interval_ms", 100, 1, 60 * 1000);
+
+    ini_ctx.section_name = NULL;
+    result = fcfs_preload_binding_load(&ini_ctx, FCFS_PRELOAD_SECTION_NAME);
+    iniFreeContext(&ini_context);
+
+    for (i=0; i<BINDINGS.count; i++) {
+        BINDINGS.entries[i].ctx->dir_cache.timeout_ms =
+            (dir_attr_cache_timeout > 0.0 ? (int)
+             (dir_attr_cache_timeout * 1000) : 0);
+        BINDINGS.entries[i].ctx->append_buffer.size = buffer_size;
+        BINDINGS.entries[i].ctx->append_buffer.flush_interval_ms =
+            flush_interval_ms;
+    }
+
+    g_fcfs_preload_global_vars.startup_stat.mountpoint_us =
+        get_current_time_us() - start_time_us;
+    return result;
+}
+
+#define FCFS_PRELOAD_SEM_INIT_WAIT_MS  1000
+
+/* shared by all users of this host, so the cap applies to every uid */
+#define FCFS_PRELOAD_SEM_MODE  0666
+
+/* the semaphore set: the free direct slots and the cap */
+#define FCFS_PRELOAD_SEM_FREE_SLOTS  0
+#define FCFS_PRELOAD_SEM_MAX_DIRECT  1
+#define FCFS_PRELOAD_SEM_COUNT       2
+
+union fcfs_preload_semun {
+    int val;
+    struct semid_ds *buf;
+    unsigned short *array;
+};
+
+/* wait for the creator to set the initial value, the sem_otime
+ * is set by the first semop of the creator
+ */
+static int agent_wait_semaphore_inited()
+{
+    union fcfs_preload_semun arg;
+    struct semid_ds ds;
+    int i;
+
+    arg.buf = &ds;
+    for (i=0; i<FCFS_PRELOAD_SEM_INIT_WAIT_MS; i++) {
+        if (semctl(g_fcfs_preload_global_vars.agent.semid,
+                    0, IPC_STAT, arg) != 0)
+        {
+            return errno != 0 ? errno : EPERM;
+        }
+        if (ds.sem_otime != 0) {
+            return 0;
+        }
+        fc_sleep_ms(1);
+    }
+
+    return ETIMEDOUT;
+}
+
+/* apply the max_direct_processes of this process when it differs from
+ * the cap of the semaphore. the cap is compared and swapped in one semop,
+ * and the free slots are changed by the same delta. the lower cap waits
+ * for the slots in use to be given back, and is applied by the next
+ * process which finds enough free slots
+ */
+static void agent_check_semaphore_cap()
+{
+    struct sembuf ops[4];
+    int semid;
+    int old_max;
+    int new_max;
+    int delta;
+
+    semid = g_fcfs_preload_global_vars.agent.semid;
+    new_max = g_fcfs_preload_global_vars.agent.max_direct_processes;
+    if ((old_max=semctl(semid, FCFS_PRELOAD_SEM_MAX_DIRECT,
+                    GETVAL)) < 0 || old_max == new_max)
+    {
+        return;
+    }
+
+    delta = new_max - old_max;
+    ops[0].sem_num = FCFS_PRELOAD_SEM_MAX_DIRECT;
+    ops[0].sem_op = -old_max;
+    ops[0].sem_flg = IPC_NOWAIT;
+    ops[1].sem_num = FCFS_PRELOAD_SEM_MAX_DIRECT;
+    ops[1].sem_op = 0;   //the cap is not changed by others
+    ops[1].sem_flg = IPC_NOWAIT;
+    ops[2].sem_num = FCFS_PRELOAD_SEM_MAX_DIRECT;
+    ops[2].sem_op = new_max;
+    ops[2].sem_flg = 0;
+    ops[3].sem_num = FCFS_PRELOAD_SEM_FREE_SLOTS;
+    ops[3].sem_op = delta;
+    ops[3].sem_flg = IPC_NOWAIT;
+    if (semop(semid, ops, 4) == 0) {
+        logInfo("file: "__FILE__", line: %d, pid: %d, "
+                "change the max direct processes of this host "
+                "from %d to %d", __LINE__, getpid(), old_max, new_max);
+    } else {
+        logWarning("file: "__FILE__", line: %d, pid: %d, "
+                "change the max direct processes of this host from "
+                "%d to %d fail, errno: %d, error info: %s, the old value "
+                "is used until the slots in use are given back", __LINE__,
+                getpid(), old_max, new_max, errno, STRERROR(errno));
+    }
+}
+
+/* the free direct slots of this host are counted down by a SysV semaphore
+ * with SEM_UNDO, so the kernel gives back the slot when the process exits.
+ * the cap is kept in the semaphore set too, so the changed
+ * max_direct_processes is applied without removing the semaphore
+ */
+static int agent_open_semaphore()
+{
+    struct sembuf ops[2];
+    key_t key;
+    int result;
+
+    if ((key=ftok(g_fcfs_preload_global_vars.config_filename, 'P')) < 0) {
+        result = errno != 0 ? errno : EPERM;
+    } else if ((g_fcfs_preload_global_vars.agent.semid=semget(key,
+                    FCFS_PRELOAD_SEM_COUNT, IPC_CREAT | IPC_EXCL |
+                    FCFS_PRELOAD_SEM_MODE)) >= 0)
+    {
+        ops[0].sem_num = FCFS_PRELOAD_SEM_FREE_SLOTS;
+        ops[0].sem_op = g_fcfs_preload_global_vars.agent.max_direct_processes;
+        ops[0].sem_flg = 0;
+        ops[1].sem_num = FCFS_PRELOAD_SEM_MAX_DIRECT;
+        ops[1].sem_op = g_fcfs_preload_global_vars.agent.max_direct_processes;
+        ops[1].sem_flg = 0;
+        result = (semop(g_fcfs_preload_global_vars.agent.semid,
+                    ops, 2) == 0) ? 0 : (errno != 0 ? errno : EPERM);
+    } else if (errno == EEXIST && (g_fcfs_preload_global_vars.agent.
+                semid=semget(key, FCFS_PRELOAD_SEM_COUNT, 0)) >= 0)
+    {
+        if ((result=agent_wait_semaphore_inited()) == 0) {
+            agent_check_semaphore_cap();
+        }
+    } else {
+        result = errno != 0 ? errno : EPERM;
+    }
+
+    if (result != 0) {
+        logWarning("file: "__FILE__", line: %d, pid: %d, "
+                "open the semaphore of config file: %s fail, "
+                "errno: %d, error info: %s, connect to the servers "
+                "directly without the limit of max_direct_processes, "
+                "remove the semaphore by ipcrm if it is stale", __LINE__,
+                getpid(), g_fcfs_preload_global_vars.config_filename,
+                result, STRERROR(result));
+        g_fcfs_preload_global_vars.agent.semid = -1;
+    }
+    return result;
+}
+
+/* take a free slot atomically, the child after fork takes its own slot
+ * when the force is true, and it connects directly even if no free slot
+ * because its inherited FastCFS fds need the direct connections
+ */
+static bool agent_take_direct_slot(const bool force)
+{
+    struct sembuf op;
+
+    if (g_fcfs_preload_global_vars.agent.semid < 0) {  //not opened
+        return true;
+    }
+
+    op.sem_num = FCFS_PRELOAD_SEM_FREE_SLOTS;
+    op.sem_op = -1;
+    op.sem_flg = SEM_UNDO | IPC_NOWAIT;
+    if (semop(g_fcfs_preload_global_vars.agent.semid, &op, 1) == 0) {
+        return true;
+    }
+
+    if (errno != EAGAIN) {
+        logWarning("file: "__FILE__", line: %d, "
+                "semop fail, errno: %d, error info: %s",
+                __LINE__, errno, STRERROR(errno));
+        return true;
+    }
+    return force;
+}
+
+/* the FUSE daemon of the same mountpoint is the agent of this host, it
+ * shares the connections and the caches among the processes
+ */
+static bool agent_fuse_mounted()
+{
+    struct statfs buf;
+
+    if (syscall(SYS_statfs, g_fcfs_papi_global_vars.ctx.
+                mountpoint.str, &buf) != 0)
+    {
+        return false;
+    }
+    return buf.f_type == FCFS_PRELOAD_FUSE_SUPER_MAGIC;
+}
+
+static bool agent_use_direct()
+{
+    if (!agent_fuse_mounted()) {
+        return true;
+    }
+
+    if (g_fcfs_preload_global_vars.agent.max_direct_processes == 0) {
+        return false;
+    }
+
+    if (agent_open_semaphore() != 0) {
+        return true;
+    }
+
+    if (agent_take_direct_slot(false)) {
+        return true;
+    }
+
+    logWarning("file: "__FILE__", line: %d, pid: %d, "
+            "the direct processes of this host reach the limit: %d, "
+            "access FastCFS through the FUSE mountpoint: %s", __LINE__,
+            getpid(), g_fcfs_preload_global_vars.agent.max_direct_processes,
+            g_fcfs_papi_global_vars.ctx.mountpoint.str);
+    return false;
+}
+
+static int setup_secondary_bindings()
+{
+    FCFSPreloadBinding *binding;
+    FCFSPreloadBinding *end;
+    int result;
+
+    end = BINDINGS.entries + BINDINGS.count;
+    for (binding=BINDINGS.entries + 1; binding<end; binding++) {
+        if ((result=fcfs_posix_api_init_secondary(binding->ctx,
+                        FCFS_PRELOAD_LOG_PREFIX_NAME, NULL,
+                        binding->config_filename)) != 0)
+        {
+            return result;
+        }
+
+        if ((result=fcfs_posix_api_start_ex(binding->ctx)) != 0) {
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+static int setup_cluster()
+{
+    int64_t start_time_us;
+    int result;
+
+    start_time_us = get_current_time_us();
+#ifdef FCFS_PRELOAD_WITH_CAPI
+    if ((result=fcfs_capi_init()) != 0) {
+        return result;
+    }
+#endif
+
+    log_set_fd_flags(&g_log_context, O_CLOEXEC);
+    if ((result=fcfs_posix_api_init(FCFS_PRELOAD_LOG_PREFIX_NAME, NULL,
+                    g_fcfs_preload_global_vars.config_filename)) != 0)
+    {
+        return result;
+    }
+
+    if ((result=fcfs_posix_api_start()) != 0) {
+        return result;
+    }
+
+    if ((result=setup_secondary_bindings()) != 0) {
+        return result;
+    }
+
+    g_fcfs_preload_global_vars.startup_stat.init_us =
+        get_current_time_us() - start_time_us;
+    logDebug("file: "__FILE__", line: %d, "
+            "pid: %d, parent pid: %d, base path: %s, log_fd: %d, "
+            "bindings: %d, start-up time {constructor: %d us, "
+            "load mountpoint: %d us, cluster setup: %d us}", __LINE__,
+            getpid(), getppid(), SF_G_BASE_PATH_STR,
+            g_log_context.log_fd, BINDINGS.count,
+            g_fcfs_preload_global_vars.startup_stat.constructor_us,
+            g_fcfs_preload_global_vars.startup_stat.mountpoint_us,
+            g_fcfs_preload_global_vars.startup_stat.init_us);
+    return 0;
+}
+
+static int rebuild_after_fork()
+{
+    const bool publish = true;
+    FCFSPreloadBinding *binding;
+    FCFSPreloadBinding *end;
+    int64_t start_time_us;
+    int result;
+
+    start_time_us = get_current_time_us();
+    if (g_fcfs_preload_global_vars.agent.enabled) {
+        /* the semaphore adjustment is not inherited by the child */
+        agent_take_direct_slot(true);
+    }
+
+    end = BINDINGS.entries + BINDINGS.count;
+    for (binding=BINDINGS.entries; binding<end; binding++) {
+        if ((result=fcfs_posix_api_rebuild_ex1(binding->ctx,
+                        FCFS_PRELOAD_LOG_PREFIX_NAME, NULL,
+                        binding->config_filename,
+                        FCFS_API_DEFAULT_FASTDIR_SECTION_NAME,
+                        FCFS_API_DEFAULT_FASTSTORE_SECTION_NAME,
+                        publish)) != 0)
+        {
+            return result;
+        }
+    }
+
+    g_fcfs_preload_global_vars.startup_stat.rebuild_us =
+        get_current_time_us() - start_time_us;
+    logDebug("file: "__FILE__", line: %d, "
+            "pid: %d, parent pid: %d, rebuild after fork time: %d us",
+            __LINE__, getpid(), getppid(), g_fcfs_preload_global_vars.
+            startup_stat.rebuild_us);
+    return 0;
+}
+
+/* the path is NULL for the rebuild after fork only, return the stage */
+static int lazy_init(const char *path)
+{
+    int stage;
+
+    PTHREAD_MUTEX_LOCK(&g_fcfs_preload_global_vars.lazy_init.lock);
+    g_fcfs_preload_global_vars.lazy_init.tid = pthread_self();
+    g_fcfs_preload_global_vars.lazy_init.running = true;
+
+    stage = g_fcfs_preload_global_vars.stage;
+    if (stage == FCFS_PRELOAD_STAGE_NONE && path != NULL) {
+        stage = (load_config() == 0 ? FCFS_PRELOAD_STAGE_MOUNTPOINT :
+                FCFS_PRELOAD_STAGE_FAILED);
+        FC_ATOMIC_SET(g_fcfs_preload_global_vars.stage, stage);
+    }
+
+    if (stage == FCFS_PRELOAD_STAGE_MOUNTPOINT && path != NULL &&
+            fcfs_preload_binding_find(path) != NULL)
+    {
+        if (g_fcfs_preload_global_vars.agent.enabled &&
+                !agent_use_direct())
+        {
+            stage = FCFS_PRELOAD_STAGE_AGENT;
+        } else if (setup_cluster() == 0) {
+            g_fcfs_preload_global_vars.inited = true;
+            stage = FCFS_PRELOAD_STAGE_INITED;
+        } else {
+            stage = FCFS_PRELOAD_STAGE_FAILED;
+        }
+        FC_ATOMIC_SET(g_fcfs_preload_global_vars.stage, stage);
+    } else if (stage == FCFS_PRELOAD_STAGE_FORKED && (path == NULL ||
+                fcfs_preload_binding_find(path) != NULL))
+    {
+        stage = (rebuild_after_fork() == 0 ? FCFS_PRELOAD_STAGE_INITED :
+                FCFS_PRELOAD_STAGE_FAILED);
+        FC_ATOMIC_SET(g_fcfs_preload_global_vars.stage, stage);
+    }
+
+    g_fcfs_preload_global_vars.lazy_init.running = false;
+    PTHREAD_MUTEX_UNLOCK(&g_fcfs_preload_global_vars.lazy_init.lock);
+    return stage;
+}
+
+/* the files accessed by the init itself such as the config files */
+#define LAZY_INIT_BY_MYSELF  (g_fcfs_preload_global_vars.lazy_init.running \
+        && pthread_equal(g_fcfs_preload_global_vars.lazy_init.tid, \
+            pthread_self()))
+
+FCFSPosixAPIContext *fcfs_preload_lazy_get_context(const char *path)
+{
+    int stage;
+
+    stage = FC_ATOMIC_GET(g_fcfs_preload_global_vars.stage);
+    if (stage == FCFS_PRELOAD_STAGE_MOUNTPOINT ||
+            stage == FCFS_PRELOAD_STAGE_FORKED)
+    {
+        if (fcfs_preload_binding_find(path) == NULL) {
+            return NULL;
+        }
+    } else if (stage != FCFS_PRELOAD_STAGE_NONE) {
+        return (stage == FCFS_PRELOAD_STAGE_INITED ?
+                fcfs_preload_binding_find(path) : NULL);
+    }
+
+    if (LAZY_INIT_BY_MYSELF) {
+        return NULL;
+    }
+
+    return (lazy_init(path) == FCFS_PRELOAD_STAGE_INITED ?
+            fcfs_preload_binding_find(path) : NULL);
+}
+
+bool fcfs_preload_lazy_rebuild()
+{
+    if (LAZY_INIT_BY_MYSELF) {
+        return false;
+    }
+    return lazy_init(NULL) == FCFS_PRELOAD_STAGE_INITED;
+}
+
+/* the lazy init lock is held during fork, so the child never inherits
+ * a half done init
+ */
+static void fork_prepare()
+{
+    FCFSPreloadBinding *binding;
+    FCFSPreloadBinding *end;
+
+    PTHREAD_MUTEX_LOCK(&g_fcfs_preload_global_vars.lazy_init.lock);
+    if (g_fcfs_preload_global_vars.stage == FCFS_PRELOAD_STAGE_INITED) {
+        end = BINDINGS.entries + BINDINGS.count;
+        for (binding=BINDINGS.entries; binding<end; binding++) {
+            fcfs_posix_api_fork_prepare_ex(binding->ctx);
+        }
+    }
+}
+
+static void fork_parent()
+{
+    FCFSPreloadBinding *binding;
+    FCFSPreloadBinding *end;
+
+    if (g_fcfs_preload_global_vars.stage == FCFS_PRELOAD_STAGE_INITED) {
+        end = BINDINGS.entries + BINDINGS.count;
+        for (binding=BINDINGS.entries; binding<end; binding++) {
+            fcfs_posix_api_fork_parent_ex(binding->ctx);
+        }
+    }
+    PTHREAD_MUTEX_UNLOCK(&g_fcfs_preload_global_vars.lazy_init.lock);
+}
+
+/* the background threads do not exist in the child, the client
+ * contexts are rebuilt on the first access of FastCFS
+ */
+static void fork_child()
+{
+    FCFSPreloadBinding *binding;
+    FCFSPreloadBinding *end;
+
+    g_fcfs_preload_global_vars.lazy_init.running = false;
+    if (g_fcfs_preload_global_vars.stage == FCFS_PRELOAD_STAGE_INITED) {
+        end = BINDINGS.entries + BINDINGS.count;
+        for (binding=BINDINGS.entries; binding<end; binding++) {
+            fcfs_posix_api_fork_child_ex(binding->ctx);
+        }
+        g_fcfs_preload_global_vars.stage = FCFS_PRELOAD_STAGE_FORKED;
+    }
+    PTHREAD_MUTEX_UNLOCK(&g_fcfs_preload_global_vars.lazy_init.lock);
+}
+
+void fcfs_preload_global_stop()
+{
+    FCFSPreloadBinding *binding;
+    FCFSPreloadBinding *end;
+
+    if (g_fcfs_preload_global_vars.stage != FCFS_PRELOAD_STAGE_INITED) {
+        return;
+    }
+
+    end = BINDINGS.entries + BINDINGS.count;
+    for (binding=BINDINGS.entries; binding<end; binding++) {
+        fcfs_posix_api_stop_ex(binding->ctx);
+    }
+}
+
 int fcfs_preload_global_init()
 {
+    int result;
+
+    g_fcfs_preload_global_vars.agent.semid = -1;
+    if ((result=init_pthread_lock(&g_fcfs_preload_global_vars.
+                    lazy_init.lock)) != 0)
+    {
+        return result;
+    }
+
+    if ((result=pthread_atfork(fork_prepare, fork_parent,
+                    fork_child)) != 0)
+    {
+        logError("file: "__FILE__", line: %d, "
+                "pthread_atfork fail, errno: %d, error info: %s",
+                __LINE__, result, STRERROR(result));
+        return result;
+    }
+
     return dlsym_all();
 }
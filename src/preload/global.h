@@ -18,6 +18,7 @@
 #define _FCFS_PRELOAD_GLOBAL_H
 
 #include "types.h"
+#include "binding.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -27,6 +28,52 @@ extern "C" {
 
 	int fcfs_preload_global_init();
 
+    /* stop the background threads of the bindings */
+    void fcfs_preload_global_stop();
+
+    /* load the mountpoints and setup the clusters on the first access
+     * of the mountpoints, return the context of the binding which the
+     * path belongs to, NULL for none
+     */
+    FCFSPosixAPIContext *fcfs_preload_lazy_get_context(const char *path);
+
+    static inline FCFSPosixAPIContext *fcfs_preload_get_context(
+            const char *path)
+    {
+        if (g_fcfs_preload_global_vars.stage == FCFS_PRELOAD_STAGE_INITED) {
+            return fcfs_preload_binding_find(path);
+        }
+        return fcfs_preload_lazy_get_context(path);
+    }
+
+    /* rebuild the client contexts in the child process after fork,
+     * return true for success
+     */
+    bool fcfs_preload_lazy_rebuild();
+
+    /* check before the access of the inherited FastCFS fd or FILE/DIR */
+    static inline bool fcfs_preload_check_forked()
+    {
+        if (g_fcfs_preload_global_vars.stage != FCFS_PRELOAD_STAGE_FORKED) {
+            return true;
+        }
+        return fcfs_preload_lazy_rebuild();
+    }
+
+    /* the relative path of the *at functions follows the directory fd,
+     * return NULL when neither belongs to FastCFS
+     */
+    static inline FCFSPosixAPIContext *fcfs_preload_get_at_context(
+            const int fd, const char *path)
+    {
+        if (*path != '/' && FCFS_PAPI_IS_MY_FD(fd) &&
+                fcfs_preload_check_forked())
+        {
+            return fcfs_posix_api_get_fd_context(fd);
+        }
+        return fcfs_preload_get_context(path);
+    }
+
 #ifdef __cplusplus
 }
 #endif
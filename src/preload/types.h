@@ -25,6 +25,14 @@ typedef struct __dirstream DIR;
 #define FCFS_PRELOAD_CALL_SYSTEM   1645611685
 #define FCFS_PRELOAD_CALL_FASTCFS  1645611708
 
+/* the cluster setup is deferred to the first access of the mountpoint */
+#define FCFS_PRELOAD_STAGE_NONE        0
+#define FCFS_PRELOAD_STAGE_MOUNTPOINT  1  //the mountpoint loaded
+#define FCFS_PRELOAD_STAGE_INITED      2  //the cluster setup done
+#define FCFS_PRELOAD_STAGE_FAILED      3
+#define FCFS_PRELOAD_STAGE_FORKED      4  //should rebuild in the child
+#define FCFS_PRELOAD_STAGE_AGENT       5  //access by the FUSE daemon
+
 typedef struct fcfs_preload_dir_wrapper {
     int call_type;
     DIR *dirp;
@@ -35,9 +43,52 @@ typedef struct fcfs_preload_file_wrapper {
     FILE *fp;
 } FCFSPreloadFILEWrapper;
 
+/* the first binding is the mountpoint of the config file */
+#define FCFS_PRELOAD_MAX_BINDINGS  FCFS_POSIX_API_MAX_CONTEXTS
+
+typedef struct fcfs_preload_trie_node {
+    string_t name;  //the path component
+    FCFSPosixAPIContext *ctx;  //not NULL when a mountpoint ends here
+    struct fcfs_preload_trie_node *children;
+    struct fcfs_preload_trie_node *next;  //the next sibling
+} FCFSPreloadTrieNode;
+
+typedef struct fcfs_preload_binding {
+    FCFSPosixAPIContext *ctx;
+    const char *config_filename;
+} FCFSPreloadBinding;
+
 typedef struct fcfs_preload_global_vars {
     bool inited;
     int cwd_call_type;
+    FCFSPosixAPIContext *cwd_ctx;  //valid when the cwd is in FastCFS
+    volatile int stage;
+    const char *config_filename;
+
+    struct {
+        FCFSPreloadBinding entries[FCFS_PRELOAD_MAX_BINDINGS];
+        int count;
+        FCFSPreloadTrieNode root;  //match the mountpoints of the bindings
+    } bindings;
+
+    struct {
+        pthread_mutex_t lock;
+        pthread_t tid;   //the thread doing the init
+        volatile bool running;
+    } lazy_init;
+
+    struct {
+        bool enabled;
+        int max_direct_processes;
+        int semid;  //for the count of the direct processes of this host
+    } agent;
+
+    struct {  //the start-up time of this process
+        int constructor_us;
+        int mountpoint_us;
+        int init_us;
+        int rebuild_us;  //after fork
+    } startup_stat;
 
     struct {
         int (*unsetenv)(const char *name);
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "fastcommon/logger.h"
+#include "fastcommon/shared_func.h"
+#include "fastcfs/api/fcfs_api.h"
+
+typedef struct {
+    const char *pattern;  //for find mode
+    bool show_all;
+    volatile int64_t file_count;
+    volatile int64_t dir_count;
+    volatile int64_t total_size;
+    volatile int64_t total_alloc;
+} DUStatInfo;
+
+static void usage(char *argv[])
+{
+    fprintf(stderr, "Usage: %s [-c config_file=%s] [-t threads=%d] "
+            "[-q max_queue_size=%d] [-a show all entries] "
+            "[-n name_pattern for find] <namespace> [path=/]\n",
+            argv[0], FCFS_FUSE_DEFAULT_CONFIG_FILENAME,
+            FCFS_API_WALK_DEFAULT_THREAD_COUNT,
+            FCFS_API_WALK_DEFAULT_MAX_QUEUE_SIZE);
+}
+
+static inline const char *get_base_name(const string_t *path)
+{
+    const char *p;
+
+    p = path->str + path->len - 1;
+    while (p > path->str && *p != '/') {
+        p--;
+    }
+    return (*p == '/' ? p + 1 : p);
+}
+
+static int du_callback(void *args, const FCFSAPIWalkVisitType type,
+        const FCFSAPIWalkEntry *entry)
+{
+    DUStatInfo *stat;
+
+    stat = (DUStatInfo *)args;
+    if (type == fcfs_api_walk_visit_post) {
+        return FCFS_API_WALK_CONTINUE;
+    }
+
+    if (type == fcfs_api_walk_visit_pre) {
+        __sync_add_and_fetch(&stat->dir_count, 1);
+    } else {
+        __sync_add_and_fetch(&stat->file_count, 1);
+        __sync_add_and_fetch(&stat->total_size, entry->dentry->stat.size);
+        __sync_add_and_fetch(&stat->total_alloc,
+                entry->dentry->stat.alloc);
+    }
+
+    if (stat->pattern != NULL) {
+        if (fnmatch(stat->pattern, get_base_name(entry->path), 0) == 0) {
+            printf("%s\n", entry->path->str);
+        }
+    } else if (stat->show_all) {
+        printf("%"PRId64"\t%s\n", entry->dentry->stat.size,
+                entry->path->str);
+    }
+
+    return FCFS_API_WALK_CONTINUE;
+}
+
+int main(int argc, char *argv[])
+{
+    const bool publish = false;
+    const char *config_filename = FCFS_FUSE_DEFAULT_CONFIG_FILENAME;
+    const char *ns;
+    const char *path;
+    FCFSAPIWalkOptions options;
+    DUStatInfo stat;
+    int64_t start_time_ms;
+    char time_buff[32];
+    int ch;
+    int result;
+
+    memset(&stat, 0, sizeof(stat));
+    options.thread_count = FCFS_API_WALK_DEFAULT_THREAD_COUNT;
+    options.max_queue_size = FCFS_API_WALK_DEFAULT_MAX_QUEUE_SIZE;
+    while ((ch=getopt(argc, argv, "hc:t:q:an:")) != -1) {
+        switch (ch) {
+            case 'h':
+                usage(argv);
+                return 0;
+            case 'c':
+                config_filename = optarg;
+                break;
+            case 't':
+                options.thread_count = strtol(optarg, NULL, 10);
+                break;
+            case 'q':
+                options.max_queue_size = strtol(optarg, NULL, 10);
+                break;
+            case 'a':
+                stat.show_all = true;
+                break;
+            case 'n':
+                stat.pattern = optarg;
+                break;
+            default:
+                usage(argv);
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        usage(argv);
+        return 1;
+    }
+
+    log_init();
+    ns = argv[optind];
+    path = (optind + 1 < argc ? argv[optind + 1] : "/");
+    if ((result=fcfs_api_pooled_init_with_auth(ns,
+                    config_filename, publish)) != 0)
+    {
+        return result;
+    }
+    if ((result=fcfs_api_start()) != 0) {
+        return result;
+    }
+
+    start_time_ms = get_current_time_ms();
+    result = fcfs_api_walk(path, &options, du_callback, &stat);
+    if (result != 0 && result != ECANCELED) {
+        fprintf(stderr, "walk %s fail, errno: %d, error info: %s\n",
+                path, result, STRERROR(result));
+    }
+
+    if (stat.pattern == NULL) {
+        long_to_comma_str(get_current_time_ms() -
+                start_time_ms, time_buff);
+        printf("{\"path\": \"%s\", \"dirs\": %"PRId64", \"files\": %"PRId64
+                ", \"size\": %"PRId64", \"alloc\": %"PRId64", "
+                "\"time_used_ms\": \"%s\"}\n", path, stat.dir_count,
+                stat.file_count, stat.total_size, stat.total_alloc,
+                time_buff);
+    }
+
+    fcfs_api_destroy();
+    return result;
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "fastcommon/logger.h"
+#include "fastcommon/shared_func.h"
+#include "fastcfs/api/fcfs_api.h"
+
+typedef struct {
+    const char *pattern;
+    char type;      //f for regular file, d for directory, l for symlink
+    int max_depth;  //-1 for unlimited
+    int min_depth;
+    int size_cmp;   //1 for greater, -1 for less, 0 for equal
+    int64_t size;
+    bool match_size;
+    volatile int64_t match_count;
+} FindCondition;
+
+static void usage(char *argv[])
+{
+    fprintf(stderr, "Usage: %s [-c config_file=%s] [-t threads=%d] "
+            "[-q max_queue_size=%d] [-n name_pattern] [-T type: f|d|l] "
+            "[-d max_depth] [-m min_depth] [-s [+-]size] "
+            "<namespace> [path=/]\n", argv[0],
+            FCFS_FUSE_DEFAULT_CONFIG_FILENAME,
+            FCFS_API_WALK_DEFAULT_THREAD_COUNT,
+            FCFS_API_WALK_DEFAULT_MAX_QUEUE_SIZE);
+}
+
+static inline const char *get_base_name(const string_t *path)
+{
+    const char *p;
+
+    p = path->str + path->len - 1;
+    while (p > path->str && *p != '/') {
+        p--;
+    }
+    return (*p == '/' && path->len > 1 ? p + 1 : p);
+}
+
+static bool match_type(const char type, const mode_t mode)
+{
+    switch (type) {
+        case 'f':
+            return S_ISREG(mode);
+        case 'd':
+            return S_ISDIR(mode);
+        case 'l':
+            return S_ISLNK(mode);
+        default:
+            return true;
+    }
+}
+
+static bool match_entry(FindCondition *cond, const FCFSAPIWalkEntry *entry)
+{
+    int64_t size;
+
+    if (entry->depth < cond->min_depth) {
+        return false;
+    }
+    if (!match_type(cond->type, entry->dentry->stat.mode)) {
+        return false;
+    }
+    if (cond->match_size) {
+        size = entry->dentry->stat.size;
+        if ((cond->size_cmp > 0 && size <= cond->size) ||
+                (cond->size_cmp < 0 && size >= cond->size) ||
+                (cond->size_cmp == 0 && size != cond->size))
+        {
+            return false;
+        }
+    }
+    if (cond->pattern != NULL && fnmatch(cond->pattern,
+                get_base_name(entry->path), 0) != 0)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+static int find_callback(void *args, const FCFSAPIWalkVisitType type,
+        const FCFSAPIWalkEntry *entry)
+{
+    FindCondition *cond;
+
+    cond = (FindCondition *)args;
+    if (type == fcfs_api_walk_visit_post) {
+        return FCFS_API_WALK_CONTINUE;
+    }
+
+    if (match_entry(cond, entry)) {
+        __sync_add_and_fetch(&cond->match_count, 1);
+        printf("%s\n", entry->path->str);
+    }
+
+    if (type == fcfs_api_walk_visit_pre && cond->max_depth >= 0 &&
+            entry->depth >= cond->max_depth)
+    {
+        return FCFS_API_WALK_PRUNE;
+    }
+    return FCFS_API_WALK_CONTINUE;
+}
+
+static int parse_size(FindCondition *cond, const char *str)
+{
+    if (*str == '+') {
+        cond->size_cmp = 1;
+        str++;
+    } else if (*str == '-') {
+        cond->size_cmp = -1;
+        str++;
+    } else {
+        cond->size_cmp = 0;
+    }
+
+    cond->match_size = true;
+    return parse_bytes(str, 1, &cond->size);
+}
+
+int main(int argc, char *argv[])
+{
+    const bool publish = false;
+    const char *config_filename = FCFS_FUSE_DEFAULT_CONFIG_FILENAME;
+    const char *ns;
+    const char *path;
+    FCFSAPIWalkOptions options;
+    FindCondition cond;
+    int ch;
+    int result;
+
+    memset(&cond, 0, sizeof(cond));
+    cond.max_depth = -1;
+    options.thread_count = FCFS_API_WALK_DEFAULT_THREAD_COUNT;
+    options.max_queue_size = FCFS_API_WALK_DEFAULT_MAX_QUEUE_SIZE;
+    while ((ch=getopt(argc, argv, "hc:t:q:n:T:d:m:s:")) != -1) {
+        switch (ch) {
+            case 'h':
+                usage(argv);
+                return 0;
+            case 'c':
+                config_filename = optarg;
+                break;
+            case 't':
+                options.thread_count = strtol(optarg, NULL, 10);
+                break;
+            case 'q':
+                options.max_queue_size = strtol(optarg, NULL, 10);
+                break;
+            case 'n':
+                cond.pattern = optarg;
+                break;
+            case 'T':
+                if (strcmp(optarg, "f") != 0 && strcmp(optarg, "d") != 0
+                        && strcmp(optarg, "l") != 0)
+                {
+                    fprintf(stderr, "invalid type: %s\n", optarg);
+                    usage(argv);
+                    return EINVAL;
+                }
+                cond.type = *optarg;
+                break;
+            case 'd':
+                cond.max_depth = strtol(optarg, NULL, 10);
+                break;
+            case 'm':
+                cond.min_depth = strtol(optarg, NULL, 10);
+                break;
+            case 's':
+                if (parse_size(&cond, optarg) != 0) {
+                    fprintf(stderr, "invalid size: %s\n", optarg);
+                    usage(argv);
+                    return EINVAL;
+                }
+                break;
+            default:
+                usage(argv);
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        usage(argv);
+        return 1;
+    }
+
+    log_init();
+    ns = argv[optind];
+    path = (optind + 1 < argc ? argv[optind + 1] : "/");
+    if ((result=fcfs_api_pooled_init_with_auth(ns,
+                    config_filename, publish)) != 0)
+    {
+        return result;
+    }
+    if ((result=fcfs_api_start()) != 0) {
+        return result;
+    }
+
+    result = fcfs_api_walk(path, &options, find_callback, &cond);
+    if (result != 0 && result != ECANCELED) {
+        fprintf(stderr, "walk %s fail, errno: %d, error info: %s\n",
+                path, result, STRERROR(result));
+    }
+
+    fcfs_api_destroy();
+    return result;
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "fastcommon/logger.h"
+#include "fastcommon/shared_func.h"
+#include "fastcommon/pthread_func.h"
+#include "fastcommon/fc_atomic.h"
+#include "sf/sf_global.h"
+#include "fastcfs/api/fcfs_api.h"
+
+static FCFSAPIRemoveTreeStat rm_stat;
+static int64_t start_time_ms;
+static struct {
+    bool done;     //set by the main thread to stop the progress thread
+    bool running;  //cleared by the progress thread when it exits
+    pthread_lock_cond_pair_t lcp;
+} progress_ctx;
+
+static void usage(char *argv[])
+{
+    fprintf(stderr, "Usage: %s [-c config_file=%s] [-t threads=%d] "
+            "[-q max_queue_size=%d] [-i progress_interval=1s] "
+            "<namespace> <path>\n", argv[0],
+            FCFS_FUSE_DEFAULT_CONFIG_FILENAME,
+            FCFS_API_WALK_DEFAULT_THREAD_COUNT,
+            FCFS_API_WALK_DEFAULT_MAX_QUEUE_SIZE);
+}
+
+static void output_progress(const char *caption)
+{
+    char files_buff[32];
+    char dirs_buff[32];
+    char bytes_buff[32];
+    int64_t time_used;
+
+    time_used = get_current_time_ms() - start_time_ms;
+    long_to_comma_str(FC_ATOMIC_GET(rm_stat.file_count), files_buff);
+    long_to_comma_str(FC_ATOMIC_GET(rm_stat.dir_count), dirs_buff);
+    long_to_comma_str(FC_ATOMIC_GET(rm_stat.bytes), bytes_buff);
+    fprintf(stderr, "%s removed files: %s, dirs: %s, bytes: %s, "
+            "fail count: %"PRId64", time used: %"PRId64" ms\n",
+            caption, files_buff, dirs_buff, bytes_buff,
+            FC_ATOMIC_GET(rm_stat.fail_count), time_used);
+}
+
+static void *progress_thread_func(void *arg)
+{
+    struct timespec ts;
+    int interval;
+
+    interval = (long)arg;
+    PTHREAD_MUTEX_LOCK(&progress_ctx.lcp.lock);
+    while (!progress_ctx.done) {
+        ts.tv_sec = time(NULL) + interval;
+        ts.tv_nsec = 0;
+        pthread_cond_timedwait(&progress_ctx.lcp.cond,
+                &progress_ctx.lcp.lock, &ts);
+        if (!progress_ctx.done) {
+            output_progress("[progress]");
+        }
+    }
+    progress_ctx.running = false;
+    pthread_cond_signal(&progress_ctx.lcp.cond);
+    PTHREAD_MUTEX_UNLOCK(&progress_ctx.lcp.lock);
+
+    return NULL;
+}
+
+static void stop_progress_thread()
+{
+    PTHREAD_MUTEX_LOCK(&progress_ctx.lcp.lock);
+    progress_ctx.done = true;
+    pthread_cond_broadcast(&progress_ctx.lcp.cond);
+    while (progress_ctx.running) {
+        pthread_cond_wait(&progress_ctx.lcp.cond, &progress_ctx.lcp.lock);
+    }
+    PTHREAD_MUTEX_UNLOCK(&progress_ctx.lcp.lock);
+}
+
+int main(int argc, char *argv[])
+{
+    const bool publish = false;
+    const char *config_filename = FCFS_FUSE_DEFAULT_CONFIG_FILENAME;
+    const char *ns;
+    const char *path;
+    FCFSAPIWalkOptions options;
+    pthread_t tid;
+    long interval;
+    int ch;
+    int result;
+
+    interval = 1;
+    options.thread_count = FCFS_API_WALK_DEFAULT_THREAD_COUNT;
+    options.max_queue_size = FCFS_API_WALK_DEFAULT_MAX_QUEUE_SIZE;
+    while ((ch=getopt(argc, argv, "hc:t:q:i:")) != -1) {
+        switch (ch) {
+            case 'h':
+                usage(argv);
+                return 0;
+            case 'c':
+                config_filename = optarg;
+                break;
+            case 't':
+                options.thread_count = strtol(optarg, NULL, 10);
+                break;
+            case 'q':
+                options.max_queue_size = strtol(optarg, NULL, 10);
+                break;
+            case 'i':
+                interval = strtol(optarg, NULL, 10);
+                break;
+            default:
+                usage(argv);
+                return 1;
+        }
+    }
+
+    if (optind + 2 > argc) {
+        usage(argv);
+        return 1;
+    }
+
+    log_init();
+    ns = argv[optind];
+    path = argv[optind + 1];
+    if ((result=fcfs_api_pooled_init_with_auth(ns,
+                    config_filename, publish)) != 0)
+    {
+        return result;
+    }
+    if ((result=fcfs_api_start()) != 0) {
+        return result;
+    }
+
+    start_time_ms = get_current_time_ms();
+    if (interval > 0) {
+        if ((result=init_pthread_lock_cond_pair(&progress_ctx.lcp)) != 0) {
+            return result;
+        }
+        progress_ctx.running = true;
+        if ((result=fc_create_thread(&tid, progress_thread_func,
+                        (void *)interval, SF_G_THREAD_STACK_SIZE)) != 0)
+        {
+            return result;
+        }
+    }
+
+    result = fcfs_api_remove_tree(path, &options, &rm_stat);
+    if (interval > 0) {
+        stop_progress_thread();
+        destroy_pthread_lock_cond_pair(&progress_ctx.lcp);
+    }
+    output_progress("[done]");
+    if (result != 0) {
+        fprintf(stderr, "remove %s fail, errno: %d, error info: %s\n",
+                path, result, STRERROR(result));
+    }
+
+    fcfs_api_destroy();
+    return result;
+}
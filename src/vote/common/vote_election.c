@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "vote_election.h"
+
+int fcfs_vote_election_decide(const FCFSVoteElectionParams *params,
+        const FCFSVoteElectionRound *round)
+{
+    if (!round->quorum_ok) {
+        return FCFS_VOTE_ELECTION_RETRY_QUORUM;
+    }
+
+    if ((round->active_count == round->server_count) ||
+            (round->active_count >= 2 && round->has_master))
+    {
+        return FCFS_VOTE_ELECTION_DONE;
+    }
+
+    if (round->elapsed_ms >= params->max_wait_time * 1000) {
+        return FCFS_VOTE_ELECTION_DONE;
+    }
+
+    return params->pre_vote_enabled ? FCFS_VOTE_ELECTION_PRE_VOTE :
+        FCFS_VOTE_ELECTION_WAIT;
+}
+
+/* k-of-n miss detection: the master is lost when miss_threshold of
+ * the recent miss_window heartbeats fail, or no heartbeat success
+ * within master_lost_timeout and the failure is not the first one
+ */
+int fcfs_vote_heartbeat_record(const FCFSVoteElectionParams *params,
+        FCFSVoteHeartbeatDetector *detector, const bool success,
+        const int64_t current_time_ms)
+{
+    uint64_t mask;
+
+    mask = (params->heartbeat.miss_window >= 64) ? ~0ULL :
+        ((1ULL << params->heartbeat.miss_window) - 1);
+    detector->miss_bits = ((detector->miss_bits << 1) |
+            (success ? 0 : 1)) & mask;
+    if (success) {
+        detector->fail_count = 0;
+        detector->last_ok_time_ms = current_time_ms;
+        return FCFS_VOTE_HEARTBEAT_ALIVE;
+    }
+
+    ++detector->fail_count;
+    if (__builtin_popcountll(detector->miss_bits) >=
+            params->heartbeat.miss_threshold)
+    {
+        return FCFS_VOTE_HEARTBEAT_LOST_MISSES;
+    }
+
+    if (current_time_ms - detector->last_ok_time_ms >
+            params->master_lost_timeout * 1000LL)
+    {
+        return (detector->fail_count > 1) ? FCFS_VOTE_HEARTBEAT_LOST_TIMEOUT :
+            FCFS_VOTE_HEARTBEAT_RETRY;
+    }
+
+    return FCFS_VOTE_HEARTBEAT_WAIT;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* the decisions of the master election shared by fcfs_voted and
+ * fcfs_authd, they depend on nothing but the arguments so the same
+ * code can run against the simulated network of fvote_election_sim
+ */
+
+#ifndef _FCFS_VOTE_ELECTION_H
+#define _FCFS_VOTE_ELECTION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/* the result of a select master round */
+#define FCFS_VOTE_ELECTION_RETRY_QUORUM  1  //alive servers < quorum
+#define FCFS_VOTE_ELECTION_WAIT          2  //wait for the absent servers
+#define FCFS_VOTE_ELECTION_PRE_VOTE      3  //ask the others for the candidate
+#define FCFS_VOTE_ELECTION_DONE          4  //the candidate is determined
+
+/* the result of a heartbeat to the master */
+#define FCFS_VOTE_HEARTBEAT_ALIVE        0
+#define FCFS_VOTE_HEARTBEAT_RETRY        1  //ping again at once
+#define FCFS_VOTE_HEARTBEAT_WAIT         2  //ping again after the interval
+#define FCFS_VOTE_HEARTBEAT_LOST_MISSES  3  //k-of-n heartbeats fail
+#define FCFS_VOTE_HEARTBEAT_LOST_TIMEOUT 4  //master_lost_timeout reached
+
+typedef struct fcfs_vote_election_params {
+    int master_lost_timeout;  //in seconds
+    int max_wait_time;        //in seconds
+    struct {
+        int interval_ms;
+        int miss_window;
+        int miss_threshold;
+    } heartbeat;
+    bool pre_vote_enabled;
+} FCFSVoteElectionParams;
+
+typedef struct fcfs_vote_election_round {
+    int server_count;
+    int active_count;
+    bool quorum_ok;      //the active servers satisfy the quorum
+    bool has_master;     //the candidate already is master
+    int elapsed_ms;      //since the election start
+} FCFSVoteElectionRound;
+
+typedef struct fcfs_vote_heartbeat_detector {
+    int fail_count;
+    uint64_t miss_bits;
+    int64_t last_ok_time_ms;
+} FCFSVoteHeartbeatDetector;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* compare the server status for the master candidate, the master
+ * first then the bigger server id, the best one sorts to the last
+ */
+static inline int fcfs_vote_election_compare(const bool is_master1,
+        const int server_id1, const bool is_master2, const int server_id2)
+{
+    int sub;
+
+    sub = (int)is_master1 - (int)is_master2;
+    if (sub != 0) {
+        return sub;
+    }
+    return server_id1 - server_id2;
+}
+
+/* what to do after the status of the servers collected */
+int fcfs_vote_election_decide(const FCFSVoteElectionParams *params,
+        const FCFSVoteElectionRound *round);
+
+/* grant when I lost the master too or the candidate is my master,
+ * the server ids are 0 for none
+ */
+static inline bool fcfs_vote_election_pre_vote_grant(
+        const int my_master_id, const int candidate_id)
+{
+    return (my_master_id == 0 || my_master_id == candidate_id);
+}
+
+static inline bool fcfs_vote_election_pre_vote_passed(
+        const int server_count, const int granted_count)
+{
+    return granted_count > server_count / 2;
+}
+
+/* the rules of the two phase master notify, the server ids are 0 for
+ * none, return 0 to accept, otherwise the caller should clear the
+ * next master
+ */
+static inline int fcfs_vote_election_check_pre_set(
+        const int next_master_id, const int master_id)
+{
+    return (next_master_id == 0 || next_master_id == master_id) ?
+        0 : EEXIST;
+}
+
+static inline int fcfs_vote_election_check_commit(
+        const int next_master_id, const int master_id)
+{
+    return (next_master_id != 0 && next_master_id == master_id) ?
+        0 : EBUSY;
+}
+
+static inline void fcfs_vote_heartbeat_reset(
+        FCFSVoteHeartbeatDetector *detector, const int64_t current_time_ms)
+{
+    detector->fail_count = 0;
+    detector->miss_bits = 0;
+    detector->last_ok_time_ms = current_time_ms;
+}
+
+/* record the result of a heartbeat to the master,
+ * return FCFS_VOTE_HEARTBEAT_xxx
+ */
+int fcfs_vote_heartbeat_record(const FCFSVoteElectionParams *params,
+        FCFSVoteHeartbeatDetector *detector, const bool success,
+        const int64_t current_time_ms);
+
+/* the network timeout in seconds of the next ping */
+static inline int fcfs_vote_heartbeat_ping_timeout(
+        const FCFSVoteElectionParams *params,
+        const FCFSVoteHeartbeatDetector *detector,
+        const int64_t current_time_ms)
+{
+    int remain_time;
+
+    remain_time = params->master_lost_timeout - (int)((current_time_ms -
+                detector->last_ok_time_ms) / 1000);
+    return (remain_time < 2) ? 2 : remain_time;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -62,6 +62,10 @@ const char *fcfs_vote_get_cmd_caption(const int cmd)
             return "PRE_SET_NEXT_MASTER";
         case FCFS_VOTE_CLUSTER_PROTO_COMMIT_NEXT_MASTER:
             return "COMMIT_NEXT_MASTER";
+        case FCFS_VOTE_CLUSTER_PROTO_PRE_VOTE_REQ:
+            return "PRE_VOTE_REQ";
+        case FCFS_VOTE_CLUSTER_PROTO_PRE_VOTE_RESP:
+            return "PRE_VOTE_RESP";
         default:
             return sf_get_cmd_caption(cmd);
     }
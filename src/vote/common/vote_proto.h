@@ -43,6 +43,8 @@
 #define FCFS_VOTE_CLUSTER_PROTO_PING_MASTER_RESP          86
 #define FCFS_VOTE_CLUSTER_PROTO_PRE_SET_NEXT_MASTER       87  //notify next master to other servers
 #define FCFS_VOTE_CLUSTER_PROTO_COMMIT_NEXT_MASTER        88  //commit next master to other servers
+#define FCFS_VOTE_CLUSTER_PROTO_PRE_VOTE_REQ              89  //ask if the master lost
+#define FCFS_VOTE_CLUSTER_PROTO_PRE_VOTE_RESP             90
 
 typedef SFCommonProtoHeader  FCFSVoteProtoHeader;
 
@@ -71,6 +73,17 @@ typedef struct fcfs_vote_proto_get_server_status_resp {
     char padding[3];
 } FCFSVoteProtoGetServerStatusResp;
 
+typedef struct fcfs_vote_proto_pre_vote_req {
+    char config_sign[SF_CLUSTER_CONFIG_SIGN_LEN];
+    char server_id[4];     //the requester server id
+    char candidate_id[4];  //the candidate server id for the next master
+} FCFSVoteProtoPreVoteReq;
+
+typedef struct fcfs_vote_proto_pre_vote_resp {
+    char granted;  //the responder lost the master too
+    char padding[7];
+} FCFSVoteProtoPreVoteResp;
+
 typedef struct fcfs_vote_proto_join_master_req {
     char server_id[4];     //the slave server id
     char padding[4];
@@ -144,6 +144,43 @@ static int cluster_deal_get_server_status(struct fast_task_info *task)
     return 0;
 }
 
+static int cluster_deal_pre_vote(struct fast_task_info *task)
+{
+    int result;
+    int server_id;
+    int candidate_id;
+    FCFSVoteProtoPreVoteReq *req;
+    FCFSVoteProtoPreVoteResp *resp;
+    FCFSVoteClusterServerInfo *master;
+
+    if ((result=server_expect_body_length(sizeof(
+                        FCFSVoteProtoPreVoteReq))) != 0)
+    {
+        return result;
+    }
+
+    req = (FCFSVoteProtoPreVoteReq *)REQUEST.body;
+    server_id = buff2int(req->server_id);
+    if ((result=cluster_check_config_sign(task, server_id,
+                    req->config_sign)) != 0)
+    {
+        return result;
+    }
+
+    /* grant when I lost the master too or the candidate is my master */
+    candidate_id = buff2int(req->candidate_id);
+    master = CLUSTER_MASTER_ATOM_PTR;
+    resp = (FCFSVoteProtoPreVoteResp *)SF_PROTO_SEND_BODY(task);
+    memset(resp, 0, sizeof(*resp));
+    resp->granted = fcfs_vote_election_pre_vote_grant((master != NULL ?
+                master->server->id : 0), candidate_id);
+
+    RESPONSE.header.body_len = sizeof(FCFSVoteProtoPreVoteResp);
+    RESPONSE.header.cmd = FCFS_VOTE_CLUSTER_PROTO_PRE_VOTE_RESP;
+    TASK_CTX.common.response_done = true;
+    return 0;
+}
+
 static int cluster_deal_join_master(struct fast_task_info *task)
 {
     int result;
@@ -290,6 +327,8 @@ static int cluster_process(struct fast_task_info *task)
             return sf_proto_deal_active_test(task, &REQUEST, &RESPONSE);
         case FCFS_VOTE_CLUSTER_PROTO_GET_SERVER_STATUS_REQ:
             return cluster_deal_get_server_status(task);
+        case FCFS_VOTE_CLUSTER_PROTO_PRE_VOTE_REQ:
+            return cluster_deal_pre_vote(task);
         case FCFS_VOTE_CLUSTER_PROTO_PRE_SET_NEXT_MASTER:
         case FCFS_VOTE_CLUSTER_PROTO_COMMIT_NEXT_MASTER:
             return cluster_deal_next_master(task);
@@ -195,16 +195,11 @@ static int cluster_cmp_server_status(const void *p1, const void *p2)
 {
     FCFSVoteClusterServerStatus *status1;
     FCFSVoteClusterServerStatus *status2;
-    int sub;
 
     status1 = (FCFSVoteClusterServerStatus *)p1;
     status2 = (FCFSVoteClusterServerStatus *)p2;
-    sub = (int)status1->is_master - (int)status2->is_master;
-    if (sub != 0) {
-        return sub;
-    }
-
-    return (int)status1->server_id - (int)status2->server_id;
+    return fcfs_vote_election_compare(status1->is_master,
+            status1->server_id, status2->is_master, status2->server_id);
 }
 
 #define cluster_get_server_status(server_status) \
@@ -237,6 +232,85 @@ static int cluster_get_server_status_ex(FCFSVoteClusterServerStatus
     }
 }
 
+static int proto_pre_vote(ConnectionInfo *conn, const int network_timeout,
+        const int candidate_id, bool *granted)
+{
+	int result;
+	FCFSVoteProtoHeader *header;
+    FCFSVoteProtoPreVoteReq *req;
+    FCFSVoteProtoPreVoteResp *resp;
+    SFResponseInfo response;
+	char out_buff[sizeof(FCFSVoteProtoHeader) + sizeof(FCFSVoteProtoPreVoteReq)];
+	char in_body[sizeof(FCFSVoteProtoPreVoteResp)];
+
+    header = (FCFSVoteProtoHeader *)out_buff;
+    SF_PROTO_SET_HEADER(header, FCFS_VOTE_CLUSTER_PROTO_PRE_VOTE_REQ,
+            sizeof(out_buff) - sizeof(FCFSVoteProtoHeader));
+
+    req = (FCFSVoteProtoPreVoteReq *)(out_buff + sizeof(FCFSVoteProtoHeader));
+    int2buff(CLUSTER_MY_SERVER_ID, req->server_id);
+    int2buff(candidate_id, req->candidate_id);
+    memcpy(req->config_sign, CLUSTER_CONFIG_SIGN_BUF,
+            SF_CLUSTER_CONFIG_SIGN_LEN);
+
+    response.error.length = 0;
+    if ((result=sf_send_and_recv_response(conn, out_buff,
+                    sizeof(out_buff), &response, network_timeout,
+                    FCFS_VOTE_CLUSTER_PROTO_PRE_VOTE_RESP, in_body,
+                    sizeof(in_body))) != 0)
+    {
+        vote_log_network_error(&response, conn, result);
+        return result;
+    }
+
+    resp = (FCFSVoteProtoPreVoteResp *)in_body;
+    *granted = resp->granted;
+    return 0;
+}
+
+/* ask the servers whether they lost the master too, the master
+ * election needs not to wait for the lost master when the majority
+ * of the servers lost it
+ */
+static bool cluster_pre_vote(const int candidate_id)
+{
+    const int connect_timeout = 2;
+    const int network_timeout = 2;
+    FCFSVoteClusterServerInfo *server;
+    FCFSVoteClusterServerInfo *end;
+    FCFSVoteClusterServerInfo *master;
+    ConnectionInfo conn;
+    int granted_count;
+    bool granted;
+
+    granted_count = 0;
+    end = CLUSTER_SERVER_ARRAY.servers + CLUSTER_SERVER_ARRAY.count;
+    for (server=CLUSTER_SERVER_ARRAY.servers; server<end; server++) {
+        if (server == CLUSTER_MYSELF_PTR) {
+            master = CLUSTER_MASTER_ATOM_PTR;
+            granted = fcfs_vote_election_pre_vote_grant((master != NULL ?
+                        master->server->id : 0), candidate_id);
+        } else {
+            granted = false;
+            if (fc_server_make_connection_ex(&CLUSTER_GROUP_ADDRESS_ARRAY(
+                            server->server), &conn, "fvote",
+                        connect_timeout, NULL, false) == 0)
+            {
+                proto_pre_vote(&conn, network_timeout,
+                        candidate_id, &granted);
+                conn_pool_disconnect_server(&conn);
+            }
+        }
+
+        if (granted) {
+            ++granted_count;
+        }
+    }
+
+    return fcfs_vote_election_pre_vote_passed(
+            CLUSTER_SERVER_ARRAY.count, granted_count);
+}
+
 static int do_check_brainsplit(FCFSVoteClusterServerInfo *cs)
 {
     int result;
@@ -434,22 +508,27 @@ static int do_notify_master_changed(FCFSVoteClusterServerInfo *cs,
     return result;
 }
 
+#define NEXT_MASTER_ID(next_master) \
+    ((next_master) != NULL ? (next_master)->server->id : 0)
+
 int cluster_relationship_pre_set_master(FCFSVoteClusterServerInfo *master)
 {
     FCFSVoteClusterServerInfo *next_master;
+    int result;
 
     next_master = CLUSTER_NEXT_MASTER;
-    if (next_master == NULL) {
-        CLUSTER_NEXT_MASTER = master;
-    } else if (next_master != master) {
+    if ((result=fcfs_vote_election_check_pre_set(NEXT_MASTER_ID(
+                        next_master), master->server->id)) != 0)
+    {
         logError("file: "__FILE__", line: %d, "
                 "try to set next master id: %d, "
                 "but next master: %d already exist",
                 __LINE__, master->server->id, next_master->server->id);
         CLUSTER_NEXT_MASTER = NULL;
-        return EEXIST;
+        return result;
     }
 
+    CLUSTER_NEXT_MASTER = master;
     return 0;
 }
 
@@ -508,17 +587,19 @@ int cluster_relationship_commit_master(FCFSVoteClusterServerInfo *master)
     int result;
 
     next_master = CLUSTER_NEXT_MASTER;
-    if (next_master == NULL) {
-        logError("file: "__FILE__", line: %d, "
-                "next master is NULL", __LINE__);
-        return EBUSY;
-    }
-    if (next_master != master) {
-        logError("file: "__FILE__", line: %d, "
-                "next master server id: %d != expected server id: %d",
-                __LINE__, next_master->server->id, master->server->id);
-        CLUSTER_NEXT_MASTER = NULL;
-        return EBUSY;
+    if ((result=fcfs_vote_election_check_commit(NEXT_MASTER_ID(
+                        next_master), master->server->id)) != 0)
+    {
+        if (next_master == NULL) {
+            logError("file: "__FILE__", line: %d, "
+                    "next master is NULL", __LINE__);
+        } else {
+            logError("file: "__FILE__", line: %d, "
+                    "next master server id: %d != expected server id: %d",
+                    __LINE__, next_master->server->id, master->server->id);
+            CLUSTER_NEXT_MASTER = NULL;
+        }
+        return result;
     }
 
     result = cluster_relationship_set_master(master, start_time);
@@ -635,9 +716,11 @@ static int cluster_select_master()
     int max_sleep_secs;
     int sleep_secs;
     int remain_time;
+    int decision;
     time_t start_time;
     time_t last_log_time;
 	FCFSVoteClusterServerStatus server_status;
+    FCFSVoteElectionRound round;
     FCFSVoteClusterServerInfo *next_master;
     char formatted_ip[FORMATTED_IP_SIZE];
 
@@ -648,6 +731,7 @@ static int cluster_select_master()
     last_log_time = 0;
     sleep_secs = 10;
     max_sleep_secs = 1;
+    round.server_count = CLUSTER_SERVER_ARRAY.count;
     i = 0;
     while (CLUSTER_MASTER_ATOM_PTR == NULL) {
         if (sleep_secs > 1) {
@@ -669,9 +753,13 @@ static int cluster_select_master()
         }
 
         ++i;
-        if (!sf_election_quorum_check(MASTER_ELECTION_QUORUM, false,
-                    CLUSTER_SERVER_ARRAY.count, active_count))
-        {
+        round.active_count = active_count;
+        round.quorum_ok = sf_election_quorum_check(MASTER_ELECTION_QUORUM,
+                false, CLUSTER_SERVER_ARRAY.count, active_count);
+        round.has_master = server_status.is_master;
+        round.elapsed_ms = (g_current_time - start_time) * 1000;
+        decision = fcfs_vote_election_decide(&ELECTION_PARAMS, &round);
+        if (decision == FCFS_VOTE_ELECTION_RETRY_QUORUM) {
             sleep_secs = 1;
             if (need_log) {
                 logWarning("file: "__FILE__", line: %d, "
@@ -685,17 +773,27 @@ static int cluster_select_master()
             continue;
         }
 
-        if ((active_count == CLUSTER_SERVER_ARRAY.count) ||
-                (active_count >= 2 && server_status.is_master))
-        {
+        if (decision == FCFS_VOTE_ELECTION_DONE) {
             break;
         }
 
-        remain_time = ELECTION_MAX_WAIT_TIME - (g_current_time - start_time);
-        if (remain_time <= 0) {
-            break;
+        if (decision == FCFS_VOTE_ELECTION_PRE_VOTE) {
+            if (cluster_pre_vote(server_status.server_id)) {
+                logInfo("file: "__FILE__", line: %d, "
+                        "round %dth select master, alive server count: %d "
+                        "< server count: %d, the majority of the servers "
+                        "lost the master, candidate id: %d", __LINE__, i,
+                        active_count, CLUSTER_SERVER_ARRAY.count,
+                        server_status.server_id);
+                break;
+            }
+
+            /* wait for the other servers to detect the master lost */
+            fc_sleep_ms(ELECTION_HEARTBEAT_INTERVAL_MS);
+            continue;
         }
 
+        remain_time = ELECTION_MAX_WAIT_TIME - (g_current_time - start_time);
         sleep_secs = FC_MIN(remain_time, max_sleep_secs);
         logWarning("file: "__FILE__", line: %d, "
                 "round %dth select master, alive server count: %d "
@@ -797,11 +895,11 @@ static void *cluster_thread_entrance(void* arg)
 #define MAX_SLEEP_SECONDS  10
 
     int result;
-    int fail_count;
-    int sleep_seconds;
-    int ping_remain_time;
-    time_t ping_start_time;
+    int status;
+    int sleep_ms;
+    int ping_timeout;
     bool is_ping;
+    FCFSVoteHeartbeatDetector detector;
     FCFSVoteClusterServerInfo *master;
     ConnectionInfo mconn;  //master connection
     char formatted_ip[FORMATTED_IP_SIZE];
@@ -813,64 +911,77 @@ static void *cluster_thread_entrance(void* arg)
     memset(&mconn, 0, sizeof(mconn));
     mconn.sock = -1;
 
-    fail_count = 0;
-    sleep_seconds = 1;
-    ping_start_time = g_current_time;
+    fcfs_vote_heartbeat_reset(&detector, get_current_time_ms());
+    sleep_ms = 1000;
     while (SF_G_CONTINUE_FLAG) {
         master = CLUSTER_MASTER_ATOM_PTR;
         if (master == NULL) {
             if (cluster_select_master() != 0) {
-                sleep_seconds = 1 + (int)((double)rand()
-                        * (double)MAX_SLEEP_SECONDS / RAND_MAX);
+                sleep_ms = 1000 + (int)((double)rand()
+                        * (double)MAX_SLEEP_SECONDS * 1000 / RAND_MAX);
             } else {
                 if (mconn.sock >= 0) {
                     conn_pool_disconnect_server(&mconn);
                 }
-                ping_start_time = g_current_time;
-                sleep_seconds = 1;
+                fcfs_vote_heartbeat_reset(&detector, get_current_time_ms());
+                sleep_ms = ELECTION_HEARTBEAT_INTERVAL_MS;
             }
         } else {
-            ping_remain_time = ELECTION_MASTER_LOST_TIMEOUT -
-                (g_current_time - ping_start_time);
-            if (ping_remain_time < 2) {
-                ping_remain_time = 2;
-            }
+            ping_timeout = fcfs_vote_heartbeat_ping_timeout(&ELECTION_PARAMS,
+                    &detector, get_current_time_ms());
             if ((result=cluster_ping_master(master, &mconn,
-                            ping_remain_time, &is_ping)) == 0)
+                            ping_timeout, &is_ping)) == 0)
             {
-                fail_count = 0;
-                ping_start_time = g_current_time;
-                sleep_seconds = 1;
+                if (is_ping) {
+                    fcfs_vote_heartbeat_record(&ELECTION_PARAMS, &detector,
+                            true, get_current_time_ms());
+                    sleep_ms = ELECTION_HEARTBEAT_INTERVAL_MS;
+                } else {
+                    fcfs_vote_heartbeat_reset(&detector,
+                            get_current_time_ms());
+                    sleep_ms = 1000;  //master check
+                }
             } else if (is_ping) {
-                ++fail_count;
+                status = fcfs_vote_heartbeat_record(&ELECTION_PARAMS,
+                        &detector, false, get_current_time_ms());
                 format_ip_address(CLUSTER_GROUP_ADDRESS_FIRST_IP(
                             master->server), formatted_ip);
                 logError("file: "__FILE__", line: %d, "
                         "%dth ping master id: %d, %s:%u fail", __LINE__,
-                        fail_count, master->server->id, formatted_ip,
+                        detector.fail_count, master->server->id, formatted_ip,
                         CLUSTER_GROUP_ADDRESS_FIRST_PORT(master->server));
                 if (result == SF_RETRIABLE_ERROR_NOT_MASTER) {
-                    cluster_unset_master(master);
-                    fail_count = 0;
-                    sleep_seconds = 0;
-                } else if (g_current_time - ping_start_time >
-                        ELECTION_MASTER_LOST_TIMEOUT)
-                {
-                    if (fail_count > 1) {
+                    status = FCFS_VOTE_HEARTBEAT_LOST_TIMEOUT;
+                } else if (status == FCFS_VOTE_HEARTBEAT_LOST_MISSES) {
+                    logWarning("file: "__FILE__", line: %d, "
+                            "master id: %d lost because %d of the recent "
+                            "%d heartbeats fail", __LINE__, master->server->
+                            id, ELECTION_HEARTBEAT.miss_threshold,
+                            ELECTION_HEARTBEAT.miss_window);
+                }
+
+                switch (status) {
+                    case FCFS_VOTE_HEARTBEAT_LOST_MISSES:
+                    case FCFS_VOTE_HEARTBEAT_LOST_TIMEOUT:
                         cluster_unset_master(master);
-                        fail_count = 0;
-                    }
-                    sleep_seconds = 0;
-                } else {
-                    sleep_seconds = 1;
+                        fcfs_vote_heartbeat_reset(&detector,
+                                get_current_time_ms());
+                        sleep_ms = 0;
+                        break;
+                    case FCFS_VOTE_HEARTBEAT_RETRY:
+                        sleep_ms = 0;
+                        break;
+                    default:
+                        sleep_ms = ELECTION_HEARTBEAT_INTERVAL_MS;
+                        break;
                 }
             } else {
-                sleep_seconds = 1;
+                sleep_ms = 1000;
             }
         }
 
-        if (sleep_seconds > 0) {
-            sleep(sleep_seconds);
+        if (sleep_ms > 0) {
+            fc_sleep_ms(sleep_ms);
         }
     }
 
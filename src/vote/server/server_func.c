@@ -50,6 +50,7 @@ static void server_log_configs()
     char sz_global_config[512];
     char sz_slowlog_config[256];
     char sz_service_config[256];
+    char sz_group_config[128];
 
     sf_global_config_to_string(sz_global_config, sizeof(sz_global_config));
     sf_slow_log_config_to_string(&SLOW_LOG_CFG, "slow-log",
@@ -59,16 +60,24 @@ static void server_log_configs()
 
     snprintf(sz_server_config, sizeof(sz_server_config),
             "master-election {quorum: %s, master_lost_timeout: %ds, "
-            "max_wait_time: %ds}", sf_get_election_quorum_caption(
+            "max_wait_time: %ds, heartbeat_interval_ms: %d, "
+            "heartbeat_miss_window: %d, heartbeat_miss_threshold: %d, "
+            "pre_vote_enabled: %d}", sf_get_election_quorum_caption(
                 MASTER_ELECTION_QUORUM), ELECTION_MASTER_LOST_TIMEOUT,
-            ELECTION_MAX_WAIT_TIME);
+            ELECTION_MAX_WAIT_TIME, ELECTION_HEARTBEAT_INTERVAL_MS,
+            ELECTION_HEARTBEAT.miss_window, ELECTION_HEARTBEAT.
+            miss_threshold, ELECTION_PRE_VOTE_ENABLED);
 
-    logInfo("FCFSVote V%d.%d.%d, %s, %s, service: {%s}, %s",
+    snprintf(sz_group_config, sizeof(sz_group_config),
+            "service-group {htable_capacity: %d, shared_lock_count: %d}",
+            SERVICE_GROUP_HTABLE_CAPACITY, SERVICE_GROUP_SHARED_LOCK_COUNT);
+
+    logInfo("FCFSVote V%d.%d.%d, %s, %s, service: {%s}, %s, %s",
             g_fcfs_vote_global_vars.version.major,
             g_fcfs_vote_global_vars.version.minor,
             g_fcfs_vote_global_vars.version.patch,
             sz_global_config, sz_slowlog_config,
-            sz_service_config, sz_server_config);
+            sz_service_config, sz_group_config, sz_server_config);
 
     log_local_host_ip_addrs();
     log_cluster_server_config();
@@ -93,6 +102,15 @@ static int load_master_election_config(const char *cluster_filename)
             &ini_ctx, "master_lost_timeout", 3, 1, 30);
     ELECTION_MAX_WAIT_TIME = iniGetIntCorrectValue(
             &ini_ctx, "max_wait_time", 5, 1, 300);
+    ELECTION_HEARTBEAT_INTERVAL_MS = iniGetIntCorrectValue(
+            &ini_ctx, "heartbeat_interval_ms", 1000, 10, 10000);
+    ELECTION_HEARTBEAT.miss_window = iniGetIntCorrectValue(
+            &ini_ctx, "heartbeat_miss_window", 5, 1, 64);
+    ELECTION_HEARTBEAT.miss_threshold = iniGetIntCorrectValue(
+            &ini_ctx, "heartbeat_miss_threshold", 3, 1,
+            ELECTION_HEARTBEAT.miss_window);
+    ELECTION_PRE_VOTE_ENABLED = iniGetBoolValue(ini_ctx.section_name,
+            "pre_vote_enabled", ini_ctx.context, true);
     if ((result=sf_load_election_quorum_config(&MASTER_ELECTION_QUORUM,
                     &ini_ctx)) != 0)
     {
@@ -103,6 +121,19 @@ static int load_master_election_config(const char *cluster_filename)
     return 0;
 }
 
+static void load_service_group_config(const char *filename,
+        IniContext *ini_context)
+{
+    IniFullContext ini_ctx;
+
+    FAST_INI_SET_FULL_CTX_EX(ini_ctx, filename,
+            "service-group", ini_context);
+    SERVICE_GROUP_SHARED_LOCK_COUNT = iniGetIntCorrectValue(
+            &ini_ctx, "shared_lock_count", 163, 1, 10000);
+    SERVICE_GROUP_HTABLE_CAPACITY = iniGetIntCorrectValue(
+            &ini_ctx, "htable_capacity", 1361, 1, 100000000);
+}
+
 static int load_cluster_config(IniFullContext *ini_ctx,
         char *full_cluster_filename)
 {
@@ -179,6 +210,7 @@ int server_load_config(const char *filename)
         return result;
     }
 
+    load_service_group_config(filename, &ini_context);
     iniFreeContext(&ini_context);
 
     load_local_host_ip_addrs();
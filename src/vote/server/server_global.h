@@ -19,6 +19,7 @@
 
 #include "fastcommon/common_define.h"
 #include "sf/sf_global.h"
+#include "../common/vote_election.h"
 #include "../common/vote_global.h"
 #include "server_types.h"
 
@@ -33,22 +34,28 @@ typedef struct server_global_vars {
         struct {
             SFElectionQuorum quorum;
             bool vote_node_enabled;
-            int master_lost_timeout;
-            int max_wait_time;
+            FCFSVoteElectionParams params;
         } master_election;
 
         SFContext sf_context;  //for cluster communication
     } cluster;
 
+    struct {
+        int htable_capacity;
+        int shared_lock_count;
+    } service_group;
+
     SFSlowLogContext slow_log;
 } VoteServerGlobalVars;
 
 #define MASTER_ELECTION_QUORUM g_server_global_vars.cluster. \
     master_election.quorum
-#define ELECTION_MASTER_LOST_TIMEOUT g_server_global_vars.cluster. \
-    master_election.master_lost_timeout
-#define ELECTION_MAX_WAIT_TIME   g_server_global_vars.cluster. \
-    master_election.max_wait_time
+#define ELECTION_PARAMS g_server_global_vars.cluster.master_election.params
+#define ELECTION_MASTER_LOST_TIMEOUT ELECTION_PARAMS.master_lost_timeout
+#define ELECTION_MAX_WAIT_TIME   ELECTION_PARAMS.max_wait_time
+#define ELECTION_HEARTBEAT       ELECTION_PARAMS.heartbeat
+#define ELECTION_HEARTBEAT_INTERVAL_MS ELECTION_HEARTBEAT.interval_ms
+#define ELECTION_PRE_VOTE_ENABLED ELECTION_PARAMS.pre_vote_enabled
 
 #define CLUSTER_CONFIG          g_server_global_vars.cluster.config
 #define CLUSTER_SERVER_CONFIG   CLUSTER_CONFIG.server_cfg
@@ -63,6 +70,11 @@ typedef struct server_global_vars {
 #define CLUSTER_SERVER_ARRAY    g_server_global_vars.cluster.server_array
 #define CLUSTER_MY_SERVER_ID    CLUSTER_MYSELF_PTR->server->id
 
+#define SERVICE_GROUP_HTABLE_CAPACITY   \
+    g_server_global_vars.service_group.htable_capacity
+#define SERVICE_GROUP_SHARED_LOCK_COUNT \
+    g_server_global_vars.service_group.shared_lock_count
+
 #define SERVICE_SF_CTX          g_sf_context
 #define CLUSTER_SF_CTX          g_server_global_vars.cluster.sf_context
 
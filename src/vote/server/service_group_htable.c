@@ -20,28 +20,70 @@
 #include "server_global.h"
 #include "service_group_htable.h"
 
+/* the htable doubles its capacity when the group count exceeds the
+ * capacity, the buckets of the old htable are moved to the new one by
+ * the following inserts step by step. the capacity is a multiple of
+ * the lock count so a group is guarded by the same lock in both of the
+ * htables. the groups are never freed and the retired buckets are kept
+ * for the lookups without lock
+ */
+#define SERVICE_GROUP_REHASH_BUCKETS_ONCE  64
+
 typedef struct fcfs_vote_shared_lock_array {
     pthread_mutex_t *locks;
     int count;
 } FCFSVoteSharedLockArray;
 
 typedef struct fcfs_vote_service_group_htable {
-    FCFSVoteServiceGroupInfo **buckets;
     int capacity;
+    volatile int rehash_index;   //the next bucket to move when retiring
+    volatile int rehashed_count;
+    struct fcfs_vote_service_group_htable *retired_next;
+    FCFSVoteServiceGroupInfo *volatile buckets[0];
 } FCFSVoteServiceGroupHtable;
 
 typedef struct fcfs_vote_service_group_context {
     struct fast_mblock_man allocator;  //element: FCFSVoteServiceGroupInfo
     FCFSVoteSharedLockArray lock_array;
-    FCFSVoteServiceGroupHtable htable;
+    struct {
+        FCFSVoteServiceGroupHtable *volatile current;
+        FCFSVoteServiceGroupHtable *volatile old;  //in rehashing
+        FCFSVoteServiceGroupHtable *retired;
+        volatile int group_count;
+        pthread_mutex_t lock;  //for resize
+    } htable;
 } FCFSVoteServiceGroupContext;
 
 static FCFSVoteServiceGroupContext service_group_ctx;
 
+#define SERVICE_GROUP_GET_LOCK(hash_code) \
+    (service_group_ctx.lock_array.locks + (hash_code) % \
+     service_group_ctx.lock_array.count)
+
+#define SERVICE_GROUP_GET_BUCKET(htable, hash_code) \
+    ((htable)->buckets + (hash_code) % (htable)->capacity)
+
+static FCFSVoteServiceGroupHtable *service_group_htable_alloc(
+        const int capacity)
+{
+    FCFSVoteServiceGroupHtable *htable;
+    int bytes;
+
+    bytes = sizeof(FCFSVoteServiceGroupHtable) +
+        sizeof(FCFSVoteServiceGroupInfo *) * capacity;
+    if ((htable=fc_malloc(bytes)) == NULL) {
+        return NULL;
+    }
+    memset(htable, 0, bytes);
+    htable->capacity = capacity;
+    return htable;
+}
+
 int service_group_htable_init()
 {
     int result;
     int bytes;
+    int capacity;
     pthread_mutex_t *lock;
     pthread_mutex_t *end;
 
@@ -52,7 +94,7 @@ int service_group_htable_init()
         return result;
     }
 
-    service_group_ctx.lock_array.count = 17;
+    service_group_ctx.lock_array.count = SERVICE_GROUP_SHARED_LOCK_COUNT;
     bytes = sizeof(pthread_mutex_t) * service_group_ctx.lock_array.count;
     service_group_ctx.lock_array.locks = fc_malloc(bytes);
     if (service_group_ctx.lock_array.locks == NULL) {
@@ -66,46 +108,200 @@ int service_group_htable_init()
             return result;
         }
     }
+    if ((result=init_pthread_lock(&service_group_ctx.htable.lock)) != 0) {
+        return result;
+    }
 
-    service_group_ctx.htable.capacity = 1361;
-    bytes = sizeof(FCFSVoteServiceGroupInfo *) *
-        service_group_ctx.htable.capacity;
-    service_group_ctx.htable.buckets = fc_malloc(bytes);
-    if (service_group_ctx.htable.buckets == NULL) {
+    capacity = ((SERVICE_GROUP_HTABLE_CAPACITY +
+                service_group_ctx.lock_array.count - 1) /
+            service_group_ctx.lock_array.count) *
+        service_group_ctx.lock_array.count;
+    if ((service_group_ctx.htable.current=
+                service_group_htable_alloc(capacity)) == NULL)
+    {
         return ENOMEM;
     }
-    memset(service_group_ctx.htable.buckets, 0, bytes);
 
     return 0;
 }
 
+static inline FCFSVoteServiceGroupInfo *service_group_htable_find(
+        FCFSVoteServiceGroupHtable *htable, const uint64_t hash_code)
+{
+    FCFSVoteServiceGroupInfo *current;
+
+    current = *SERVICE_GROUP_GET_BUCKET(htable, hash_code);
+    while (current != NULL) {
+        if (current->hash_code == hash_code) {
+            return current;
+        }
+        current = current->next;
+    }
+
+    return NULL;
+}
+
+/* the caller should hold the bucket lock of the hash code */
+static FCFSVoteServiceGroupInfo *service_group_htable_find_locked(
+        const uint64_t hash_code)
+{
+    FCFSVoteServiceGroupInfo *group;
+    FCFSVoteServiceGroupHtable *old;
+
+    if ((group=service_group_htable_find(service_group_ctx.
+                    htable.current, hash_code)) != NULL)
+    {
+        return group;
+    }
+
+    old = FC_ATOMIC_GET(service_group_ctx.htable.old);
+    return (old != NULL ? service_group_htable_find(old, hash_code) : NULL);
+}
+
+/* a group moved from the old htable links to the chain of the new
+ * htable, so the readers walk the new chain after the move, and the
+ * group not found should be looked up again with the bucket lock
+ */
+static inline FCFSVoteServiceGroupInfo *service_group_htable_find_lockless(
+        const uint64_t hash_code)
+{
+    FCFSVoteServiceGroupInfo *group;
+    FCFSVoteServiceGroupHtable *old;
+
+    if ((group=service_group_htable_find(FC_ATOMIC_GET(service_group_ctx.
+                        htable.current), hash_code)) != NULL)
+    {
+        return group;
+    }
+
+    old = FC_ATOMIC_GET(service_group_ctx.htable.old);
+    return (old != NULL ? service_group_htable_find(old, hash_code) : NULL);
+}
+
+static inline void service_group_htable_link(
+        FCFSVoteServiceGroupInfo *volatile *bucket,
+        FCFSVoteServiceGroupInfo *group)
+{
+    group->next = *bucket;
+    __sync_synchronize();  //publish the group fields before the bucket
+    *bucket = group;
+}
+
+static void service_group_htable_resize()
+{
+    FCFSVoteServiceGroupHtable *htable;
+    pthread_mutex_t *lock;
+    pthread_mutex_t *end;
+    int old_capacity;
+
+    PTHREAD_MUTEX_LOCK(&service_group_ctx.htable.lock);
+    old_capacity = service_group_ctx.htable.current->capacity;
+    if (service_group_ctx.htable.old != NULL || FC_ATOMIC_GET(
+                service_group_ctx.htable.group_count) <= old_capacity)
+    {
+        PTHREAD_MUTEX_UNLOCK(&service_group_ctx.htable.lock);
+        return;
+    }
+
+    if ((htable=service_group_htable_alloc(2 * old_capacity)) == NULL) {
+        PTHREAD_MUTEX_UNLOCK(&service_group_ctx.htable.lock);
+        return;
+    }
+
+    end = service_group_ctx.lock_array.locks +
+        service_group_ctx.lock_array.count;
+    for (lock=service_group_ctx.lock_array.locks; lock<end; lock++) {
+        PTHREAD_MUTEX_LOCK(lock);
+    }
+    FC_ATOMIC_SET(service_group_ctx.htable.old,
+            service_group_ctx.htable.current);
+    FC_ATOMIC_SET(service_group_ctx.htable.current, htable);
+    for (lock=service_group_ctx.lock_array.locks; lock<end; lock++) {
+        PTHREAD_MUTEX_UNLOCK(lock);
+    }
+    PTHREAD_MUTEX_UNLOCK(&service_group_ctx.htable.lock);
+
+    logInfo("file: "__FILE__", line: %d, "
+            "service group count: %d, resize htable capacity from %d to %d",
+            __LINE__, FC_ATOMIC_GET(service_group_ctx.htable.group_count),
+            old_capacity, htable->capacity);
+}
+
+static void service_group_htable_rehash(const int bucket_count)
+{
+    FCFSVoteServiceGroupHtable *old;
+    FCFSVoteServiceGroupHtable *current;
+    FCFSVoteServiceGroupInfo *group;
+    FCFSVoteServiceGroupInfo *next;
+    pthread_mutex_t *lock;
+    int bucket_index;
+    int i;
+
+    if ((old=FC_ATOMIC_GET(service_group_ctx.htable.old)) == NULL) {
+        return;
+    }
+
+    for (i=0; i<bucket_count; i++) {
+        bucket_index = __sync_fetch_and_add(&old->rehash_index, 1);
+        if (bucket_index >= old->capacity) {
+            break;
+        }
+
+        lock = SERVICE_GROUP_GET_LOCK(bucket_index);
+        PTHREAD_MUTEX_LOCK(lock);
+        current = service_group_ctx.htable.current;
+        group = old->buckets[bucket_index];
+        while (group != NULL) {
+            next = group->next;
+            service_group_htable_link(SERVICE_GROUP_GET_BUCKET(
+                        current, group->hash_code), group);
+            group = next;
+        }
+        old->buckets[bucket_index] = NULL;
+        PTHREAD_MUTEX_UNLOCK(lock);
+
+        if (__sync_add_and_fetch(&old->rehashed_count, 1) ==
+                old->capacity)
+        {
+            PTHREAD_MUTEX_LOCK(&service_group_ctx.htable.lock);
+            old->retired_next = service_group_ctx.htable.retired;
+            service_group_ctx.htable.retired = old;
+            FC_ATOMIC_SET(service_group_ctx.htable.old, NULL);
+            PTHREAD_MUTEX_UNLOCK(&service_group_ctx.htable.lock);
+
+            logInfo("file: "__FILE__", line: %d, "
+                    "service group htable rehash done, capacity: %d",
+                    __LINE__, current->capacity);
+            break;
+        }
+    }
+}
+
 int service_group_htable_get(const short service_id, const int group_id,
         const int leader_id, const short response_size,
         struct fast_task_info *task, FCFSVoteServiceGroupInfo **group)
 {
     uint64_t hash_code;
-    int bucket_index;
     int old_leader_id;
     int result;
+    bool inserted;
     pthread_mutex_t *lock;
-    FCFSVoteServiceGroupInfo **bucket;
     FCFSVoteServiceGroupInfo *current;
 
     hash_code = ((int64_t)service_id << 32) | (int64_t)group_id;
-    bucket_index = hash_code % service_group_ctx.htable.capacity;
-    lock = service_group_ctx.lock_array.locks + bucket_index %
-        service_group_ctx.lock_array.count;
-    bucket = service_group_ctx.htable.buckets + bucket_index;
-
-    PTHREAD_MUTEX_LOCK(lock);
-    current = *bucket;
-    while (current != NULL) {
-        if (hash_code == current->hash_code) {
-            break;
+    if (leader_id == 0) {
+        if ((current=service_group_htable_find_lockless(
+                        hash_code)) != NULL)
+        {
+            *group = current;
+            return 0;
         }
-        current = current->next;
     }
 
+    inserted = false;
+    lock = SERVICE_GROUP_GET_LOCK(hash_code);
+    PTHREAD_MUTEX_LOCK(lock);
+    current = service_group_htable_find_locked(hash_code);
     if (current == NULL) {
         current = fast_mblock_alloc_object(&service_group_ctx.allocator);
         if (current != NULL) {
@@ -113,10 +309,13 @@ int service_group_htable_get(const short service_id, const int group_id,
             current->service_id = service_id;
             current->response_size = response_size;
             current->group_id = group_id;
+            current->next_leader = 0;
             current->leader_id = leader_id;
             current->task = (leader_id > 0 ? task : NULL);
-            current->next = *bucket;
-            *bucket = current;
+            service_group_htable_link(SERVICE_GROUP_GET_BUCKET(
+                        service_group_ctx.htable.current,
+                        hash_code), current);
+            inserted = true;
             result = 0;
         } else {
             result = ENOMEM;
@@ -154,18 +353,24 @@ int service_group_htable_get(const short service_id, const int group_id,
 
     PTHREAD_MUTEX_UNLOCK(lock);
 
+    if (inserted) {
+        if (__sync_add_and_fetch(&service_group_ctx.htable.group_count, 1) >
+                FC_ATOMIC_GET(service_group_ctx.htable.current)->capacity)
+        {
+            service_group_htable_resize();
+        }
+        service_group_htable_rehash(SERVICE_GROUP_REHASH_BUCKETS_ONCE);
+    }
+
     *group = current;
     return result;
 }
 
 void service_group_htable_unset_task(FCFSVoteServiceGroupInfo *group)
 {
-    int bucket_index;
     pthread_mutex_t *lock;
 
-    bucket_index = group->hash_code % service_group_ctx.htable.capacity;
-    lock = service_group_ctx.lock_array.locks + bucket_index %
-        service_group_ctx.lock_array.count;
+    lock = SERVICE_GROUP_GET_LOCK(group->hash_code);
     PTHREAD_MUTEX_LOCK(lock);
     group->task = NULL;
     PTHREAD_MUTEX_UNLOCK(lock);
@@ -173,21 +378,39 @@ void service_group_htable_unset_task(FCFSVoteServiceGroupInfo *group)
 
 void service_group_htable_clear_tasks()
 {
-    FCFSVoteServiceGroupInfo **bucket;
-    FCFSVoteServiceGroupInfo **end;
+    FCFSVoteServiceGroupHtable *htable;
+    FCFSVoteServiceGroupInfo *volatile *bucket;
+    FCFSVoteServiceGroupInfo *volatile *end;
     FCFSVoteServiceGroupInfo *current;
     int bucket_index;
     int group_count;
     int clear_count;
     pthread_mutex_t *lock;
 
+    /* finish the rehash and hold the resize lock, so all groups are
+     * in the current htable during the traversal
+     */
+    while (1) {
+        while (FC_ATOMIC_GET(service_group_ctx.htable.old) != NULL) {
+            service_group_htable_rehash(SERVICE_GROUP_REHASH_BUCKETS_ONCE);
+            if (FC_ATOMIC_GET(service_group_ctx.htable.old) != NULL) {
+                fc_sleep_ms(1);
+            }
+        }
+
+        PTHREAD_MUTEX_LOCK(&service_group_ctx.htable.lock);
+        if (service_group_ctx.htable.old == NULL) {
+            break;
+        }
+        PTHREAD_MUTEX_UNLOCK(&service_group_ctx.htable.lock);
+    }
+
     group_count = clear_count = 0;
-    end = service_group_ctx.htable.buckets +
-        service_group_ctx.htable.capacity;
-    for (bucket=service_group_ctx.htable.buckets; bucket<end; bucket++) {
-        bucket_index = bucket - service_group_ctx.htable.buckets;
-        lock = service_group_ctx.lock_array.locks + bucket_index %
-            service_group_ctx.lock_array.count;
+    htable = service_group_ctx.htable.current;
+    end = htable->buckets + htable->capacity;
+    for (bucket=htable->buckets; bucket<end; bucket++) {
+        bucket_index = bucket - htable->buckets;
+        lock = SERVICE_GROUP_GET_LOCK(bucket_index);
         PTHREAD_MUTEX_LOCK(lock);
         if (*bucket != NULL) {
             current = *bucket;
@@ -201,8 +424,10 @@ void service_group_htable_clear_tasks()
         }
         PTHREAD_MUTEX_UNLOCK(lock);
     }
+    PTHREAD_MUTEX_UNLOCK(&service_group_ctx.htable.lock);
 
     logInfo("file: "__FILE__", line: %d, "
-            "service group count: %d, clear count: %d",
-            __LINE__, group_count, clear_count);
+            "service group count: %d, clear count: %d, "
+            "htable capacity: %d", __LINE__, group_count,
+            clear_count, htable->capacity);
 }
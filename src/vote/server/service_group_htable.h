@@ -29,7 +29,7 @@ typedef struct fcfs_vote_service_group_info {
     volatile int next_leader;
     volatile int leader_id;
     struct fast_task_info *task;
-    struct fcfs_vote_service_group_info *next;  //for htable
+    struct fcfs_vote_service_group_info *volatile next;  //for htable
 } FCFSVoteServiceGroupInfo;
 
 #ifdef __cplusplus
@@ -38,6 +38,9 @@ extern "C" {
 
 int service_group_htable_init();
 
+/* the lookup of the groups which exist and the leader_id is 0 takes
+ * no lock, the new group and the leader join take the bucket lock
+ */
 int service_group_htable_get(const short service_id, const int group_id,
         const int leader_id, const short response_size,
         struct fast_task_info *task, FCFSVoteServiceGroupInfo **group);
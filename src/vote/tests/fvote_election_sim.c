@@ -0,0 +1,1494 @@
+/*
+ * Copyright (c) 2020 YuQing <384681@qq.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* fvote_election_sim runs the master election of fcfs_voted and
+ * fcfs_authd against a simulated network in virtual time. the
+ * decisions come from vote_election.c, the same code as the servers,
+ * and the message flows follow cluster_relationship.c: the sequential
+ * RPCs of the relationship thread, the two phase master notify, the
+ * heartbeats to the master and the brain-split check of the master.
+ *
+ * each scenario starts the cluster then injects random faults: kill
+ * the master or a slave, restart a dead server, partition and heal
+ * the network. the events are ordered by (time, sequence) and all
+ * randomness comes from the seed, so a run is reproducible.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include "vote_election.h"
+
+#define MAX_SERVER_COUNT        16
+
+#define RPC_TIMEOUT_MS          2000   //connect and network timeout
+#define PEER_IDLE_TIMEOUT_MS    10000  //master closes the silent peer
+#define MASTER_CHECK_INTERVAL   1000
+#define MAX_SLEEP_SECONDS       10
+
+#define SIM_ERROR_NOT_MASTER    10001
+
+#define MSG_GET_STATUS          0
+#define MSG_PRE_VOTE            1
+#define MSG_PRE_SET_MASTER      2
+#define MSG_COMMIT_MASTER       3
+#define MSG_PING_MASTER         4
+#define MSG_TYPE_COUNT          5
+
+#define EVENT_WAKEUP            1
+#define EVENT_REQUEST           2
+#define EVENT_RESPONSE          3
+#define EVENT_RPC_TIMEOUT       4
+#define EVENT_FAULT             5
+
+/* what the relationship thread is doing */
+#define STAGE_SLEEPING          0
+#define STAGE_GET_STATUS        1
+#define STAGE_PRE_VOTE          2
+#define STAGE_PRE_SET_MASTER    3
+#define STAGE_COMMIT_MASTER     4
+#define STAGE_PING_MASTER       5
+#define STAGE_BRAINSPLIT_CHECK  6
+
+#define FAULT_START             0
+#define FAULT_KILL_MASTER       1
+#define FAULT_KILL_SLAVE        2
+#define FAULT_RESTART           3
+#define FAULT_PARTITION         4
+#define FAULT_HEAL              5
+#define FAULT_TYPE_COUNT        6
+
+typedef struct sim_event {
+    int64_t time;
+    int64_t seq;
+    int type;
+    int node;         //the target node index
+    int incarnation;  //of the target node for wakeup, response and timeout
+    int from;
+    int msg_type;
+    int64_t rpc_id;
+    int arg;
+    int result;
+    int payload;
+    bool is_master;
+    bool connect_fail;
+} SimEvent;
+
+typedef struct sim_node {
+    int id;
+    int index;
+    bool alive;
+    int incarnation;
+    int master_id;       //0 for none
+    int next_master_id;  //0 for none
+    double clock_rate;   //the skew of the local clock
+    FCFSVoteHeartbeatDetector detector;
+
+    int stage;
+    int64_t rpc_id;
+    bool rpc_connect_fail;  //the fate of the outstanding RPC when timeout
+
+    struct {
+        int64_t start_time;  //local time
+        int round;
+        int max_sleep_secs;
+        int index;           //the next server to contact
+        int active_count;
+        int granted_count;
+        int success_count;
+        int candidate_id;
+        bool candidate_is_master;
+    } election;
+
+    struct {
+        bool joined[MAX_SERVER_COUNT];
+        int64_t last_recv_time[MAX_SERVER_COUNT];
+        int64_t next_probe_time[MAX_SERVER_COUNT];
+        int index;
+        int inactive_count;
+    } master;
+} SimNode;
+
+typedef struct sim_fault_stat {
+    int count;
+    int no_quorum;
+    int converged;
+    int64_t *times;  //convergence time in ms
+    int alloc;
+} SimFaultStat;
+
+static struct {
+    int server_count;
+    int scenarios;
+    uint64_t seed;
+    int duration;        //in seconds
+    int fault_interval;  //in seconds
+    int latency_ms;
+    int jitter_ms;
+    double drop_percent;
+    double skew_percent;
+    bool verbose;
+    FCFSVoteElectionParams params;
+} cfg = {3, 1000, 1, 120, 20, 1, 2, 0.0, 0.0, false,
+    {3, 5, {1000, 5, 3}, true}};
+
+static struct {
+    uint64_t rand_state;
+    int64_t now;
+    int64_t event_seq;
+    int64_t rpc_seq;
+    struct {
+        SimEvent *events;
+        int count;
+        int alloc;
+    } queue;
+
+    SimNode nodes[MAX_SERVER_COUNT];
+    int groups[MAX_SERVER_COUNT];  //the partition group of the nodes
+    bool partitioned;
+
+    struct {
+        bool measuring;
+        int fault_type;
+        int64_t fault_time;
+    } convergence;
+
+    struct {
+        bool occurring;
+        int64_t start_time;
+    } split_brain;
+} sim;
+
+static struct {
+    SimFaultStat faults[FAULT_TYPE_COUNT];
+    int64_t split_brain_count;
+    int64_t split_brain_time;
+    int64_t split_brain_max_time;
+    int64_t messages[MSG_TYPE_COUNT];
+    int64_t packets;
+    int64_t events;
+} stat;
+
+static const char *msg_captions[MSG_TYPE_COUNT] = {
+    "get_status", "pre_vote", "pre_set_master", "commit_master", "ping"
+};
+
+static const char *fault_captions[FAULT_TYPE_COUNT] = {
+    "start", "kill_master", "kill_slave", "restart", "partition", "heal"
+};
+
+static void node_run(SimNode *node);
+static void rpc_done(SimNode *node, const SimEvent *event);
+
+static inline uint64_t sim_rand()
+{
+    uint64_t x;
+
+    x = sim.rand_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    sim.rand_state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+/* return [0, n) */
+static inline int sim_rand_int(const int n)
+{
+    return (int)(sim_rand() % (uint64_t)n);
+}
+
+static inline double sim_rand_double()
+{
+    return (double)(sim_rand() >> 11) / (double)(1ULL << 53);
+}
+
+static inline int64_t local_time(const SimNode *node)
+{
+    return (int64_t)(sim.now * node->clock_rate);
+}
+
+/* the real duration of the local duration of the node */
+static inline int64_t real_duration(const SimNode *node, const int64_t ms)
+{
+    return (int64_t)(ms / node->clock_rate + 0.5);
+}
+
+static inline int64_t link_latency()
+{
+    return cfg.latency_ms + (cfg.jitter_ms > 0 ?
+            sim_rand_int(cfg.jitter_ms + 1) : 0);
+}
+
+static inline bool link_ok(const int index1, const int index2)
+{
+    return sim.groups[index1] == sim.groups[index2];
+}
+
+static inline bool message_dropped()
+{
+    return cfg.drop_percent > 0.0 && sim_rand_double() * 100.0 <
+        cfg.drop_percent;
+}
+
+static inline bool quorum_check(const int active_count)
+{
+    return active_count > cfg.server_count / 2;
+}
+
+static int event_compare(const SimEvent *e1, const SimEvent *e2)
+{
+    if (e1->time != e2->time) {
+        return e1->time < e2->time ? -1 : 1;
+    }
+    return e1->seq < e2->seq ? -1 : (e1->seq > e2->seq ? 1 : 0);
+}
+
+static void event_push(SimEvent *event)
+{
+    SimEvent *events;
+    SimEvent tmp;
+    int i;
+    int parent;
+
+    if (sim.queue.count == sim.queue.alloc) {
+        sim.queue.alloc = (sim.queue.alloc == 0) ? 1024 :
+            sim.queue.alloc * 2;
+        events = (SimEvent *)realloc(sim.queue.events,
+                sizeof(SimEvent) * sim.queue.alloc);
+        if (events == NULL) {
+            fprintf(stderr, "realloc %d events fail\n", sim.queue.alloc);
+            exit(ENOMEM);
+        }
+        sim.queue.events = events;
+    }
+
+    event->seq = ++sim.event_seq;
+    events = sim.queue.events;
+    i = sim.queue.count++;
+    events[i] = *event;
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (event_compare(events + parent, events + i) <= 0) {
+            break;
+        }
+        tmp = events[parent];
+        events[parent] = events[i];
+        events[i] = tmp;
+        i = parent;
+    }
+}
+
+static bool event_pop(SimEvent *event)
+{
+    SimEvent *events;
+    SimEvent tmp;
+    int i;
+    int child;
+
+    if (sim.queue.count == 0) {
+        return false;
+    }
+
+    events = sim.queue.events;
+    *event = events[0];
+    events[0] = events[--sim.queue.count];
+    i = 0;
+    while ((child=2 * i + 1) < sim.queue.count) {
+        if (child + 1 < sim.queue.count &&
+                event_compare(events + child + 1, events + child) < 0)
+        {
+            child++;
+        }
+        if (event_compare(events + i, events + child) <= 0) {
+            break;
+        }
+        tmp = events[child];
+        events[child] = events[i];
+        events[i] = tmp;
+        i = child;
+    }
+    return true;
+}
+
+static void node_sleep(SimNode *node, const int64_t local_ms)
+{
+    SimEvent event;
+
+    memset(&event, 0, sizeof(event));
+    event.type = EVENT_WAKEUP;
+    event.time = sim.now + real_duration(node, local_ms);
+    event.node = node->index;
+    event.incarnation = node->incarnation;
+    node->stage = STAGE_SLEEPING;
+    event_push(&event);
+}
+
+/* send a request and wait for the response like the blocking calls of
+ * the relationship thread, the fate of the request is determined here
+ */
+static void rpc_send(SimNode *node, const int stage, const int to,
+        const int msg_type, const int arg, const int64_t timeout_ms)
+{
+    SimNode *peer;
+    SimEvent event;
+
+    peer = sim.nodes + to;
+    node->stage = stage;
+    node->rpc_id = ++sim.rpc_seq;
+    stat.messages[msg_type]++;
+
+    memset(&event, 0, sizeof(event));
+    event.node = node->index;
+    event.incarnation = node->incarnation;
+    event.rpc_id = node->rpc_id;
+    if (!link_ok(node->index, to)) {  //connect timeout
+        node->rpc_connect_fail = true;
+    } else if (!peer->alive) {  //connection refused
+        stat.packets++;
+        event.type = EVENT_RESPONSE;
+        event.time = sim.now + 2 * link_latency();
+        event.result = ECONNREFUSED;
+        event.connect_fail = true;
+        event_push(&event);
+        return;
+    } else {
+        stat.packets++;
+        node->rpc_connect_fail = false;
+        if (!message_dropped()) {
+            event.type = EVENT_REQUEST;
+            event.time = sim.now + link_latency();
+            event.node = to;
+            event.from = node->index;
+            event.msg_type = msg_type;
+            event.arg = arg;
+            event.incarnation = node->incarnation;
+            event_push(&event);
+        }
+    }
+
+    memset(&event, 0, sizeof(event));
+    event.type = EVENT_RPC_TIMEOUT;
+    event.time = sim.now + real_duration(node, timeout_ms);
+    event.node = node->index;
+    event.incarnation = node->incarnation;
+    event.rpc_id = node->rpc_id;
+    event.result = ETIMEDOUT;
+    event_push(&event);
+}
+
+static void node_init_inactive_servers(SimNode *node)
+{
+    int i;
+
+    for (i=0; i<cfg.server_count; i++) {
+        node->master.joined[i] = false;
+        node->master.next_probe_time[i] = 0;
+    }
+}
+
+static void node_set_master(SimNode *node, const int master_id)
+{
+    if (cfg.verbose) {
+        printf("%10"PRId64" ms: server %d set master to %d\n",
+                sim.now, node->id, master_id);
+    }
+    node->master_id = master_id;
+}
+
+static void node_trigger_reselect_master(SimNode *node)
+{
+    if (node->master_id == node->id) {
+        node->master_id = 0;
+        if (cfg.verbose) {
+            printf("%10"PRId64" ms: master %d triggers reselect\n",
+                    sim.now, node->id);
+        }
+    }
+}
+
+static int node_pre_set_master(SimNode *node, const int master_id)
+{
+    int result;
+
+    if ((result=fcfs_vote_election_check_pre_set(node->next_master_id,
+                    master_id)) != 0)
+    {
+        node->next_master_id = 0;
+        return result;
+    }
+    node->next_master_id = master_id;
+    return 0;
+}
+
+static int node_commit_master(SimNode *node, const int master_id)
+{
+    int result;
+
+    if ((result=fcfs_vote_election_check_commit(node->next_master_id,
+                    master_id)) != 0)
+    {
+        node->next_master_id = 0;
+        return result;
+    }
+    if (node->master_id != master_id) {
+        node_set_master(node, master_id);
+    }
+    node->next_master_id = 0;
+    return 0;
+}
+
+/* the cluster handler of the peer */
+static int node_deal_request(SimNode *node, const SimEvent *request,
+        int *payload, bool *is_master)
+{
+    *payload = 0;
+    *is_master = false;
+    switch (request->msg_type) {
+        case MSG_GET_STATUS:
+            *payload = node->id;
+            *is_master = (node->master_id == node->id);
+            return 0;
+        case MSG_PRE_VOTE:
+            *payload = fcfs_vote_election_pre_vote_grant(
+                    node->master_id, request->arg);
+            return 0;
+        case MSG_PRE_SET_MASTER:
+        case MSG_COMMIT_MASTER:
+            if (node->master_id == node->id) {
+                node_trigger_reselect_master(node);
+                return EEXIST;
+            }
+            if (request->msg_type == MSG_PRE_SET_MASTER) {
+                return node_pre_set_master(node, request->arg);
+            } else {
+                return node_commit_master(node, request->arg);
+            }
+        case MSG_PING_MASTER:
+            if (node->master_id != node->id &&
+                    node->next_master_id != node->id)
+            {
+                return SIM_ERROR_NOT_MASTER;
+            }
+            node->master.joined[request->from] = true;
+            node->master.last_recv_time[request->from] = sim.now;
+            return 0;
+        default:
+            return EINVAL;
+    }
+}
+
+static void on_request(const SimEvent *request)
+{
+    SimNode *node;
+    SimEvent response;
+
+    node = sim.nodes + request->node;
+    memset(&response, 0, sizeof(response));
+    response.type = EVENT_RESPONSE;
+    response.node = request->from;
+    response.incarnation = request->incarnation;
+    response.msg_type = request->msg_type;
+
+    /* the request may be in flight when the network changed */
+    if (!link_ok(request->node, request->from)) {
+        return;
+    }
+    if (!node->alive) {
+        stat.packets++;
+        response.time = sim.now + link_latency();
+        response.result = ECONNRESET;
+        response.connect_fail = true;
+        response.rpc_id = request->rpc_id;
+        event_push(&response);
+        return;
+    }
+
+    response.result = node_deal_request(node, request,
+            &response.payload, &response.is_master);
+    stat.packets++;
+    if (message_dropped()) {
+        return;
+    }
+
+    response.time = sim.now + link_latency();
+    response.rpc_id = request->rpc_id;
+    event_push(&response);
+}
+
+static void election_finish(SimNode *node, const int result)
+{
+    if (result == 0) {
+        fcfs_vote_heartbeat_reset(&node->detector, local_time(node));
+        node_sleep(node, cfg.params.heartbeat.interval_ms);
+    } else {
+        node_sleep(node, 1000 + sim_rand_int(MAX_SLEEP_SECONDS * 1000));
+    }
+}
+
+static void election_next_round(SimNode *node);
+static void election_decide(SimNode *node);
+static void election_notify_start(SimNode *node);
+static void election_notify_continue(SimNode *node);
+
+static void election_start(SimNode *node)
+{
+    node->election.start_time = local_time(node);
+    node->election.round = 0;
+    node->election.max_sleep_secs = 1;
+    election_next_round(node);
+}
+
+/* the loop of cluster_get_master */
+static void election_status_continue(SimNode *node)
+{
+    SimNode *peer;
+
+    while (node->election.index < cfg.server_count) {
+        peer = sim.nodes + node->election.index++;
+        if (peer == node) {
+            node->election.active_count++;
+            if (fcfs_vote_election_compare(node->master_id == node->id,
+                        node->id, node->election.candidate_is_master,
+                        node->election.candidate_id) > 0)
+            {
+                node->election.candidate_id = node->id;
+                node->election.candidate_is_master =
+                    (node->master_id == node->id);
+            }
+            continue;
+        }
+
+        rpc_send(node, STAGE_GET_STATUS, peer->index,
+                MSG_GET_STATUS, 0, RPC_TIMEOUT_MS);
+        return;
+    }
+
+    election_decide(node);
+}
+
+static void election_next_round(SimNode *node)
+{
+    if (node->master_id != 0) {  //abort because the master exists
+        election_finish(node, 0);
+        return;
+    }
+
+    node->election.index = 0;
+    node->election.active_count = 0;
+    node->election.candidate_id = 0;
+    node->election.candidate_is_master = false;
+    election_status_continue(node);
+}
+
+static void election_pre_vote_continue(SimNode *node)
+{
+    SimNode *peer;
+
+    while (node->election.index < cfg.server_count) {
+        peer = sim.nodes + node->election.index++;
+        if (peer == node) {
+            if (fcfs_vote_election_pre_vote_grant(node->master_id,
+                        node->election.candidate_id))
+            {
+                node->election.granted_count++;
+            }
+            continue;
+        }
+
+        rpc_send(node, STAGE_PRE_VOTE, peer->index, MSG_PRE_VOTE,
+                node->election.candidate_id, RPC_TIMEOUT_MS);
+        return;
+    }
+
+    if (fcfs_vote_election_pre_vote_passed(cfg.server_count,
+                node->election.granted_count))
+    {
+        election_notify_start(node);
+    } else {
+        /* wait for the other servers to detect the master lost */
+        node->election.index = -1;
+        node_sleep(node, cfg.params.heartbeat.interval_ms);
+    }
+}
+
+/* the code after the select loop of cluster_select_master */
+static void election_notify_start(SimNode *node)
+{
+    if (node->master_id != 0) {
+        election_finish(node, 0);
+        return;
+    }
+
+    if (node->election.candidate_id == node->id) {
+        node->stage = STAGE_PRE_SET_MASTER;
+        node->election.index = 0;
+        node->election.success_count = 0;
+        election_notify_continue(node);
+    } else if (node->election.candidate_is_master) {
+        node_set_master(node, node->election.candidate_id);
+        election_finish(node, 0);
+    } else {  //waiting for the candidate to notify
+        election_finish(node, ENOENT);
+    }
+}
+
+static void election_decide(SimNode *node)
+{
+    FCFSVoteElectionRound round;
+    int64_t elapsed_secs;
+    int remain_time;
+    int sleep_secs;
+
+    node->election.round++;
+    elapsed_secs = (local_time(node) - node->election.start_time) / 1000;
+    round.server_count = cfg.server_count;
+    round.active_count = node->election.active_count;
+    round.quorum_ok = quorum_check(node->election.active_count);
+    round.has_master = node->election.candidate_is_master;
+    round.elapsed_ms = elapsed_secs * 1000;
+    switch (fcfs_vote_election_decide(&cfg.params, &round)) {
+        case FCFS_VOTE_ELECTION_RETRY_QUORUM:
+            node->election.index = -1;
+            node_sleep(node, 1000);
+            break;
+        case FCFS_VOTE_ELECTION_DONE:
+            election_notify_start(node);
+            break;
+        case FCFS_VOTE_ELECTION_PRE_VOTE:
+            node->election.index = 0;
+            node->election.granted_count = 0;
+            election_pre_vote_continue(node);
+            break;
+        default:
+            remain_time = cfg.params.max_wait_time - elapsed_secs;
+            sleep_secs = (remain_time < node->election.max_sleep_secs) ?
+                remain_time : node->election.max_sleep_secs;
+            if ((node->election.round % 2 == 0) &&
+                    (node->election.max_sleep_secs < 8))
+            {
+                node->election.max_sleep_secs *= 2;
+            }
+            node->election.index = -1;
+            node_sleep(node, sleep_secs * 1000);
+            break;
+    }
+}
+
+/* the notify_next_master loops of the pre-set and the commit phases */
+static void election_notify_continue(SimNode *node)
+{
+    SimNode *peer;
+    int msg_type;
+    int result;
+
+    msg_type = (node->stage == STAGE_PRE_SET_MASTER) ?
+        MSG_PRE_SET_MASTER : MSG_COMMIT_MASTER;
+    while (node->election.index < cfg.server_count) {
+        peer = sim.nodes + node->election.index++;
+        if (peer == node) {
+            if (msg_type == MSG_PRE_SET_MASTER) {
+                if ((result=node_pre_set_master(node, node->id)) == 0) {
+                    node_init_inactive_servers(node);
+                }
+            } else {
+                result = node_commit_master(node, node->id);
+            }
+            if (result != 0) {
+                if (msg_type == MSG_COMMIT_MASTER) {
+                    node_trigger_reselect_master(node);
+                }
+                election_finish(node, result);
+                return;
+            }
+            node->election.success_count++;
+            continue;
+        }
+
+        rpc_send(node, node->stage, peer->index, msg_type,
+                node->id, RPC_TIMEOUT_MS);
+        return;
+    }
+
+    if (!quorum_check(node->election.success_count)) {
+        if (msg_type == MSG_COMMIT_MASTER) {
+            node_trigger_reselect_master(node);
+        }
+        election_finish(node, EAGAIN);
+        return;
+    }
+
+    if (msg_type == MSG_PRE_SET_MASTER) {
+        node->stage = STAGE_COMMIT_MASTER;
+        node->election.index = 0;
+        node->election.success_count = 0;
+        election_notify_continue(node);
+    } else {
+        election_finish(node, 0);
+    }
+}
+
+static void master_check_finish(SimNode *node, const int result)
+{
+    if (result == 0) {
+        fcfs_vote_heartbeat_reset(&node->detector, local_time(node));
+    }
+    node_sleep(node, MASTER_CHECK_INTERVAL);
+}
+
+/* the brain-split check of the master for the inactive servers */
+static void master_check_continue(SimNode *node)
+{
+    int64_t now;
+    int i;
+
+    now = local_time(node);
+    while (node->master.index < cfg.server_count) {
+        i = node->master.index++;
+        if (i == node->index || node->master.joined[i] ||
+                node->master.next_probe_time[i] > now)
+        {
+            continue;
+        }
+
+        node->master.next_probe_time[i] = now + 1000;
+        rpc_send(node, STAGE_BRAINSPLIT_CHECK, i,
+                MSG_GET_STATUS, 0, RPC_TIMEOUT_MS);
+        return;
+    }
+
+    if (!quorum_check(cfg.server_count - node->master.inactive_count)) {
+        node_trigger_reselect_master(node);
+        master_check_finish(node, EBUSY);
+        return;
+    }
+    master_check_finish(node, 0);
+}
+
+static void master_check_start(SimNode *node)
+{
+    int i;
+
+    node->master.inactive_count = 0;
+    for (i=0; i<cfg.server_count; i++) {
+        if (i == node->index) {
+            continue;
+        }
+        if (node->master.joined[i] && sim.now - node->master.
+                last_recv_time[i] > PEER_IDLE_TIMEOUT_MS)
+        {
+            node->master.joined[i] = false;  //the connection closed
+        }
+        if (!node->master.joined[i]) {
+            node->master.inactive_count++;
+        }
+    }
+
+    node->master.index = 0;
+    master_check_continue(node);
+}
+
+static void ping_master_start(SimNode *node)
+{
+    int64_t timeout_ms;
+    int i;
+
+    timeout_ms = fcfs_vote_heartbeat_ping_timeout(&cfg.params,
+            &node->detector, local_time(node)) * 1000LL;
+    if (timeout_ms > RPC_TIMEOUT_MS) {
+        timeout_ms = RPC_TIMEOUT_MS;
+    }
+    for (i=0; i<cfg.server_count; i++) {
+        if (sim.nodes[i].id == node->master_id) {
+            rpc_send(node, STAGE_PING_MASTER, i, MSG_PING_MASTER,
+                    0, timeout_ms);
+            return;
+        }
+    }
+}
+
+static void ping_master_done(SimNode *node, const SimEvent *event)
+{
+    int status;
+
+    if (event->result == 0) {
+        fcfs_vote_heartbeat_record(&cfg.params, &node->detector,
+                true, local_time(node));
+        node_sleep(node, cfg.params.heartbeat.interval_ms);
+        return;
+    }
+
+    status = fcfs_vote_heartbeat_record(&cfg.params, &node->detector,
+            false, local_time(node));
+    if (event->result == SIM_ERROR_NOT_MASTER) {
+        status = FCFS_VOTE_HEARTBEAT_LOST_TIMEOUT;
+    }
+    switch (status) {
+        case FCFS_VOTE_HEARTBEAT_LOST_MISSES:
+        case FCFS_VOTE_HEARTBEAT_LOST_TIMEOUT:
+            if (node->master_id != 0) {
+                node_set_master(node, 0);
+            }
+            fcfs_vote_heartbeat_reset(&node->detector, local_time(node));
+            node_run(node);
+            break;
+        case FCFS_VOTE_HEARTBEAT_RETRY:
+            node_run(node);
+            break;
+        default:
+            node_sleep(node, cfg.params.heartbeat.interval_ms);
+            break;
+    }
+}
+
+/* one loop of cluster_thread_entrance */
+static void node_run(SimNode *node)
+{
+    if (node->master_id == 0) {
+        if (node->election.index == -1) {  //the next round
+            election_next_round(node);
+        } else {
+            election_start(node);
+        }
+    } else if (node->master_id == node->id) {
+        node->election.index = 0;
+        master_check_start(node);
+    } else {
+        node->election.index = 0;
+        ping_master_start(node);
+    }
+}
+
+static void rpc_done(SimNode *node, const SimEvent *event)
+{
+    bool connect_fail;
+
+    node->rpc_id = 0;
+    connect_fail = (event->type == EVENT_RPC_TIMEOUT) ?
+        node->rpc_connect_fail : event->connect_fail;
+    switch (node->stage) {
+        case STAGE_GET_STATUS:
+            if (event->result == 0) {
+                node->election.active_count++;
+                if (fcfs_vote_election_compare(event->is_master,
+                            event->payload, node->election.
+                            candidate_is_master, node->election.
+                            candidate_id) > 0)
+                {
+                    node->election.candidate_id = event->payload;
+                    node->election.candidate_is_master = event->is_master;
+                }
+            }
+            election_status_continue(node);
+            break;
+        case STAGE_PRE_VOTE:
+            if (event->result == 0 && event->payload) {
+                node->election.granted_count++;
+            }
+            election_pre_vote_continue(node);
+            break;
+        case STAGE_PRE_SET_MASTER:
+        case STAGE_COMMIT_MASTER:
+            if (event->result == 0) {
+                node->election.success_count++;
+            } else if (!connect_fail) {
+                if (node->stage == STAGE_COMMIT_MASTER) {
+                    node_trigger_reselect_master(node);
+                }
+                election_finish(node, event->result);
+                break;
+            }
+            election_notify_continue(node);
+            break;
+        case STAGE_PING_MASTER:
+            ping_master_done(node, event);
+            break;
+        case STAGE_BRAINSPLIT_CHECK:
+            if (event->result == 0) {
+                if (event->is_master) {  //brain-split occurs
+                    node_trigger_reselect_master(node);
+                    master_check_finish(node, EEXIST);
+                    break;
+                }
+                node->master.inactive_count--;
+            }
+            if (node->master_id != node->id) {
+                master_check_finish(node, EBUSY);
+            } else {
+                master_check_continue(node);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static int majority_group()
+{
+    int counts[MAX_SERVER_COUNT];
+    int i;
+
+    memset(counts, 0, sizeof(counts));
+    for (i=0; i<cfg.server_count; i++) {
+        if (sim.nodes[i].alive) {
+            counts[sim.groups[i]]++;
+        }
+    }
+    for (i=0; i<cfg.server_count; i++) {
+        if (quorum_check(counts[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int current_master_index()
+{
+    int group;
+    int i;
+
+    group = majority_group();
+    for (i=0; i<cfg.server_count; i++) {
+        if (sim.nodes[i].alive && sim.groups[i] == group &&
+                sim.nodes[i].master_id == sim.nodes[i].id)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* all alive servers of the majority group follow the same master */
+static bool cluster_converged()
+{
+    int group;
+    int master_id;
+    int i;
+
+    if ((group=majority_group()) < 0) {
+        return false;
+    }
+
+    master_id = 0;
+    for (i=0; i<cfg.server_count; i++) {
+        if (!sim.nodes[i].alive || sim.groups[i] != group) {
+            continue;
+        }
+        if (master_id == 0) {
+            master_id = sim.nodes[i].master_id;
+            if (master_id == 0) {
+                return false;
+            }
+        } else if (sim.nodes[i].master_id != master_id) {
+            return false;
+        }
+    }
+
+    for (i=0; i<cfg.server_count; i++) {
+        if (sim.nodes[i].id == master_id) {
+            return sim.nodes[i].alive && sim.groups[i] == group &&
+                sim.nodes[i].master_id == master_id;
+        }
+    }
+    return false;
+}
+
+static void add_convergence_time(SimFaultStat *fs, const int64_t time_used)
+{
+    int64_t *times;
+
+    if (fs->converged == fs->alloc) {
+        fs->alloc = (fs->alloc == 0) ? 256 : fs->alloc * 2;
+        times = (int64_t *)realloc(fs->times, sizeof(int64_t) * fs->alloc);
+        if (times == NULL) {
+            fprintf(stderr, "realloc %d times fail\n", fs->alloc);
+            exit(ENOMEM);
+        }
+        fs->times = times;
+    }
+    fs->times[fs->converged++] = time_used;
+}
+
+static void check_cluster_state()
+{
+    int master_count;
+    int64_t time_used;
+    int i;
+
+    if (sim.convergence.measuring && cluster_converged()) {
+        time_used = sim.now - sim.convergence.fault_time;
+        add_convergence_time(stat.faults + sim.convergence.fault_type,
+                time_used);
+        sim.convergence.measuring = false;
+        if (cfg.verbose) {
+            printf("%10"PRId64" ms: converged after %s, time used: "
+                    "%"PRId64" ms\n", sim.now, fault_captions[
+                    sim.convergence.fault_type], time_used);
+        }
+    }
+
+    master_count = 0;
+    for (i=0; i<cfg.server_count; i++) {
+        if (sim.nodes[i].alive && sim.nodes[i].master_id ==
+                sim.nodes[i].id)
+        {
+            master_count++;
+        }
+    }
+
+    if (master_count >= 2) {
+        if (!sim.split_brain.occurring) {
+            sim.split_brain.occurring = true;
+            sim.split_brain.start_time = sim.now;
+            stat.split_brain_count++;
+        }
+    } else if (sim.split_brain.occurring) {
+        sim.split_brain.occurring = false;
+        time_used = sim.now - sim.split_brain.start_time;
+        stat.split_brain_time += time_used;
+        if (time_used > stat.split_brain_max_time) {
+            stat.split_brain_max_time = time_used;
+        }
+    }
+}
+
+static void node_start(SimNode *node, const int64_t delay)
+{
+    SimEvent event;
+
+    node->alive = true;
+    node->incarnation++;
+    node->master_id = 0;
+    node->next_master_id = 0;
+    node->rpc_id = 0;
+    node->stage = STAGE_SLEEPING;
+    node->election.index = 0;
+    node_init_inactive_servers(node);
+    fcfs_vote_heartbeat_reset(&node->detector, local_time(node));
+
+    memset(&event, 0, sizeof(event));
+    event.type = EVENT_WAKEUP;
+    event.time = sim.now + delay;
+    event.node = node->index;
+    event.incarnation = node->incarnation;
+    event_push(&event);
+}
+
+static void node_kill(SimNode *node)
+{
+    int i;
+
+    node->alive = false;
+    node->incarnation++;
+    node->master_id = 0;
+    node->next_master_id = 0;
+
+    /* the reachable master gets the connection close at once */
+    for (i=0; i<cfg.server_count; i++) {
+        if (link_ok(i, node->index)) {
+            sim.nodes[i].master.joined[node->index] = false;
+        }
+    }
+}
+
+static int pick_node(const bool alive, const int exclude)
+{
+    int indexes[MAX_SERVER_COUNT];
+    int count;
+    int i;
+
+    count = 0;
+    for (i=0; i<cfg.server_count; i++) {
+        if (sim.nodes[i].alive == alive && i != exclude) {
+            indexes[count++] = i;
+        }
+    }
+    return (count > 0) ? indexes[sim_rand_int(count)] : -1;
+}
+
+static void inject_fault()
+{
+    int candidates[FAULT_TYPE_COUNT];
+    int count;
+    int dead_count;
+    int master;
+    int fault_type;
+    int index;
+    int i;
+
+    dead_count = 0;
+    for (i=0; i<cfg.server_count; i++) {
+        if (!sim.nodes[i].alive) {
+            dead_count++;
+        }
+    }
+    master = current_master_index();
+
+    count = 0;
+    if (dead_count < (cfg.server_count - 1) / 2) {
+        if (master >= 0) {
+            candidates[count++] = FAULT_KILL_MASTER;
+        }
+        candidates[count++] = FAULT_KILL_SLAVE;
+    }
+    if (dead_count > 0) {
+        candidates[count++] = FAULT_RESTART;
+    }
+    if (cfg.server_count >= 3) {
+        candidates[count++] = sim.partitioned ?
+            FAULT_HEAL : FAULT_PARTITION;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    fault_type = candidates[sim_rand_int(count)];
+    switch (fault_type) {
+        case FAULT_KILL_MASTER:
+            index = master;
+            node_kill(sim.nodes + index);
+            break;
+        case FAULT_KILL_SLAVE:
+            if ((index=pick_node(true, master)) < 0) {
+                return;
+            }
+            node_kill(sim.nodes + index);
+            break;
+        case FAULT_RESTART:
+            index = pick_node(false, -1);
+            node_start(sim.nodes + index, 100 + sim_rand_int(500));
+            break;
+        case FAULT_PARTITION:
+            /* isolate a minority which includes the master by chance */
+            count = 1 + sim_rand_int((cfg.server_count - 1) / 2);
+            for (i=0; i<count; i++) {
+                index = (i == 0 && master >= 0 && sim_rand_int(2) == 0) ?
+                    master : sim_rand_int(cfg.server_count);
+                sim.groups[index] = 1;
+                if (cfg.verbose) {
+                    printf("%10"PRId64" ms: isolate server %d\n",
+                            sim.now, sim.nodes[index].id);
+                }
+            }
+            sim.partitioned = true;
+            index = -1;
+            break;
+        default:  //FAULT_HEAL
+            memset(sim.groups, 0, sizeof(sim.groups));
+            sim.partitioned = false;
+            index = -1;
+            break;
+    }
+
+    if (cfg.verbose) {
+        printf("%10"PRId64" ms: fault %s, server: %d\n", sim.now,
+                fault_captions[fault_type], index >= 0 ?
+                sim.nodes[index].id : 0);
+    }
+
+    stat.faults[fault_type].count++;
+    if (majority_group() < 0) {
+        stat.faults[fault_type].no_quorum++;
+        sim.convergence.measuring = false;
+    } else {
+        sim.convergence.measuring = true;
+        sim.convergence.fault_type = fault_type;
+        sim.convergence.fault_time = sim.now;
+    }
+}
+
+static void schedule_fault(const int64_t base_time)
+{
+    SimEvent event;
+
+    memset(&event, 0, sizeof(event));
+    event.type = EVENT_FAULT;
+    event.time = base_time + cfg.fault_interval * 500LL +
+        sim_rand_int(cfg.fault_interval * 1000);
+    event_push(&event);
+}
+
+static void run_scenario(const int scenario)
+{
+    SimEvent event;
+    SimNode *node;
+    double skew;
+    int64_t end_time;
+    int i;
+
+    sim.rand_state = (cfg.seed + scenario) * 0x9E3779B97F4A7C15ULL;
+    if (sim.rand_state == 0) {
+        sim.rand_state = 1;
+    }
+    sim.now = 0;
+    sim.queue.count = 0;
+    sim.partitioned = false;
+    sim.convergence.measuring = false;
+    sim.split_brain.occurring = false;
+    memset(sim.groups, 0, sizeof(sim.groups));
+    memset(sim.nodes, 0, sizeof(sim.nodes));
+
+    skew = cfg.skew_percent / 100.0;
+    for (i=0; i<cfg.server_count; i++) {
+        node = sim.nodes + i;
+        node->index = i;
+        node->id = i + 1;
+        node->clock_rate = 1.0 + skew * (2.0 * sim_rand_double() - 1.0);
+        node_start(node, sim_rand_int(1000));
+    }
+
+    stat.faults[FAULT_START].count++;
+    sim.convergence.measuring = true;
+    sim.convergence.fault_type = FAULT_START;
+    sim.convergence.fault_time = 0;
+    schedule_fault(0);
+
+    end_time = cfg.duration * 1000LL;
+    while (event_pop(&event) && event.time <= end_time) {
+        sim.now = event.time;
+        stat.events++;
+        node = sim.nodes + event.node;
+        switch (event.type) {
+            case EVENT_WAKEUP:
+                if (node->alive && node->incarnation == event.incarnation) {
+                    node_run(node);
+                }
+                break;
+            case EVENT_REQUEST:
+                on_request(&event);
+                break;
+            case EVENT_RESPONSE:
+            case EVENT_RPC_TIMEOUT:
+                if (node->alive && node->incarnation == event.incarnation &&
+                        node->rpc_id == event.rpc_id && event.rpc_id != 0)
+                {
+                    rpc_done(node, &event);
+                }
+                break;
+            case EVENT_FAULT:
+                inject_fault();
+                schedule_fault(sim.now);
+                break;
+        }
+        check_cluster_state();
+    }
+
+    sim.now = end_time;
+    check_cluster_state();
+    if (sim.split_brain.occurring) {
+        sim.split_brain.occurring = false;
+        stat.split_brain_time += sim.now - sim.split_brain.start_time;
+    }
+}
+
+static int compare_int64(const void *p1, const void *p2)
+{
+    int64_t n1;
+    int64_t n2;
+
+    n1 = *(const int64_t *)p1;
+    n2 = *(const int64_t *)p2;
+    return (n1 > n2) - (n1 < n2);
+}
+
+static inline int64_t percentile(const SimFaultStat *fs, const int percent)
+{
+    int index;
+
+    if (fs->converged == 0) {
+        return 0;
+    }
+    index = (int)((int64_t)fs->converged * percent / 100);
+    return fs->times[index < fs->converged ? index : fs->converged - 1];
+}
+
+static void output_stat()
+{
+    SimFaultStat *fs;
+    int64_t total;
+    int i;
+
+    printf("scenarios: %d, servers: %d, seed: %"PRIu64", duration: %ds, "
+            "fault interval: %ds\n", cfg.scenarios, cfg.server_count,
+            cfg.seed, cfg.duration, cfg.fault_interval);
+    printf("master_lost_timeout: %ds, max_wait_time: %ds, "
+            "heartbeat_interval_ms: %d, heartbeat miss: %d of %d, "
+            "pre_vote_enabled: %d\n", cfg.params.master_lost_timeout,
+            cfg.params.max_wait_time, cfg.params.heartbeat.interval_ms,
+            cfg.params.heartbeat.miss_threshold,
+            cfg.params.heartbeat.miss_window, cfg.params.pre_vote_enabled);
+    printf("latency: %d + [0, %d] ms, drop: %.2f%%, clock skew: %.2f%%\n\n",
+            cfg.latency_ms, cfg.jitter_ms, cfg.drop_percent,
+            cfg.skew_percent);
+
+    printf("%-12s %8s %9s %9s %12s %9s %9s %9s %9s\n", "fault", "count",
+            "no_quorum", "converged", "unconverged", "p50_ms", "p90_ms",
+            "p99_ms", "max_ms");
+    for (i=0; i<FAULT_TYPE_COUNT; i++) {
+        fs = stat.faults + i;
+        qsort(fs->times, fs->converged, sizeof(int64_t), compare_int64);
+        printf("%-12s %8d %9d %9d %12d %9"PRId64" %9"PRId64" %9"PRId64
+                " %9"PRId64"\n", fault_captions[i], fs->count,
+                fs->no_quorum, fs->converged, fs->count - fs->no_quorum -
+                fs->converged, percentile(fs, 50), percentile(fs, 90),
+                percentile(fs, 99), fs->converged > 0 ?
+                fs->times[fs->converged - 1] : 0);
+    }
+
+    printf("\nsplit-brain count: %"PRId64", total time: %"PRId64" ms, "
+            "max time: %"PRId64" ms\n", stat.split_brain_count,
+            stat.split_brain_time, stat.split_brain_max_time);
+
+    total = 0;
+    printf("requests:");
+    for (i=0; i<MSG_TYPE_COUNT; i++) {
+        total += stat.messages[i];
+        printf(" %s: %"PRId64",", msg_captions[i], stat.messages[i]);
+    }
+    printf(" total: %"PRId64", per scenario: %"PRId64"\n", total,
+            total / cfg.scenarios);
+    printf("packets: %"PRId64", events: %"PRId64"\n",
+            stat.packets, stat.events);
+}
+
+static void usage(char *argv[])
+{
+    fprintf(stderr, "Usage: %s [-n server_count=%d] [-s scenarios=%d] "
+            "[-S seed=%"PRIu64"] [-D duration=%ds] [-f fault_interval=%ds]\n"
+            "\t[-t master_lost_timeout=%ds] [-w max_wait_time=%ds] "
+            "[-i heartbeat_interval_ms=%d]\n"
+            "\t[-W heartbeat_miss_window=%d] [-k heartbeat_miss_threshold=%d] "
+            "[-P disable pre-vote]\n"
+            "\t[-l latency_ms=%d] [-j jitter_ms=%d] [-d drop_percent=%.1f] "
+            "[-K clock_skew_percent=%.1f] [-v verbose]\n",
+            argv[0], cfg.server_count, cfg.scenarios, cfg.seed,
+            cfg.duration, cfg.fault_interval, cfg.params.master_lost_timeout,
+            cfg.params.max_wait_time, cfg.params.heartbeat.interval_ms,
+            cfg.params.heartbeat.miss_window,
+            cfg.params.heartbeat.miss_threshold, cfg.latency_ms,
+            cfg.jitter_ms, cfg.drop_percent, cfg.skew_percent);
+}
+
+static int parse_args(int argc, char *argv[])
+{
+    int ch;
+
+    while ((ch=getopt(argc, argv, "hn:s:S:D:f:t:w:i:W:k:Pl:j:d:K:v")) != -1) {
+        switch (ch) {
+            case 'h':
+                usage(argv);
+                return EINTR;
+            case 'n':
+                cfg.server_count = strtol(optarg, NULL, 10);
+                break;
+            case 's':
+                cfg.scenarios = strtol(optarg, NULL, 10);
+                break;
+            case 'S':
+                cfg.seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'D':
+                cfg.duration = strtol(optarg, NULL, 10);
+                break;
+            case 'f':
+                cfg.fault_interval = strtol(optarg, NULL, 10);
+                break;
+            case 't':
+                cfg.params.master_lost_timeout = strtol(optarg, NULL, 10);
+                break;
+            case 'w':
+                cfg.params.max_wait_time = strtol(optarg, NULL, 10);
+                break;
+            case 'i':
+                cfg.params.heartbeat.interval_ms = strtol(optarg, NULL, 10);
+                break;
+            case 'W':
+                cfg.params.heartbeat.miss_window = strtol(optarg, NULL, 10);
+                break;
+            case 'k':
+                cfg.params.heartbeat.miss_threshold =
+                    strtol(optarg, NULL, 10);
+                break;
+            case 'P':
+                cfg.params.pre_vote_enabled = false;
+                break;
+            case 'l':
+                cfg.latency_ms = strtol(optarg, NULL, 10);
+                break;
+            case 'j':
+                cfg.jitter_ms = strtol(optarg, NULL, 10);
+                break;
+            case 'd':
+                cfg.drop_percent = strtod(optarg, NULL);
+                break;
+            case 'K':
+                cfg.skew_percent = strtod(optarg, NULL);
+                break;
+            case 'v':
+                cfg.verbose = true;
+                break;
+            default:
+                usage(argv);
+                return EINVAL;
+        }
+    }
+
+    /* the same ranges as the config items of cluster.conf */
+    if (cfg.server_count < 1 || cfg.server_count > MAX_SERVER_COUNT ||
+            cfg.scenarios <= 0 || cfg.duration <= 0 ||
+            cfg.fault_interval <= 0 || cfg.params.master_lost_timeout < 1 ||
+            cfg.params.master_lost_timeout > 30 ||
+            cfg.params.max_wait_time < 1 ||
+            cfg.params.max_wait_time > 300 ||
+            cfg.params.heartbeat.interval_ms < 10 ||
+            cfg.params.heartbeat.interval_ms > 10000 ||
+            cfg.params.heartbeat.miss_window < 1 ||
+            cfg.params.heartbeat.miss_window > 64 ||
+            cfg.params.heartbeat.miss_threshold < 1 ||
+            cfg.params.heartbeat.miss_threshold >
+            cfg.params.heartbeat.miss_window || cfg.latency_ms < 1 ||
+            cfg.jitter_ms < 0 || cfg.drop_percent < 0.0 ||
+            cfg.drop_percent >= 100.0 || cfg.skew_percent < 0.0 ||
+            cfg.skew_percent >= 50.0)
+    {
+        usage(argv);
+        return EINVAL;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int result;
+    int i;
+
+    if ((result=parse_args(argc, argv)) != 0) {
+        return result == EINTR ? 0 : result;
+    }
+
+    for (i=0; i<cfg.scenarios; i++) {
+        if (cfg.verbose) {
+            printf("scenario %d\n", i + 1);
+        }
+        run_scenario(i);
+    }
+
+    output_stat();
+    return 0;
+}
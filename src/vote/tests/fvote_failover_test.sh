@@ -0,0 +1,187 @@
+#!/bin/bash
+#
+# fvote_failover_test.sh starts a local fcfs_voted cluster on 127.0.0.1,
+# kills the master with SIGKILL round by round, and measures the time
+# until another server becomes the master.
+#
+# the programs fcfs_voted and fvote_cluster_stat should be installed
+# or in the PATH, the master is detected by polling fvote_cluster_stat
+# so the measured time has tens of milliseconds precision.
+#
+
+SERVER_COUNT=3
+ROUNDS=5
+HEARTBEAT_INTERVAL_MS=100
+BASE_PORT=41111
+PRE_VOTE_ENABLED=true
+WAIT_TIMEOUT=60
+
+usage() {
+  echo "Usage: $0 [-n server_count=$SERVER_COUNT] [-r rounds=$ROUNDS]" \
+    "[-i heartbeat_interval_ms=$HEARTBEAT_INTERVAL_MS]" \
+    "[-p base_port=$BASE_PORT] [-P disable pre-vote]"
+}
+
+while getopts "hn:r:i:p:P" opt; do
+  case $opt in
+    h) usage; exit 0;;
+    n) SERVER_COUNT=$OPTARG;;
+    r) ROUNDS=$OPTARG;;
+    i) HEARTBEAT_INTERVAL_MS=$OPTARG;;
+    p) BASE_PORT=$OPTARG;;
+    P) PRE_VOTE_ENABLED=false;;
+    *) usage; exit 1;;
+  esac
+done
+
+for program in fcfs_voted fvote_cluster_stat; do
+  if ! command -v $program > /dev/null 2>&1; then
+    echo "program $program not found in PATH" >&2
+    exit 2
+  fi
+done
+
+WORK_PATH=$(mktemp -d /tmp/fvote_failover.XXXXXX) || exit 2
+
+now_ms() {
+  echo $(( $(date +%s%N) / 1000000 ))
+}
+
+server_pid() {
+  pgrep -f "fcfs_voted $WORK_PATH/server-$1/server.conf"
+}
+
+start_server() {
+  fcfs_voted $WORK_PATH/server-$1/server.conf start > /dev/null 2>&1
+}
+
+stop_all() {
+  local id
+  for (( id=1; id<=SERVER_COUNT; id++ )); do
+    fcfs_voted $WORK_PATH/server-$id/server.conf stop > /dev/null 2>&1
+  done
+}
+
+cleanup() {
+  stop_all
+  rm -rf $WORK_PATH
+}
+trap cleanup EXIT
+
+# output the server id of the master, empty for no master
+get_master() {
+  fvote_cluster_stat -c $WORK_PATH/client.conf 2> /dev/null | \
+    awk -F '[:, ]+' '/is_master: 1/ {print $2; exit}'
+}
+
+# wait for a master which is not the excluded server id
+wait_master() {
+  local exclude=$1
+  local start=$(now_ms)
+  local master
+  while (( $(now_ms) - start < WAIT_TIMEOUT * 1000 )); do
+    master=$(get_master)
+    if [ -n "$master" ] && [ "$master" != "$exclude" ]; then
+      echo $master
+      return 0
+    fi
+    sleep 0.02
+  done
+  return 1
+}
+
+write_configs() {
+  local id cluster_port service_port
+  {
+    echo "[master-election]"
+    echo "quorum = majority"
+    echo "master_lost_timeout = 3"
+    echo "max_wait_time = 5"
+    echo "heartbeat_interval_ms = $HEARTBEAT_INTERVAL_MS"
+    echo "heartbeat_miss_window = 5"
+    echo "heartbeat_miss_threshold = 3"
+    echo "pre_vote_enabled = $PRE_VOTE_ENABLED"
+    echo
+    echo "[group-cluster]"
+    echo "port = $BASE_PORT"
+    echo
+    echo "[group-service]"
+    echo "port = $(( BASE_PORT + 1 ))"
+    echo
+    for (( id=1; id<=SERVER_COUNT; id++ )); do
+      cluster_port=$(( BASE_PORT + 2 * (id - 1) ))
+      service_port=$(( cluster_port + 1 ))
+      echo "[server-$id]"
+      echo "cluster-port = $cluster_port"
+      echo "service-port = $service_port"
+      echo "host = 127.0.0.1"
+      echo
+    done
+  } > $WORK_PATH/cluster.conf
+
+  echo "cluster_config_filename = cluster.conf" > $WORK_PATH/client.conf
+
+  for (( id=1; id<=SERVER_COUNT; id++ )); do
+    cluster_port=$(( BASE_PORT + 2 * (id - 1) ))
+    service_port=$(( cluster_port + 1 ))
+    mkdir -p $WORK_PATH/server-$id
+    {
+      echo "base_path = $WORK_PATH/server-$id"
+      echo "cluster_config_filename = ../cluster.conf"
+      echo "log_level = info"
+      echo
+      echo "[cluster]"
+      echo "port = $cluster_port"
+      echo "work_threads = 2"
+      echo
+      echo "[service]"
+      echo "port = $service_port"
+      echo "work_threads = 2"
+    } > $WORK_PATH/server-$id/server.conf
+  done
+}
+
+write_configs
+for (( id=1; id<=SERVER_COUNT; id++ )); do
+  start_server $id || { echo "start server $id fail" >&2; exit 2; }
+done
+
+master=$(wait_master "") || { echo "no master elected" >&2; exit 3; }
+echo "servers: $SERVER_COUNT, heartbeat_interval_ms: $HEARTBEAT_INTERVAL_MS," \
+  "pre_vote_enabled: $PRE_VOTE_ENABLED, work path: $WORK_PATH"
+
+total=0
+min=-1
+max=0
+for (( round=1; round<=ROUNDS; round++ )); do
+  master=$(wait_master "") || { echo "no master elected" >&2; exit 3; }
+  pid=$(server_pid $master)
+  if [ -z "$pid" ]; then
+    echo "the pid of the master server $master not found" >&2
+    exit 3
+  fi
+
+  start=$(now_ms)
+  kill -9 $pid
+  new_master=$(wait_master $master) || {
+    echo "round $round: no new master after $WAIT_TIMEOUT seconds" >&2
+    exit 4
+  }
+  time_used=$(( $(now_ms) - start ))
+  echo "round $round: killed master $master, new master: $new_master," \
+    "time used: $time_used ms"
+
+  total=$(( total + time_used ))
+  if (( min < 0 || time_used < min )); then
+    min=$time_used
+  fi
+  if (( time_used > max )); then
+    max=$time_used
+  fi
+
+  start_server $master || { echo "restart server $master fail" >&2; exit 2; }
+  sleep 2  #wait for the restarted server to join
+done
+
+echo "rounds: $ROUNDS, time to new master min: $min ms," \
+  "avg: $(( total / ROUNDS )) ms, max: $max ms"